@@ -49,8 +49,58 @@ typedef enum {
     TELEBOT_ERROR_OUT_OF_MEMORY     = -3,   /**< Out of memory */
     TELEBOT_ERROR_NO_CONNECTION     = -4,   /**< No Internet connection */
     TELEBOT_ERROR_INVALID_PARAMETER = -5,   /**< Invalid parameter */
+    TELEBOT_ERROR_CANCELED          = -6,   /**< Canceled, result is no longer needed */
 } telebot_error_e;
 
+/**
+ * @brief HTTP versions of the Bot API transport, see #telebot_set_http_version().
+ */
+typedef enum telebot_http_version {
+    TELEBOT_HTTP_VERSION_DEFAULT = 0,       /**< New HTTP/1.1 connection per request */
+    TELEBOT_HTTP_VERSION_1_1,               /**< Persistent HTTP/1.1 connections, one request at a time each */
+    TELEBOT_HTTP_VERSION_2,                 /**< HTTP/2 over TLS with requests multiplexed on shared
+                                                 connections, HTTP/1.1 if the server does not support it */
+    TELEBOT_HTTP_VERSION_2_PRIOR_KNOWLEDGE, /**< HTTP/2 without TLS negotiation, for local Bot API servers */
+} telebot_http_version_e;
+
+/**
+ * @brief Runtime statistics of telebot handler, obtained with
+ * #telebot_get_stats() or #telebot_core_get_stats().
+ */
+typedef struct telebot_stats {
+    unsigned long long buffer_pool_hits;     /**< Responses received into a recycled buffer */
+    unsigned long long buffer_pool_misses;   /**< Responses that required a new buffer */
+    unsigned long long buffer_pool_grows;    /**< Buffer reallocations while receiving responses */
+    unsigned long long buffer_pool_retained; /**< Bytes currently held by the buffer pool */
+    unsigned long long chat_cache_hits;      /**< Chat information requests served from the cache */
+    unsigned long long chat_cache_misses;    /**< Chat information requests sent to the server */
+    unsigned long long chat_cache_invalidations; /**< Cached responses dropped by updates or changes */
+    unsigned long long chat_cache_entries;   /**< Responses currently cached */
+    unsigned long long http_requests;        /**< Requests sent to the Bot API server */
+    unsigned long long http_connections;     /**< Connections opened for the requests */
+    unsigned long long edits_sent;           /**< Coalesced edits sent to the server */
+    unsigned long long edits_coalesced;      /**< Queued edits superseded by later ones */
+    unsigned long long edits_skipped;        /**< Queued edits matching the message already */
+    unsigned long long chat_actions_sent;    /**< Started and refreshed chat actions sent */
+    unsigned long long chat_actions_deduplicated; /**< Chat actions started while already shown */
+    unsigned long long batched_requests;     /**< Requests sent for batched messages */
+    unsigned long long batched_messages;     /**< Messages deleted, forwarded or copied in batches */
+    unsigned long long inline_cache_hits;    /**< Inline queries answered from cache */
+    unsigned long long inline_cache_misses;  /**< Inline queries not found in cache */
+    unsigned long long inline_cache_entries; /**< Answers in the inline cache */
+    unsigned long long inline_cache_bytes;   /**< Memory used by the inline cache */
+    unsigned long long inline_queries_superseded; /**< Inline queries followed by a newer one of the user */
+    unsigned long long inline_answers_dropped; /**< Answers to superseded inline queries not sent */
+    unsigned long long payment_queries;      /**< Shipping and pre-checkout queries of the payment lane */
+    unsigned long long payment_answers;      /**< Payment queries answered by the handler in time */
+    unsigned long long payment_overruns;     /**< Payment queries answered with an error at the deadline */
+    unsigned long long payment_late_answers; /**< Handler answers after the deadline, not sent */
+    unsigned long long payment_answer_time_max; /**< Longest time to answer a payment query, milliseconds */
+    unsigned long long sticker_cache_hits;   /**< Sticker sets served from the cache */
+    unsigned long long sticker_cache_misses; /**< Sticker sets requested from the server */
+    unsigned long long sticker_cache_entries; /**< Sticker sets currently cached */
+} telebot_stats_t;
+
 /**
  * @} // end of APIs
  */
@@ -55,6 +55,11 @@ typedef struct telebot_core_handler *telebot_core_handler_t;
  */
 typedef struct telebot_core_response *telebot_core_response_t;
 
+/**
+ * @brief Prepared request opaque type, see #telebot_core_prepare_send_message().
+ */
+typedef struct telebot_prepared_request *telebot_prepared_request_t;
+
 /**
  * @brief Get response error code.
  * @param[in] response Response to get its error code.
@@ -63,6 +68,14 @@ typedef struct telebot_core_response *telebot_core_response_t;
  */
 telebot_error_e telebot_core_get_response_code(telebot_core_response_t response);
 
+/**
+ * @brief Get HTTP status of response.
+ * @param[in] response Response to get its HTTP status.
+ * @return HTTP status received from the server, 0 if the request failed
+ * before a response was received.
+ */
+long telebot_core_get_response_status(telebot_core_response_t response);
+
 /**
  * @brief Get response data.
  * @param[in] response Response to get its data.
@@ -73,6 +86,10 @@ const char *telebot_core_get_response_data(telebot_core_response_t response);
 
 /**
  * @brief Release response data obtained with telebot core methods.
+ *
+ * Response data buffers are recycled for the following requests of the same
+ * core handler. A response may be released after its handler is destroyed,
+ * the buffers are freed then.
  * @param[in] response Response to release.
  */
 void telebot_core_put_response(telebot_core_response_t response);
@@ -122,6 +139,57 @@ telebot_error_e telebot_core_set_proxy(telebot_core_handler_t core_h, const char
  */
 telebot_error_e telebot_core_get_proxy(telebot_core_handler_t core_h, char **addr);
 
+/**
+ * @brief Set address of the Bot API server to send requests to, e.g. a
+ * self-hosted Bot API server or a local mock server used for testing.
+ *
+ * @param[in] core_h The telebot core handler created with #telebot_core_create().
+ * @param[in] url Server address without trailing path, e.g. "http://127.0.0.1:8081",
+ * or NULL to use the default "https://api.telegram.org".
+ * @return on Success, TELEBOT_ERROR_NONE is returned, otherwise a negative error value.
+ */
+telebot_error_e telebot_core_set_api_url(telebot_core_handler_t core_h, const char *url);
+
+/**
+ * @brief Default maximum number of connections of the shared transport, see
+ * #telebot_core_set_http_version().
+ */
+#define TELEBOT_HTTP_MAX_CONNECTIONS 4
+
+/**
+ * @brief Default maximum number of concurrent HTTP/2 streams per connection.
+ */
+#define TELEBOT_HTTP_MAX_STREAMS 100
+
+/**
+ * @brief Set HTTP version of requests. Any version except
+ * #TELEBOT_HTTP_VERSION_DEFAULT sends requests of all threads through a
+ * shared transport, which keeps connections open and, with HTTP/2, multiplexes
+ * concurrent requests on them. It may be changed while requests are sent,
+ * requests in flight complete on the previous transport.
+ *
+ * @param[in] core_h The telebot core handler created with #telebot_core_create().
+ * @param[in] version HTTP version, refers to #telebot_http_version_e.
+ * @param[in] max_connections Maximum number of connections to the server,
+ * 0 for #TELEBOT_HTTP_MAX_CONNECTIONS. With HTTP/1.1 it limits the number
+ * of requests in flight, including a long polling getUpdates.
+ * @param[in] max_streams Maximum number of concurrent requests on one HTTP/2
+ * connection, 0 for #TELEBOT_HTTP_MAX_STREAMS.
+ * @return on Success, TELEBOT_ERROR_NONE is returned, otherwise a negative error value.
+ */
+telebot_error_e telebot_core_set_http_version(telebot_core_handler_t core_h, telebot_http_version_e version,
+                                              int max_connections, int max_streams);
+
+/**
+ * @brief Get runtime statistics of the core handler, e.g. hit rate of the
+ * response buffer pool.
+ *
+ * @param[in] core_h The telebot core handler created with #telebot_core_create().
+ * @param[out] stats Statistics collected since the handler is created.
+ * @return on Success, TELEBOT_ERROR_NONE is returned, otherwise a negative error value.
+ */
+telebot_error_e telebot_core_get_stats(telebot_core_handler_t core_h, telebot_stats_t *stats);
+
 /**
  * @brief Receive incoming updates (long polling). It will not work if an outgoing
  * webhook is set up. In order to avoid getting duplicate updates, recalculate
@@ -226,6 +294,50 @@ telebot_core_response_t telebot_core_send_message(telebot_core_handler_t core_h,
         bool disable_web_page_preview, bool disable_notification,
         int reply_to_message_id, const char *reply_markup);
 
+/**
+ * @brief Prepare sendMessage request with parameters that are the same for many
+ * messages. Constant parameters, including the serialized keyboard, are encoded
+ * once, so sending the prepared request only encodes the chat and text.
+ * @param[in] core_h The telebot core handler created with #telebot_core_create().
+ * @param[in] parse_mode Send Markdown or HTML, if you want Telegram apps to show bold,
+ * italic, fixed-width or inline URLs in your bot's message.
+ * @param[in] disable_web_page_preview Disables link previews for links in this message.
+ * @param[in] disable_notification Sends the message silently. Users will receive a
+ * notification with no sound.
+ * @param[in] reply_markup Additional interface options. An object for a custom
+ * reply keyboard, instructions to hide keyboard or to force a reply from the user.
+ * @param[out] prepared Prepared request, which MUST be released with
+ * #telebot_core_put_prepared_request(). It is not modified by sending, so it
+ * can be used from several threads.
+ * @return on Success, TELEBOT_ERROR_NONE is returned, otherwise a negative error value.
+ */
+telebot_error_e telebot_core_prepare_send_message(telebot_core_handler_t core_h, const char *parse_mode,
+        bool disable_web_page_preview, bool disable_notification, const char *reply_markup,
+        telebot_prepared_request_t *prepared);
+
+/**
+ * @brief Send text message using request prepared with
+ * #telebot_core_prepare_send_message().
+ * @param[in] core_h The telebot core handler created with #telebot_core_create().
+ * @param[in] prepared Prepared sendMessage request.
+ * @param[in] chat_id Unique identifier for the target chat.
+ * @param[in] text Text of the message to be sent, 1-4096 characters after entities parsing.
+ * @param[in] reply_to_message_id If the message is a reply, ID of the original message.
+ * @return #telebot_core_response_t response that contains the sent message,
+ * which MUST be released with #telebot_core_put_response(), or null if allocation fails.
+ * Response code should be checked with #teleobot_core_get_response_code(),
+ * before getting data with #telebot_core_get_response_data().
+ */
+telebot_core_response_t telebot_core_send_prepared_message(telebot_core_handler_t core_h,
+        telebot_prepared_request_t prepared, long long int chat_id, const char *text,
+        int reply_to_message_id);
+
+/**
+ * @brief Release prepared request.
+ * @param[in] prepared Prepared request to release.
+ */
+void telebot_core_put_prepared_request(telebot_prepared_request_t prepared);
+
 /**
  * @brief Forward messages of any kind.
  * @param[in] core_h The telebot core handler created with #telebot_core_create().
@@ -1694,6 +1806,56 @@ telebot_core_response_t telebot_core_unpin_all_general_forum_topic_messages(tele
 telebot_core_response_t telebot_core_get_custom_emoji_stickers(telebot_core_handler_t core_h,
         const char *custom_emoji_ids);
 
+/**
+ * @brief Use this method to get a sticker set.
+ * @param[in] core_h The telebot core handler.
+ * @param[in] name Name of the sticker set.
+ * @return #telebot_core_response_t response that contains a StickerSet object.
+ */
+telebot_core_response_t telebot_core_get_sticker_set(telebot_core_handler_t core_h,
+        const char *name);
+
+/**
+ * @brief Use this method to upload a file with a sticker for later use in the
+ * #telebot_core_create_new_sticker_set() and #telebot_core_add_sticker_to_set()
+ * methods.
+ * @param[in] core_h The telebot core handler.
+ * @param[in] user_id User identifier of sticker file owner.
+ * @param[in] sticker Path to the .WEBP, .PNG, .TGS, or .WEBM file to upload.
+ * @param[in] sticker_format Format of the sticker, must be one of "static",
+ * "animated", "video".
+ * @return #telebot_core_response_t response that contains the uploaded File.
+ */
+telebot_core_response_t telebot_core_upload_sticker_file(telebot_core_handler_t core_h,
+        long long int user_id, const char *sticker, const char *sticker_format);
+
+/**
+ * @brief Use this method to create a new sticker set owned by a user.
+ * @param[in] core_h The telebot core handler.
+ * @param[in] user_id User identifier of created sticker set owner.
+ * @param[in] name Short name of sticker set, must end in "_by_<bot_username>".
+ * @param[in] title Sticker set title, 1-64 characters.
+ * @param[in] stickers JSON-serialized list of 1-50 initial InputSticker objects.
+ * @param[in] sticker_type Optional. Type of stickers in the set, "regular",
+ * "mask" or "custom_emoji".
+ * @return #telebot_core_response_t response that contains the result (true/false).
+ */
+telebot_core_response_t telebot_core_create_new_sticker_set(telebot_core_handler_t core_h,
+        long long int user_id, const char *name, const char *title, const char *stickers,
+        const char *sticker_type);
+
+/**
+ * @brief Use this method to add a new sticker to a set created by the bot.
+ * @param[in] core_h The telebot core handler.
+ * @param[in] user_id User identifier of sticker set owner.
+ * @param[in] name Sticker set name.
+ * @param[in] sticker JSON-serialized InputSticker object with information
+ * about the added sticker.
+ * @return #telebot_core_response_t response that contains the result (true/false).
+ */
+telebot_core_response_t telebot_core_add_sticker_to_set(telebot_core_handler_t core_h,
+        long long int user_id, const char *name, const char *sticker);
+
 /**
  * @brief Use this method to send answers to an inline query to a user from a Web App.
  * @param[in] core_h The telebot core handler.
@@ -1745,6 +1907,38 @@ telebot_core_response_t telebot_core_answer_inline_query(telebot_core_handler_t
         const char *inline_query_id, const char *results, int cache_time,
         bool is_personal, const char *next_offset, const char *button);
 
+/**
+ * @brief Prepare answerInlineQuery request with a page of results, so that
+ * it can be sent to several queries without encoding results again.
+ * @param[in] core_h The telebot core handler.
+ * @param[in] results A JSON-serialized array of results for the inline query.
+ * @param[in] cache_time The maximum amount of time in seconds that the result
+ * of the inline query may be cached on the server.
+ * @param[in] is_personal Pass True, if results may be cached only for the user
+ * that sent the query.
+ * @param[in] next_offset Pass the offset that a client should send in the next
+ * query with the same text to receive more results.
+ * @param[in] button A JSON-serialized object describing a button to be shown
+ * above inline query results.
+ * @param[out] prepared Prepared request, which MUST be released with
+ * #telebot_core_put_prepared_request().
+ * @return on Success, TELEBOT_ERROR_NONE is returned, otherwise a negative error value.
+ */
+telebot_error_e telebot_core_prepare_answer_inline_query(telebot_core_handler_t core_h,
+        const char *results, int cache_time, bool is_personal, const char *next_offset,
+        const char *button, telebot_prepared_request_t *prepared);
+
+/**
+ * @brief Answer an inline query with request prepared with
+ * #telebot_core_prepare_answer_inline_query().
+ * @param[in] core_h The telebot core handler.
+ * @param[in] prepared Prepared answerInlineQuery request.
+ * @param[in] inline_query_id Unique identifier for the answered query.
+ * @return #telebot_core_response_t response.
+ */
+telebot_core_response_t telebot_core_answer_prepared_inline_query(telebot_core_handler_t core_h,
+        telebot_prepared_request_t prepared, const char *inline_query_id);
+
 /**
  * @brief Use this method to save a prepared inline message.
  * @param[in] core_h The telebot core handler.
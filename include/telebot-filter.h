@@ -0,0 +1,108 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TELEBOT_FILTER_H__
+#define __TELEBOT_FILTER_H__
+
+#include "telebot-common.h"
+#include "telebot-types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file        telebot-filter.h
+ * @ingroup     TELEBOT_API
+ * @brief       This file contains the update filter of telegram bot
+ * @author      Elmurod Talipov
+ * @date        2026-10-18
+ */
+
+/**
+ * @addtogroup TELEBOT_API
+ * @{
+ */
+
+/**
+ * @brief This object describes which updates are delivered by
+ * #telebot_get_updates(). Criteria with zero count are not used.
+ *
+ * An update is delivered if its type is one of @p update_types, its chat is
+ * one of @p chat_ids, and it matches at least one of the content criteria
+ * (@p commands, @p entity_types, @p callback_data_prefixes) that are set.
+ * Updates without a chat (e.g. inline queries or polls) are rejected when
+ * @p chat_ids are set. Commands and entity types are matched against
+ * messages, callback data prefixes against callback queries.
+ */
+typedef struct telebot_update_filter
+{
+    /** Update types to deliver */
+    telebot_update_type_e *update_types;
+    int update_types_count;
+
+    /** Identifiers of the chats to deliver updates from */
+    long long int *chat_ids;
+    int chat_ids_count;
+
+    /**
+     * Commands to deliver messages of, with or without leading '/', e.g.
+     * "start". A command matches "/start", "/start args" and "/start@bot".
+     */
+    const char **commands;
+    int commands_count;
+
+    /**
+     * Message entity types to deliver messages with, e.g. "url" or "mention".
+     * Entities of both text and caption are considered.
+     */
+    const char **entity_types;
+    int entity_types_count;
+
+    /** Prefixes of callback data to deliver callback queries with */
+    const char **callback_data_prefixes;
+    int callback_data_prefixes_count;
+} telebot_update_filter_t;
+
+/**
+ * @brief Set filter of updates for the handler.
+ *
+ * The filter is compiled once and evaluated on the raw updates received by
+ * #telebot_get_updates(), before they are parsed. Updates that don't match
+ * are skipped without being parsed or allocated, but they are still confirmed
+ * to Telegram, so they are not received again. #telebot_get_updates() may
+ * therefore return #TELEBOT_ERROR_NONE with zero updates.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] filter Filter description, copied by the function. NULL removes
+ * the filter of the handler.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_update_filter(telebot_handler_t handle,
+    const telebot_update_filter_t *filter);
+
+/**
+ * @} // end of APIs
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TELEBOT_FILTER_H__ */
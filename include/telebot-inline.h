@@ -20,6 +20,7 @@
 #define __TELEBOT_INLINE_H__
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "telebot-types.h"
 
 #ifdef __cplusplus
@@ -46,6 +47,86 @@ telebot_error_e telebot_answer_inline_query(telebot_handler_t handle,
     const char *inline_query_id, const char *results, int cache_time,
     bool is_personal, const char *next_offset, const char *button);
 
+/**
+ * @brief Enable or disable cancellation of superseded inline queries.
+ *
+ * As users type, a new inline query is received for every keystroke. Once a
+ * newer query of the same user is received with #telebot_get_updates(), the
+ * earlier ones are superseded: #telebot_is_inline_query_superseded() returns
+ * true for them, so their handlers can stop computing results, and answers to
+ * them are not sent, the answering functions return #TELEBOT_ERROR_CANCELED.
+ * Superseded queries and dropped answers are reported by #telebot_get_stats().
+ * It is disabled by default.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] enable True to cancel superseded queries.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_inline_query_supersession(telebot_handler_t handle, bool enable);
+
+/**
+ * @brief Check if an inline query is superseded by a newer query of its user,
+ * see #telebot_set_inline_query_supersession().
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] inline_query_id Unique identifier of the query.
+ * @return true if the query is superseded, its answer would be dropped.
+ */
+bool telebot_is_inline_query_superseded(telebot_handler_t handle, const char *inline_query_id);
+
+/**
+ * @brief Default memory bound of the inline cache in bytes, see
+ * #telebot_set_inline_cache().
+ */
+#define TELEBOT_INLINE_CACHE_SIZE (16 * 1024 * 1024)
+
+/**
+ * @brief Enable or disable cache of inline query answers.
+ *
+ * Answers given with #telebot_answer_inline_query_cached() are kept encoded
+ * for @p ttl seconds, keyed by query, offset and personalization key, so that
+ * #telebot_answer_inline_query_from_cache() answers repeated queries without
+ * computing or encoding results again. Queries differing only in case or
+ * spacing share answers. The least recently used answers are dropped to stay
+ * within @p max_size bytes. Hits and misses are reported by
+ * #telebot_get_stats(). The cache is disabled by default.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] ttl Seconds answers are cached for, 0 disables the cache.
+ * @param[in] max_size Memory bound in bytes, 0 for #TELEBOT_INLINE_CACHE_SIZE.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_inline_cache(telebot_handler_t handle, int ttl, size_t max_size);
+
+/**
+ * @brief Answer an inline query with a cached answer if there is one.
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] inline_query_id Unique identifier for the answered query.
+ * @param[in] query Text of the query.
+ * @param[in] offset Offset of the results to be returned.
+ * @param[in] personal_key Key of answers personalized for the user, for
+ * example the user id, or NULL for answers shared by all users.
+ * @param[out] answered Set to true if the query was answered from cache,
+ * otherwise the answer needs to be computed and given with
+ * #telebot_answer_inline_query_cached().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_answer_inline_query_from_cache(telebot_handler_t handle,
+    const char *inline_query_id, const char *query, const char *offset,
+    const char *personal_key, bool *answered);
+
+/**
+ * @brief Answer an inline query and cache the answer for the same query,
+ * offset and personalization key, see #telebot_answer_inline_query() and
+ * #telebot_answer_inline_query_from_cache() for parameters.
+ */
+telebot_error_e telebot_answer_inline_query_cached(telebot_handler_t handle,
+    const char *inline_query_id, const char *query, const char *offset,
+    const char *personal_key, const char *results, int cache_time,
+    bool is_personal, const char *next_offset, const char *button);
+
 /**
  * @brief Use this method to save a prepared inline message.
  */
@@ -0,0 +1,117 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TELEBOT_JOURNAL_H__
+#define __TELEBOT_JOURNAL_H__
+
+#include <stddef.h>
+#include "telebot-common.h"
+#include "telebot-types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file        telebot-journal.h
+ * @ingroup     TELEBOT_API
+ * @brief       This file contains the durable update journal of telegram bot
+ * @author      Elmurod Talipov
+ * @date        2026-10-18
+ */
+
+/**
+ * @addtogroup TELEBOT_API
+ * @{
+ */
+
+/**
+ * @brief Default capacity of the journal ring, in bytes.
+ */
+#define TELEBOT_JOURNAL_DEFAULT_CAPACITY (8 * 1024 * 1024)
+
+/**
+ * @brief Enable the update journal for the handler.
+ *
+ * Once enabled, #telebot_get_updates() appends every raw update to an
+ * append-only, memory mapped ring file before the updates are parsed and the
+ * polling offset is advanced. Updates stay in the journal until they are
+ * acknowledged with #telebot_ack_update(). If the journal already holds
+ * unacknowledged updates (e.g. the previous process crashed while handling
+ * them), they are returned by the following #telebot_get_updates() calls
+ * before any new update is polled, giving at-least-once processing.
+ *
+ * When the ring cannot hold a new batch, #telebot_get_updates() fails without
+ * confirming the batch to Telegram, so it is delivered again once enough
+ * updates are acknowledged.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] path Path of the journal file, created if it does not exist.
+ * @param[in] capacity Size of the ring in bytes, used only when the file is
+ * created. Zero selects #TELEBOT_JOURNAL_DEFAULT_CAPACITY.
+ * @param[in] sync_batch Number of appended batches and acknowledgements after
+ * which the journal is flushed to disk. Values below 1 flush on every change.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_enable_journal(telebot_handler_t handle, const char *path,
+    size_t capacity, int sync_batch);
+
+/**
+ * @brief Flush and close the update journal of the handler.
+ *
+ * Unacknowledged updates are kept in the file and replayed the next time the
+ * journal is enabled. The journal is closed by #telebot_destroy() as well.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_disable_journal(telebot_handler_t handle);
+
+/**
+ * @brief Acknowledge that updates are completely processed.
+ *
+ * All journaled updates with identifier up to and including @p update_id
+ * are released from the journal and will not be replayed.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] update_id Identifier of the last processed update.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_ack_update(telebot_handler_t handle, int update_id);
+
+/**
+ * @brief Force pending journal changes to be written to disk.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_sync_journal(telebot_handler_t handle);
+
+/**
+ * @} // end of APIs
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TELEBOT_JOURNAL_H__ */
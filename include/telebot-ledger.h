@@ -0,0 +1,176 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TELEBOT_LEDGER_H__
+#define __TELEBOT_LEDGER_H__
+
+#include "telebot-common.h"
+#include "telebot-types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file        telebot-ledger.h
+ * @ingroup     TELEBOT_API
+ * @brief       This file contains the local Telegram Stars ledger of telegram bot
+ * @author      Elmurod Talipov
+ * @date        2026-10-19
+ */
+
+/**
+ * @addtogroup TELEBOT_API
+ * @{
+ */
+
+/**
+ * @brief Nanostars in a Telegram Star, ledger amounts are in nanostars.
+ */
+#define TELEBOT_NANOSTARS_PER_STAR 1000000000LL
+
+/**
+ * @brief Origin of a ledger entry.
+ */
+typedef enum telebot_star_ledger_source {
+    TELEBOT_STAR_LEDGER_TRANSACTION = 0, /**< Transaction returned by getStarTransactions */
+    TELEBOT_STAR_LEDGER_PAYMENT,         /**< Successful payment in Telegram Stars of an update */
+    TELEBOT_STAR_LEDGER_REFUND,          /**< Refunded payment in Telegram Stars of an update */
+} telebot_star_ledger_source_e;
+
+/**
+ * @brief Transaction recorded in the ledger.
+ */
+typedef struct telebot_star_ledger_entry {
+    /** Transaction identifier, owned by the ledger until it is disabled */
+    const char *id;
+
+    /** Date of the transaction in Unix time */
+    long long int date;
+
+    /** Amount in nanostars, negative for outgoing transactions */
+    long long int amount;
+
+    /** Origin of the entry */
+    telebot_star_ledger_source_e source;
+} telebot_star_ledger_entry_t;
+
+/**
+ * @brief Totals of the ledger entries of a period.
+ */
+typedef struct telebot_star_ledger_summary {
+    /** Number of transactions */
+    int count;
+
+    /** Nanostars received */
+    long long int incoming;
+
+    /** Nanostars sent, as a positive amount */
+    long long int outgoing;
+} telebot_star_ledger_summary_t;
+
+/**
+ * @brief Enable the local Telegram Stars ledger for the handler.
+ *
+ * The ledger is an append-only binary file of transactions, loaded into
+ * memory when enabled. #telebot_sync_star_ledger() appends transactions
+ * returned by getStarTransactions since the last synchronization, and
+ * #telebot_get_updates() appends successful and refunded payments in Telegram
+ * Stars as they are received. Transactions are recorded once, the ones of
+ * updates are matched with the same transactions synchronized later by their
+ * identifier and direction. Balance and period queries are answered from
+ * memory without requests.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] path Path of the ledger file, created if it does not exist.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_enable_star_ledger(telebot_handler_t handle, const char *path);
+
+/**
+ * @brief Close the Telegram Stars ledger of the handler, entries obtained
+ * from it are no longer valid. The ledger is closed by #telebot_destroy() as well.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_disable_star_ledger(telebot_handler_t handle);
+
+/**
+ * @brief Append transactions of the bot made since the last synchronization.
+ *
+ * Transactions are requested a page at a time from the checkpoint stored in
+ * the ledger, which is advanced once the new transactions are written.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[out] added Number of transactions appended, may be NULL.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_sync_star_ledger(telebot_handler_t handle, int *added);
+
+/**
+ * @brief Get balance of all ledger entries.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[out] balance Balance in nanostars.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_get_star_ledger_balance(telebot_handler_t handle, long long int *balance);
+
+/**
+ * @brief Get totals of the ledger entries dated from @p from until before @p to.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] from Start of the period in Unix time, inclusive.
+ * @param[in] to End of the period in Unix time, exclusive.
+ * @param[out] summary Totals of the period.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_get_star_ledger_summary(telebot_handler_t handle, long long int from,
+    long long int to, telebot_star_ledger_summary_t *summary);
+
+/**
+ * @brief Get the ledger entries dated from @p from until before @p to, oldest first.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] from Start of the period in Unix time, inclusive.
+ * @param[in] to End of the period in Unix time, exclusive.
+ * @param[in] offset Number of entries of the period to skip.
+ * @param[out] entries Array to copy the entries to.
+ * @param[in] max Size of @p entries.
+ * @param[out] count Number of entries copied.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_get_star_ledger_entries(telebot_handler_t handle, long long int from,
+    long long int to, int offset, telebot_star_ledger_entry_t *entries, int max, int *count);
+
+/**
+ * @} // end of APIs
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TELEBOT_LEDGER_H__ */
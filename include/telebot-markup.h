@@ -0,0 +1,275 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TELEBOT_MARKUP_H__
+#define __TELEBOT_MARKUP_H__
+
+#include <stdbool.h>
+#include "telebot-common.h"
+#include "telebot-types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file        telebot-markup.h
+ * @ingroup     TELEBOT_API
+ * @brief       This file contains the reply markup builder of telegram bot
+ * @author      Elmurod Talipov
+ * @date        2026-10-18
+ */
+
+/**
+ * @addtogroup TELEBOT_API
+ * @{
+ */
+
+/**
+ * @brief Maximum number of unused keyboards kept in the shared markup cache
+ * of a handler, see #telebot_markup_share().
+ */
+#define TELEBOT_MARKUP_CACHE_SIZE 256
+
+/**
+ * @brief Reply markup builder opaque type.
+ *
+ * A builder writes compact JSON of an inline keyboard, a reply keyboard,
+ * ForceReply or ReplyKeyboardRemove directly into its own buffer, which is
+ * reused when the builder is reset. Usage:
+ * @code
+ * telebot_markup_t markup;
+ * const char *json;
+ * telebot_markup_create(&markup);
+ * telebot_markup_inline_keyboard(markup);
+ * telebot_markup_callback_button(markup, "Yes", "vote:yes");
+ * telebot_markup_callback_button(markup, "No", "vote:no");
+ * telebot_markup_row(markup);
+ * telebot_markup_url_button(markup, "Help", "https://example.com");
+ * telebot_markup_get_json(markup, &json);
+ * telebot_send_message(handle, chat_id, "Vote:", NULL, false, false, 0, json);
+ * telebot_markup_destroy(markup);
+ * @endcode
+ */
+typedef struct telebot_markup *telebot_markup_t;
+
+/**
+ * @brief Create reply markup builder.
+ * @param[out] markup Builder, which MUST be released with #telebot_markup_destroy().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_create(telebot_markup_t *markup);
+
+/**
+ * @brief Release reply markup builder.
+ * @param[in] markup Builder created with #telebot_markup_create().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_destroy(telebot_markup_t markup);
+
+/**
+ * @brief Discard the markup built so far, keeping the buffer for the next one.
+ * @param[in] markup Builder created with #telebot_markup_create().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_reset(telebot_markup_t markup);
+
+/**
+ * @brief Start inline keyboard. Buttons are added to the first row until
+ * #telebot_markup_row() is called.
+ * @param[in] markup Empty builder.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_inline_keyboard(telebot_markup_t markup);
+
+/**
+ * @brief Start custom reply keyboard. Buttons are added to the first row until
+ * #telebot_markup_row() is called.
+ * @param[in] markup Empty builder.
+ * @param[in] is_persistent Always show the keyboard when the regular keyboard is hidden.
+ * @param[in] resize_keyboard Resize the keyboard vertically for optimal fit.
+ * @param[in] one_time_keyboard Hide the keyboard as soon as it's been used.
+ * @param[in] input_field_placeholder Optional. Placeholder shown in the input
+ * field, 1-64 characters.
+ * @param[in] selective Show the keyboard to specific users only.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_reply_keyboard(telebot_markup_t markup, bool is_persistent,
+    bool resize_keyboard, bool one_time_keyboard, const char *input_field_placeholder,
+    bool selective);
+
+/**
+ * @brief Build ForceReply markup, which makes clients display a reply interface.
+ * @param[in] markup Empty builder.
+ * @param[in] input_field_placeholder Optional. Placeholder shown in the input
+ * field, 1-64 characters.
+ * @param[in] selective Force reply from specific users only.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_force_reply(telebot_markup_t markup,
+    const char *input_field_placeholder, bool selective);
+
+/**
+ * @brief Build ReplyKeyboardRemove markup, which removes the custom keyboard.
+ * @param[in] markup Empty builder.
+ * @param[in] selective Remove the keyboard for specific users only.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_remove_keyboard(telebot_markup_t markup, bool selective);
+
+/**
+ * @brief Start a new row of buttons of the keyboard. The row is written with
+ * its first button, so a keyboard never has empty rows.
+ * @param[in] markup Builder with a keyboard started.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_row(telebot_markup_t markup);
+
+/**
+ * @brief Add inline button sending a callback query with the data.
+ * @param[in] markup Builder with an inline keyboard started.
+ * @param[in] text Label text on the button.
+ * @param[in] callback_data Data sent in the callback query, 1-64 bytes.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_callback_button(telebot_markup_t markup, const char *text,
+    const char *callback_data);
+
+/**
+ * @brief Add inline button opening the url.
+ * @param[in] markup Builder with an inline keyboard started.
+ * @param[in] text Label text on the button.
+ * @param[in] url HTTP or tg:// url to be opened when the button is pressed.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_url_button(telebot_markup_t markup, const char *text,
+    const char *url);
+
+/**
+ * @brief Add inline button launching a Web App.
+ * @param[in] markup Builder with an inline or reply keyboard started.
+ * @param[in] text Label text on the button.
+ * @param[in] url HTTPS url of the Web App.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_web_app_button(telebot_markup_t markup, const char *text,
+    const char *url);
+
+/**
+ * @brief Add inline button switching to inline mode with the query.
+ * @param[in] markup Builder with an inline keyboard started.
+ * @param[in] text Label text on the button.
+ * @param[in] query Inline query to insert, can be empty.
+ * @param[in] current_chat True to insert the query in the current chat,
+ * false to let the user select a chat.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_switch_inline_button(telebot_markup_t markup, const char *text,
+    const char *query, bool current_chat);
+
+/**
+ * @brief Add inline button copying the text to the clipboard.
+ * @param[in] markup Builder with an inline keyboard started.
+ * @param[in] text Label text on the button.
+ * @param[in] copy_text Text to be copied, 1-256 characters.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_copy_text_button(telebot_markup_t markup, const char *text,
+    const char *copy_text);
+
+/**
+ * @brief Add inline Pay button. It must be the first button in the first row.
+ * @param[in] markup Builder with an inline keyboard started.
+ * @param[in] text Label text on the button.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_pay_button(telebot_markup_t markup, const char *text);
+
+/**
+ * @brief Add reply keyboard button sending its text, or requesting contact or
+ * location of the user.
+ * @param[in] markup Builder with a reply keyboard started.
+ * @param[in] text Text of the button.
+ * @param[in] request_contact Send phone number of the user when pressed.
+ * @param[in] request_location Send location of the user when pressed.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_text_button(telebot_markup_t markup, const char *text,
+    bool request_contact, bool request_location);
+
+/**
+ * @brief Get JSON of the built markup, to pass as reply_markup.
+ *
+ * The markup is complete after this call, no buttons can be added until the
+ * builder is reset.
+ * @param[in] markup Builder with markup built.
+ * @param[out] json JSON owned by the builder, valid until it is reset or destroyed.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_get_json(telebot_markup_t markup, const char **json);
+
+/**
+ * @brief Get shared copy of the built markup from the handler's markup cache.
+ *
+ * Markups are cached by content, so identical keyboards built anywhere in the
+ * bot share one copy, and the same pointer is returned for them (which also
+ * makes them cheap to compare). Up to #TELEBOT_MARKUP_CACHE_SIZE markups that
+ * are no longer referenced stay cached for reuse.
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] markup Builder with markup built.
+ * @param[out] json Shared JSON, which MUST be released with #telebot_markup_release().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_share(telebot_handler_t handle, telebot_markup_t markup,
+    const char **json);
+
+/**
+ * @brief Release shared markup obtained with #telebot_markup_share().
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] json Shared JSON to release.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_markup_release(telebot_handler_t handle, const char *json);
+
+/**
+ * @} // end of APIs
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TELEBOT_MARKUP_H__ */
@@ -89,9 +89,62 @@ telebot_error_e telebot_set_proxy(telebot_handler_t handle, char *addr, char *au
  */
 telebot_error_e telebot_get_proxy(telebot_handler_t handle, char **addr);
 
+/**
+ * @brief Set address of the Bot API server, e.g. a self-hosted Bot API server
+ * or a local mock server used for testing.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] url Server address without trailing path, e.g.
+ * "http://127.0.0.1:8081", or NULL to use the default "https://api.telegram.org".
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_api_url(telebot_handler_t handle, const char *url);
+
+/**
+ * @brief Set HTTP version of requests to the Bot API server.
+ *
+ * By default every request opens its own connection. Any other version sends
+ * requests of all threads through a shared transport, which keeps up to
+ * max_connections connections open. With HTTP/2, concurrent requests such
+ * as sendMessage and answerCallbackQuery from several threads share one
+ * connection as separate streams, saving a TCP and TLS handshake per request.
+ * The server falls back to HTTP/1.1 if it does not support HTTP/2. It may be
+ * changed while requests are sent, requests in flight complete on the
+ * previous transport.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] version HTTP version, refers to #telebot_http_version_e.
+ * @param[in] max_connections Maximum number of connections to the server,
+ * 0 for #TELEBOT_HTTP_MAX_CONNECTIONS. With HTTP/1.1 it limits the number
+ * of requests in flight, including a long polling getUpdates.
+ * @param[in] max_streams Maximum number of concurrent requests on one HTTP/2
+ * connection, 0 for #TELEBOT_HTTP_MAX_STREAMS.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_http_version(telebot_handler_t handle, telebot_http_version_e version,
+                                         int max_connections, int max_streams);
+
+/**
+ * @brief Get runtime statistics of the handler, e.g. hit rate of the response
+ * buffer pool.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[out] stats Statistics collected since the handler is created.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_get_stats(telebot_handler_t handle, telebot_stats_t *stats);
+
 /**
  * @brief This function is used to get latest updates.
  *
+ * Users and chats that occur several times in the received updates (senders,
+ * chats of messages and replies, callback queries, ...) are parsed once and
+ * shared by reference, so they must be treated as read-only. Each shared
+ * object is released with the last update referring to it.
+ *
  * @param[in] handle The telebot handler created with #telebot_create().
  * @param[in] offset Identifier of the first update to be returned. The
  * negative offset can be specified to retrieve updates starting from -offset
@@ -124,6 +177,73 @@ telebot_error_e telebot_get_updates(telebot_handler_t handle, int offset,
  */
 telebot_error_e telebot_put_updates(telebot_update_t *updates, int count);
 
+/**
+ * @brief This function is used to enable or disable lazy parsing of updates.
+ *
+ * With lazy parsing, messages of updates obtained with #telebot_get_updates()
+ * have only message_id, message_thread_id, date, chat, from, text and
+ * edit_date fields filled. All other fields (reply_to_message, entities,
+ * media, service messages, etc.) are NULL or zero until they are loaded with
+ * #telebot_load_message_field(), or all at once with #telebot_load_message(),
+ * so the parsing cost is paid only for the fields which are actually read.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] enable True to parse messages lazily, false to parse fully.
+ * @return On success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_lazy_parsing(telebot_handler_t handle, bool enable);
+
+/**
+ * @brief Default number of responses kept by the chat cache, see
+ * #telebot_set_chat_cache().
+ */
+#define TELEBOT_CHAT_CACHE_CAPACITY 1024
+
+/**
+ * @brief This function is used to enable or disable cache of chat information.
+ *
+ * Results of #telebot_get_chat(), #telebot_get_chat_admins() and
+ * #telebot_get_chat_member() are cached for @p ttl seconds, the least recently
+ * used ones are dropped when @p capacity is reached. Cached results are
+ * dropped as soon as they become stale because of received updates
+ * (chat_member, my_chat_member, members joining or leaving, chat title or
+ * photo changes, ...) or of changes made by the bot itself (banning,
+ * restricting or promoting members, setting chat title, ...). Hits and misses
+ * are reported by #telebot_get_stats(). The cache is disabled by default.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] ttl Seconds results are cached for, 0 disables the cache.
+ * @param[in] capacity Maximum number of cached results, 0 for
+ * #TELEBOT_CHAT_CACHE_CAPACITY.
+ * @return On success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_chat_cache(telebot_handler_t handle, int ttl, int capacity);
+
+/**
+ * @brief This function is used to load the remaining fields of a message
+ * parsed lazily. It does nothing for messages which are already complete.
+ *
+ * @param[in,out] message Message of an update obtained with #telebot_get_updates().
+ * @return On success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_load_message(telebot_message_t *message);
+
+/**
+ * @brief This function is used to load one of the remaining fields of a
+ * message parsed lazily, leaving the others unparsed. It does nothing for
+ * fields which are already loaded.
+ *
+ * @param[in,out] message Message of an update obtained with #telebot_get_updates().
+ * @param[in] field Field to load, e.g. #TELEBOT_MESSAGE_FIELD_REPLY_TO_MESSAGE
+ * fills reply_to_message.
+ * @return On success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_load_message_field(telebot_message_t *message, telebot_message_field_e field);
+
 
 /**
  * @brief This function is used to specify a url and receive incoming updates
@@ -232,6 +352,48 @@ telebot_error_e telebot_send_message(telebot_handler_t handle, long long int cha
     const char *text, const char *parse_mode, bool disable_web_page_preview,
     bool disable_notification, int reply_to_message_id, const char *reply_markup);
 
+/**
+ * @brief Prepare text message request for sending many messages that differ only
+ * in chat and text, e.g. broadcasting with the same keyboard. Constant
+ * parameters, including the serialized keyboard, are encoded once.
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] parse_mode Send Markdown or HTML, if you want Telegram apps to show bold,
+ * italic, fixed-width or inline URLs in your bot's message.
+ * @param[in] disable_web_page_preview Disables link previews for links in this message.
+ * @param[in] disable_notification Sends the message silently. Users will receive a
+ * notification with no sound.
+ * @param[in] reply_markup Additional interface options. An object for a custom
+ * reply keyboard, instructions to hide keyboard or to force a reply from the user.
+ * @param[out] prepared Prepared request, which MUST be released with
+ * #telebot_put_prepared_request().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_prepare_send_message(telebot_handler_t handle, const char *parse_mode,
+    bool disable_web_page_preview, bool disable_notification, const char *reply_markup,
+    telebot_prepared_request_t *prepared);
+
+/**
+ * @brief Send text message using request prepared with #telebot_prepare_send_message().
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] prepared Prepared request.
+ * @param[in] chat_id Unique identifier for the target chat.
+ * @param[in] text Text of the message to be sent, 1-4096 characters after entities parsing.
+ * @param[in] reply_to_message_id If the message is a reply, ID of the original message.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_send_prepared_message(telebot_handler_t handle, telebot_prepared_request_t prepared,
+    long long int chat_id, const char *text, int reply_to_message_id);
+
+/**
+ * @brief Release prepared request.
+ * @param[in] prepared Prepared request obtained with #telebot_prepare_send_message().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_put_prepared_request(telebot_prepared_request_t prepared);
+
 /**
  * @brief Forward messages of any kind.
  * @param[in] handle The telebot handler created with #telebot_create().
@@ -654,6 +816,59 @@ telebot_error_e telebot_send_dice(telebot_handler_t handle, long long int chat_i
 telebot_error_e telebot_send_chat_action(telebot_handler_t handle, long long int chat_id,
     char *action);
 
+/**
+ * @brief Default interval between chat actions sent to a chat in milliseconds,
+ * see #telebot_set_chat_action_refresh().
+ */
+#define TELEBOT_CHAT_ACTION_REFRESH 4000
+
+/**
+ * @brief This function is used to enable or disable refreshing of chat actions
+ * started with #telebot_start_chat_action().
+ *
+ * A started action is sent to the chat immediately and then every @p refresh
+ * milliseconds, before it expires, until it is stopped with
+ * #telebot_stop_chat_action(). Actions of a chat started several times, by
+ * different jobs, are sent once; only the most recently started action of a
+ * chat is shown. Refreshes due at about the same time are sent together by a
+ * single timer. Sent and deduplicated actions are reported by
+ * #telebot_get_stats(). Refreshing is disabled by default, started actions
+ * are then sent only once.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] refresh Milliseconds between actions sent to a chat, 0 disables
+ * refreshing, #TELEBOT_CHAT_ACTION_REFRESH is a reasonable value.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_chat_action_refresh(telebot_handler_t handle, int refresh);
+
+/**
+ * @brief Start showing a chat action until it is stopped, see
+ * #telebot_set_chat_action_refresh(). Every start MUST be paired with
+ * #telebot_stop_chat_action().
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] chat_id Unique identifier for the target chat.
+ * @param[in] action Type of action to broadcast, see #telebot_send_chat_action().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_start_chat_action(telebot_handler_t handle, long long int chat_id,
+    const char *action);
+
+/**
+ * @brief Stop showing a chat action started with #telebot_start_chat_action().
+ * The action is no longer refreshed once it is stopped as many times as it was
+ * started, the one started before it is shown again if any.
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] chat_id Unique identifier for the target chat.
+ * @param[in] action Type of action passed to #telebot_start_chat_action().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_stop_chat_action(telebot_handler_t handle, long long int chat_id,
+    const char *action);
+
 /**
  * @brief This function is used to get user profile pictures object
  *
@@ -681,6 +896,61 @@ telebot_error_e telebot_get_user_profile_photos(telebot_handler_t handle,
  */
 telebot_error_e telebot_put_user_profile_photos(telebot_user_profile_photos_t *photos);
 
+/**
+ * @brief Default number of items fetched per request by iterators.
+ */
+#define TELEBOT_ITERATOR_PAGE_SIZE 100
+
+/**
+ * @brief This function is used to iterate over all profile pictures of a user.
+ *
+ * Pictures are requested a page at a time, the next page is fetched in the
+ * background while the current one is consumed, so at most two pages are held
+ * in memory. Iterator MUST be released with #telebot_iterator_destroy().
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] user_id Unique identifier of the target user.
+ * @param[in] page_size Pictures per request, between 1-100, 0 for
+ * #TELEBOT_ITERATOR_PAGE_SIZE.
+ * @param[out] iterator Iterator to pass to #telebot_iterator_next_profile_photo().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_iterate_user_profile_photos(telebot_handler_t handle,
+        int user_id, int page_size, telebot_iterator_t *iterator);
+
+/**
+ * @brief This function is used to get next profile picture of an iterator.
+ * @param[in] iterator Iterator created with #telebot_iterate_user_profile_photos().
+ * @param[out] sizes Sizes of the picture, valid until the next call, NULL at
+ * the end of iteration.
+ * @param[out] count Number of sizes, 0 at the end of iteration.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value. Failed page requests are retried by the next call.
+ */
+telebot_error_e telebot_iterator_next_profile_photo(telebot_iterator_t iterator,
+        const telebot_photo_t *sizes[4], int *count);
+
+/**
+ * @brief This function is used to get progress of an iterator.
+ * @param[in] iterator Iterator to get progress of.
+ * @param[out] consumed Number of items returned so far.
+ * @param[out] total Total number of items reported by the server, -1 if it
+ * is not known.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_iterator_get_progress(telebot_iterator_t iterator, int *consumed, int *total);
+
+/**
+ * @brief This function is used to release an iterator, along with the items
+ * it returned.
+ * @param[in] iterator Iterator to release.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_iterator_destroy(telebot_iterator_t iterator);
+
 /**
  * @brief Use this method to get user profile audios.
  */
@@ -1219,6 +1489,75 @@ telebot_error_e telebot_edit_message_reply_markup(telebot_handler_t handle,
     long long int chat_id, int message_id, const char *inline_message_id,
     const char *reply_markup);
 
+/**
+ * @brief Default interval between edits of a message in milliseconds, see
+ * #telebot_set_edit_coalescing().
+ */
+#define TELEBOT_EDIT_INTERVAL 1000
+
+/**
+ * @brief This function is used to enable or disable coalescing of edits queued
+ * with #telebot_queue_edit_message_text(), #telebot_queue_edit_message_caption()
+ * and #telebot_queue_edit_message_reply_markup().
+ *
+ * Queued edits of a message, identified by chat_id and message_id or by
+ * inline_message_id, are sent at most once per @p interval. Only the latest
+ * one is sent, a reply markup edit queued after a text or caption edit is
+ * merged into it. Edits leaving the message as it is after the last successful
+ * edit are not sent at all. Sent, superseded and skipped edits are reported by
+ * #telebot_get_stats(). Pending edits are sent when coalescing is disabled or
+ * the handler is destroyed. Coalescing is disabled by default, queued edits
+ * are then sent immediately.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] interval Milliseconds between edits of a message, 0 disables
+ * coalescing, #TELEBOT_EDIT_INTERVAL is a reasonable value.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_edit_coalescing(telebot_handler_t handle, int interval);
+
+/**
+ * @brief Queue edit of text and game messages, see #telebot_edit_message_text()
+ * for parameters and #telebot_set_edit_coalescing() for coalescing. Failures
+ * of coalesced edits are only logged.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_queue_edit_message_text(telebot_handler_t handle,
+    long long int chat_id, int message_id, const char *inline_message_id,
+    const char *text, const char *parse_mode, bool disable_web_page_preview,
+    const char *reply_markup);
+
+/**
+ * @brief Queue edit of message captions, see #telebot_edit_message_caption()
+ * for parameters and #telebot_set_edit_coalescing() for coalescing.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_queue_edit_message_caption(telebot_handler_t handle,
+    long long int chat_id, int message_id, const char *inline_message_id,
+    const char *caption, const char *parse_mode, const char *reply_markup);
+
+/**
+ * @brief Queue edit of message reply markup, see
+ * #telebot_edit_message_reply_markup() for parameters and
+ * #telebot_set_edit_coalescing() for coalescing.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_queue_edit_message_reply_markup(telebot_handler_t handle,
+    long long int chat_id, int message_id, const char *inline_message_id,
+    const char *reply_markup);
+
+/**
+ * @brief Send all pending queued edits now, waiting for them to complete.
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_flush_edits(telebot_handler_t handle);
+
 /**
  * @brief Stop a poll which was sent by the bot.
  * @param[in] handle The telebot handler created with #telebot_create().
@@ -1465,6 +1804,106 @@ telebot_error_e telebot_forward_messages(telebot_handler_t handle,
 telebot_error_e telebot_delete_messages(telebot_handler_t handle,
     long long int chat_id, const char *message_ids);
 
+/**
+ * @brief Default window single message requests are gathered for in
+ * milliseconds, see #telebot_set_message_batching().
+ */
+#define TELEBOT_BATCH_WINDOW 50
+
+/**
+ * @brief Callback completing a message passed to #telebot_batch_delete_message(),
+ * #telebot_batch_forward_message() or #telebot_batch_copy_message().
+ * @param[in] user_data User data passed with the message.
+ * @param[in] result Result of the request the message was sent with.
+ * @param[in] message_id Identifier of the deleted message, or of the new
+ * message for forwards and copies, 0 if it is not known.
+ */
+typedef void (*telebot_batch_cb_f)(void *user_data, telebot_error_e result, int message_id);
+
+/**
+ * @brief This function is used to enable or disable batching of messages
+ * passed to #telebot_batch_delete_message(), #telebot_batch_forward_message()
+ * and #telebot_batch_copy_message().
+ *
+ * Messages of the same chat (and source chat and options) passed within
+ * @p window milliseconds are sent with a single deleteMessages,
+ * forwardMessages or copyMessages request, of up to 100 messages. Callbacks
+ * are called from a library thread once the request completes. Since these
+ * methods skip messages which can not be found, deleted messages are reported
+ * as deleted, and new identifiers are 0 if any message of the batch was
+ * skipped. Pending batches are sent when batching is disabled or the handler
+ * is destroyed. Batching is disabled by default, messages are then sent
+ * immediately and callbacks are called before returning.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] window Milliseconds messages are gathered for, 0 disables
+ * batching, #TELEBOT_BATCH_WINDOW is a reasonable value.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_message_batching(telebot_handler_t handle, int window);
+
+/**
+ * @brief Delete a message with the next batch of its chat, see
+ * #telebot_set_message_batching().
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] chat_id Unique identifier for the target chat.
+ * @param[in] message_id Identifier of the message to delete.
+ * @param[in] callback Callback called when the message is deleted, or NULL.
+ * @param[in] user_data User data passed to the callback.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_batch_delete_message(telebot_handler_t handle,
+    long long int chat_id, int message_id, telebot_batch_cb_f callback, void *user_data);
+
+/**
+ * @brief Forward a message with the next batch of its chat, see
+ * #telebot_set_message_batching() and #telebot_forward_messages().
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] chat_id Unique identifier for the target chat.
+ * @param[in] from_chat_id Unique identifier for the chat where the original message was sent.
+ * @param[in] message_id Identifier of the message to forward.
+ * @param[in] disable_notification Sends the message silently.
+ * @param[in] protect_content Protects the contents of the sent message from forwarding and saving.
+ * @param[in] callback Callback called when the message is forwarded, or NULL.
+ * @param[in] user_data User data passed to the callback.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_batch_forward_message(telebot_handler_t handle,
+    long long int chat_id, long long int from_chat_id, int message_id,
+    bool disable_notification, bool protect_content, telebot_batch_cb_f callback,
+    void *user_data);
+
+/**
+ * @brief Copy a message with the next batch of its chat, see
+ * #telebot_set_message_batching() and #telebot_copy_messages().
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] chat_id Unique identifier for the target chat.
+ * @param[in] from_chat_id Unique identifier for the chat where the original message was sent.
+ * @param[in] message_id Identifier of the message to copy.
+ * @param[in] disable_notification Sends the message silently.
+ * @param[in] protect_content Protects the contents of the sent message from forwarding and saving.
+ * @param[in] remove_caption Pass True to copy the message without its caption.
+ * @param[in] callback Callback called when the message is copied, or NULL.
+ * @param[in] user_data User data passed to the callback.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_batch_copy_message(telebot_handler_t handle,
+    long long int chat_id, long long int from_chat_id, int message_id,
+    bool disable_notification, bool protect_content, bool remove_caption,
+    telebot_batch_cb_f callback, void *user_data);
+
+/**
+ * @brief Send the messages gathered so far without waiting for their window.
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_flush_batches(telebot_handler_t handle);
+
 /**
  * @brief Use this method to ban a user in a group, a supergroup or a channel.
  * @param[in] handle The telebot handler.
@@ -19,13 +19,65 @@
 #ifndef __TELEBOT_PARSER_H__
 #define __TELEBOT_PARSER_H__
 
+#include <stdint.h>
 #include "telebot-types.h"
 #include "telebot-methods.h"
+#include "telebot-stickers.h"
+
+/** Options controlling how updates are parsed */
+typedef struct telebot_parser_options
+{
+    bool lazy; /**< Parse only frequently used message fields, rest on demand */
+    const struct telebot_filter *filter; /**< Skip updates not passing the filter */
+    bool skip_payments; /**< Skip shipping and pre-checkout queries of the payment lane */
+    const int64_t *received; /**< Monotonic receive time of each raw update, NULL for now */
+} telebot_parser_options_t;
+
+/** Message fields not loaded yet, see telebot_parser_get_message_lazy() */
+typedef struct telebot_message_lazy
+{
+    struct json_object *obj; /**< Unparsed message */
+    bool loaded[TELEBOT_MESSAGE_FIELD_MAX]; /**< Fields already parsed into the message */
+    int pending; /**< Number of fields not loaded yet */
+} telebot_message_lazy_t;
 
 struct json_object *telebot_parser_str_to_obj(const char *data);
 
-/** Get update from Json Object */
-telebot_error_e telebot_parser_get_updates(struct json_object *obj, telebot_update_t **updates, int *count);
+/** Get type and payload object of raw update, TELEBOT_UPDATE_TYPE_MAX if unknown */
+telebot_update_type_e telebot_parser_get_update_type(struct json_object *update, struct json_object **payload);
+
+/** Get update type of its key in update object, TELEBOT_UPDATE_TYPE_MAX if unknown */
+telebot_update_type_e telebot_parser_get_update_type_from_str(const char *str);
+
+/** Get key of update type in update object, NULL if invalid */
+const char *telebot_parser_get_update_type_str(telebot_update_type_e type);
+
+/** Get update from Json Object, options may be NULL */
+telebot_error_e telebot_parser_get_updates(struct json_object *obj, const telebot_parser_options_t *options,
+                                           telebot_update_t **updates, int *count);
+
+/**
+ * Release update array of telebot_parser_get_updates() with the payloads,
+ * payload contents must have been released already
+ */
+void telebot_parser_free_updates(telebot_update_t *updates);
+
+/** Get bytes taken by update array of telebot_parser_get_updates() and its payloads */
+size_t telebot_parser_get_updates_footprint(const telebot_update_t *updates);
+
+/** Get size of payload of update type, 0 if invalid */
+size_t telebot_parser_get_update_payload_size(telebot_update_type_e type);
+
+/**
+ * Parse user object into a shared user. Within telebot_parser_get_updates()
+ * a user already parsed in the batch from identical JSON is returned with
+ * another reference.
+ * Released with telebot_put_user_ref().
+ */
+telebot_error_e telebot_parser_get_user_ref(struct json_object *obj, telebot_user_t **user);
+
+/** Parse chat object into a shared chat, see telebot_parser_get_user_ref() */
+telebot_error_e telebot_parser_get_chat_ref(struct json_object *obj, telebot_chat_t **chat);
 
 /** Parse webhook info object */
 telebot_error_e telebot_parser_get_webhook_info(struct json_object *obj, telebot_webhook_info_t *info);
@@ -33,6 +85,18 @@ telebot_error_e telebot_parser_get_webhook_info(struct json_object *obj, telebot
 /** Parse message object */
 telebot_error_e telebot_parser_get_message(struct json_object *obj, telebot_message_t *msg);
 
+/** Parse frequently used fields of message object, the rest is parsed on demand */
+telebot_error_e telebot_parser_get_message_lazy(struct json_object *obj, telebot_message_t *msg);
+
+/** Parse remaining fields of lazily parsed message object */
+telebot_error_e telebot_parser_load_message(telebot_message_t *msg);
+
+/** Parse one of the remaining fields of lazily parsed message object */
+telebot_error_e telebot_parser_load_message_field(telebot_message_t *msg, telebot_message_field_e field);
+
+/** Release fields of lazily parsed message object which were never loaded */
+void telebot_parser_put_message_lazy(telebot_message_lazy_t *lazy);
+
 /** Parse message entity object */
 telebot_error_e telebot_parser_get_message_entity(struct json_object *obj, telebot_message_entity_t *entity);
 
@@ -222,9 +286,15 @@ telebot_error_e telebot_parser_get_shipping_query(struct json_object *obj, teleb
 /** Parse pre-checkout query object */
 telebot_error_e telebot_parser_get_pre_checkout_query(struct json_object *obj, telebot_pre_checkout_query_t *query);
 
+/** Parse sticker object */
+telebot_error_e telebot_parser_get_sticker(struct json_object *obj, telebot_sticker_t *sticker);
+
 /** Parse stickers array */
 telebot_error_e telebot_parser_get_stickers(struct json_object *obj, telebot_sticker_t **stickers, int *count);
 
+/** Parse sticker set object */
+telebot_error_e telebot_parser_get_sticker_set(struct json_object *obj, telebot_sticker_set_t *set);
+
 /** Parse star transactions */
 telebot_error_e telebot_parser_get_star_transactions(struct json_object *obj, telebot_star_transactions_t *transactions);
 
@@ -45,6 +45,102 @@ extern "C" {
 telebot_error_e telebot_set_passport_data_errors(telebot_handler_t handle,
     long long int user_id, const char *errors);
 
+/**
+ * @brief Opaque decrypted credentials of Telegram Passport data.
+ */
+typedef struct telebot_passport_credentials *telebot_passport_credentials_t;
+
+/**
+ * @brief Passport file of an element, see #telebot_decrypt_passport_files().
+ */
+typedef enum telebot_passport_file_kind {
+    TELEBOT_PASSPORT_FILE = 0,          /**< Item of files of the element */
+    TELEBOT_PASSPORT_FILE_FRONT_SIDE,   /**< Front side of the document */
+    TELEBOT_PASSPORT_FILE_REVERSE_SIDE, /**< Reverse side of the document */
+    TELEBOT_PASSPORT_FILE_SELFIE,       /**< Selfie with the document */
+    TELEBOT_PASSPORT_FILE_TRANSLATION,  /**< Item of translation of the element */
+} telebot_passport_file_kind_e;
+
+/**
+ * @brief Decrypted Telegram Passport element.
+ */
+typedef struct telebot_passport_element {
+    /** Element type, see #telebot_encrypted_passport_element_t */
+    char *type;
+
+    /** Decrypted JSON-serialized data, NULL if the element has no data */
+    char *data;
+} telebot_passport_element_t;
+
+/**
+ * @brief Downloaded passport file to decrypt.
+ */
+typedef struct telebot_passport_file_job {
+    /** Type of the element the file belongs to */
+    const char *element_type;
+
+    /** Field of the element the file is in */
+    telebot_passport_file_kind_e kind;
+
+    /** Position in files or translation of the element */
+    int index;
+
+    /** Path of the encrypted file, downloaded with #telebot_download_file() */
+    const char *input_path;
+
+    /** Path to write the decrypted file to */
+    const char *output_path;
+
+    /** Result of the decryption, set by #telebot_decrypt_passport_files() */
+    telebot_error_e result;
+} telebot_passport_file_job_t;
+
+/**
+ * @brief Set the private key of the bot used to decrypt passport credentials,
+ * it is parsed once and kept by the handler. NULL removes the key.
+ */
+telebot_error_e telebot_set_passport_private_key(telebot_handler_t handle,
+    const char *private_key_pem);
+
+/**
+ * @brief Decrypt credentials of passport data with the key of the bot, the
+ * credentials are verified against their hash. They MUST be released with
+ * #telebot_put_passport_credentials().
+ */
+telebot_error_e telebot_decrypt_passport_credentials(telebot_handler_t handle,
+    const telebot_encrypted_credentials_t *encrypted, telebot_passport_credentials_t *credentials);
+
+/**
+ * @brief Get the nonce of decrypted credentials, owned by the credentials.
+ */
+telebot_error_e telebot_get_passport_nonce(telebot_passport_credentials_t credentials,
+    const char **nonce);
+
+/**
+ * @brief Release credentials obtained with #telebot_decrypt_passport_credentials().
+ */
+telebot_error_e telebot_put_passport_credentials(telebot_passport_credentials_t credentials);
+
+/**
+ * @brief Decrypt data of all elements of passport data, in parallel. Elements
+ * MUST be released with #telebot_put_passport_elements().
+ */
+telebot_error_e telebot_decrypt_passport_elements(telebot_passport_credentials_t credentials,
+    const telebot_passport_data_t *passport_data, telebot_passport_element_t **elements, int *count);
+
+/**
+ * @brief Release elements obtained with #telebot_decrypt_passport_elements().
+ */
+telebot_error_e telebot_put_passport_elements(telebot_passport_element_t *elements, int count);
+
+/**
+ * @brief Decrypt downloaded passport files in parallel, streaming each file
+ * through a fixed buffer. Result of every file is set in its job, the first
+ * failure is returned.
+ */
+telebot_error_e telebot_decrypt_passport_files(telebot_passport_credentials_t credentials,
+    telebot_passport_file_job_t *jobs, int count);
+
 /**
  * @} // end of APIs
  */
@@ -79,6 +79,37 @@ telebot_error_e telebot_answer_shipping_query(telebot_handler_t handle,
 telebot_error_e telebot_answer_pre_checkout_query(telebot_handler_t handle,
     const char *pre_checkout_query_id, bool ok, const char *error_message);
 
+/** Default time to answer payment queries in, milliseconds, Telegram allows 10 seconds */
+#define TELEBOT_PAYMENT_DEADLINE 8000
+
+/** Default error shown to users when a payment query is not answered in time */
+#define TELEBOT_PAYMENT_ERROR_MESSAGE "The payment could not be processed in time, please try again."
+
+/**
+ * @brief Handler of payment lane updates, called on the reserved worker thread.
+ * Update is released when the handler returns.
+ */
+typedef void (*telebot_payment_cb_f)(void *user_data, telebot_handler_t handle, telebot_update_t *update);
+
+/**
+ * @brief Use this method to handle shipping and pre-checkout queries on a
+ * reserved worker as soon as they are received.
+ *
+ * Such updates are no longer returned by #telebot_get_updates, they are passed
+ * to callback instead. Answers are sent on a dedicated persistent connection.
+ * Queries not answered within deadline milliseconds of arrival are answered
+ * with ok false and error_message, later answers of the handler return
+ * TELEBOT_ERROR_CANCELED. Proxy and API server must be set before enabling.
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] callback Handler of payment queries, NULL disables the lane.
+ * @param[in] user_data Passed to callback.
+ * @param[in] deadline Milliseconds to answer in, 0 for #TELEBOT_PAYMENT_DEADLINE.
+ * @param[in] error_message Error of overrun queries, NULL for #TELEBOT_PAYMENT_ERROR_MESSAGE.
+ * @return On success, TELEBOT_ERROR_NONE is returned.
+ */
+telebot_error_e telebot_set_payment_lane(telebot_handler_t handle, telebot_payment_cb_f callback,
+    void *user_data, int deadline, const char *error_message);
+
 /**
  * @brief Use this method to get the current Telegram Stars balance of the bot.
  */
@@ -95,6 +126,20 @@ telebot_error_e telebot_get_star_transactions(telebot_handler_t handle,
  */
 telebot_error_e telebot_put_star_transactions(telebot_star_transactions_t *transactions);
 
+/**
+ * @brief Iterate over all Telegram Star transactions of the bot, next page is
+ * prefetched while the current one is consumed, see #telebot_iterator_destroy().
+ */
+telebot_error_e telebot_iterate_star_transactions(telebot_handler_t handle,
+    int page_size, telebot_iterator_t *iterator);
+
+/**
+ * @brief Get next transaction of an iterator, valid until the next call, NULL
+ * at the end of iteration.
+ */
+telebot_error_e telebot_iterator_next_star_transaction(telebot_iterator_t iterator,
+    const telebot_star_transaction_t **transaction);
+
 /**
  * @brief Use this method to refund a successful payment in Telegram Stars.
  */
@@ -144,6 +189,25 @@ telebot_error_e telebot_get_chat_gifts(telebot_handler_t handle,
  */
 telebot_error_e telebot_put_chat_gifts(telebot_user_gifts_t *gifts);
 
+/**
+ * @brief Iterate over all gifts received by a user, see #telebot_iterate_star_transactions().
+ */
+telebot_error_e telebot_iterate_user_gifts(telebot_handler_t handle,
+    long long int user_id, int page_size, telebot_iterator_t *iterator);
+
+/**
+ * @brief Iterate over all gifts received by a chat, see #telebot_iterate_star_transactions().
+ */
+telebot_error_e telebot_iterate_chat_gifts(telebot_handler_t handle,
+    long long int chat_id, int page_size, telebot_iterator_t *iterator);
+
+/**
+ * @brief Get next gift of an iterator, valid until the next call, NULL at the
+ * end of iteration.
+ */
+telebot_error_e telebot_iterator_next_user_gift(telebot_iterator_t iterator,
+    const telebot_user_gift_t **gift);
+
 /**
  * @brief Use this method to upgrade a gift.
  */
@@ -20,8 +20,11 @@
 #define __TELEBOT_PRIVATE_H__
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+#include <curl/curl.h>
 #include "telebot-common.h"
 #include "telebot-types.h"
 #include "telebot-core.h"
@@ -31,11 +34,30 @@
 #define TELEBOT_BUFFER_SECTOR                512
 #define TELEBOT_BUFFER_BLOCK                 1024
 #define TELEBOT_BUFFER_PAGE                  4096
+#define TELEBOT_BUFFER_POOL_SIZE             4
+#define TELEBOT_BUFFER_POOL_MAX_CAPACITY     (1024 * 1024)
 #define TELEBOT_UPDATE_COUNT_MAX_LIMIT       100
 #define TELEBOT_USER_PROFILE_PHOTOS_LIMIT    100
 #define TELEBOT_SAFE_FREE(addr)              if (addr) { free(addr); addr = NULL; }
 #define TELEBOT_SAFE_FZCNT(addr, count)      { TELEBOT_SAFE_FREE(addr); count = 0; }
 #define TELEBOT_SAFE_STRDUP(str)             (str) ? strdup(str) : NULL;
+#define TELEBOT_HASH_SEED                    0xCBF29CE484222325ULL
+
+/** FNV-1a hash of size bytes, continuing from hash, TELEBOT_HASH_SEED to start */
+static inline uint64_t telebot_hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+
+    return hash;
+}
+
+/** FNV-1a hash of a string */
+static inline uint64_t telebot_hash_str(const char *str)
+{
+    return telebot_hash_bytes(TELEBOT_HASH_SEED, str, strlen(str));
+}
 
 #define TELEBOT_METHOD_GET_UPDATES                              "getUpdates"
 #define TELEBOT_METHOD_SET_WEBHOOK                              "setWebhook"
@@ -262,6 +284,42 @@ typedef struct telebot_core_mime_s
 
 } telebot_core_mime_t;
 
+/**
+ * @brief This object represents pool of response buffers, recycled across
+ * requests of the same core handler. It outlives the handler until every
+ * response holding one of its buffers is released.
+ */
+typedef struct telebot_core_buffer_pool
+{
+    pthread_mutex_t lock;
+    int refs;                                    /**< Core handler and responses */
+    char *buffers[TELEBOT_BUFFER_POOL_SIZE];     /**< Free buffers */
+    size_t capacities[TELEBOT_BUFFER_POOL_SIZE]; /**< Capacities of free buffers */
+    int count;                                   /**< Number of free buffers */
+    telebot_stats_t stats;                       /**< Pool statistics */
+} telebot_core_buffer_pool_t;
+
+typedef struct telebot_core_transport telebot_core_transport_t;
+
+/**
+ * Create transport that performs requests of all threads on shared
+ * connections of one curl multi handle, driven by its own thread.
+ */
+telebot_error_e telebot_core_transport_create(telebot_http_version_e version, int max_connections,
+                                              int max_streams, telebot_core_transport_t **transport);
+
+/** Take a reference on transport, held while a request is performed on it */
+void telebot_core_transport_get(telebot_core_transport_t *transport);
+
+/**
+ * Release a reference on transport. The last one stops the transport thread and
+ * closes connections, requests still queued or in flight then fail.
+ */
+void telebot_core_transport_put(telebot_core_transport_t *transport);
+
+/** Perform request of curl easy handle on the transport, waiting for its completion */
+CURLcode telebot_core_transport_perform(telebot_core_transport_t *transport, CURL *curl_h);
+
 /**
  * @brief This object represents core handler.
  */
@@ -270,15 +328,60 @@ struct telebot_core_handler
     char *token;      /**< Telegam bot token */
     char *proxy_addr; /**< Proxy address (optional) */
     char *proxy_auth; /**< Proxy authentication (optional) */
+    char *api_url;    /**< Bot API server address (optional) */
+    telebot_core_buffer_pool_t *pool; /**< Response buffers */
+    telebot_core_transport_t *transport; /**< Shared connections (optional) */
+    pthread_mutex_t transport_lock; /**< Guards replacing transport while requests take it */
 };
 
+typedef struct telebot_journal telebot_journal_t;
+typedef struct telebot_filter telebot_filter_t;
+typedef struct telebot_markup_cache telebot_markup_cache_t;
+typedef struct telebot_cache telebot_cache_t;
+typedef struct telebot_scheduler telebot_scheduler_t;
+typedef struct telebot_edits telebot_edits_t;
+typedef struct telebot_actions telebot_actions_t;
+typedef struct telebot_batcher telebot_batcher_t;
+typedef struct telebot_inline_cache telebot_inline_cache_t;
+typedef struct telebot_inline_tracker telebot_inline_tracker_t;
+typedef struct telebot_payment_lane telebot_payment_lane_t;
+typedef struct telebot_ledger telebot_ledger_t;
+typedef struct telebot_passport_key telebot_passport_key_t;
+
 /**
  * @brief This object represents handler.
  */
 struct telebot_handler
 {
     telebot_core_handler_t core_h; /**< Core handler */
+    pthread_rwlock_t lock;         /**< Held for reading to use optional modules, for writing to replace them, never recursively */
+    pthread_mutex_t scheduler_lock; /**< Serializes creation of the scheduler */
     int offset;                    /**< Offset value to get updates */
+    telebot_journal_t *journal;    /**< Update journal (optional) */
+    bool lazy_parsing;             /**< Parse update messages on demand */
+    telebot_filter_t *filter;      /**< Compiled update filter (optional) */
+    telebot_markup_cache_t *markups; /**< Shared reply markups */
+    telebot_cache_t *chat_cache;   /**< Cache of chat information (optional) */
+    telebot_scheduler_t *scheduler; /**< Timed work of batching features (optional) */
+    telebot_edits_t *edits;        /**< Coalesced message edits (optional) */
+    telebot_actions_t *actions;    /**< Refreshed chat actions (optional) */
+    telebot_batcher_t *batcher;    /**< Batched single message requests (optional) */
+    telebot_inline_cache_t *inline_cache; /**< Cache of inline query answers (optional) */
+    telebot_inline_tracker_t *inline_tracker; /**< Latest inline query of users (optional) */
+    telebot_payment_lane_t *payment_lane; /**< Deadline aware payment query handling (optional) */
+    telebot_ledger_t *ledger;      /**< Local Telegram Stars ledger (optional) */
+    telebot_passport_key_t *passport_key; /**< Private key for passport credentials (optional) */
+    telebot_cache_t *sticker_cache; /**< Cache of sticker sets by name (optional) */
+};
+
+/**
+ * @brief This object represents a request with constant parameters encoded once.
+ */
+struct telebot_prepared_request
+{
+    const char *method; /**< Bot API method */
+    char *prefix;       /**< Url encoded constant parameters */
+    size_t prefix_size; /**< Length of prefix */
 };
 
 /**
@@ -286,9 +389,262 @@ struct telebot_handler
  */
 struct telebot_core_response
 {
-    telebot_error_e ret; /**< Telegram bot response code */
-    size_t size;         /**< Telegam bot response size */
-    char *data;          /**< Telegam bot response object */
+    telebot_error_e ret;           /**< Telegram bot response code */
+    size_t size;                   /**< Telegam bot response size */
+    char *data;                    /**< Telegam bot response object */
+    size_t capacity;               /**< Allocated size of data */
+    telebot_core_buffer_pool_t *pool; /**< Pool the data buffer is returned to */
+    long status;                   /**< HTTP status, 0 if no response was received */
 };
 
+struct json_object;
+
+/** Open or create update journal file */
+telebot_error_e telebot_journal_open(telebot_journal_t **journal, const char *path,
+                                     size_t capacity, int sync_batch);
+
+/** Flush and close update journal */
+void telebot_journal_close(telebot_journal_t *journal);
+
+/**
+ * Append raw updates array to journal, already journaled updates are skipped.
+ * Nothing is appended if the journal has no room for all of them.
+ */
+telebot_error_e telebot_journal_append(telebot_journal_t *journal, struct json_object *updates);
+
+/** Mark appended updates as delivered, otherwise they are replayed */
+void telebot_journal_delivered(telebot_journal_t *journal);
+
+/** Release journaled updates up to and including update_id */
+telebot_error_e telebot_journal_ack(telebot_journal_t *journal, int update_id);
+
+/**
+ * Get next batch of unacknowledged updates found on open, NULL when done.
+ * received is set to the monotonic time each of them was journaled at, free it after use.
+ */
+telebot_error_e telebot_journal_replay(telebot_journal_t *journal, int limit, struct json_object **updates,
+                                       int64_t **received);
+
+/** Get offset following the last journaled update */
+int telebot_journal_get_offset(telebot_journal_t *journal);
+
+struct telebot_update_filter;
+
+/** Compile update filter description */
+telebot_error_e telebot_filter_compile(const struct telebot_update_filter *spec, telebot_filter_t **filter);
+
+/** Destroy compiled update filter */
+void telebot_filter_destroy(telebot_filter_t *filter);
+
+/** Check whether raw update object passes the filter, NULL filter passes all */
+bool telebot_filter_match(const telebot_filter_t *filter, struct json_object *update);
+
+/** Methods with cached results */
+typedef enum
+{
+    TELEBOT_CACHE_CHAT,        /**< getChat, by chat */
+    TELEBOT_CACHE_CHAT_ADMINS, /**< getChatAdministrators, by chat */
+    TELEBOT_CACHE_CHAT_MEMBER, /**< getChatMember, by chat and user */
+    TELEBOT_CACHE_STICKER_SET, /**< getStickerSet, by name */
+} telebot_cache_kind_e;
+
+/** Counters of a response cache */
+typedef struct telebot_cache_stats
+{
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long invalidations;
+    unsigned long long entries;
+} telebot_cache_stats_t;
+
+/** Create response cache, ttl in seconds */
+telebot_error_e telebot_cache_create(telebot_cache_t **cache, int ttl, int capacity);
+
+/** Destroy response cache */
+void telebot_cache_destroy(telebot_cache_t *cache);
+
+/**
+ * Get copy of cached response to be freed by caller, NULL on miss. The
+ * generation of the bucket is passed to telebot_cache_put() for the response
+ * of a miss.
+ */
+char *telebot_cache_get(telebot_cache_t *cache, telebot_cache_kind_e kind, long long int chat_id,
+                        long long int user_id, unsigned long *generation);
+
+/** Cache response, unless invalidated since telebot_cache_get() returned generation */
+void telebot_cache_put(telebot_cache_t *cache, telebot_cache_kind_e kind, long long int chat_id,
+                       long long int user_id, const char *data, unsigned long generation);
+
+/** Drop cached response */
+void telebot_cache_invalidate(telebot_cache_t *cache, telebot_cache_kind_e kind, long long int chat_id,
+                              long long int user_id);
+
+/** Get copy of cached response of a method requested by name, see telebot_cache_get() */
+char *telebot_cache_get_named(telebot_cache_t *cache, telebot_cache_kind_e kind, const char *name,
+                              unsigned long *generation);
+
+/** Cache response of a method requested by name, see telebot_cache_put() */
+void telebot_cache_put_named(telebot_cache_t *cache, telebot_cache_kind_e kind, const char *name, const char *data,
+                             unsigned long generation);
+
+/** Drop cached response of a method requested by name */
+void telebot_cache_invalidate_named(telebot_cache_t *cache, telebot_cache_kind_e kind, const char *name);
+
+/** Drop cached responses made stale by changed membership or rights of the user */
+void telebot_cache_invalidate_member(telebot_cache_t *cache, long long int chat_id, long long int user_id);
+
+/** Drop cached responses made stale by raw update */
+void telebot_cache_invalidate_update(telebot_cache_t *cache, struct json_object *update);
+
+/** Get counters of response cache */
+void telebot_cache_get_stats(telebot_cache_t *cache, telebot_cache_stats_t *stats);
+
+/** Maximum number of tasks of a scheduler */
+#define TELEBOT_SCHEDULER_TASKS 8
+
+/**
+ * Task run by the scheduler thread when due, now is the monotonic time in
+ * milliseconds. It returns the time it is due next, or -1 if it is idle until
+ * woken with telebot_scheduler_wake().
+ */
+typedef int64_t (*telebot_scheduler_task_f)(void *data, int64_t now);
+
+/** Get monotonic time in milliseconds used by the scheduler */
+int64_t telebot_scheduler_now(void);
+
+/** Create scheduler and start its thread */
+telebot_error_e telebot_scheduler_create(telebot_scheduler_t **scheduler);
+
+/** Stop scheduler thread, tasks must have been removed */
+void telebot_scheduler_destroy(telebot_scheduler_t *scheduler);
+
+/** Add idle task to scheduler, returns its slot or -1 if all slots are used */
+int telebot_scheduler_add(telebot_scheduler_t *scheduler, telebot_scheduler_task_f task, void *data);
+
+/** Remove task of slot, waiting for its run in progress to complete */
+void telebot_scheduler_remove(telebot_scheduler_t *scheduler, int slot);
+
+/** Make task of slot due at the monotonic time, unless it is due earlier */
+void telebot_scheduler_wake(telebot_scheduler_t *scheduler, int slot, int64_t at);
+
+/** Get scheduler of handler, creating it on first use */
+telebot_error_e telebot_scheduler_get(telebot_handler_t handle, telebot_scheduler_t **scheduler);
+
+/** Send pending edits and release edit coalescer */
+void telebot_edits_destroy(telebot_edits_t *edits);
+
+/** Fill edit coalescing counters of stats */
+void telebot_edits_get_stats(telebot_edits_t *edits, telebot_stats_t *stats);
+
+/** Stop refreshing chat actions and release them */
+void telebot_actions_destroy(telebot_actions_t *actions);
+
+/** Fill chat action counters of stats */
+void telebot_actions_get_stats(telebot_actions_t *actions, telebot_stats_t *stats);
+
+/** Send gathered batches and release message batcher */
+void telebot_batcher_destroy(telebot_batcher_t *batcher);
+
+/** Fill message batching counters of stats */
+void telebot_batcher_get_stats(telebot_batcher_t *batcher, telebot_stats_t *stats);
+
+/** Create cache of inline query answers, ttl in seconds */
+telebot_error_e telebot_inline_cache_create(telebot_inline_cache_t **cache, int ttl, size_t max_size);
+
+/** Release cache of inline query answers */
+void telebot_inline_cache_destroy(telebot_inline_cache_t *cache);
+
+/** Fill inline cache counters of stats */
+void telebot_inline_cache_get_stats(telebot_inline_cache_t *cache, telebot_stats_t *stats);
+
+/** Create tracker of latest inline queries of users */
+telebot_error_e telebot_inline_tracker_create(telebot_inline_tracker_t **tracker);
+
+/** Release tracker of inline queries */
+void telebot_inline_tracker_destroy(telebot_inline_tracker_t *tracker);
+
+/** Track inline queries of updates, superseding earlier queries of their users */
+void telebot_inline_tracker_add(telebot_inline_tracker_t *tracker, telebot_update_t *updates, int count);
+
+/** Check if inline query is superseded, counting it as dropped answer if drop is true */
+bool telebot_inline_tracker_is_superseded(telebot_inline_tracker_t *tracker, const char *inline_query_id,
+                                          bool drop);
+
+/** Fill inline query counters of stats */
+void telebot_inline_tracker_get_stats(telebot_inline_tracker_t *tracker, telebot_stats_t *stats);
+
+/** Release payment lane, queued queries are dropped unanswered */
+void telebot_payment_lane_destroy(telebot_payment_lane_t *lane);
+
+/** Hand shipping and pre-checkout queries of raw updates to the payment lane */
+void telebot_payment_lane_submit(telebot_payment_lane_t *lane, struct json_object *updates,
+                                 const int64_t *received, const telebot_filter_t *filter);
+
+/**
+ * Claim answering a payment query, core_h is set to the connection to answer on.
+ * Returns TELEBOT_ERROR_CANCELED if the query was answered after its deadline already.
+ */
+telebot_error_e telebot_payment_lane_claim(telebot_payment_lane_t *lane, const char *query_id,
+                                           telebot_core_handler_t *core_h);
+
+/** Fill payment lane counters of stats */
+void telebot_payment_lane_get_stats(telebot_payment_lane_t *lane, telebot_stats_t *stats);
+
+/** Open or create Telegram Stars ledger file and load its entries */
+telebot_error_e telebot_ledger_open(telebot_ledger_t **ledger, const char *path);
+
+/** Close Telegram Stars ledger */
+void telebot_ledger_close(telebot_ledger_t *ledger);
+
+/** Append payments in Telegram Stars of raw updates to the ledger */
+void telebot_ledger_add_updates(telebot_ledger_t *ledger, struct json_object *updates);
+
+/** Release private key of passport credentials */
+void telebot_passport_key_destroy(telebot_passport_key_t *key);
+
+/** Create shared reply markup cache */
+telebot_error_e telebot_markup_cache_create(telebot_markup_cache_t **cache);
+
+/** Destroy shared reply markup cache and all markups in it */
+void telebot_markup_cache_destroy(telebot_markup_cache_t *cache);
+
+/**
+ * @brief User allocated by the parser, shared by reference between the updates
+ * of a getUpdates batch.
+ */
+typedef struct telebot_user_ref
+{
+    int refs;            /**< Number of references, updated atomically */
+    telebot_user_t user; /**< Shared user */
+} telebot_user_ref_t;
+
+/**
+ * @brief Chat allocated by the parser, shared by reference between the updates
+ * of a getUpdates batch.
+ */
+typedef struct telebot_chat_ref
+{
+    int refs;            /**< Number of references, updated atomically */
+    telebot_chat_t chat; /**< Shared chat */
+} telebot_chat_ref_t;
+
+/** Drop reference to shared user, releasing it with the last reference */
+void telebot_put_user_ref(telebot_user_t *user);
+
+/** Drop reference to shared chat, releasing it with the last reference */
+void telebot_put_chat_ref(telebot_chat_t *chat);
+
+/** Release fields of message extras, not the extras themselves */
+void telebot_put_message_extras(telebot_message_extras_t *extras);
+
+/** Get shared copy of string that lives as long as the process, NULL on NULL */
+const char *telebot_intern(const char *str);
+
+/**
+ * Look string up in values of enumeration, where index 0 is the unknown value.
+ * Known values are returned as the static string of the table, unknown ones
+ * are interned.
+ */
+int telebot_intern_enum(const char *str, const char *const *values, int count, const char **interned);
+
 #endif /* __TELEBOT_PRIVATE_H__ */
@@ -108,6 +108,93 @@ telebot_error_e telebot_get_sticker_set(telebot_handler_t handle, const char *na
  */
 telebot_error_e telebot_put_sticker_set(telebot_sticker_set_t *stickers);
 
+/**
+ * @brief Default number of sticker sets kept by the sticker set cache, see
+ * #telebot_set_sticker_set_cache().
+ */
+#define TELEBOT_STICKER_SET_CACHE_CAPACITY 64
+
+/**
+ * @brief Cache sticker sets obtained with #telebot_get_sticker_set() by name.
+ *
+ * Sticker sets are cached for @p ttl seconds, the least recently used ones are
+ * dropped when @p capacity is reached. A set is dropped from the cache when the
+ * bot changes it with #telebot_create_sticker_set(). Hits and misses are
+ * reported by #telebot_get_stats(). The cache is disabled by default.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] ttl Seconds sticker sets are cached for, 0 disables the cache.
+ * @param[in] capacity Maximum number of cached sticker sets, 0 for
+ * #TELEBOT_STICKER_SET_CACHE_CAPACITY.
+ * @return On success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_set_sticker_set_cache(telebot_handler_t handle, int ttl, int capacity);
+
+/**
+ * @brief Maximum number of stickers a sticker set is created with, the rest
+ * are added one by one.
+ */
+#define TELEBOT_STICKER_SET_INITIAL_MAX 50
+
+/**
+ * @brief Default number of sticker files uploaded at the same time by
+ * #telebot_create_sticker_set().
+ */
+#define TELEBOT_STICKER_UPLOAD_CONCURRENCY 4
+
+/**
+ * @brief Default milliseconds between requests of #telebot_create_sticker_set().
+ */
+#define TELEBOT_STICKER_UPLOAD_INTERVAL 100
+
+/**
+ * @brief This object describes a sticker to be added to a sticker set.
+ */
+typedef struct telebot_input_sticker {
+    /** Path of the sticker file to upload, or file_id of an uploaded one */
+    const char *sticker;
+
+    /** True, if sticker is a path to file */
+    bool is_file;
+
+    /** Format of the sticker, must be one of "static", "animated", "video" */
+    const char *format;
+
+    /** JSON-serialized list of 1-20 emoji associated with the sticker */
+    const char *emoji_list;
+
+    /** Optional. JSON-serialized list of 0-20 search keywords for the sticker */
+    const char *keywords;
+} telebot_input_sticker_t;
+
+/**
+ * @brief Create a new sticker set owned by a user.
+ *
+ * Sticker files are uploaded concurrently, at most @p concurrency at a time
+ * and at least @p interval milliseconds apart, failed uploads are retried.
+ * Once all of them are uploaded, the set is created with the first
+ * #TELEBOT_STICKER_SET_INITIAL_MAX stickers and the rest are added in order.
+ *
+ * @param[in] handle The telebot handler created with #telebot_create().
+ * @param[in] user_id User identifier of created sticker set owner.
+ * @param[in] name Short name of sticker set, must end in "_by_<bot_username>".
+ * @param[in] title Sticker set title, 1-64 characters.
+ * @param[in] sticker_type Optional. Type of stickers in the set, "regular",
+ * "mask" or "custom_emoji".
+ * @param[in] stickers Stickers of the set, in order.
+ * @param[in] count Number of stickers.
+ * @param[in] concurrency Maximum number of concurrent uploads, 0 for
+ * #TELEBOT_STICKER_UPLOAD_CONCURRENCY.
+ * @param[in] interval Minimum milliseconds between requests, 0 for
+ * #TELEBOT_STICKER_UPLOAD_INTERVAL.
+ * @return on Success, #TELEBOT_ERROR_NONE is returned, otherwise a negative
+ * error value.
+ */
+telebot_error_e telebot_create_sticker_set(telebot_handler_t handle, long long int user_id,
+    const char *name, const char *title, const char *sticker_type,
+    const telebot_input_sticker_t *stickers, int count, int concurrency, int interval);
+
 /**
  * @brief Release a sticker object.
  *
@@ -68,6 +68,104 @@ typedef enum telebot_update_type {
     TELEBOT_UPDATE_TYPE_MAX                   /**< Number of update types */
 } telebot_update_type_e;
 
+/**
+ * @brief Enumerations of chat types, see #telebot_chat_t.
+ */
+typedef enum telebot_chat_type {
+    TELEBOT_CHAT_TYPE_UNKNOWN = 0,  /**< Type not known to the library */
+    TELEBOT_CHAT_TYPE_PRIVATE,      /**< Private chat */
+    TELEBOT_CHAT_TYPE_GROUP,        /**< Group */
+    TELEBOT_CHAT_TYPE_SUPERGROUP,   /**< Supergroup */
+    TELEBOT_CHAT_TYPE_CHANNEL,      /**< Channel */
+    TELEBOT_CHAT_TYPE_MAX           /**< Number of chat types */
+} telebot_chat_type_e;
+
+/**
+ * @brief Enumerations of message entity types, see #telebot_message_entity_t.
+ */
+typedef enum telebot_message_entity_type {
+    TELEBOT_MESSAGE_ENTITY_TYPE_UNKNOWN = 0,           /**< Type not known to the library */
+    TELEBOT_MESSAGE_ENTITY_TYPE_MENTION,               /**< @username */
+    TELEBOT_MESSAGE_ENTITY_TYPE_HASHTAG,               /**< #hashtag */
+    TELEBOT_MESSAGE_ENTITY_TYPE_CASHTAG,               /**< $USD */
+    TELEBOT_MESSAGE_ENTITY_TYPE_BOT_COMMAND,           /**< /start@jobs_bot */
+    TELEBOT_MESSAGE_ENTITY_TYPE_URL,                   /**< https://telegram.org */
+    TELEBOT_MESSAGE_ENTITY_TYPE_EMAIL,                 /**< do-not-reply@telegram.org */
+    TELEBOT_MESSAGE_ENTITY_TYPE_PHONE_NUMBER,          /**< +1-212-555-0123 */
+    TELEBOT_MESSAGE_ENTITY_TYPE_BOLD,                  /**< Bold text */
+    TELEBOT_MESSAGE_ENTITY_TYPE_ITALIC,                /**< Italic text */
+    TELEBOT_MESSAGE_ENTITY_TYPE_UNDERLINE,             /**< Underlined text */
+    TELEBOT_MESSAGE_ENTITY_TYPE_STRIKETHROUGH,         /**< Strikethrough text */
+    TELEBOT_MESSAGE_ENTITY_TYPE_SPOILER,               /**< Spoiler message */
+    TELEBOT_MESSAGE_ENTITY_TYPE_BLOCKQUOTE,            /**< Block quotation */
+    TELEBOT_MESSAGE_ENTITY_TYPE_EXPANDABLE_BLOCKQUOTE, /**< Collapsed-by-default block quotation */
+    TELEBOT_MESSAGE_ENTITY_TYPE_CODE,                  /**< Monowidth string */
+    TELEBOT_MESSAGE_ENTITY_TYPE_PRE,                   /**< Monowidth block */
+    TELEBOT_MESSAGE_ENTITY_TYPE_TEXT_LINK,             /**< Clickable text URLs */
+    TELEBOT_MESSAGE_ENTITY_TYPE_TEXT_MENTION,          /**< Mention of users without usernames */
+    TELEBOT_MESSAGE_ENTITY_TYPE_CUSTOM_EMOJI,          /**< Inline custom emoji stickers */
+    TELEBOT_MESSAGE_ENTITY_TYPE_MAX                    /**< Number of message entity types */
+} telebot_message_entity_type_e;
+
+/**
+ * @brief Enumerations of reaction types, see #telebot_reaction_type_t.
+ */
+typedef enum {
+    TELEBOT_REACTION_TYPE_UNKNOWN = 0, /**< Type not known to the library */
+    TELEBOT_REACTION_TYPE_EMOJI,       /**< Regular emoji */
+    TELEBOT_REACTION_TYPE_CUSTOM_EMOJI, /**< Custom emoji */
+    TELEBOT_REACTION_TYPE_PAID,        /**< Paid reaction */
+    TELEBOT_REACTION_TYPE_MAX          /**< Number of reaction types */
+} telebot_reaction_type_e;
+
+/**
+ * @brief Enumerations of chat member statuses, see #telebot_chat_member_t.
+ */
+typedef enum telebot_chat_member_status {
+    TELEBOT_CHAT_MEMBER_STATUS_UNKNOWN = 0,   /**< Status not known to the library */
+    TELEBOT_CHAT_MEMBER_STATUS_CREATOR,       /**< Owner of the chat */
+    TELEBOT_CHAT_MEMBER_STATUS_ADMINISTRATOR, /**< Administrator */
+    TELEBOT_CHAT_MEMBER_STATUS_MEMBER,        /**< Member without restrictions */
+    TELEBOT_CHAT_MEMBER_STATUS_RESTRICTED,    /**< Member with restrictions */
+    TELEBOT_CHAT_MEMBER_STATUS_LEFT,          /**< Left the chat */
+    TELEBOT_CHAT_MEMBER_STATUS_KICKED,        /**< Banned in the chat */
+    TELEBOT_CHAT_MEMBER_STATUS_MAX            /**< Number of chat member statuses */
+} telebot_chat_member_status_e;
+
+/**
+ * @brief Enumerations of message fields loaded on demand with
+ * #telebot_load_message_field(), see #telebot_set_lazy_parsing().
+ */
+typedef enum telebot_message_field {
+    TELEBOT_MESSAGE_FIELD_FORWARD = 0,          /**< forward_origin and legacy forward_* fields */
+    TELEBOT_MESSAGE_FIELD_SENDER,               /**< sender_chat, sender_business_bot, via_bot, ... */
+    TELEBOT_MESSAGE_FIELD_REPLY_TO_MESSAGE,     /**< reply_to_message */
+    TELEBOT_MESSAGE_FIELD_EXTERNAL_REPLY,       /**< external_reply */
+    TELEBOT_MESSAGE_FIELD_QUOTE,                /**< quote */
+    TELEBOT_MESSAGE_FIELD_REPLY_TO_STORY,       /**< reply_to_story */
+    TELEBOT_MESSAGE_FIELD_ENTITIES,             /**< entities */
+    TELEBOT_MESSAGE_FIELD_LINK_PREVIEW_OPTIONS, /**< link_preview_options */
+    TELEBOT_MESSAGE_FIELD_ANIMATION,            /**< animation */
+    TELEBOT_MESSAGE_FIELD_AUDIO,                /**< audio */
+    TELEBOT_MESSAGE_FIELD_DOCUMENT,             /**< document */
+    TELEBOT_MESSAGE_FIELD_PAID_MEDIA,           /**< paid_media */
+    TELEBOT_MESSAGE_FIELD_PHOTOS,               /**< photos */
+    TELEBOT_MESSAGE_FIELD_STICKER,              /**< sticker */
+    TELEBOT_MESSAGE_FIELD_VIDEO,                /**< video */
+    TELEBOT_MESSAGE_FIELD_VIDEO_NOTE,           /**< video_note */
+    TELEBOT_MESSAGE_FIELD_VOICE,                /**< voice */
+    TELEBOT_MESSAGE_FIELD_CAPTION,              /**< caption, caption_entities, show_caption_above_media */
+    TELEBOT_MESSAGE_FIELD_CONTACT,              /**< contact */
+    TELEBOT_MESSAGE_FIELD_DICE,                 /**< dice */
+    TELEBOT_MESSAGE_FIELD_POLL,                 /**< poll */
+    TELEBOT_MESSAGE_FIELD_VENUE,                /**< venue */
+    TELEBOT_MESSAGE_FIELD_LOCATION,             /**< location */
+    TELEBOT_MESSAGE_FIELD_EXTRAS,               /**< extras, service messages and rare fields */
+    TELEBOT_MESSAGE_FIELD_REPLY_MARKUP,         /**< reply_markup */
+    TELEBOT_MESSAGE_FIELD_PROPERTIES,           /**< Flags, media_group_id and effect_id */
+    TELEBOT_MESSAGE_FIELD_MAX                   /**< Number of message fields */
+} telebot_message_field_e;
+
 /**
  * @brief Describes the birthdate of a user.
  */
@@ -191,8 +289,8 @@ typedef struct telebot_user {
     /** Optional. User's or bot's username. */
     char *username;
 
-    /** Optional. IETF language tag of the user's language. */
-    char *language_code;
+    /** Optional. IETF language tag of the user's language, interned by the library. */
+    const char *language_code;
 
     /** Optional. True, if this user is a Telegram Premium user. */
     bool is_premium;
@@ -231,7 +329,10 @@ typedef struct telebot_chat {
     long long int id;
 
     /** Type of chat, can be either "private", or "group", "supergroup", or "channel". */
-    char *type;
+    const char *type;
+
+    /** Type of chat as enumeration, #TELEBOT_CHAT_TYPE_UNKNOWN for new types. */
+    telebot_chat_type_e chat_type;
 
     /** Optional. Title, for supergroups, channels and group chats. */
     char *title;
@@ -1065,11 +1166,14 @@ typedef struct telebot_message_reaction_count_updated {
  * @brief This object represents a reaction type.
  */
 typedef struct telebot_reaction_type {
-    /** Type of the reaction, currently can be "emoji" or "custom_emoji" */
-    char *type;
+    /** Type of the reaction, currently can be "emoji", "custom_emoji" or "paid" */
+    const char *type;
 
-    /** Optional. Reaction emoji. */
-    char *emoji;
+    /** Type of the reaction as enumeration, #TELEBOT_REACTION_TYPE_UNKNOWN for new types. */
+    telebot_reaction_type_e reaction_type;
+
+    /** Optional. Reaction emoji, interned by the library. */
+    const char *emoji;
 
     /** Optional. Custom emoji identifier. */
     char *custom_emoji_id;
@@ -1771,8 +1875,160 @@ typedef struct telebot_game_high_score {
     int score;
 } telebot_game_high_score_t;
 
+/**
+ * @brief Rarely set fields of a message: chat member and chat settings
+ * changes, payments, forum topic and video chat events, giveaways and other
+ * service messages. See #telebot_message_t.
+ */
+typedef struct telebot_message_extras {
+    /**
+     * Optional. New members that were added to the group or supergroup and
+     * information about them (the bot itself may be one of these members)
+     */
+    struct telebot_user *new_chat_members;
+    int count_new_chat_members;
+
+    /**
+     * Optional. A member was removed from the group, information about them
+     * (this member may be the bot itself)
+     */
+    struct telebot_user *left_chat_members;
+    int count_left_chat_members;
+
+    /** Optional. A chat title was changed to this value */
+    char *new_chat_title;
+
+    /** Optional. A chat photo was change to this value */
+    struct telebot_photo *new_chat_photos;
+    int count_new_chat_photos;
+
+    /** Optional. Informs that the chat photo was deleted */
+    bool delete_chat_photo;
+
+    /** Optional. Informs that the group has been created */
+    bool group_chat_created;
+
+    /** Optional. Service message: the supergroup has been created */
+    bool supergroup_chat_created;
+
+    /** Optional. Service message: the channel has been created */
+    bool channel_chat_created;
+
+    /** Optional. Service message: auto-delete timer settings changed in the chat */
+    struct telebot_message_auto_delete_timer_changed *message_auto_delete_timer_changed;
+
+    /**
+     * Optional. The group has been migrated to a supergroup with the specified
+     * identifier, not exceeding 1e13 by absolute value
+     */
+    long long int migrate_to_chat_id;
+
+    /**
+     * Optional. The supergroup has been migrated from a group with the
+     * specified identifier, not exceeding 1e13 by absolute value
+     */
+    long long int migrate_from_chat_id;
+
+    /**
+     * Optional. Specified message was pinned. Note that the Message object in
+     * this field will not contain further reply_to_message fields even if it
+     * is itself a reply.
+     */
+    struct telebot_message *pinned_message;
+
+    /**
+     * Optional. Message is an invoice for a payment, information about the
+     * invoice.
+     */
+    struct telebot_invoice *invoice;
+
+    /**
+     * Optional. Message is a service message about a successful payment,
+     * information about the payment.
+     */
+    struct telebot_successful_payment *successful_payment;
+
+    /** Optional. Message is a service message about a refunded payment */
+    struct telebot_refunded_payment *refunded_payment;
+
+    /** Optional. Service message: the user allowed the bot to write messages */
+    struct telebot_write_access_allowed *write_access_allowed;
+
+    /** Optional. The domain name of the website on which the user has logged in.*/
+    char *connected_website;
+
+    /** Telegram Passport data */
+    struct telebot_passport_data *passport_data;
+
+    /**
+     * Optional. Service message. A user in the chat triggered another user's
+     * proximity alert while sharing Live Location.
+     */
+    struct telebot_proximity_alert_triggered *proximity_alert_triggered;
+
+    /** Optional. Service message: forum topic created. */
+    struct telebot_forum_topic_created *forum_topic_created;
+
+    /** Optional. Service message: forum topic edited. */
+    struct telebot_forum_topic_edited *forum_topic_edited;
+
+    /** Optional. Service message: forum topic closed. */
+    struct telebot_forum_topic_closed *forum_topic_closed;
+
+    /** Optional. Service message: forum topic reopened. */
+    struct telebot_forum_topic_reopened *forum_topic_reopened;
+
+    /** Optional. Service message: general forum topic hidden. */
+    struct telebot_general_forum_topic_hidden *general_forum_topic_hidden;
+
+    /** Optional. Service message: general forum topic unhidden. */
+    struct telebot_general_forum_topic_unhidden *general_forum_topic_unhidden;
+
+    /** Optional. Service message: video chat scheduled. */
+    struct telebot_video_chat_scheduled *video_chat_scheduled;
+
+    /** Optional. Service message: video chat started. */
+    struct telebot_video_chat_started *video_chat_started;
+
+    /** Optional. Service message: video chat ended. */
+    struct telebot_video_chat_ended *video_chat_ended;
+
+    /** Optional. Service message: new participants invited to a video chat. */
+    struct telebot_video_chat_participants_invited *video_chat_participants_invited;
+
+    /** Optional. Service message: data sent by a Web App. */
+    struct telebot_web_app_data *web_app_data;
+
+    /** Optional. Service message: users were shared with the bot */
+    struct telebot_users_shared *users_shared;
+
+    /** Optional. Service message: a chat was shared with the bot */
+    struct telebot_chat_shared *chat_shared;
+
+    /** Optional. Service message: a regular gift was sent or received */
+    struct telebot_gift_info *gift;
+
+    /** Optional. Service message: a unique gift was sent or received */
+    struct telebot_unique_gift_info *unique_gift;
+
+    /** Optional. Service message: user boosted the chat */
+    struct telebot_chat_boost_added *boost_added;
+
+    /** Optional. Service message: chat background set */
+    struct telebot_chat_background *chat_background_set;
+
+    /** Optional. Service message: giveaway created */
+    struct telebot_giveaway_created *giveaway_created;
+
+    /** Optional. Service message: giveaway completed */
+    struct telebot_giveaway_completed *giveaway_completed;
+} telebot_message_extras_t;
+
 /**
  * @brief This object represents a message.
+ *
+ * Fields read by most handlers come first, so they share the leading cache
+ * lines of the message. Rarely set fields are kept in #telebot_message_extras_t.
  */
 typedef struct telebot_message {
     /** Unique message identifier */
@@ -1784,9 +2040,34 @@ typedef struct telebot_message {
      */
     int message_thread_id;
 
+    /** Date the message was sent in Unix time */
+    long date;
+
+    /** Optional. Date the message was last edited in Unix time */
+    long edit_date;
+
+    /** Conversation the message belongs to */
+    struct telebot_chat *chat;
+
     /** Optional. Sender, can be empty for messages sent to channels */
     struct telebot_user *from;
 
+    /** Optional. For text messages, the actual UTF-8 text of the message */
+    char *text;
+
+    /**
+     * Optional. For text messages, special entities like usernames, URLs, bot
+     * commands, etc. that appear in the text.
+     */
+    struct telebot_message_entity *entities;
+    int count_entities;
+
+    /**
+     * Optional. Rarely set fields, mostly service messages. Allocated only
+     * when at least one of them is present, NULL otherwise.
+     */
+    struct telebot_message_extras *extras;
+
     /**
      * Optional. Sender of the message, sent on behalf of a chat. For example,
      * the channel itself for channel posts, the supergroup itself for messages
@@ -1806,12 +2087,6 @@ typedef struct telebot_message {
     /** Optional. Unique identifier of the business connection */
     char *business_connection_id;
 
-    /** Date the message was sent in Unix time */
-    long date;
-
-    /** Conversation the message belongs to */
-    struct telebot_chat *chat;
-
     /** Optional. Information about the original message for forwarded messages */
     struct telebot_message_origin *forward_origin;
 
@@ -1876,9 +2151,6 @@ typedef struct telebot_message {
     /** Optional. Bot through which the message was sent */
     struct telebot_user *via_bot;
 
-    /** Optional. Date the message was last edited in Unix time */
-    long edit_date;
-
     /** Optional. True, if the message can't be forwarded */
     bool has_protected_content;
 
@@ -1894,16 +2166,6 @@ typedef struct telebot_message {
     /** Optional. Signature of the post author for messages in channels */
     char *author_signature;
 
-    /** Optional. For text messages, the actual UTF-8 text of the message */
-    char *text;
-
-    /**
-     * Optional. For text messages, special entities like usernames, URLs, bot
-     * commands, etc. that appear in the text.
-     */
-    struct telebot_message_entity *entities;
-    int count_entities;
-
     /** Optional. Options used for link preview generation for the message */
     struct telebot_link_preview_options *link_preview_options;
 
@@ -1973,148 +2235,6 @@ typedef struct telebot_message {
     /** Optional. Message is a shared location, information about the location */
     struct telebot_location *location;
 
-    /**
-     * Optional. New members that were added to the group or supergroup and
-     * information about them (the bot itself may be one of these members)
-     */
-    struct telebot_user *new_chat_members;
-    int count_new_chat_members;
-
-    /**
-     * Optional. A member was removed from the group, information about them
-     * (this member may be the bot itself)
-     */
-    struct telebot_user *left_chat_members;
-    int count_left_chat_members;
-
-    /** Optional. A chat title was changed to this value */
-    char *new_chat_title;
-
-    /** Optional. A chat photo was change to this value */
-    struct telebot_photo *new_chat_photos;
-    int count_new_chat_photos;
-
-    /** Optional. Informs that the chat photo was deleted */
-    bool delete_chat_photo;
-
-    /** Optional. Informs that the group has been created */
-    bool group_chat_created;
-
-    /** Optional. Service message: the supergroup has been created */
-    bool supergroup_chat_created;
-
-    /** Optional. Service message: the channel has been created */
-    bool channel_chat_created;
-
-    /** Optional. Service message: auto-delete timer settings changed in the chat */
-    struct telebot_message_auto_delete_timer_changed *message_auto_delete_timer_changed;
-
-    /**
-     * Optional. The group has been migrated to a supergroup with the specified
-     * identifier, not exceeding 1e13 by absolute value
-     */
-    long long int migrate_to_chat_id;
-
-    /**
-     * Optional. The supergroup has been migrated from a group with the
-     * specified identifier, not exceeding 1e13 by absolute value
-     */
-    long long int migrate_from_chat_id;
-
-    /**
-     * Optional. Specified message was pinned. Note that the Message object in
-     * this field will not contain further reply_to_message fields even if it
-     * is itself a reply.
-     */
-    struct telebot_message *pinned_message;
-
-    /**
-     * Optional. Message is an invoice for a payment, information about the
-     * invoice.
-     */
-    struct telebot_invoice *invoice;
-
-    /**
-     * Optional. Message is a service message about a successful payment,
-     * information about the payment.
-     */
-    struct telebot_successful_payment *successful_payment;
-
-    /** Optional. Message is a service message about a refunded payment */
-    struct telebot_refunded_payment *refunded_payment;
-
-    /** Optional. Service message: the user allowed the bot to write messages */
-    struct telebot_write_access_allowed *write_access_allowed;
-
-    /** Optional. The domain name of the website on which the user has logged in.*/
-    char *connected_website;
-
-    /** Telegram Passport data */
-    struct telebot_passport_data *passport_data;
-
-    /**
-     * Optional. Service message. A user in the chat triggered another user's
-     * proximity alert while sharing Live Location.
-     */
-    struct telebot_proximity_alert_triggered *proximity_alert_triggered;
-
-    /** Optional. Service message: forum topic created. */
-    struct telebot_forum_topic_created *forum_topic_created;
-
-    /** Optional. Service message: forum topic edited. */
-    struct telebot_forum_topic_edited *forum_topic_edited;
-
-    /** Optional. Service message: forum topic closed. */
-    struct telebot_forum_topic_closed *forum_topic_closed;
-
-    /** Optional. Service message: forum topic reopened. */
-    struct telebot_forum_topic_reopened *forum_topic_reopened;
-
-    /** Optional. Service message: general forum topic hidden. */
-    struct telebot_general_forum_topic_hidden *general_forum_topic_hidden;
-
-    /** Optional. Service message: general forum topic unhidden. */
-    struct telebot_general_forum_topic_unhidden *general_forum_topic_unhidden;
-
-    /** Optional. Service message: video chat scheduled. */
-    struct telebot_video_chat_scheduled *video_chat_scheduled;
-
-    /** Optional. Service message: video chat started. */
-    struct telebot_video_chat_started *video_chat_started;
-
-    /** Optional. Service message: video chat ended. */
-    struct telebot_video_chat_ended *video_chat_ended;
-
-    /** Optional. Service message: new participants invited to a video chat. */
-    struct telebot_video_chat_participants_invited *video_chat_participants_invited;
-
-    /** Optional. Service message: data sent by a Web App. */
-    struct telebot_web_app_data *web_app_data;
-
-    /** Optional. Service message: users were shared with the bot */
-    struct telebot_users_shared *users_shared;
-
-    /** Optional. Service message: a chat was shared with the bot */
-    struct telebot_chat_shared *chat_shared;
-
-    /** Optional. Service message: a regular gift was sent or received */
-    struct telebot_gift_info *gift;
-
-    /** Optional. Service message: a unique gift was sent or received */
-    struct telebot_unique_gift_info *unique_gift;
-
-    /** Optional. Service message: user boosted the chat */
-    struct telebot_chat_boost_added *boost_added;
-
-    /** Optional. Service message: chat background set */
-    struct telebot_chat_background *chat_background_set;
-
-    /** Optional. Service message: giveaway created */
-    struct telebot_giveaway_created *giveaway_created;
-
-    /** Optional. Service message: giveaway completed */
-    struct telebot_giveaway_completed *giveaway_completed;
-
     /** Optional. True, if the message media is covered by a spoiler animation */
     bool has_media_spoiler;
 
@@ -2123,6 +2243,12 @@ typedef struct telebot_message {
      * represented as ordinary url buttons.
      */
     struct telebot_inline_keyboard_markup *reply_markup;
+
+    /**
+     * Internal. Fields not loaded yet when lazy parsing is enabled with
+     * #telebot_set_lazy_parsing(), NULL once all fields are available.
+     */
+    struct telebot_message_lazy *lazy;
 } telebot_message_t;
 
 /**
@@ -2136,7 +2262,10 @@ typedef struct telebot_message_entity {
      * string), pre (monowidth block), text_link (for clickable text URLs),
      * text_mention (for users without usernames)
      */
-    char *type;
+    const char *type;
+
+    /** Type of the entity as enumeration, #TELEBOT_MESSAGE_ENTITY_TYPE_UNKNOWN for new types. */
+    telebot_message_entity_type_e entity_type;
 
     /** Offset in UTF-16 code units to the start of the entity */
     int offset;
@@ -2555,7 +2684,7 @@ typedef struct telebot_poll {
     bool is_anonymous;
 
     /** Poll type, currently can be "regular" or "quiz" */
-    char *type;
+    const char *type;
 
     /** True, if the poll allows multiple answers */
     bool allows_multiple_answers;
@@ -2941,7 +3070,10 @@ typedef struct telebot_chat_member {
      * The member's status in the chat. Can be "creator", "administrator"”,
      * "member", "restricted", "left" or "kicked".
      */
-    char *status;
+    const char *status;
+
+    /** The member's status as enumeration, #TELEBOT_CHAT_MEMBER_STATUS_UNKNOWN for new statuses. */
+    telebot_chat_member_status_e member_status;
 
     /** Optional. Owner and administrators only. Custom title for this user. */
     char *custom_title;
@@ -3188,6 +3320,12 @@ typedef struct telebot_shipping_query {
 
     /** User specified shipping address */
     struct telebot_shipping_address *shipping_address;
+
+    /**
+     * Monotonic time in milliseconds the query was received at, it must be
+     * answered within 10 seconds.
+     */
+    long long int received;
 } telebot_shipping_query_t;
 
 /**
@@ -3217,6 +3355,12 @@ typedef struct telebot_pre_checkout_query {
 
     /** Optional. Order info provided by the user */
     struct telebot_order_info *order_info;
+
+    /**
+     * Monotonic time in milliseconds the query was received at, it must be
+     * answered within 10 seconds.
+     */
+    long long int received;
 } telebot_pre_checkout_query_t;
 
 /**
@@ -3337,85 +3481,94 @@ typedef struct telebot_update {
      */
     telebot_update_type_e update_type;
 
+    /**
+     * Payload of the update, the member matching update_type is valid. Payloads
+     * are allocated together with the update array and released with it by
+     * #telebot_put_updates(). It is NULL for updates of types unknown to this
+     * library, whose update_type is #TELEBOT_UPDATE_TYPE_MAX.
+     */
     union {
+        /** Payload of any type */
+        void *payload;
+
         /** New incoming message of any kind — text, photo, sticker, etc. */
-        telebot_message_t message;
+        telebot_message_t *message;
 
         /** New version of a message that is known to the bot and was edited */
-        telebot_message_t edited_message;
+        telebot_message_t *edited_message;
 
         /**  New incoming channel post of any kind — text, photo, sticker, etc. */
-        telebot_message_t channel_post;
+        telebot_message_t *channel_post;
 
         /** New version of a channel post that is known to the bot and was edited */
-        telebot_message_t edited_channel_post;
+        telebot_message_t *edited_channel_post;
 
         /** The bot was connected to or disconnected from a business account */
-        telebot_business_connection_t business_connection;
+        telebot_business_connection_t *business_connection;
 
         /** New message from a connected business account */
-        telebot_message_t business_message;
+        telebot_message_t *business_message;
 
         /** New version of a message from a connected business account */
-        telebot_message_t edited_business_message;
+        telebot_message_t *edited_business_message;
 
         /** Messages were deleted from a connected business account */
-        telebot_business_messages_deleted_t deleted_business_messages;
+        telebot_business_messages_deleted_t *deleted_business_messages;
 
         /** New incoming inline query */
-        telebot_inline_query_t inline_query;
+        telebot_inline_query_t *inline_query;
 
         /**
          * The result of an inline query that was chosen by a user and sent to
          * their chat partner. Please see our documentation on the feedback collecting
          * for details on how to enable these updates for your bot.
          */
-        telebot_chosen_inline_result_t chosen_inline_result;
+        telebot_chosen_inline_result_t *chosen_inline_result;
 
         /** New incoming callback query */
-        telebot_callback_query_t callback_query;
+        telebot_callback_query_t *callback_query;
 
         /** New incoming shipping query. Only for invoices with flexible price */
-        telebot_shipping_query_t shipping_query;
+        telebot_shipping_query_t *shipping_query;
 
         /** New incoming pre-checkout query. Contains full information about checkout */
-        telebot_pre_checkout_query_t pre_checkout_query;
+        telebot_pre_checkout_query_t *pre_checkout_query;
 
         /** A user purchased paid media */
-        telebot_paid_media_purchased_t purchased_paid_media;
+        telebot_paid_media_purchased_t *purchased_paid_media;
 
         /**
          * New poll state. Bots receive only updates about stopped polls and
          * polls, which are sent by the bot
          */
-        telebot_poll_t poll;
+        telebot_poll_t *poll;
 
         /**
          * A user changed their answer in a non-anonymous poll. Bots receive
          * new votes only in polls that were sent by the bot itself.
          */
-        telebot_poll_answer_t poll_answer;
+        telebot_poll_answer_t *poll_answer;
 
         /** The bot's chat member status was updated in a chat. For private chats, this update is received only when the bot is blocked or unblocked by the user. */
-        telebot_chat_member_updated_t my_chat_member;
+        telebot_chat_member_updated_t *my_chat_member;
 
         /** A chat member's status was updated in a chat. The bot must be an administrator in the chat and must explicitly specify "chat_member" in the list of allowed_updates to receive these updates. */
-        telebot_chat_member_updated_t chat_member;
+        telebot_chat_member_updated_t *chat_member;
 
         /** A request to join the chat has been sent. The bot must have the can_invite_users administrator right in the chat to receive these updates. */
-        telebot_chat_join_request_t chat_join_request;
+        telebot_chat_join_request_t *chat_join_request;
 
         /** A reaction to a message was changed by a user. The bot must be an administrator in the chat and must explicitly specify "message_reaction" in the list of allowed_updates to receive these updates. */
-        telebot_message_reaction_updated_t message_reaction;
+        telebot_message_reaction_updated_t *message_reaction;
 
         /** Reactions to a message with anonymous reactions were changed. The bot must be an administrator in the chat and must explicitly specify "message_reaction_count" in the list of allowed_updates to receive these updates. */
-        telebot_message_reaction_count_updated_t message_reaction_count;
+        telebot_message_reaction_count_updated_t *message_reaction_count;
 
         /** A chat boost was added or changed. The bot must be an administrator in the chat to receive these updates. */
-        telebot_chat_boost_updated_t chat_boost;
+        telebot_chat_boost_updated_t *chat_boost;
 
         /** A boost was removed from a chat. The bot must be an administrator in the chat to receive these updates. */
-        telebot_chat_boost_removed_t chat_boost_removed;
+        telebot_chat_boost_removed_t *chat_boost_removed;
     };
 } telebot_update_t;
 
@@ -3488,6 +3641,12 @@ typedef struct telebot_message_auto_delete_timer_changed {
  */
 typedef struct telebot_handler *telebot_handler_t;
 
+/**
+ * @brief This is opaque object to represent a page iterator, see
+ * #telebot_iterate_user_profile_photos().
+ */
+typedef struct telebot_iterator *telebot_iterator_t;
+
 /**
  * @} // end of APIs
  */
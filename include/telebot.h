@@ -36,6 +36,10 @@
 #include "telebot-passport.h"
 #include "telebot-games.h"
 #include "telebot-forums.h"
+#include "telebot-journal.h"
+#include "telebot-ledger.h"
+#include "telebot-filter.h"
+#include "telebot-markup.h"
 
 #endif /* __TELEBOT_H__ */
 
@@ -0,0 +1,366 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <telebot-methods.h>
+#include <telebot-private.h>
+
+#define TELEBOT_ACTIONS_BUCKETS 1024
+/* Refreshes due this soon are sent along with due ones, milliseconds */
+#define TELEBOT_ACTIONS_SLACK 250
+
+/* Action started for a chat, by count callers */
+typedef struct telebot_actions_ref
+{
+    struct telebot_actions_ref *next;
+    char *action;
+    int count;
+} telebot_actions_ref_t;
+
+typedef struct telebot_actions_entry
+{
+    struct telebot_actions_entry *next; /* Next entry in the bucket */
+    long long int chat_id;
+    telebot_actions_ref_t *refs; /* Most recently started first, it is the one shown */
+    int64_t due;                 /* Monotonic time in milliseconds */
+} telebot_actions_entry_t;
+
+/* Chat action to send, taken out of the lock */
+typedef struct telebot_actions_send
+{
+    struct telebot_actions_send *next;
+    long long int chat_id;
+    char *action;
+} telebot_actions_send_t;
+
+struct telebot_actions
+{
+    telebot_handler_t handle;
+    telebot_scheduler_t *scheduler;
+    int slot;
+    pthread_mutex_t lock;
+    int64_t refresh; /* Milliseconds between actions sent to a chat */
+    telebot_actions_entry_t *buckets[TELEBOT_ACTIONS_BUCKETS];
+    unsigned long long actions_sent;
+    unsigned long long actions_deduplicated;
+};
+
+static telebot_actions_entry_t **telebot_actions_find(telebot_actions_t *actions, long long int chat_id)
+{
+    uint64_t hash = (uint64_t)chat_id * 0x9E3779B97F4A7C15ULL;
+    hash ^= hash >> 29;
+
+    telebot_actions_entry_t **link = &(actions->buckets[hash & (TELEBOT_ACTIONS_BUCKETS - 1)]);
+    while ((*link != NULL) && ((*link)->chat_id != chat_id))
+        link = &((*link)->next);
+
+    return link;
+}
+
+static void telebot_actions_entry_free(telebot_actions_entry_t *entry)
+{
+    while (entry->refs != NULL)
+    {
+        telebot_actions_ref_t *ref = entry->refs;
+        entry->refs = ref->next;
+        free(ref->action);
+        free(ref);
+    }
+    free(entry);
+}
+
+static int64_t telebot_actions_task(void *data, int64_t now)
+{
+    telebot_actions_t *actions = data;
+    telebot_actions_send_t *batch = NULL;
+    int64_t next = -1;
+
+    pthread_mutex_lock(&(actions->lock));
+    for (int i = 0; i < TELEBOT_ACTIONS_BUCKETS; i++)
+    {
+        for (telebot_actions_entry_t *entry = actions->buckets[i]; entry != NULL; entry = entry->next)
+        {
+            if (entry->due <= now + TELEBOT_ACTIONS_SLACK)
+            {
+                telebot_actions_send_t *send = malloc(sizeof(telebot_actions_send_t));
+                if (send != NULL)
+                {
+                    send->chat_id = entry->chat_id;
+                    send->action = strdup(entry->refs->action);
+                    send->next = batch;
+                    batch = send;
+                }
+                entry->due = now + actions->refresh;
+            }
+            if ((next < 0) || (entry->due < next))
+                next = entry->due;
+        }
+    }
+    pthread_mutex_unlock(&(actions->lock));
+
+    while (batch != NULL)
+    {
+        telebot_actions_send_t *send = batch;
+        batch = send->next;
+        if (send->action != NULL)
+        {
+            if (telebot_send_chat_action(actions->handle, send->chat_id, send->action) != TELEBOT_ERROR_NONE)
+                ERR("Failed to send chat action %s to chat %lld", send->action, send->chat_id);
+            pthread_mutex_lock(&(actions->lock));
+            actions->actions_sent++;
+            pthread_mutex_unlock(&(actions->lock));
+        }
+        free(send->action);
+        free(send);
+    }
+
+    return next;
+}
+
+static telebot_error_e telebot_actions_create(telebot_handler_t handle, int refresh, telebot_actions_t **actions)
+{
+    telebot_scheduler_t *scheduler = NULL;
+    telebot_error_e ret = telebot_scheduler_get(handle, &scheduler);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    telebot_actions_t *_actions = calloc(1, sizeof(telebot_actions_t));
+    if (_actions == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    _actions->handle = handle;
+    _actions->scheduler = scheduler;
+    _actions->refresh = refresh;
+    pthread_mutex_init(&(_actions->lock), NULL);
+
+    _actions->slot = telebot_scheduler_add(scheduler, telebot_actions_task, _actions);
+    if (_actions->slot < 0)
+    {
+        pthread_mutex_destroy(&(_actions->lock));
+        free(_actions);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    *actions = _actions;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_actions_destroy(telebot_actions_t *actions)
+{
+    if (actions == NULL)
+        return;
+
+    telebot_scheduler_remove(actions->scheduler, actions->slot);
+
+    for (int i = 0; i < TELEBOT_ACTIONS_BUCKETS; i++)
+    {
+        while (actions->buckets[i] != NULL)
+        {
+            telebot_actions_entry_t *entry = actions->buckets[i];
+            actions->buckets[i] = entry->next;
+            telebot_actions_entry_free(entry);
+        }
+    }
+
+    pthread_mutex_destroy(&(actions->lock));
+    free(actions);
+}
+
+void telebot_actions_get_stats(telebot_actions_t *actions, telebot_stats_t *stats)
+{
+    if (actions == NULL)
+        return;
+
+    pthread_mutex_lock(&(actions->lock));
+    stats->chat_actions_sent = actions->actions_sent;
+    stats->chat_actions_deduplicated = actions->actions_deduplicated;
+    pthread_mutex_unlock(&(actions->lock));
+}
+
+telebot_error_e telebot_set_chat_action_refresh(telebot_handler_t handle, int refresh)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (refresh < 0)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_actions_t *actions = NULL;
+    if (refresh > 0)
+    {
+        telebot_error_e ret = telebot_actions_create(handle, refresh, &actions);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    /* Replaced once it is not in use, destroyed after as its threads may call back */
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_actions_t *old = handle->actions;
+    handle->actions = actions;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_actions_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_actions_start(telebot_actions_t *actions, long long int chat_id, const char *action)
+{
+    int64_t now = telebot_scheduler_now();
+    int64_t due = -1;
+
+    pthread_mutex_lock(&(actions->lock));
+    telebot_actions_entry_t **link = telebot_actions_find(actions, chat_id);
+    telebot_actions_entry_t *entry = *link;
+    if (entry == NULL)
+    {
+        entry = calloc(1, sizeof(telebot_actions_entry_t));
+        if (entry == NULL)
+        {
+            pthread_mutex_unlock(&(actions->lock));
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        }
+        entry->chat_id = chat_id;
+        *link = entry;
+    }
+
+    telebot_actions_ref_t **ref_link = &(entry->refs);
+    while ((*ref_link != NULL) && strcmp((*ref_link)->action, action))
+        ref_link = &((*ref_link)->next);
+
+    telebot_actions_ref_t *ref = *ref_link;
+    if ((ref != NULL) && (ref == entry->refs))
+    {
+        /* Already shown, it is refreshed anyway */
+        actions->actions_deduplicated++;
+    }
+    else
+    {
+        if (ref == NULL)
+        {
+            ref = calloc(1, sizeof(telebot_actions_ref_t));
+            if ((ref == NULL) || ((ref->action = strdup(action)) == NULL))
+            {
+                free(ref);
+                if (entry->refs == NULL)
+                {
+                    *link = entry->next;
+                    free(entry);
+                }
+                pthread_mutex_unlock(&(actions->lock));
+                return TELEBOT_ERROR_OUT_OF_MEMORY;
+            }
+        }
+        else
+        {
+            *ref_link = ref->next;
+        }
+        ref->next = entry->refs;
+        entry->refs = ref;
+        entry->due = now;
+        due = now;
+    }
+    ref->count++;
+    pthread_mutex_unlock(&(actions->lock));
+
+    if (due >= 0)
+        telebot_scheduler_wake(actions->scheduler, actions->slot, due);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_actions_stop(telebot_actions_t *actions, long long int chat_id, const char *action)
+{
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    int64_t due = -1;
+
+    pthread_mutex_lock(&(actions->lock));
+    telebot_actions_entry_t **link = telebot_actions_find(actions, chat_id);
+    telebot_actions_entry_t *entry = *link;
+    telebot_actions_ref_t **ref_link = (entry != NULL) ? &(entry->refs) : NULL;
+    while ((ref_link != NULL) && (*ref_link != NULL) && strcmp((*ref_link)->action, action))
+        ref_link = &((*ref_link)->next);
+
+    if ((ref_link == NULL) || (*ref_link == NULL))
+    {
+        ERR("Chat action %s was not started for chat %lld", action, chat_id);
+        ret = TELEBOT_ERROR_INVALID_PARAMETER;
+    }
+    else if (--(*ref_link)->count == 0)
+    {
+        telebot_actions_ref_t *ref = *ref_link;
+        *ref_link = ref->next;
+        free(ref->action);
+        free(ref);
+
+        if (entry->refs == NULL)
+        {
+            *link = entry->next;
+            free(entry);
+        }
+        else if (ref_link == &(entry->refs))
+        {
+            /* Show the action started before the stopped one */
+            entry->due = telebot_scheduler_now();
+            due = entry->due;
+        }
+    }
+    pthread_mutex_unlock(&(actions->lock));
+
+    if (due >= 0)
+        telebot_scheduler_wake(actions->scheduler, actions->slot, due);
+
+    return ret;
+}
+
+telebot_error_e telebot_start_chat_action(telebot_handler_t handle, long long int chat_id, const char *action)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (action == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (handle->actions == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return telebot_send_chat_action(handle, chat_id, (char *)action);
+    }
+
+    telebot_error_e ret = telebot_actions_start(handle->actions, chat_id, action);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
+
+telebot_error_e telebot_stop_chat_action(telebot_handler_t handle, long long int chat_id, const char *action)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (action == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    if (handle->actions != NULL)
+        ret = telebot_actions_stop(handle->actions, chat_id, action);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
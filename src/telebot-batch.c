@@ -0,0 +1,412 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <telebot-methods.h>
+#include <telebot-private.h>
+
+#define TELEBOT_BATCH_BUCKETS 1024
+/* Maximum number of messages of deleteMessages, forwardMessages and copyMessages */
+#define TELEBOT_BATCH_SIZE 100
+
+typedef enum telebot_batch_kind
+{
+    TELEBOT_BATCH_DELETE = 0,
+    TELEBOT_BATCH_FORWARD,
+    TELEBOT_BATCH_COPY,
+} telebot_batch_kind_e;
+
+typedef struct telebot_batch_item
+{
+    int message_id;
+    telebot_batch_cb_f callback;
+    void *user_data;
+} telebot_batch_item_t;
+
+/* Messages sent with a single request, items are in order of arrival */
+typedef struct telebot_batch
+{
+    struct telebot_batch *next; /* Next batch in the bucket or the ready list */
+    telebot_batch_kind_e kind;
+    long long int chat_id;
+    long long int from_chat_id;
+    bool disable_notification;
+    bool protect_content;
+    bool remove_caption;
+    int64_t due; /* Monotonic time in milliseconds */
+    int count;
+    telebot_batch_item_t items[TELEBOT_BATCH_SIZE];
+} telebot_batch_t;
+
+struct telebot_batcher
+{
+    telebot_handler_t handle;
+    telebot_scheduler_t *scheduler;
+    int slot;
+    pthread_mutex_t lock;
+    int64_t window; /* Milliseconds messages are gathered for */
+    telebot_batch_t *ready; /* Full batches, sent first */
+    telebot_batch_t *buckets[TELEBOT_BATCH_BUCKETS];
+    unsigned long long requests;
+    unsigned long long messages;
+};
+
+static telebot_batch_t **telebot_batcher_find(telebot_batcher_t *batcher, const telebot_batch_t *key)
+{
+    uint64_t hash = ((uint64_t)key->chat_id * 0x9E3779B97F4A7C15ULL) ^
+                    ((uint64_t)key->from_chat_id * 0xC2B2AE3D27D4EB4FULL) ^ key->kind;
+    hash ^= hash >> 29;
+
+    telebot_batch_t **link = &(batcher->buckets[hash & (TELEBOT_BATCH_BUCKETS - 1)]);
+    while (*link != NULL)
+    {
+        telebot_batch_t *batch = *link;
+        if ((batch->kind == key->kind) && (batch->chat_id == key->chat_id) &&
+            (batch->from_chat_id == key->from_chat_id) &&
+            (batch->disable_notification == key->disable_notification) &&
+            (batch->protect_content == key->protect_content) && (batch->remove_caption == key->remove_caption))
+            break;
+        link = &(batch->next);
+    }
+
+    return link;
+}
+
+static int telebot_batch_compare(const void *a, const void *b)
+{
+    const telebot_batch_item_t *item_a = a, *item_b = b;
+
+    return (item_a->message_id > item_b->message_id) - (item_a->message_id < item_b->message_id);
+}
+
+/* Send batch and complete its items, the batch is released */
+static void telebot_batch_send(telebot_handler_t handle, telebot_batch_t *batch)
+{
+    /* Identifiers must be strictly increasing, duplicates are sent once */
+    qsort(batch->items, batch->count, sizeof(telebot_batch_item_t), telebot_batch_compare);
+
+    char message_ids[TELEBOT_BATCH_SIZE * 12 + 3];
+    int length = 0, unique = 0;
+    message_ids[length++] = '[';
+    for (int i = 0; i < batch->count; i++)
+    {
+        if ((i > 0) && (batch->items[i].message_id == batch->items[i - 1].message_id))
+            continue;
+        length += snprintf(message_ids + length, sizeof(message_ids) - length, "%s%d", unique ? "," : "",
+                           batch->items[i].message_id);
+        unique++;
+    }
+    snprintf(message_ids + length, sizeof(message_ids) - length, "]");
+
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    int *message_ids_out = NULL;
+    int count = 0;
+    switch (batch->kind)
+    {
+    case TELEBOT_BATCH_DELETE:
+        /* deleteMessage reports messages which can not be deleted, deleteMessages skips them */
+        if (unique == 1)
+            ret = telebot_delete_message(handle, batch->chat_id, batch->items[0].message_id);
+        else
+            ret = telebot_delete_messages(handle, batch->chat_id, message_ids);
+        break;
+    case TELEBOT_BATCH_FORWARD:
+        ret = telebot_forward_messages(handle, batch->chat_id, batch->from_chat_id, message_ids,
+                                       batch->disable_notification, batch->protect_content, &message_ids_out, &count);
+        break;
+    case TELEBOT_BATCH_COPY:
+        ret = telebot_copy_messages(handle, batch->chat_id, batch->from_chat_id, message_ids,
+                                    batch->disable_notification, batch->protect_content, batch->remove_caption,
+                                    &message_ids_out, &count);
+        break;
+    }
+
+    if (ret != TELEBOT_ERROR_NONE)
+        ERR("Failed to send batch of %d messages of chat %lld", unique, batch->chat_id);
+
+    /* Skipped messages make new identifiers unknown */
+    if (count != unique)
+        TELEBOT_SAFE_FZCNT(message_ids_out, count);
+
+    for (int i = 0, index = -1; i < batch->count; i++)
+    {
+        telebot_batch_item_t *item = &(batch->items[i]);
+        if ((i == 0) || (item->message_id != batch->items[i - 1].message_id))
+            index++;
+        if (item->callback != NULL)
+        {
+            int message_id = (batch->kind == TELEBOT_BATCH_DELETE) ? item->message_id :
+                             (message_ids_out != NULL) ? message_ids_out[index] : 0;
+            item->callback(item->user_data, ret, message_id);
+        }
+    }
+
+    TELEBOT_SAFE_FREE(message_ids_out);
+    free(batch);
+}
+
+/* Take batches due at now, or all of them if forced. Sets when the next batch is due, or -1. */
+static telebot_batch_t *telebot_batcher_take(telebot_batcher_t *batcher, int64_t now, bool force, int64_t *next)
+{
+    *next = -1;
+
+    pthread_mutex_lock(&(batcher->lock));
+    telebot_batch_t *batches = batcher->ready;
+    batcher->ready = NULL;
+    for (int i = 0; i < TELEBOT_BATCH_BUCKETS; i++)
+    {
+        telebot_batch_t **link = &(batcher->buckets[i]);
+        while (*link != NULL)
+        {
+            telebot_batch_t *batch = *link;
+            if (!force && (batch->due > now))
+            {
+                if ((*next < 0) || (batch->due < *next))
+                    *next = batch->due;
+                link = &(batch->next);
+                continue;
+            }
+            *link = batch->next;
+            batch->next = batches;
+            batches = batch;
+        }
+    }
+
+    for (telebot_batch_t *batch = batches; batch != NULL; batch = batch->next)
+    {
+        batcher->requests++;
+        batcher->messages += batch->count;
+    }
+    pthread_mutex_unlock(&(batcher->lock));
+
+    return batches;
+}
+
+/* Send batches taken from the batcher, their callbacks may use the handler */
+static void telebot_batches_send(telebot_handler_t handle, telebot_batch_t *batches)
+{
+    while (batches != NULL)
+    {
+        telebot_batch_t *batch = batches;
+        batches = batch->next;
+        telebot_batch_send(handle, batch);
+    }
+}
+
+/* Send batches due at now, or all of them if forced. Returns when the next batch is due, or -1. */
+static int64_t telebot_batcher_send(telebot_batcher_t *batcher, int64_t now, bool force)
+{
+    int64_t next = -1;
+    telebot_batches_send(batcher->handle, telebot_batcher_take(batcher, now, force, &next));
+
+    return next;
+}
+
+static int64_t telebot_batcher_task(void *data, int64_t now)
+{
+    return telebot_batcher_send(data, now, false);
+}
+
+static telebot_error_e telebot_batcher_create(telebot_handler_t handle, int window, telebot_batcher_t **batcher)
+{
+    telebot_scheduler_t *scheduler = NULL;
+    telebot_error_e ret = telebot_scheduler_get(handle, &scheduler);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    telebot_batcher_t *_batcher = calloc(1, sizeof(telebot_batcher_t));
+    if (_batcher == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    _batcher->handle = handle;
+    _batcher->scheduler = scheduler;
+    _batcher->window = window;
+    pthread_mutex_init(&(_batcher->lock), NULL);
+
+    _batcher->slot = telebot_scheduler_add(scheduler, telebot_batcher_task, _batcher);
+    if (_batcher->slot < 0)
+    {
+        pthread_mutex_destroy(&(_batcher->lock));
+        free(_batcher);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    *batcher = _batcher;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_batcher_destroy(telebot_batcher_t *batcher)
+{
+    if (batcher == NULL)
+        return;
+
+    telebot_scheduler_remove(batcher->scheduler, batcher->slot);
+    telebot_batcher_send(batcher, telebot_scheduler_now(), true);
+
+    pthread_mutex_destroy(&(batcher->lock));
+    free(batcher);
+}
+
+void telebot_batcher_get_stats(telebot_batcher_t *batcher, telebot_stats_t *stats)
+{
+    if (batcher == NULL)
+        return;
+
+    pthread_mutex_lock(&(batcher->lock));
+    stats->batched_requests = batcher->requests;
+    stats->batched_messages = batcher->messages;
+    pthread_mutex_unlock(&(batcher->lock));
+}
+
+static telebot_error_e telebot_batcher_add(telebot_handler_t handle, const telebot_batch_t *key,
+                                           int message_id, telebot_batch_cb_f callback, void *user_data)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (message_id <= 0)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_batcher_t *batcher = handle->batcher;
+    if (batcher == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+
+        /* Batching is disabled, send it as a batch of one right away */
+        telebot_batch_t *batch = malloc(sizeof(telebot_batch_t));
+        if (batch == NULL)
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        *batch = *key;
+        batch->count = 1;
+        batch->items[0] = (telebot_batch_item_t){message_id, callback, user_data};
+        telebot_batch_send(handle, batch);
+        return TELEBOT_ERROR_NONE;
+    }
+
+    int64_t due = -1;
+    pthread_mutex_lock(&(batcher->lock));
+    telebot_batch_t **link = telebot_batcher_find(batcher, key);
+    telebot_batch_t *batch = *link;
+    if (batch == NULL)
+    {
+        batch = malloc(sizeof(telebot_batch_t));
+        if (batch == NULL)
+        {
+            pthread_mutex_unlock(&(batcher->lock));
+            pthread_rwlock_unlock(&(handle->lock));
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        }
+        *batch = *key;
+        batch->next = NULL;
+        batch->count = 0;
+        batch->due = telebot_scheduler_now() + batcher->window;
+        *link = batch;
+        due = batch->due;
+    }
+
+    batch->items[batch->count++] = (telebot_batch_item_t){message_id, callback, user_data};
+    if (batch->count == TELEBOT_BATCH_SIZE)
+    {
+        *link = batch->next;
+        batch->next = batcher->ready;
+        batcher->ready = batch;
+        due = 0;
+    }
+    pthread_mutex_unlock(&(batcher->lock));
+
+    if (due >= 0)
+        telebot_scheduler_wake(batcher->scheduler, batcher->slot, due);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_set_message_batching(telebot_handler_t handle, int window)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (window < 0)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_batcher_t *batcher = NULL;
+    if (window > 0)
+    {
+        telebot_error_e ret = telebot_batcher_create(handle, window, &batcher);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    /* Replaced once it is not in use, destroyed after as its threads may call back */
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_batcher_t *old = handle->batcher;
+    handle->batcher = batcher;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_batcher_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_batch_delete_message(telebot_handler_t handle, long long int chat_id, int message_id,
+                                             telebot_batch_cb_f callback, void *user_data)
+{
+    telebot_batch_t key = {.kind = TELEBOT_BATCH_DELETE, .chat_id = chat_id};
+
+    return telebot_batcher_add(handle, &key, message_id, callback, user_data);
+}
+
+telebot_error_e telebot_batch_forward_message(telebot_handler_t handle, long long int chat_id,
+                                              long long int from_chat_id, int message_id,
+                                              bool disable_notification, bool protect_content,
+                                              telebot_batch_cb_f callback, void *user_data)
+{
+    telebot_batch_t key = {.kind = TELEBOT_BATCH_FORWARD, .chat_id = chat_id, .from_chat_id = from_chat_id,
+                           .disable_notification = disable_notification, .protect_content = protect_content};
+
+    return telebot_batcher_add(handle, &key, message_id, callback, user_data);
+}
+
+telebot_error_e telebot_batch_copy_message(telebot_handler_t handle, long long int chat_id,
+                                           long long int from_chat_id, int message_id,
+                                           bool disable_notification, bool protect_content, bool remove_caption,
+                                           telebot_batch_cb_f callback, void *user_data)
+{
+    telebot_batch_t key = {.kind = TELEBOT_BATCH_COPY, .chat_id = chat_id, .from_chat_id = from_chat_id,
+                           .disable_notification = disable_notification, .protect_content = protect_content,
+                           .remove_caption = remove_caption};
+
+    return telebot_batcher_add(handle, &key, message_id, callback, user_data);
+}
+
+telebot_error_e telebot_flush_batches(telebot_handler_t handle)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    /* Sent once the lock is released, as callbacks may call back into the handler */
+    int64_t next = -1;
+    telebot_batch_t *batches = NULL;
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (handle->batcher != NULL)
+        batches = telebot_batcher_take(handle->batcher, telebot_scheduler_now(), true, &next);
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_batches_send(handle, batches);
+
+    return TELEBOT_ERROR_NONE;
+}
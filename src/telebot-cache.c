@@ -0,0 +1,428 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <json.h>
+#include <telebot-methods.h>
+#include <telebot-parser.h>
+#include <telebot-private.h>
+
+/* Key of a cached response, name is set only for methods requested by name */
+typedef struct telebot_cache_key
+{
+    telebot_cache_kind_e kind;
+    long long int chat_id;
+    long long int user_id;
+    const char *name;
+} telebot_cache_key_t;
+
+typedef struct telebot_cache_entry
+{
+    struct telebot_cache_entry *next;     /* Next entry in the bucket */
+    struct telebot_cache_entry *lru_prev; /* Recently used entries first */
+    struct telebot_cache_entry *lru_next;
+    telebot_cache_kind_e kind;
+    long long int chat_id;
+    long long int user_id;
+    char *name;
+    int64_t expires; /* Monotonic time in milliseconds */
+    char *data;      /* Raw response of the method */
+} telebot_cache_entry_t;
+
+struct telebot_cache
+{
+    pthread_mutex_t lock;
+    int64_t ttl; /* Milliseconds */
+    int capacity;
+    int count;
+    telebot_cache_entry_t **buckets;
+    unsigned long *generations; /* Incremented by every invalidation in the bucket */
+    size_t buckets_count; /* Power of two */
+    telebot_cache_entry_t *lru_head;
+    telebot_cache_entry_t *lru_tail;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long invalidations;
+};
+
+static int64_t telebot_cache_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static size_t telebot_cache_index(telebot_cache_t *cache, const telebot_cache_key_t *key)
+{
+    uint64_t hash = ((uint64_t)key->chat_id * 0x9E3779B97F4A7C15ULL) ^
+                    ((uint64_t)key->user_id * 0xC2B2AE3D27D4EB4FULL) ^ key->kind;
+    if (key->name != NULL)
+        hash ^= telebot_hash_str(key->name);
+    hash ^= hash >> 29;
+
+    return hash & (cache->buckets_count - 1);
+}
+
+static telebot_cache_entry_t **telebot_cache_find(telebot_cache_t *cache, const telebot_cache_key_t *key)
+{
+    telebot_cache_entry_t **link = &(cache->buckets[telebot_cache_index(cache, key)]);
+    while ((*link != NULL) &&
+           (((*link)->kind != key->kind) || ((*link)->chat_id != key->chat_id) ||
+            ((*link)->user_id != key->user_id) || (((*link)->name == NULL) != (key->name == NULL)) ||
+            ((key->name != NULL) && strcmp((*link)->name, key->name))))
+        link = &((*link)->next);
+
+    return link;
+}
+
+static void telebot_cache_lru_remove(telebot_cache_t *cache, telebot_cache_entry_t *entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache->lru_head = entry->lru_next;
+
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache->lru_tail = entry->lru_prev;
+}
+
+static void telebot_cache_lru_push(telebot_cache_t *cache, telebot_cache_entry_t *entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head)
+        cache->lru_head->lru_prev = entry;
+    else
+        cache->lru_tail = entry;
+    cache->lru_head = entry;
+}
+
+/* Remove entry found by telebot_cache_find() */
+static void telebot_cache_remove(telebot_cache_t *cache, telebot_cache_entry_t **link)
+{
+    telebot_cache_entry_t *entry = *link;
+    *link = entry->next;
+    telebot_cache_lru_remove(cache, entry);
+    cache->count--;
+
+    TELEBOT_SAFE_FREE(entry->name);
+    TELEBOT_SAFE_FREE(entry->data);
+    free(entry);
+}
+
+telebot_error_e telebot_cache_create(telebot_cache_t **cache, int ttl, int capacity)
+{
+    if ((cache == NULL) || (ttl <= 0) || (capacity <= 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_cache_t *c = calloc(1, sizeof(telebot_cache_t));
+    if (c == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    c->buckets_count = 16;
+    while (c->buckets_count < (size_t)capacity)
+        c->buckets_count *= 2;
+
+    c->buckets = calloc(c->buckets_count, sizeof(telebot_cache_entry_t *));
+    c->generations = calloc(c->buckets_count, sizeof(unsigned long));
+    if ((c->buckets == NULL) || (c->generations == NULL))
+    {
+        free(c->buckets);
+        free(c->generations);
+        free(c);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    pthread_mutex_init(&(c->lock), NULL);
+    c->ttl = (int64_t)ttl * 1000;
+    c->capacity = capacity;
+
+    *cache = c;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_cache_destroy(telebot_cache_t *cache)
+{
+    if (cache == NULL)
+        return;
+
+    telebot_cache_entry_t *entry = cache->lru_head;
+    while (entry != NULL)
+    {
+        telebot_cache_entry_t *next = entry->lru_next;
+        TELEBOT_SAFE_FREE(entry->name);
+        TELEBOT_SAFE_FREE(entry->data);
+        free(entry);
+        entry = next;
+    }
+
+    free(cache->buckets);
+    free(cache->generations);
+    pthread_mutex_destroy(&(cache->lock));
+    free(cache);
+}
+
+static char *telebot_cache_lookup(telebot_cache_t *cache, const telebot_cache_key_t *key, unsigned long *generation)
+{
+    if (cache == NULL)
+        return NULL;
+
+    char *data = NULL;
+    pthread_mutex_lock(&(cache->lock));
+    *generation = cache->generations[telebot_cache_index(cache, key)];
+
+    telebot_cache_entry_t **link = telebot_cache_find(cache, key);
+    telebot_cache_entry_t *entry = *link;
+    if ((entry != NULL) && (entry->expires <= telebot_cache_now()))
+    {
+        telebot_cache_remove(cache, link);
+    }
+    else if (entry != NULL)
+    {
+        data = strdup(entry->data);
+        telebot_cache_lru_remove(cache, entry);
+        telebot_cache_lru_push(cache, entry);
+    }
+
+    if (data != NULL)
+        cache->hits++;
+    else
+        cache->misses++;
+    pthread_mutex_unlock(&(cache->lock));
+
+    return data;
+}
+
+static void telebot_cache_store(telebot_cache_t *cache, const telebot_cache_key_t *key, const char *data,
+                                unsigned long generation)
+{
+    if ((cache == NULL) || (data == NULL))
+        return;
+
+    pthread_mutex_lock(&(cache->lock));
+
+    /* Response requested before an invalidation of its bucket may already be stale */
+    if (generation != cache->generations[telebot_cache_index(cache, key)])
+        goto unlock;
+
+    telebot_cache_entry_t **link = telebot_cache_find(cache, key);
+    if (*link != NULL)
+        telebot_cache_remove(cache, link);
+
+    if (cache->count >= cache->capacity)
+    {
+        telebot_cache_entry_t *oldest = cache->lru_tail;
+        telebot_cache_key_t oldest_key = {oldest->kind, oldest->chat_id, oldest->user_id, oldest->name};
+        telebot_cache_remove(cache, telebot_cache_find(cache, &oldest_key));
+    }
+
+    telebot_cache_entry_t *entry = calloc(1, sizeof(telebot_cache_entry_t));
+    if (entry == NULL)
+        goto unlock;
+
+    entry->data = strdup(data);
+    entry->name = (key->name != NULL) ? strdup(key->name) : NULL;
+    if ((entry->data == NULL) || ((key->name != NULL) && (entry->name == NULL)))
+    {
+        TELEBOT_SAFE_FREE(entry->data);
+        TELEBOT_SAFE_FREE(entry->name);
+        free(entry);
+        goto unlock;
+    }
+
+    entry->kind = key->kind;
+    entry->chat_id = key->chat_id;
+    entry->user_id = key->user_id;
+    entry->expires = telebot_cache_now() + cache->ttl;
+
+    link = &(cache->buckets[telebot_cache_index(cache, key)]);
+    entry->next = *link;
+    *link = entry;
+    telebot_cache_lru_push(cache, entry);
+    cache->count++;
+
+unlock:
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+static void telebot_cache_drop(telebot_cache_t *cache, const telebot_cache_key_t *key)
+{
+    if (cache == NULL)
+        return;
+
+    pthread_mutex_lock(&(cache->lock));
+    cache->generations[telebot_cache_index(cache, key)]++;
+
+    telebot_cache_entry_t **link = telebot_cache_find(cache, key);
+    if (*link != NULL)
+    {
+        telebot_cache_remove(cache, link);
+        cache->invalidations++;
+    }
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+char *telebot_cache_get(telebot_cache_t *cache, telebot_cache_kind_e kind, long long int chat_id,
+                        long long int user_id, unsigned long *generation)
+{
+    telebot_cache_key_t key = {kind, chat_id, user_id, NULL};
+    return telebot_cache_lookup(cache, &key, generation);
+}
+
+void telebot_cache_put(telebot_cache_t *cache, telebot_cache_kind_e kind, long long int chat_id,
+                       long long int user_id, const char *data, unsigned long generation)
+{
+    telebot_cache_key_t key = {kind, chat_id, user_id, NULL};
+    telebot_cache_store(cache, &key, data, generation);
+}
+
+void telebot_cache_invalidate(telebot_cache_t *cache, telebot_cache_kind_e kind, long long int chat_id,
+                              long long int user_id)
+{
+    telebot_cache_key_t key = {kind, chat_id, user_id, NULL};
+    telebot_cache_drop(cache, &key);
+}
+
+char *telebot_cache_get_named(telebot_cache_t *cache, telebot_cache_kind_e kind, const char *name,
+                              unsigned long *generation)
+{
+    telebot_cache_key_t key = {kind, 0, 0, name};
+    return telebot_cache_lookup(cache, &key, generation);
+}
+
+void telebot_cache_put_named(telebot_cache_t *cache, telebot_cache_kind_e kind, const char *name, const char *data,
+                             unsigned long generation)
+{
+    telebot_cache_key_t key = {kind, 0, 0, name};
+    telebot_cache_store(cache, &key, data, generation);
+}
+
+void telebot_cache_invalidate_named(telebot_cache_t *cache, telebot_cache_kind_e kind, const char *name)
+{
+    telebot_cache_key_t key = {kind, 0, 0, name};
+    telebot_cache_drop(cache, &key);
+}
+
+static long long int telebot_cache_get_id(struct json_object *obj, const char *key)
+{
+    struct json_object *child = NULL;
+    struct json_object *id = NULL;
+    if (!json_object_object_get_ex(obj, key, &child) || !json_object_object_get_ex(child, "id", &id))
+        return 0;
+
+    return json_object_get_int64(id);
+}
+
+void telebot_cache_invalidate_member(telebot_cache_t *cache, long long int chat_id, long long int user_id)
+{
+    telebot_cache_invalidate(cache, TELEBOT_CACHE_CHAT_MEMBER, chat_id, user_id);
+    telebot_cache_invalidate(cache, TELEBOT_CACHE_CHAT_ADMINS, chat_id, 0);
+}
+
+void telebot_cache_invalidate_update(telebot_cache_t *cache, struct json_object *update)
+{
+    if (cache == NULL)
+        return;
+
+    struct json_object *payload = NULL;
+    telebot_update_type_e type = telebot_parser_get_update_type(update, &payload);
+    long long int chat_id = telebot_cache_get_id(payload, "chat");
+    if (chat_id == 0)
+        return;
+
+    if ((type == TELEBOT_UPDATE_TYPE_CHAT_MEMBER) || (type == TELEBOT_UPDATE_TYPE_MY_CHAT_MEMBER))
+    {
+        struct json_object *member = NULL;
+        if (json_object_object_get_ex(payload, "new_chat_member", &member))
+            telebot_cache_invalidate_member(cache, chat_id, telebot_cache_get_id(member, "user"));
+
+        /* Bot's own rights are part of the full chat information */
+        if (type == TELEBOT_UPDATE_TYPE_MY_CHAT_MEMBER)
+            telebot_cache_invalidate(cache, TELEBOT_CACHE_CHAT, chat_id, 0);
+    }
+    else if (type == TELEBOT_UPDATE_TYPE_MESSAGE)
+    {
+        /* Service messages, chat_member updates are not sent unless requested */
+        struct json_object *users = NULL;
+        if (json_object_object_get_ex(payload, "new_chat_members", &users))
+        {
+            int count = json_object_array_length(users);
+            for (int i = 0; i < count; i++)
+            {
+                struct json_object *id = NULL;
+                if (json_object_object_get_ex(json_object_array_get_idx(users, i), "id", &id))
+                    telebot_cache_invalidate_member(cache, chat_id, json_object_get_int64(id));
+            }
+        }
+
+        long long int left_id = telebot_cache_get_id(payload, "left_chat_member");
+        if (left_id != 0)
+            telebot_cache_invalidate_member(cache, chat_id, left_id);
+
+        if (json_object_object_get_ex(payload, "new_chat_title", NULL) ||
+            json_object_object_get_ex(payload, "new_chat_photo", NULL) ||
+            json_object_object_get_ex(payload, "delete_chat_photo", NULL) ||
+            json_object_object_get_ex(payload, "pinned_message", NULL) ||
+            json_object_object_get_ex(payload, "migrate_to_chat_id", NULL))
+            telebot_cache_invalidate(cache, TELEBOT_CACHE_CHAT, chat_id, 0);
+    }
+}
+
+void telebot_cache_get_stats(telebot_cache_t *cache, telebot_cache_stats_t *stats)
+{
+    memset(stats, 0, sizeof(telebot_cache_stats_t));
+    if (cache == NULL)
+        return;
+
+    pthread_mutex_lock(&(cache->lock));
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->invalidations = cache->invalidations;
+    stats->entries = cache->count;
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+telebot_error_e telebot_set_chat_cache(telebot_handler_t handle, int ttl, int capacity)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((ttl < 0) || (capacity < 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_cache_t *cache = NULL;
+    if (ttl > 0)
+    {
+        telebot_error_e ret = telebot_cache_create(&cache, ttl, capacity ? capacity : TELEBOT_CHAT_CACHE_CAPACITY);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    /* Replaced once it is not in use */
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_cache_t *old = handle->chat_cache;
+    handle->chat_cache = cache;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_cache_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
@@ -39,6 +39,14 @@ telebot_error_e telebot_core_get_response_code(telebot_core_response_t response)
         return TELEBOT_ERROR_OUT_OF_MEMORY;
 }
 
+long telebot_core_get_response_status(telebot_core_response_t response)
+{
+    if (response)
+        return response->status;
+    else
+        return 0L;
+}
+
 const char *telebot_core_get_response_data(telebot_core_response_t response)
 {
     if (response)
@@ -47,10 +55,95 @@ const char *telebot_core_get_response_data(telebot_core_response_t response)
         return NULL;
 }
 
+static telebot_core_buffer_pool_t *telebot_core_pool_ref(telebot_core_buffer_pool_t *pool)
+{
+    pthread_mutex_lock(&(pool->lock));
+    pool->refs++;
+    pthread_mutex_unlock(&(pool->lock));
+
+    return pool;
+}
+
+/* Drop a reference, the last one frees the pool with its buffers */
+static void telebot_core_pool_unref(telebot_core_buffer_pool_t *pool)
+{
+    pthread_mutex_lock(&(pool->lock));
+    bool last = (--pool->refs == 0);
+    pthread_mutex_unlock(&(pool->lock));
+    if (!last)
+        return;
+
+    for (int index = 0; index < pool->count; index++)
+        TELEBOT_SAFE_FREE(pool->buffers[index]);
+    pthread_mutex_destroy(&(pool->lock));
+    free(pool);
+}
+
+/* Take a recycled buffer from the pool, or allocate a new one */
+static char *telebot_core_pool_get(telebot_core_buffer_pool_t *pool, size_t *capacity)
+{
+    char *buffer = NULL;
+
+    pthread_mutex_lock(&(pool->lock));
+    if (pool->count > 0)
+    {
+        /* Most recently returned buffer is likely still in cache */
+        pool->count--;
+        buffer = pool->buffers[pool->count];
+        *capacity = pool->capacities[pool->count];
+        pool->stats.buffer_pool_retained -= *capacity;
+        pool->stats.buffer_pool_hits++;
+    }
+    else
+    {
+        pool->stats.buffer_pool_misses++;
+    }
+    pthread_mutex_unlock(&(pool->lock));
+
+    if (buffer == NULL)
+    {
+        *capacity = TELEBOT_BUFFER_PAGE;
+        buffer = malloc(*capacity);
+        if (buffer == NULL)
+            *capacity = 0;
+    }
+
+    return buffer;
+}
+
+/* Return buffer to the pool, buffers above the cap or beyond pool size are freed */
+static void telebot_core_pool_put(telebot_core_buffer_pool_t *pool, char *buffer, size_t capacity)
+{
+    if (buffer == NULL)
+        return;
+
+    if (capacity <= TELEBOT_BUFFER_POOL_MAX_CAPACITY)
+    {
+        pthread_mutex_lock(&(pool->lock));
+        if (pool->count < TELEBOT_BUFFER_POOL_SIZE)
+        {
+            pool->buffers[pool->count] = buffer;
+            pool->capacities[pool->count] = capacity;
+            pool->count++;
+            pool->stats.buffer_pool_retained += capacity;
+            buffer = NULL;
+        }
+        pthread_mutex_unlock(&(pool->lock));
+    }
+
+    free(buffer);
+}
+
 void telebot_core_put_response(telebot_core_response_t response)
 {
     if (response)
     {
+        if (response->pool != NULL)
+        {
+            telebot_core_pool_put(response->pool, response->data, response->capacity);
+            response->data = NULL;
+            telebot_core_pool_unref(response->pool);
+        }
         TELEBOT_SAFE_FZCNT(response->data, response->size);
         TELEBOT_SAFE_FREE(response);
     }
@@ -84,6 +177,20 @@ telebot_core_create(telebot_core_handler_t *core_h, const char *token)
 
     _core_h->proxy_addr = NULL;
     _core_h->proxy_auth = NULL;
+    _core_h->api_url = NULL;
+    _core_h->transport = NULL;
+    pthread_mutex_init(&(_core_h->transport_lock), NULL);
+
+    _core_h->pool = calloc(1, sizeof(telebot_core_buffer_pool_t));
+    if (_core_h->pool == NULL)
+    {
+        ERR("Failed to allocate memory for buffer pool");
+        TELEBOT_SAFE_FREE(_core_h->token);
+        TELEBOT_SAFE_FREE(_core_h);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+    _core_h->pool->refs = 1;
+    pthread_mutex_init(&(_core_h->pool->lock), NULL);
 
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
@@ -120,6 +227,15 @@ telebot_core_destroy(telebot_core_handler_t *core_h)
         TELEBOT_SAFE_FREE((*core_h)->proxy_auth);
     }
 
+    TELEBOT_SAFE_FREE((*core_h)->api_url);
+
+    telebot_core_transport_put((*core_h)->transport);
+    (*core_h)->transport = NULL;
+    pthread_mutex_destroy(&((*core_h)->transport_lock));
+
+    /* Responses not released yet keep the pool */
+    telebot_core_pool_unref((*core_h)->pool);
+
     TELEBOT_SAFE_FREE(*core_h);
     return TELEBOT_ERROR_NONE;
 }
@@ -169,26 +285,308 @@ telebot_core_get_proxy(telebot_core_handler_t core_h, char **addr)
     return TELEBOT_ERROR_NONE;
 }
 
+telebot_error_e
+telebot_core_set_api_url(telebot_core_handler_t core_h, const char *url)
+{
+    if (core_h == NULL)
+    {
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+    }
+
+    char *api_url = NULL;
+    if (url != NULL)
+    {
+        api_url = strdup(url);
+        if (api_url == NULL)
+        {
+            ERR("Failed to allocate memory for API server address");
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        }
+
+        /* Strip trailing slashes, method path is appended with one */
+        size_t len = strlen(api_url);
+        while ((len > 0) && (api_url[len - 1] == '/'))
+            api_url[--len] = '\0';
+    }
+
+    TELEBOT_SAFE_FREE(core_h->api_url);
+    core_h->api_url = api_url;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e
+telebot_core_set_http_version(telebot_core_handler_t core_h, telebot_http_version_e version,
+                              int max_connections, int max_streams)
+{
+    if (core_h == NULL)
+    {
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+    }
+
+    telebot_core_transport_t *transport = NULL;
+    if (version != TELEBOT_HTTP_VERSION_DEFAULT)
+    {
+        telebot_error_e ret = telebot_core_transport_create(version, max_connections, max_streams, &transport);
+        if (ret != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to create transport, error: %d", ret);
+            return ret;
+        }
+    }
+
+    /* Requests in flight keep the old transport until they are done */
+    pthread_mutex_lock(&(core_h->transport_lock));
+    telebot_core_transport_t *old = core_h->transport;
+    core_h->transport = transport;
+    pthread_mutex_unlock(&(core_h->transport_lock));
+    telebot_core_transport_put(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static inline const char *telebot_core_get_api_url(telebot_core_handler_t core_h)
+{
+    return (core_h->api_url != NULL) ? core_h->api_url : TELEBOT_API_URL;
+}
+
+telebot_error_e
+telebot_core_get_stats(telebot_core_handler_t core_h, telebot_stats_t *stats)
+{
+    if ((core_h == NULL) || (stats == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_mutex_lock(&(core_h->pool->lock));
+    *stats = core_h->pool->stats;
+    pthread_mutex_unlock(&(core_h->pool->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
+
+/* Grow pool buffer geometrically to hold at least size bytes */
+static bool telebot_core_buffer_reserve(telebot_core_buffer_pool_t *pool, char **data, size_t *capacity, size_t size)
+{
+    if (size <= *capacity)
+        return true;
+
+    size_t _capacity = (*capacity > 0) ? *capacity : TELEBOT_BUFFER_PAGE;
+    while (_capacity < size)
+        _capacity *= 2;
+
+    char *_data = (char *)realloc(*data, _capacity);
+    if (_data == NULL)
+        return false;
+
+    *data = _data;
+    *capacity = _capacity;
+
+    pthread_mutex_lock(&(pool->lock));
+    pool->stats.buffer_pool_grows++;
+    pthread_mutex_unlock(&(pool->lock));
+
+    return true;
+}
+
+static inline bool telebot_core_response_reserve(telebot_core_response_t resp, size_t size)
+{
+    return telebot_core_buffer_reserve(resp->pool, &(resp->data), &(resp->capacity), size);
+}
+
+typedef struct telebot_core_write_context
+{
+    telebot_core_response_t resp;
+    CURL *curl_h;
+    bool sized; /* Buffer is pre-sized from Content-Length */
+} telebot_core_write_context_t;
+
 static size_t write_data_cb(void *contents, size_t size, size_t nmemb, void *userp)
 {
-    telebot_core_response_t resp = (telebot_core_response_t)userp;
+    telebot_core_write_context_t *ctx = (telebot_core_write_context_t *)userp;
+    telebot_core_response_t resp = ctx->resp;
     size_t r_size = size * nmemb;
 
-    char *data = (char *)realloc(resp->data, resp->size + r_size + 1);
-    if (data == NULL)
+    if (!ctx->sized)
+    {
+        /* Headers are complete once body arrives, reserve the whole body at once */
+        curl_off_t length = -1;
+        ctx->sized = true;
+        if ((curl_easy_getinfo(ctx->curl_h, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) == CURLE_OK) &&
+            (length > 0))
+            telebot_core_response_reserve(resp, (size_t)length + 1);
+    }
+
+    if (!telebot_core_response_reserve(resp, resp->size + r_size + 1))
     {
         ERR("Failed to allocate memory, size:%u", (unsigned int)r_size);
-        TELEBOT_SAFE_FZCNT(resp->data, resp->size);
         return 0;
     }
-    memcpy((data + resp->size), contents, r_size);
-    resp->data = data;
+    memcpy((resp->data + resp->size), contents, r_size);
     resp->size += r_size;
     resp->data[resp->size] = 0;
 
     return r_size;
 }
 
+/**
+ * Request body encoded as application/x-www-form-urlencoded into a pool
+ * buffer, used for requests without file parts.
+ */
+typedef struct telebot_core_form
+{
+    telebot_core_handler_t core_h;
+    char *data;
+    size_t size;
+    size_t capacity;
+} telebot_core_form_t;
+
+static bool telebot_core_form_append(telebot_core_form_t *form, const char *str, size_t len)
+{
+    if (!telebot_core_buffer_reserve(form->core_h->pool, &(form->data), &(form->capacity), form->size + len + 1))
+        return false;
+
+    memcpy(form->data + form->size, str, len);
+    form->size += len;
+    form->data[form->size] = '\0';
+
+    return true;
+}
+
+static bool telebot_core_form_append_escaped(telebot_core_form_t *form, const char *str)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    /* Worst case every byte is percent-encoded */
+    size_t len = strlen(str);
+    if (!telebot_core_buffer_reserve(form->core_h->pool, &(form->data), &(form->capacity), form->size + 3 * len + 1))
+        return false;
+
+    char *out = form->data + form->size;
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++)
+    {
+        if (((*p >= 'a') && (*p <= 'z')) || ((*p >= 'A') && (*p <= 'Z')) ||
+            ((*p >= '0') && (*p <= '9')) || (*p == '-') || (*p == '.') || (*p == '_') || (*p == '~'))
+        {
+            *out++ = *p;
+        }
+        else
+        {
+            *out++ = '%';
+            *out++ = hex[*p >> 4];
+            *out++ = hex[*p & 0x0F];
+        }
+    }
+    form->size = out - form->data;
+    form->data[form->size] = '\0';
+
+    return true;
+}
+
+static bool telebot_core_form_append_uint(telebot_core_form_t *form, unsigned long long value, bool negative)
+{
+    char buffer[24];
+    char *p = buffer + sizeof(buffer);
+    do
+    {
+        *--p = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (negative)
+        *--p = '-';
+
+    return telebot_core_form_append(form, p, buffer + sizeof(buffer) - p);
+}
+
+static bool telebot_core_form_append_int(telebot_core_form_t *form, long long value)
+{
+    /* Negate in unsigned arithmetic, LLONG_MIN has no positive counterpart */
+    if (value < 0)
+        return telebot_core_form_append_uint(form, -(unsigned long long)value, true);
+
+    return telebot_core_form_append_uint(form, value, false);
+}
+
+/* Same output as printf("%f"), i.e. six decimals, without going through stdio */
+static bool telebot_core_form_append_double(telebot_core_form_t *form, long double value)
+{
+    if ((value != value) || (value > 1e15L) || (value < -1e15L))
+    {
+        char buffer[TELEBOT_BUFFER_SECTOR];
+        int len = snprintf(buffer, sizeof(buffer), "%Lf", value);
+        return telebot_core_form_append(form, buffer, (len > 0) ? (size_t)len : 0);
+    }
+
+    bool negative = value < 0;
+    unsigned long long scaled = (unsigned long long)((negative ? -value : value) * 1000000.0L + 0.5L);
+    unsigned long long fraction = scaled % 1000000;
+
+    if (!telebot_core_form_append_uint(form, scaled / 1000000, negative && (scaled != 0)))
+        return false;
+
+    char buffer[7];
+    buffer[0] = '.';
+    for (int i = 6; i > 0; i--)
+    {
+        buffer[i] = '0' + (fraction % 10);
+        fraction /= 10;
+    }
+
+    return telebot_core_form_append(form, buffer, sizeof(buffer));
+}
+
+static bool telebot_core_form_append_mime(telebot_core_form_t *form, telebot_core_mime_t *mime)
+{
+    if ((form->size > 0) && !telebot_core_form_append(form, "&", 1))
+        return false;
+
+    if (!telebot_core_form_append_escaped(form, mime->name) || !telebot_core_form_append(form, "=", 1))
+        return false;
+
+    switch (mime->type)
+    {
+    case TELEBOT_MIME_TYPE_CHAR:
+    {
+        char str[2] = {mime->data.c, '\0'};
+        return telebot_core_form_append_escaped(form, str);
+    }
+    case TELEBOT_MIME_TYPE_INT:
+        return telebot_core_form_append_int(form, mime->data.d);
+    case TELEBOT_MIME_TYPE_U_INT:
+        return telebot_core_form_append_uint(form, mime->data.u, false);
+    case TELEBOT_MIME_TYPE_LONG_INT:
+        return telebot_core_form_append_int(form, mime->data.ld);
+    case TELEBOT_MIME_TYPE_U_LONG_INT:
+        return telebot_core_form_append_uint(form, mime->data.lu, false);
+    case TELEBOT_MIME_TYPE_LONG_LONG_INT:
+        return telebot_core_form_append_int(form, mime->data.lld);
+    case TELEBOT_MIME_TYPE_U_LONG_LONG_INT:
+        return telebot_core_form_append_uint(form, mime->data.llu, false);
+    case TELEBOT_MIME_TYPE_FLOAT:
+        return telebot_core_form_append_double(form, mime->data.f);
+    case TELEBOT_MIME_TYPE_DOUBLE:
+        return telebot_core_form_append_double(form, mime->data.lf);
+    case TELEBOT_MIME_TYPE_LONG_DOUBLE:
+        return telebot_core_form_append_double(form, mime->data.llf);
+    case TELEBOT_MIME_TYPE_STRING:
+        return telebot_core_form_append_escaped(form, mime->data.s ? mime->data.s : "");
+    case TELEBOT_MIME_TYPE_FILE:
+    case TELEBOT_MIME_TYPE_MAX:
+    default:
+        ERR("Invalid type: %d", mime->type);
+        return false;
+    }
+}
+
+static bool telebot_core_has_file(telebot_core_mime_t mimes[], size_t size)
+{
+    for (size_t index = 0; index < size; index++)
+    {
+        if (mimes[index].type == TELEBOT_MIME_TYPE_FILE)
+            return true;
+    }
+
+    return false;
+}
+
 static void telebot_core_copy_mime_data_to_part(telebot_core_mime_t *mime, curl_mimepart *part)
 {
     curl_mime_name(part, mime->name);
@@ -249,13 +647,19 @@ static void telebot_core_copy_mime_data_to_part(telebot_core_mime_t *mime, curl_
     }
 }
 
+/**
+ * Perform request of the method. If prefix is given, it is the url encoded
+ * body of prepared constant parameters, and mimes are appended to it.
+ */
 static telebot_core_response_t
-telebot_core_curl_perform(telebot_core_handler_t core_h, const char *method, telebot_core_mime_t mimes[], size_t size)
+telebot_core_curl_perform_prefixed(telebot_core_handler_t core_h, const char *method, const char *prefix,
+                                   telebot_core_mime_t mimes[], size_t size)
 {
     CURLcode res;
     CURL *curl_h = NULL;
     curl_mime *mime = NULL;
     long resp_code = 0L;
+    telebot_core_form_t form = {.core_h = core_h};
 
     telebot_core_response_t resp = calloc(1, sizeof(struct telebot_core_response));
     if (resp == NULL)
@@ -278,9 +682,17 @@ telebot_core_curl_perform(telebot_core_handler_t core_h, const char *method, tel
         return resp;
     }
 
-    resp->data = (char *)malloc(1);
+    resp->pool = telebot_core_pool_ref(core_h->pool);
+    resp->data = telebot_core_pool_get(resp->pool, &(resp->capacity));
     resp->size = 0;
     resp->ret = TELEBOT_ERROR_NONE;
+    if (resp->data == NULL)
+    {
+        ERR("Failed to allocate memory for response data");
+        resp->ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+        return resp;
+    }
+    resp->data[0] = '\0';
 
     curl_h = curl_easy_init();
     if (curl_h == NULL)
@@ -291,10 +703,11 @@ telebot_core_curl_perform(telebot_core_handler_t core_h, const char *method, tel
     }
 
     char URL[TELEBOT_URL_SIZE];
-    snprintf(URL, TELEBOT_URL_SIZE, "%s/bot%s/%s", TELEBOT_API_URL, core_h->token, method);
+    snprintf(URL, TELEBOT_URL_SIZE, "%s/bot%s/%s", telebot_core_get_api_url(core_h), core_h->token, method);
     curl_easy_setopt(curl_h, CURLOPT_URL, URL);
+    telebot_core_write_context_t write_ctx = {.resp = resp, .curl_h = curl_h, .sized = false};
     curl_easy_setopt(curl_h, CURLOPT_WRITEFUNCTION, write_data_cb);
-    curl_easy_setopt(curl_h, CURLOPT_WRITEDATA, resp);
+    curl_easy_setopt(curl_h, CURLOPT_WRITEDATA, &write_ctx);
 
     if (core_h->proxy_addr != NULL)
     {
@@ -306,7 +719,37 @@ telebot_core_curl_perform(telebot_core_handler_t core_h, const char *method, tel
         }
     }
 
-    if (size > 0)
+    if (((size > 0) || (prefix != NULL)) && !telebot_core_has_file(mimes, size))
+    {
+        /* Scalar parameters only, send a single url encoded body */
+        form.data = telebot_core_pool_get(core_h->pool, &(form.capacity));
+        if ((form.data != NULL) && (prefix != NULL) && !telebot_core_form_append(&form, prefix, strlen(prefix)))
+        {
+            ERR("Failed to encode request body");
+            resp->ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+            goto finish;
+        }
+
+        for (size_t index = 0; index < size; index++)
+        {
+            if ((form.data == NULL) || !telebot_core_form_append_mime(&form, &mimes[index]))
+            {
+                ERR("Failed to encode request body");
+                resp->ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+                goto finish;
+            }
+        }
+
+        curl_easy_setopt(curl_h, CURLOPT_POSTFIELDS, form.data);
+        curl_easy_setopt(curl_h, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)form.size);
+    }
+    else if (prefix != NULL)
+    {
+        ERR("Files can not be sent with prepared requests");
+        resp->ret = TELEBOT_ERROR_INVALID_PARAMETER;
+        goto finish;
+    }
+    else if (size > 0)
     {
         mime = curl_mime_init(curl_h);
         if (mime == NULL)
@@ -330,7 +773,29 @@ telebot_core_curl_perform(telebot_core_handler_t core_h, const char *method, tel
         curl_easy_setopt(curl_h, CURLOPT_MIMEPOST, mime);
     }
 
-    res = curl_easy_perform(curl_h);
+    pthread_mutex_lock(&(core_h->transport_lock));
+    telebot_core_transport_t *transport = core_h->transport;
+    if (transport != NULL)
+        telebot_core_transport_get(transport);
+    pthread_mutex_unlock(&(core_h->transport_lock));
+
+    if (transport != NULL)
+    {
+        res = telebot_core_transport_perform(transport, curl_h);
+        telebot_core_transport_put(transport);
+    }
+    else
+    {
+        res = curl_easy_perform(curl_h);
+    }
+
+    long connects = 0L;
+    curl_easy_getinfo(curl_h, CURLINFO_NUM_CONNECTS, &connects);
+    pthread_mutex_lock(&(core_h->pool->lock));
+    core_h->pool->stats.http_requests++;
+    core_h->pool->stats.http_connections += connects;
+    pthread_mutex_unlock(&(core_h->pool->lock));
+
     if (res != CURLE_OK)
     {
         ERR("Failed to curl_easy_perform\nError: %s (%d)", curl_easy_strerror(res), res);
@@ -339,6 +804,7 @@ telebot_core_curl_perform(telebot_core_handler_t core_h, const char *method, tel
     }
 
     curl_easy_getinfo(curl_h, CURLINFO_RESPONSE_CODE, &resp_code);
+    resp->status = resp_code;
     if (resp_code != 200L)
     {
         ERR("Wrong HTTP response received, response: %ld", resp_code);
@@ -350,15 +816,81 @@ telebot_core_curl_perform(telebot_core_handler_t core_h, const char *method, tel
 
 finish:
     if (resp->ret != TELEBOT_ERROR_NONE)
-        TELEBOT_SAFE_FZCNT(resp->data, resp->size);
+    {
+        telebot_core_pool_put(resp->pool, resp->data, resp->capacity);
+        resp->data = NULL;
+        resp->size = 0;
+        resp->capacity = 0;
+    }
     if (mime)
         curl_mime_free(mime);
     if (curl_h)
         curl_easy_cleanup(curl_h);
+    telebot_core_pool_put(core_h->pool, form.data, form.capacity);
 
     return resp;
 }
 
+static telebot_core_response_t
+telebot_core_curl_perform(telebot_core_handler_t core_h, const char *method, telebot_core_mime_t mimes[], size_t size)
+{
+    return telebot_core_curl_perform_prefixed(core_h, method, NULL, mimes, size);
+}
+
+/* Encode constant parameters of the method once, for repeated requests */
+static telebot_error_e
+telebot_core_prepare(telebot_core_handler_t core_h, const char *method, telebot_core_mime_t mimes[], size_t size,
+                     telebot_prepared_request_t *prepared)
+{
+    if ((core_h == NULL) || (prepared == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *prepared = NULL;
+    if (telebot_core_has_file(mimes, size))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_prepared_request_t _prepared = calloc(1, sizeof(struct telebot_prepared_request));
+    if (_prepared == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    telebot_core_form_t form = {.core_h = core_h};
+    form.data = telebot_core_pool_get(core_h->pool, &(form.capacity));
+    bool encoded = (form.data != NULL);
+    if (encoded)
+    {
+        form.data[0] = '\0';
+        for (size_t index = 0; encoded && (index < size); index++)
+            encoded = telebot_core_form_append_mime(&form, &mimes[index]);
+    }
+
+    /* A truncated prefix would silently drop parameters of every request */
+    if (encoded && (form.data != NULL))
+        _prepared->prefix = strdup(form.data);
+    telebot_core_pool_put(core_h->pool, form.data, form.capacity);
+
+    if (_prepared->prefix == NULL)
+    {
+        ERR("Failed to encode prepared request");
+        TELEBOT_SAFE_FREE(_prepared);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    _prepared->method = method;
+    _prepared->prefix_size = strlen(_prepared->prefix);
+    *prepared = _prepared;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_core_put_prepared_request(telebot_prepared_request_t prepared)
+{
+    if (prepared == NULL)
+        return;
+
+    TELEBOT_SAFE_FREE(prepared->prefix);
+    TELEBOT_SAFE_FREE(prepared);
+}
+
 telebot_core_response_t
 telebot_core_get_updates(telebot_core_handler_t core_h, int offset, int limit, int timeout, const char *allowed_updates)
 {
@@ -512,6 +1044,74 @@ telebot_core_send_message(telebot_core_handler_t core_h, long long int chat_id,
     return telebot_core_curl_perform(core_h, TELEBOT_METHOD_SEND_MESSAGE, mimes, count);
 }
 
+telebot_error_e
+telebot_core_prepare_send_message(telebot_core_handler_t core_h, const char *parse_mode, bool disable_web_page_preview,
+                                  bool disable_notification, const char *reply_markup,
+                                  telebot_prepared_request_t *prepared)
+{
+    int count = 0;
+    telebot_core_mime_t mimes[4]; // number of arguments
+    if (parse_mode != NULL)
+    {
+        mimes[count].name = "parse_mode";
+        mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+        mimes[count].data.s = parse_mode;
+        count++;
+    }
+
+    mimes[count].name = "disable_notification";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = disable_notification ? "true" : "false";
+    count++;
+
+    mimes[count].name = "disable_web_page_preview";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = disable_web_page_preview ? "true" : "false";
+    count++;
+
+    if (reply_markup != NULL)
+    {
+        mimes[count].name = "reply_markup";
+        mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+        mimes[count].data.s = reply_markup;
+        count++;
+    }
+
+    return telebot_core_prepare(core_h, TELEBOT_METHOD_SEND_MESSAGE, mimes, count, prepared);
+}
+
+telebot_core_response_t
+telebot_core_send_prepared_message(telebot_core_handler_t core_h, telebot_prepared_request_t prepared,
+                                   long long int chat_id, const char *text, int reply_to_message_id)
+{
+    CHECK_ARG_NULL(prepared);
+    CHECK_ARG_NULL(text);
+    CHECK_ARG_CONDITION(strcmp(prepared->method, TELEBOT_METHOD_SEND_MESSAGE) != 0,
+                        "Prepared request is not for sendMessage");
+
+    int count = 0;
+    telebot_core_mime_t mimes[3]; // number of arguments
+    mimes[count].name = "chat_id";
+    mimes[count].type = TELEBOT_MIME_TYPE_LONG_LONG_INT;
+    mimes[count].data.lld = chat_id;
+    count++;
+
+    mimes[count].name = "text";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = text;
+    count++;
+
+    if (reply_to_message_id > 0)
+    {
+        mimes[count].name = "reply_to_message_id";
+        mimes[count].type = TELEBOT_MIME_TYPE_INT;
+        mimes[count].data.d = reply_to_message_id;
+        count++;
+    }
+
+    return telebot_core_curl_perform_prefixed(core_h, prepared->method, prepared->prefix, mimes, count);
+}
+
 telebot_core_response_t
 telebot_core_forward_message(telebot_core_handler_t core_h, long long int chat_id, long long int from_chat_id,
                              bool disable_notification, int message_id)
@@ -1828,7 +2428,7 @@ telebot_core_download_file(telebot_core_handler_t core_h, const char *file_path,
     }
 
     char URL[TELEBOT_URL_SIZE];
-    snprintf(URL, TELEBOT_URL_SIZE, "%s/file/bot%s/%s", TELEBOT_API_URL,
+    snprintf(URL, TELEBOT_URL_SIZE, "%s/file/bot%s/%s", telebot_core_get_api_url(core_h),
              core_h->token, file_path);
 
     curl_easy_setopt(curl_h, CURLOPT_URL, URL);
@@ -3379,6 +3979,104 @@ telebot_core_get_custom_emoji_stickers(telebot_core_handler_t core_h, const char
     return telebot_core_curl_perform(core_h, TELEBOT_METHOD_GET_CUSTOM_EMOJI_STICKERS, mimes, count);
 }
 
+telebot_core_response_t
+telebot_core_get_sticker_set(telebot_core_handler_t core_h, const char *name)
+{
+    CHECK_ARG_NULL(name);
+
+    int count = 0;
+    telebot_core_mime_t mimes[1];
+    mimes[count].name = "name";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = name;
+    count++;
+    return telebot_core_curl_perform(core_h, TELEBOT_METHOD_GET_STICKER_SET, mimes, count);
+}
+
+telebot_core_response_t
+telebot_core_upload_sticker_file(telebot_core_handler_t core_h, long long int user_id, const char *sticker,
+                                 const char *sticker_format)
+{
+    CHECK_ARG_NULL(sticker);
+    CHECK_ARG_NULL(sticker_format);
+
+    int count = 0;
+    telebot_core_mime_t mimes[3];
+    mimes[count].name = "user_id";
+    mimes[count].type = TELEBOT_MIME_TYPE_LONG_LONG_INT;
+    mimes[count].data.lld = user_id;
+    count++;
+    mimes[count].name = "sticker";
+    mimes[count].type = TELEBOT_MIME_TYPE_FILE;
+    mimes[count].data.s = sticker;
+    count++;
+    mimes[count].name = "sticker_format";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = sticker_format;
+    count++;
+    return telebot_core_curl_perform(core_h, TELEBOT_METHOD_UPLOAD_STICKER_FILE, mimes, count);
+}
+
+telebot_core_response_t
+telebot_core_create_new_sticker_set(telebot_core_handler_t core_h, long long int user_id, const char *name,
+                                    const char *title, const char *stickers, const char *sticker_type)
+{
+    CHECK_ARG_NULL(name);
+    CHECK_ARG_NULL(title);
+    CHECK_ARG_NULL(stickers);
+
+    int count = 0;
+    telebot_core_mime_t mimes[5];
+    mimes[count].name = "user_id";
+    mimes[count].type = TELEBOT_MIME_TYPE_LONG_LONG_INT;
+    mimes[count].data.lld = user_id;
+    count++;
+    mimes[count].name = "name";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = name;
+    count++;
+    mimes[count].name = "title";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = title;
+    count++;
+    mimes[count].name = "stickers";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = stickers;
+    count++;
+    if (sticker_type)
+    {
+        mimes[count].name = "sticker_type";
+        mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+        mimes[count].data.s = sticker_type;
+        count++;
+    }
+    return telebot_core_curl_perform(core_h, TELEBOT_METHOD_CREATE_NEW_STICKER_SET, mimes, count);
+}
+
+telebot_core_response_t
+telebot_core_add_sticker_to_set(telebot_core_handler_t core_h, long long int user_id, const char *name,
+                                const char *sticker)
+{
+    CHECK_ARG_NULL(name);
+    CHECK_ARG_NULL(sticker);
+
+    int count = 0;
+    telebot_core_mime_t mimes[3];
+    mimes[count].name = "user_id";
+    mimes[count].type = TELEBOT_MIME_TYPE_LONG_LONG_INT;
+    mimes[count].data.lld = user_id;
+    count++;
+    mimes[count].name = "name";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = name;
+    count++;
+    mimes[count].name = "sticker";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = sticker;
+    count++;
+    return telebot_core_curl_perform(core_h, TELEBOT_METHOD_ADD_STICKER_TO_SET, mimes, count);
+}
+
 telebot_core_response_t
 telebot_core_answer_web_app_query(telebot_core_handler_t core_h, const char *web_app_query_id, const char *result)
 {
@@ -3638,6 +4336,69 @@ telebot_core_answer_inline_query(telebot_core_handler_t core_h, const char *inli
     return telebot_core_curl_perform(core_h, TELEBOT_METHOD_ANSWER_INLINE_QUERY, mimes, count);
 }
 
+telebot_error_e
+telebot_core_prepare_answer_inline_query(telebot_core_handler_t core_h, const char *results, int cache_time,
+                                         bool is_personal, const char *next_offset, const char *button,
+                                         telebot_prepared_request_t *prepared)
+{
+    if (results == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    int count = 0;
+    telebot_core_mime_t mimes[5]; // number of arguments
+    mimes[count].name = "results";
+    mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[count].data.s = results;
+    count++;
+    if (cache_time > 0)
+    {
+        mimes[count].name = "cache_time";
+        mimes[count].type = TELEBOT_MIME_TYPE_INT;
+        mimes[count].data.d = cache_time;
+        count++;
+    }
+    if (is_personal)
+    {
+        mimes[count].name = "is_personal";
+        mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+        mimes[count].data.s = "true";
+        count++;
+    }
+    if (next_offset)
+    {
+        mimes[count].name = "next_offset";
+        mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+        mimes[count].data.s = next_offset;
+        count++;
+    }
+    if (button)
+    {
+        mimes[count].name = "button";
+        mimes[count].type = TELEBOT_MIME_TYPE_STRING;
+        mimes[count].data.s = button;
+        count++;
+    }
+
+    return telebot_core_prepare(core_h, TELEBOT_METHOD_ANSWER_INLINE_QUERY, mimes, count, prepared);
+}
+
+telebot_core_response_t
+telebot_core_answer_prepared_inline_query(telebot_core_handler_t core_h, telebot_prepared_request_t prepared,
+                                          const char *inline_query_id)
+{
+    CHECK_ARG_NULL(prepared);
+    CHECK_ARG_NULL(inline_query_id);
+    CHECK_ARG_CONDITION(strcmp(prepared->method, TELEBOT_METHOD_ANSWER_INLINE_QUERY) != 0,
+                        "Prepared request is not for answerInlineQuery");
+
+    telebot_core_mime_t mimes[1]; // number of arguments
+    mimes[0].name = "inline_query_id";
+    mimes[0].type = TELEBOT_MIME_TYPE_STRING;
+    mimes[0].data.s = inline_query_id;
+
+    return telebot_core_curl_perform_prefixed(core_h, prepared->method, prepared->prefix, mimes, 1);
+}
+
 telebot_core_response_t
 telebot_core_save_prepared_inline_message(telebot_core_handler_t core_h, long long int user_id, const char *result,
                                           bool allow_user_chats, bool allow_bot_chats, bool allow_group_chats,
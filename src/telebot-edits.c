@@ -0,0 +1,581 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <telebot-methods.h>
+#include <telebot-private.h>
+
+#define TELEBOT_EDITS_BUCKETS 1024
+/* Messages not edited for this long are forgotten, milliseconds */
+#define TELEBOT_EDITS_IDLE_TIME (10 * 60 * 1000)
+#define TELEBOT_EDITS_SWEEP_INTERVAL (60 * 1000)
+
+typedef enum telebot_edit_kind
+{
+    TELEBOT_EDIT_NONE = 0,
+    TELEBOT_EDIT_TEXT,
+    TELEBOT_EDIT_CAPTION,
+    TELEBOT_EDIT_MARKUP,
+} telebot_edit_kind_e;
+
+/* Edit of a message with hashes of the state it leaves the message in */
+typedef struct telebot_edit
+{
+    telebot_edit_kind_e kind;
+    char *text; /* Text or caption */
+    char *parse_mode;
+    bool disable_web_page_preview;
+    char *reply_markup;
+    uint64_t content_hash; /* Of kind, text, parse_mode and preview */
+    uint64_t markup_hash;
+} telebot_edit_t;
+
+typedef struct telebot_edits_entry
+{
+    struct telebot_edits_entry *next;         /* Next entry in the bucket */
+    struct telebot_edits_entry *pending_next; /* Next entry with a pending edit */
+    long long int chat_id;
+    int message_id;
+    char *inline_message_id;
+    telebot_edit_t pending; /* Latest edit not sent yet, kind is NONE if none */
+    telebot_edit_t sending; /* Edit being sent, owned by the sending thread */
+    bool in_flight;         /* Sending holds an edit */
+    int64_t due;            /* Monotonic time in milliseconds */
+    int64_t last_sent;
+    int64_t last_used;
+    /* State of the message after the last successful edit */
+    bool content_known;
+    bool markup_known;
+    uint64_t applied_content;
+    uint64_t applied_markup;
+} telebot_edits_entry_t;
+
+struct telebot_edits
+{
+    telebot_handler_t handle;
+    telebot_scheduler_t *scheduler;
+    int slot;
+    pthread_mutex_t lock;
+    pthread_cond_t sent; /* Signalled when edits in flight complete */
+    int64_t interval;    /* Milliseconds between edits of a message */
+    int64_t next_sweep;
+    int count;
+    int in_flight;
+    telebot_edits_entry_t *pending; /* Entries with a pending edit */
+    telebot_edits_entry_t *buckets[TELEBOT_EDITS_BUCKETS];
+    unsigned long long edits_sent;
+    unsigned long long edits_coalesced;
+    unsigned long long edits_skipped;
+};
+
+/* FNV-1a, strings are hashed with their terminator so NULL and "" differ */
+static uint64_t telebot_edits_hash(uint64_t hash, const char *str)
+{
+    if (str == NULL)
+        return telebot_hash_bytes(hash, "\xFF", 1);
+
+    return telebot_hash_bytes(hash, str, strlen(str) + 1);
+}
+
+static telebot_edits_entry_t **telebot_edits_find(telebot_edits_t *edits, long long int chat_id,
+                                                  int message_id, const char *inline_message_id)
+{
+    uint64_t hash = ((uint64_t)chat_id * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t)message_id * 0xC2B2AE3D27D4EB4FULL);
+    if (inline_message_id != NULL)
+        hash = telebot_edits_hash(hash, inline_message_id);
+    hash ^= hash >> 29;
+
+    telebot_edits_entry_t **link = &(edits->buckets[hash & (TELEBOT_EDITS_BUCKETS - 1)]);
+    while (*link != NULL)
+    {
+        telebot_edits_entry_t *entry = *link;
+        if ((entry->chat_id == chat_id) && (entry->message_id == message_id) &&
+            ((inline_message_id == NULL) ? (entry->inline_message_id == NULL) :
+             ((entry->inline_message_id != NULL) && !strcmp(entry->inline_message_id, inline_message_id))))
+            break;
+        link = &(entry->next);
+    }
+
+    return link;
+}
+
+static void telebot_edit_clear(telebot_edit_t *edit)
+{
+    TELEBOT_SAFE_FREE(edit->text);
+    TELEBOT_SAFE_FREE(edit->parse_mode);
+    TELEBOT_SAFE_FREE(edit->reply_markup);
+    edit->kind = TELEBOT_EDIT_NONE;
+}
+
+static void telebot_edits_entry_free(telebot_edits_entry_t *entry)
+{
+    telebot_edit_clear(&(entry->pending));
+    TELEBOT_SAFE_FREE(entry->inline_message_id);
+    free(entry);
+}
+
+static telebot_error_e telebot_edit_send(telebot_handler_t handle, telebot_edits_entry_t *entry, telebot_edit_t *edit)
+{
+    switch (edit->kind)
+    {
+    case TELEBOT_EDIT_TEXT:
+        return telebot_edit_message_text(handle, entry->chat_id, entry->message_id, entry->inline_message_id,
+                                         edit->text, edit->parse_mode, edit->disable_web_page_preview,
+                                         edit->reply_markup);
+    case TELEBOT_EDIT_CAPTION:
+        return telebot_edit_message_caption(handle, entry->chat_id, entry->message_id, entry->inline_message_id,
+                                            edit->text, edit->parse_mode, edit->reply_markup);
+    default:
+        return telebot_edit_message_reply_markup(handle, entry->chat_id, entry->message_id,
+                                                 entry->inline_message_id, edit->reply_markup);
+    }
+}
+
+/*
+ * Send pending edits due at now, or all of them if forced. Returns when the
+ * next pending edit is due, or -1 if there is none.
+ */
+static int64_t telebot_edits_send(telebot_edits_t *edits, int64_t now, bool force)
+{
+    telebot_edits_entry_t *batch = NULL;
+    int64_t next = -1;
+
+    pthread_mutex_lock(&(edits->lock));
+    telebot_edits_entry_t **link = &(edits->pending);
+    while (*link != NULL)
+    {
+        telebot_edits_entry_t *entry = *link;
+        if (entry->in_flight || (!force && (entry->due > now)))
+        {
+            if ((next < 0) || (entry->due < next))
+                next = entry->due;
+            link = &(entry->pending_next);
+            continue;
+        }
+
+        *link = entry->pending_next;
+        telebot_edit_t *edit = &(entry->pending);
+        if ((edit->kind != TELEBOT_EDIT_MARKUP) && entry->content_known &&
+            (entry->applied_content == edit->content_hash))
+        {
+            /* Text is unchanged, at most the markup needs to be edited */
+            TELEBOT_SAFE_FREE(edit->text);
+            TELEBOT_SAFE_FREE(edit->parse_mode);
+            edit->kind = TELEBOT_EDIT_MARKUP;
+        }
+        if ((edit->kind == TELEBOT_EDIT_MARKUP) && entry->markup_known &&
+            (entry->applied_markup == edit->markup_hash))
+        {
+            telebot_edit_clear(edit);
+            edits->edits_skipped++;
+            continue;
+        }
+
+        entry->sending = *edit;
+        edit->kind = TELEBOT_EDIT_NONE;
+        edit->text = edit->parse_mode = edit->reply_markup = NULL;
+        entry->in_flight = true;
+        entry->pending_next = batch;
+        batch = entry;
+        edits->in_flight++;
+    }
+    pthread_mutex_unlock(&(edits->lock));
+
+    /* Entries in flight are neither evicted nor sent by other threads */
+    while (batch != NULL)
+    {
+        telebot_edits_entry_t *entry = batch;
+        batch = entry->pending_next;
+
+        telebot_edit_t *edit = &(entry->sending);
+        telebot_error_e ret = telebot_edit_send(edits->handle, entry, edit);
+        int64_t sent = telebot_scheduler_now();
+
+        pthread_mutex_lock(&(edits->lock));
+        edits->edits_sent++;
+        entry->last_sent = sent;
+        if (ret == TELEBOT_ERROR_NONE)
+        {
+            if (edit->kind != TELEBOT_EDIT_MARKUP)
+            {
+                entry->applied_content = edit->content_hash;
+                entry->content_known = true;
+            }
+            entry->applied_markup = edit->markup_hash;
+            entry->markup_known = true;
+        }
+        else
+        {
+            ERR("Failed to edit message %d of chat %lld", entry->message_id, entry->chat_id);
+            entry->content_known = entry->markup_known = false;
+        }
+        telebot_edit_clear(edit);
+        entry->in_flight = false;
+        edits->in_flight--;
+        if (entry->pending.kind != TELEBOT_EDIT_NONE)
+        {
+            /* Queued while in flight, it waits for the interval from now on */
+            if (entry->due < sent + edits->interval)
+                entry->due = sent + edits->interval;
+            entry->pending_next = edits->pending;
+            edits->pending = entry;
+            if ((next < 0) || (entry->due < next))
+                next = entry->due;
+        }
+        pthread_cond_broadcast(&(edits->sent));
+        pthread_mutex_unlock(&(edits->lock));
+    }
+
+    return next;
+}
+
+static void telebot_edits_sweep(telebot_edits_t *edits, int64_t now)
+{
+    pthread_mutex_lock(&(edits->lock));
+    for (int i = 0; i < TELEBOT_EDITS_BUCKETS; i++)
+    {
+        telebot_edits_entry_t **link = &(edits->buckets[i]);
+        while (*link != NULL)
+        {
+            telebot_edits_entry_t *entry = *link;
+            if (entry->in_flight || (entry->pending.kind != TELEBOT_EDIT_NONE) ||
+                (entry->last_used + TELEBOT_EDITS_IDLE_TIME > now))
+            {
+                link = &(entry->next);
+                continue;
+            }
+            *link = entry->next;
+            telebot_edits_entry_free(entry);
+            edits->count--;
+        }
+    }
+    edits->next_sweep = now + TELEBOT_EDITS_SWEEP_INTERVAL;
+    pthread_mutex_unlock(&(edits->lock));
+}
+
+static int64_t telebot_edits_task(void *data, int64_t now)
+{
+    telebot_edits_t *edits = data;
+
+    if (now >= edits->next_sweep)
+        telebot_edits_sweep(edits, now);
+
+    int64_t next = telebot_edits_send(edits, now, false);
+
+    pthread_mutex_lock(&(edits->lock));
+    if ((edits->count > 0) && ((next < 0) || (edits->next_sweep < next)))
+        next = edits->next_sweep;
+    pthread_mutex_unlock(&(edits->lock));
+
+    return next;
+}
+
+static telebot_error_e telebot_edits_create(telebot_handler_t handle, int interval, telebot_edits_t **edits)
+{
+    telebot_scheduler_t *scheduler = NULL;
+    telebot_error_e ret = telebot_scheduler_get(handle, &scheduler);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    telebot_edits_t *_edits = calloc(1, sizeof(telebot_edits_t));
+    if (_edits == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    _edits->handle = handle;
+    _edits->scheduler = scheduler;
+    _edits->interval = interval;
+    _edits->next_sweep = telebot_scheduler_now() + TELEBOT_EDITS_SWEEP_INTERVAL;
+    pthread_mutex_init(&(_edits->lock), NULL);
+    pthread_cond_init(&(_edits->sent), NULL);
+
+    _edits->slot = telebot_scheduler_add(scheduler, telebot_edits_task, _edits);
+    if (_edits->slot < 0)
+    {
+        pthread_cond_destroy(&(_edits->sent));
+        pthread_mutex_destroy(&(_edits->lock));
+        free(_edits);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    *edits = _edits;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_edits_destroy(telebot_edits_t *edits)
+{
+    if (edits == NULL)
+        return;
+
+    telebot_scheduler_remove(edits->scheduler, edits->slot);
+    telebot_edits_send(edits, telebot_scheduler_now(), true);
+
+    for (int i = 0; i < TELEBOT_EDITS_BUCKETS; i++)
+    {
+        while (edits->buckets[i] != NULL)
+        {
+            telebot_edits_entry_t *entry = edits->buckets[i];
+            edits->buckets[i] = entry->next;
+            telebot_edits_entry_free(entry);
+        }
+    }
+
+    pthread_cond_destroy(&(edits->sent));
+    pthread_mutex_destroy(&(edits->lock));
+    free(edits);
+}
+
+void telebot_edits_get_stats(telebot_edits_t *edits, telebot_stats_t *stats)
+{
+    if (edits == NULL)
+        return;
+
+    pthread_mutex_lock(&(edits->lock));
+    stats->edits_sent = edits->edits_sent;
+    stats->edits_coalesced = edits->edits_coalesced;
+    stats->edits_skipped = edits->edits_skipped;
+    pthread_mutex_unlock(&(edits->lock));
+}
+
+/* Takes ownership of the strings of edit */
+static telebot_error_e telebot_edits_queue(telebot_edits_t *edits, long long int chat_id, int message_id,
+                                           const char *inline_message_id, telebot_edit_t *edit)
+{
+    int64_t now = telebot_scheduler_now();
+    int64_t due = -1;
+
+    pthread_mutex_lock(&(edits->lock));
+    telebot_edits_entry_t **link = telebot_edits_find(edits, chat_id, message_id, inline_message_id);
+    telebot_edits_entry_t *entry = *link;
+    if (entry == NULL)
+    {
+        entry = calloc(1, sizeof(telebot_edits_entry_t));
+        if (entry == NULL)
+        {
+            pthread_mutex_unlock(&(edits->lock));
+            telebot_edit_clear(edit);
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        }
+        entry->chat_id = chat_id;
+        entry->message_id = message_id;
+        entry->inline_message_id = TELEBOT_SAFE_STRDUP(inline_message_id);
+        entry->last_sent = now - edits->interval;
+        *link = entry;
+        edits->count++;
+    }
+    entry->last_used = now;
+
+    telebot_edit_t *pending = &(entry->pending);
+    if (pending->kind == TELEBOT_EDIT_NONE)
+    {
+        *pending = *edit;
+        entry->due = (entry->last_sent + edits->interval > now) ? entry->last_sent + edits->interval : now;
+        if (!entry->in_flight)
+        {
+            entry->pending_next = edits->pending;
+            edits->pending = entry;
+            due = entry->due;
+        }
+    }
+    else if ((edit->kind == TELEBOT_EDIT_MARKUP) && (pending->kind != TELEBOT_EDIT_MARKUP))
+    {
+        /* Keep the pending text, replacing its markup */
+        TELEBOT_SAFE_FREE(pending->reply_markup);
+        pending->reply_markup = edit->reply_markup;
+        pending->markup_hash = edit->markup_hash;
+        edits->edits_coalesced++;
+    }
+    else
+    {
+        telebot_edit_clear(pending);
+        *pending = *edit;
+        edits->edits_coalesced++;
+    }
+    pthread_mutex_unlock(&(edits->lock));
+
+    if (due >= 0)
+        telebot_scheduler_wake(edits->scheduler, edits->slot, due);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_edits_prepare(telebot_edit_t *edit, telebot_edit_kind_e kind, const char *text,
+                                             const char *parse_mode, bool disable_web_page_preview,
+                                             const char *reply_markup)
+{
+    edit->kind = kind;
+    edit->text = TELEBOT_SAFE_STRDUP(text);
+    edit->parse_mode = TELEBOT_SAFE_STRDUP(parse_mode);
+    edit->disable_web_page_preview = disable_web_page_preview;
+    edit->reply_markup = TELEBOT_SAFE_STRDUP(reply_markup);
+    if (((text != NULL) && (edit->text == NULL)) || ((parse_mode != NULL) && (edit->parse_mode == NULL)) ||
+        ((reply_markup != NULL) && (edit->reply_markup == NULL)))
+    {
+        telebot_edit_clear(edit);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    uint64_t hash = TELEBOT_HASH_SEED ^ (kind * 2 + disable_web_page_preview);
+    hash = telebot_edits_hash(hash, text);
+    edit->content_hash = telebot_edits_hash(hash, parse_mode);
+    edit->markup_hash = telebot_edits_hash(TELEBOT_HASH_SEED, reply_markup);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_set_edit_coalescing(telebot_handler_t handle, int interval)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (interval < 0)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_edits_t *edits = NULL;
+    if (interval > 0)
+    {
+        telebot_error_e ret = telebot_edits_create(handle, interval, &edits);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    /* Replaced once it is not in use, destroyed after as its threads may call back */
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_edits_t *old = handle->edits;
+    handle->edits = edits;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_edits_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_queue_edit_message_text(telebot_handler_t handle, long long int chat_id, int message_id,
+                                                const char *inline_message_id, const char *text,
+                                                const char *parse_mode, bool disable_web_page_preview,
+                                                const char *reply_markup)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((text == NULL) || (((chat_id == 0) || (message_id <= 0)) && (inline_message_id == NULL)))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (handle->edits == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return telebot_edit_message_text(handle, chat_id, message_id, inline_message_id, text, parse_mode,
+                                             disable_web_page_preview, reply_markup);
+    }
+
+    telebot_edit_t edit;
+    telebot_error_e ret = telebot_edits_prepare(&edit, TELEBOT_EDIT_TEXT, text, parse_mode,
+                                                disable_web_page_preview, reply_markup);
+    if (ret == TELEBOT_ERROR_NONE)
+        ret = telebot_edits_queue(handle->edits, chat_id, message_id, inline_message_id, &edit);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
+
+telebot_error_e telebot_queue_edit_message_caption(telebot_handler_t handle, long long int chat_id, int message_id,
+                                                   const char *inline_message_id, const char *caption,
+                                                   const char *parse_mode, const char *reply_markup)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (((chat_id == 0) || (message_id <= 0)) && (inline_message_id == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (handle->edits == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return telebot_edit_message_caption(handle, chat_id, message_id, inline_message_id, caption, parse_mode,
+                                                reply_markup);
+    }
+
+    telebot_edit_t edit;
+    telebot_error_e ret = telebot_edits_prepare(&edit, TELEBOT_EDIT_CAPTION, caption, parse_mode, false,
+                                                reply_markup);
+    if (ret == TELEBOT_ERROR_NONE)
+        ret = telebot_edits_queue(handle->edits, chat_id, message_id, inline_message_id, &edit);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
+
+telebot_error_e telebot_queue_edit_message_reply_markup(telebot_handler_t handle, long long int chat_id,
+                                                        int message_id, const char *inline_message_id,
+                                                        const char *reply_markup)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (((chat_id == 0) || (message_id <= 0)) && (inline_message_id == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (handle->edits == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return telebot_edit_message_reply_markup(handle, chat_id, message_id, inline_message_id, reply_markup);
+    }
+
+    telebot_edit_t edit;
+    telebot_error_e ret = telebot_edits_prepare(&edit, TELEBOT_EDIT_MARKUP, NULL, NULL, false, reply_markup);
+    if (ret == TELEBOT_ERROR_NONE)
+        ret = telebot_edits_queue(handle->edits, chat_id, message_id, inline_message_id, &edit);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
+
+telebot_error_e telebot_flush_edits(telebot_handler_t handle)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_edits_t *edits = handle->edits;
+    if (edits == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return TELEBOT_ERROR_NONE;
+    }
+
+    telebot_edits_send(edits, telebot_scheduler_now(), true);
+
+    /* Wait for edits sent by the scheduler, and send what was queued meanwhile */
+    pthread_mutex_lock(&(edits->lock));
+    while ((edits->in_flight > 0) || (edits->pending != NULL))
+    {
+        if (edits->in_flight > 0)
+        {
+            pthread_cond_wait(&(edits->sent), &(edits->lock));
+            continue;
+        }
+        pthread_mutex_unlock(&(edits->lock));
+        telebot_edits_send(edits, telebot_scheduler_now(), true);
+        pthread_mutex_lock(&(edits->lock));
+    }
+    pthread_mutex_unlock(&(edits->lock));
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
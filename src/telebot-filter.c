@@ -0,0 +1,336 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <json.h>
+#include <telebot-filter.h>
+#include <telebot-parser.h>
+#include <telebot-private.h>
+
+typedef struct telebot_filter_string
+{
+    char *str;
+    size_t len;
+} telebot_filter_string_t;
+
+struct telebot_filter
+{
+    uint32_t update_types; /* Bit mask of update types, 0 for any */
+    int64_t *chat_ids;     /* Sorted for binary search */
+    int chat_ids_count;
+    telebot_filter_string_t *commands; /* Normalized to start with '/' */
+    int commands_count;
+    telebot_filter_string_t *entity_types;
+    int entity_types_count;
+    telebot_filter_string_t *callback_data_prefixes;
+    int callback_data_prefixes_count;
+};
+
+static int telebot_filter_compare_id(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static telebot_error_e telebot_filter_copy_strings(telebot_filter_string_t **strings, int *strings_count,
+                                                   const char **src, int count, const char *prefix)
+{
+    if (count <= 0)
+        return TELEBOT_ERROR_NONE;
+
+    if (src == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *strings = calloc(count, sizeof(telebot_filter_string_t));
+    if (*strings == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    *strings_count = count;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (src[i] == NULL)
+            return TELEBOT_ERROR_INVALID_PARAMETER;
+
+        const char *p = (prefix && (src[i][0] != prefix[0])) ? prefix : "";
+        size_t len = strlen(p) + strlen(src[i]);
+        (*strings)[i].str = malloc(len + 1);
+        if ((*strings)[i].str == NULL)
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        snprintf((*strings)[i].str, len + 1, "%s%s", p, src[i]);
+        (*strings)[i].len = len;
+    }
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static void telebot_filter_put_strings(telebot_filter_string_t *strings, int count)
+{
+    if (strings == NULL)
+        return;
+
+    for (int i = 0; i < count; i++)
+        TELEBOT_SAFE_FREE(strings[i].str);
+    free(strings);
+}
+
+telebot_error_e telebot_filter_compile(const telebot_update_filter_t *spec, telebot_filter_t **filter)
+{
+    if ((spec == NULL) || (filter == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_filter_t *f = calloc(1, sizeof(telebot_filter_t));
+    if (f == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    telebot_error_e ret = TELEBOT_ERROR_INVALID_PARAMETER;
+    if ((spec->update_types_count > 0) && (spec->update_types == NULL))
+        goto error;
+
+    for (int i = 0; i < spec->update_types_count; i++)
+    {
+        telebot_update_type_e type = spec->update_types[i];
+        if ((type < 0) || (type >= TELEBOT_UPDATE_TYPE_MAX))
+            goto error;
+        f->update_types |= (1u << type);
+    }
+
+    if (spec->chat_ids_count > 0)
+    {
+        if (spec->chat_ids == NULL)
+            goto error;
+
+        f->chat_ids = malloc(spec->chat_ids_count * sizeof(int64_t));
+        if (f->chat_ids == NULL)
+        {
+            ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+            goto error;
+        }
+        for (int i = 0; i < spec->chat_ids_count; i++)
+            f->chat_ids[i] = spec->chat_ids[i];
+        f->chat_ids_count = spec->chat_ids_count;
+        qsort(f->chat_ids, f->chat_ids_count, sizeof(int64_t), telebot_filter_compare_id);
+    }
+
+    ret = telebot_filter_copy_strings(&(f->commands), &(f->commands_count),
+                                      spec->commands, spec->commands_count, "/");
+    if (ret != TELEBOT_ERROR_NONE)
+        goto error;
+
+    ret = telebot_filter_copy_strings(&(f->entity_types), &(f->entity_types_count),
+                                      spec->entity_types, spec->entity_types_count, NULL);
+    if (ret != TELEBOT_ERROR_NONE)
+        goto error;
+
+    ret = telebot_filter_copy_strings(&(f->callback_data_prefixes), &(f->callback_data_prefixes_count),
+                                      spec->callback_data_prefixes, spec->callback_data_prefixes_count, NULL);
+    if (ret != TELEBOT_ERROR_NONE)
+        goto error;
+
+    *filter = f;
+    return TELEBOT_ERROR_NONE;
+
+error:
+    telebot_filter_destroy(f);
+    return ret;
+}
+
+void telebot_filter_destroy(telebot_filter_t *filter)
+{
+    if (filter == NULL)
+        return;
+
+    TELEBOT_SAFE_FREE(filter->chat_ids);
+    telebot_filter_put_strings(filter->commands, filter->commands_count);
+    telebot_filter_put_strings(filter->entity_types, filter->entity_types_count);
+    telebot_filter_put_strings(filter->callback_data_prefixes, filter->callback_data_prefixes_count);
+    free(filter);
+}
+
+static bool telebot_filter_is_message(telebot_update_type_e type)
+{
+    switch (type)
+    {
+    case TELEBOT_UPDATE_TYPE_MESSAGE:
+    case TELEBOT_UPDATE_TYPE_EDITED_MESSAGE:
+    case TELEBOT_UPDATE_TYPE_CHANNEL_POST:
+    case TELEBOT_UPDATE_TYPE_EDITED_CHANNEL_POST:
+    case TELEBOT_UPDATE_TYPE_BUSINESS_MESSAGE:
+    case TELEBOT_UPDATE_TYPE_EDITED_BUSINESS_MESSAGE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool telebot_filter_match_chat(const telebot_filter_t *filter, struct json_object *payload)
+{
+    struct json_object *chat = NULL;
+    if (!json_object_object_get_ex(payload, "chat", &chat))
+    {
+        /* Callback query carries the chat in its message */
+        struct json_object *message = NULL;
+        if (!json_object_object_get_ex(payload, "message", &message) ||
+            !json_object_object_get_ex(message, "chat", &chat))
+            return false;
+    }
+
+    struct json_object *id = NULL;
+    if (!json_object_object_get_ex(chat, "id", &id))
+        return false;
+
+    int64_t chat_id = json_object_get_int64(id);
+    return bsearch(&chat_id, filter->chat_ids, filter->chat_ids_count, sizeof(int64_t),
+                   telebot_filter_compare_id) != NULL;
+}
+
+static bool telebot_filter_match_command(const telebot_filter_t *filter, struct json_object *message)
+{
+    struct json_object *text = NULL;
+    if (!json_object_object_get_ex(message, "text", &text))
+        return false;
+
+    const char *str = json_object_get_string(text);
+    if ((str == NULL) || (str[0] != '/'))
+        return false;
+
+    for (int i = 0; i < filter->commands_count; i++)
+    {
+        const telebot_filter_string_t *cmd = &(filter->commands[i]);
+        if (strncmp(str, cmd->str, cmd->len) != 0)
+            continue;
+
+        char next = str[cmd->len];
+        if ((next == '\0') || (next == ' ') || (next == '\n') || (next == '@'))
+            return true;
+    }
+
+    return false;
+}
+
+static bool telebot_filter_match_entities(const telebot_filter_t *filter, struct json_object *entities)
+{
+    int count = json_object_array_length(entities);
+    for (int i = 0; i < count; i++)
+    {
+        struct json_object *type = NULL;
+        struct json_object *entity = json_object_array_get_idx(entities, i);
+        if (!json_object_object_get_ex(entity, "type", &type))
+            continue;
+
+        const char *str = json_object_get_string(type);
+        for (int j = 0; j < filter->entity_types_count; j++)
+        {
+            if (strcmp(str, filter->entity_types[j].str) == 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+static bool telebot_filter_match_entity_type(const telebot_filter_t *filter, struct json_object *message)
+{
+    struct json_object *entities = NULL;
+    if (json_object_object_get_ex(message, "entities", &entities) &&
+        telebot_filter_match_entities(filter, entities))
+        return true;
+
+    if (json_object_object_get_ex(message, "caption_entities", &entities) &&
+        telebot_filter_match_entities(filter, entities))
+        return true;
+
+    return false;
+}
+
+static bool telebot_filter_match_callback_data(const telebot_filter_t *filter, struct json_object *query)
+{
+    struct json_object *data = NULL;
+    if (!json_object_object_get_ex(query, "data", &data))
+        return false;
+
+    const char *str = json_object_get_string(data);
+    for (int i = 0; i < filter->callback_data_prefixes_count; i++)
+    {
+        const telebot_filter_string_t *prefix = &(filter->callback_data_prefixes[i]);
+        if (strncmp(str, prefix->str, prefix->len) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool telebot_filter_match(const telebot_filter_t *filter, struct json_object *update)
+{
+    if (filter == NULL)
+        return true;
+
+    struct json_object *payload = NULL;
+    telebot_update_type_e type = telebot_parser_get_update_type(update, &payload);
+    if (type == TELEBOT_UPDATE_TYPE_MAX)
+        return false;
+
+    if (filter->update_types && !(filter->update_types & (1u << type)))
+        return false;
+
+    if (filter->chat_ids_count && !telebot_filter_match_chat(filter, payload))
+        return false;
+
+    if (!filter->commands_count && !filter->entity_types_count && !filter->callback_data_prefixes_count)
+        return true;
+
+    if (telebot_filter_is_message(type))
+    {
+        if (filter->commands_count && telebot_filter_match_command(filter, payload))
+            return true;
+
+        if (filter->entity_types_count && telebot_filter_match_entity_type(filter, payload))
+            return true;
+    }
+    else if (type == TELEBOT_UPDATE_TYPE_CALLBACK_QUERY)
+    {
+        if (filter->callback_data_prefixes_count && telebot_filter_match_callback_data(filter, payload))
+            return true;
+    }
+
+    return false;
+}
+
+telebot_error_e telebot_set_update_filter(telebot_handler_t handle, const telebot_update_filter_t *filter)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    telebot_filter_t *compiled = NULL;
+    if (filter != NULL)
+    {
+        telebot_error_e ret = telebot_filter_compile(filter, &compiled);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    /* Replaced once no batch is parsed with it */
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_filter_t *old = handle->filter;
+    handle->filter = compiled;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_filter_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
@@ -0,0 +1,394 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <telebot-core.h>
+#include <telebot-inline.h>
+#include <telebot-private.h>
+
+#define TELEBOT_INLINE_CACHE_BUCKETS 4096
+
+/*
+ * Answer of a query, offset and personalization key. The page of results is
+ * kept encoded as a prepared request. The cache holds a reference while the
+ * entry is listed and each answer being sent holds another, so an entry is
+ * released once evicted and sent, even if the cache is destroyed meanwhile.
+ */
+typedef struct telebot_inline_cache_entry
+{
+    struct telebot_inline_cache_entry *next;     /* Next entry in the bucket */
+    struct telebot_inline_cache_entry *lru_prev; /* Recently used entries first */
+    struct telebot_inline_cache_entry *lru_next;
+    uint64_t hash;
+    char *key; /* Normalized query, offset and personalization key */
+    size_t key_size;
+    size_t size;     /* Bytes accounted to the entry */
+    int64_t expires; /* Monotonic time in milliseconds */
+    int refs;        /* Atomic */
+    telebot_prepared_request_t prepared;
+} telebot_inline_cache_entry_t;
+
+struct telebot_inline_cache
+{
+    pthread_mutex_t lock;
+    int64_t ttl; /* Milliseconds */
+    size_t max_size;
+    size_t size;
+    int count;
+    telebot_inline_cache_entry_t *buckets[TELEBOT_INLINE_CACHE_BUCKETS];
+    telebot_inline_cache_entry_t *lru_head;
+    telebot_inline_cache_entry_t *lru_tail;
+    unsigned long long hits;
+    unsigned long long misses;
+};
+
+/*
+ * Queries differing in case or spacing are answered alike, the key is the
+ * lower cased query with runs of white space collapsed, then offset and
+ * personalization key, separated by '\0'.
+ */
+static char *telebot_inline_cache_key(const char *query, const char *offset, const char *personal_key,
+                                      size_t *key_size, uint64_t *hash)
+{
+    const char *parts[3] = {query ? query : "", offset ? offset : "", personal_key ? personal_key : ""};
+    char *key = malloc(strlen(parts[0]) + strlen(parts[1]) + strlen(parts[2]) + 3);
+    if (key == NULL)
+        return NULL;
+
+    size_t length = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        const char *str = parts[i];
+        if (i == 0)
+        {
+            bool space = false;
+            while (isspace((unsigned char)*str))
+                str++;
+            for (; *str != '\0'; str++)
+            {
+                if (isspace((unsigned char)*str))
+                {
+                    space = true;
+                    continue;
+                }
+                if (space)
+                    key[length++] = ' ';
+                space = false;
+                key[length++] = tolower((unsigned char)*str);
+            }
+        }
+        else
+        {
+            size_t part_length = strlen(str);
+            memcpy(key + length, str, part_length);
+            length += part_length;
+        }
+        key[length++] = '\0';
+    }
+
+    *key_size = length;
+    *hash = telebot_hash_bytes(TELEBOT_HASH_SEED, key, length);
+    return key;
+}
+
+static telebot_inline_cache_entry_t **telebot_inline_cache_find(telebot_inline_cache_t *cache, const char *key,
+                                                                size_t key_size, uint64_t hash)
+{
+    telebot_inline_cache_entry_t **link = &(cache->buckets[hash & (TELEBOT_INLINE_CACHE_BUCKETS - 1)]);
+    while ((*link != NULL) && (((*link)->hash != hash) || ((*link)->key_size != key_size) ||
+                               memcmp((*link)->key, key, key_size)))
+        link = &((*link)->next);
+
+    return link;
+}
+
+static void telebot_inline_cache_lru_remove(telebot_inline_cache_t *cache, telebot_inline_cache_entry_t *entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache->lru_head = entry->lru_next;
+
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache->lru_tail = entry->lru_prev;
+}
+
+static void telebot_inline_cache_lru_push(telebot_inline_cache_t *cache, telebot_inline_cache_entry_t *entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head)
+        cache->lru_head->lru_prev = entry;
+    else
+        cache->lru_tail = entry;
+    cache->lru_head = entry;
+}
+
+static void telebot_inline_cache_entry_free(telebot_inline_cache_entry_t *entry)
+{
+    telebot_core_put_prepared_request(entry->prepared);
+    free(entry->key);
+    free(entry);
+}
+
+static void telebot_inline_cache_entry_put(telebot_inline_cache_entry_t *entry)
+{
+    if (__atomic_sub_fetch(&(entry->refs), 1, __ATOMIC_ACQ_REL) == 0)
+        telebot_inline_cache_entry_free(entry);
+}
+
+/* Remove entry found by telebot_inline_cache_find(), it is released once no longer referenced */
+static void telebot_inline_cache_remove(telebot_inline_cache_t *cache, telebot_inline_cache_entry_t **link)
+{
+    telebot_inline_cache_entry_t *entry = *link;
+    *link = entry->next;
+    telebot_inline_cache_lru_remove(cache, entry);
+    cache->count--;
+    cache->size -= entry->size;
+
+    telebot_inline_cache_entry_put(entry);
+}
+
+telebot_error_e telebot_inline_cache_create(telebot_inline_cache_t **cache, int ttl, size_t max_size)
+{
+    if ((cache == NULL) || (ttl <= 0) || (max_size == 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_inline_cache_t *c = calloc(1, sizeof(telebot_inline_cache_t));
+    if (c == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    pthread_mutex_init(&(c->lock), NULL);
+    c->ttl = (int64_t)ttl * 1000;
+    c->max_size = max_size;
+
+    *cache = c;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_inline_cache_destroy(telebot_inline_cache_t *cache)
+{
+    if (cache == NULL)
+        return;
+
+    /* Entries being sent are released by their senders */
+    telebot_inline_cache_entry_t *entry = cache->lru_head;
+    while (entry != NULL)
+    {
+        telebot_inline_cache_entry_t *next = entry->lru_next;
+        telebot_inline_cache_entry_put(entry);
+        entry = next;
+    }
+
+    pthread_mutex_destroy(&(cache->lock));
+    free(cache);
+}
+
+void telebot_inline_cache_get_stats(telebot_inline_cache_t *cache, telebot_stats_t *stats)
+{
+    if (cache == NULL)
+        return;
+
+    pthread_mutex_lock(&(cache->lock));
+    stats->inline_cache_hits = cache->hits;
+    stats->inline_cache_misses = cache->misses;
+    stats->inline_cache_entries = cache->count;
+    stats->inline_cache_bytes = cache->size;
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+telebot_error_e telebot_set_inline_cache(telebot_handler_t handle, int ttl, size_t max_size)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (ttl < 0)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_inline_cache_t *cache = NULL;
+    if (ttl > 0)
+    {
+        telebot_error_e ret = telebot_inline_cache_create(&cache, ttl, max_size ? max_size : TELEBOT_INLINE_CACHE_SIZE);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    /* Replaced once not looked up, destroyed after as answers may still be sent from it */
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_inline_cache_t *old = handle->inline_cache;
+    handle->inline_cache = cache;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_inline_cache_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_answer_inline_query_from_cache(telebot_handler_t handle, const char *inline_query_id,
+                                                       const char *query, const char *offset,
+                                                       const char *personal_key, bool *answered)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((inline_query_id == NULL) || (answered == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *answered = false;
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (telebot_inline_tracker_is_superseded(handle->inline_tracker, inline_query_id, true))
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        *answered = true;
+        return TELEBOT_ERROR_CANCELED;
+    }
+
+    telebot_inline_cache_t *cache = handle->inline_cache;
+    if (cache == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return TELEBOT_ERROR_NONE;
+    }
+
+    size_t key_size = 0;
+    uint64_t hash = 0;
+    char *key = telebot_inline_cache_key(query, offset, personal_key, &key_size, &hash);
+    if (key == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    pthread_mutex_lock(&(cache->lock));
+    telebot_inline_cache_entry_t **link = telebot_inline_cache_find(cache, key, key_size, hash);
+    telebot_inline_cache_entry_t *entry = *link;
+    if ((entry != NULL) && (entry->expires <= telebot_scheduler_now()))
+    {
+        telebot_inline_cache_remove(cache, link);
+        entry = NULL;
+    }
+    if (entry != NULL)
+    {
+        __atomic_add_fetch(&(entry->refs), 1, __ATOMIC_RELAXED);
+        telebot_inline_cache_lru_remove(cache, entry);
+        telebot_inline_cache_lru_push(cache, entry);
+        cache->hits++;
+    }
+    else
+    {
+        cache->misses++;
+    }
+    pthread_mutex_unlock(&(cache->lock));
+    pthread_rwlock_unlock(&(handle->lock));
+    free(key);
+
+    if (entry == NULL)
+        return TELEBOT_ERROR_NONE;
+
+    telebot_core_response_t response = telebot_core_answer_prepared_inline_query(handle->core_h, entry->prepared,
+                                                                                  inline_query_id);
+    int ret = telebot_core_get_response_code(response);
+    telebot_core_put_response(response);
+    telebot_inline_cache_entry_put(entry);
+
+    *answered = true;
+    return ret;
+}
+
+telebot_error_e telebot_answer_inline_query_cached(telebot_handler_t handle, const char *inline_query_id,
+                                                   const char *query, const char *offset, const char *personal_key,
+                                                   const char *results, int cache_time, bool is_personal,
+                                                   const char *next_offset, const char *button)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((inline_query_id == NULL) || (results == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    bool superseded = telebot_inline_tracker_is_superseded(handle->inline_tracker, inline_query_id, true);
+    bool enabled = (handle->inline_cache != NULL);
+    pthread_rwlock_unlock(&(handle->lock));
+    if (superseded)
+        return TELEBOT_ERROR_CANCELED;
+    if (!enabled)
+        return telebot_answer_inline_query(handle, inline_query_id, results, cache_time, is_personal,
+                                           next_offset, button);
+
+    telebot_inline_cache_entry_t *entry = calloc(1, sizeof(telebot_inline_cache_entry_t));
+    if (entry == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    telebot_error_e ret = telebot_core_prepare_answer_inline_query(handle->core_h, results, cache_time, is_personal,
+                                                                   next_offset, button, &(entry->prepared));
+    if (ret == TELEBOT_ERROR_NONE)
+    {
+        entry->key = telebot_inline_cache_key(query, offset, personal_key, &(entry->key_size), &(entry->hash));
+        if (entry->key == NULL)
+            ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        telebot_inline_cache_entry_free(entry);
+        return ret;
+    }
+
+    telebot_core_response_t response = telebot_core_answer_prepared_inline_query(handle->core_h, entry->prepared,
+                                                                                  inline_query_id);
+    ret = telebot_core_get_response_code(response);
+    telebot_core_put_response(response);
+
+    /* Answers rejected by the server are not cached, nor pages larger than the cache */
+    entry->size = sizeof(telebot_inline_cache_entry_t) + entry->key_size + entry->prepared->prefix_size;
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_inline_cache_t *cache = handle->inline_cache;
+    if ((ret != TELEBOT_ERROR_NONE) || (cache == NULL) || (entry->size > cache->max_size))
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        telebot_inline_cache_entry_free(entry);
+        return ret;
+    }
+
+    pthread_mutex_lock(&(cache->lock));
+    telebot_inline_cache_entry_t **link = telebot_inline_cache_find(cache, entry->key, entry->key_size, entry->hash);
+    if (*link != NULL)
+        telebot_inline_cache_remove(cache, link);
+
+    while (cache->size + entry->size > cache->max_size)
+    {
+        telebot_inline_cache_entry_t *oldest = cache->lru_tail;
+        telebot_inline_cache_remove(cache, telebot_inline_cache_find(cache, oldest->key, oldest->key_size,
+                                                                     oldest->hash));
+    }
+
+    entry->expires = telebot_scheduler_now() + cache->ttl;
+    entry->refs = 1;
+    link = &(cache->buckets[entry->hash & (TELEBOT_INLINE_CACHE_BUCKETS - 1)]);
+    entry->next = *link;
+    *link = entry;
+    telebot_inline_cache_lru_push(cache, entry);
+    cache->count++;
+    cache->size += entry->size;
+    pthread_mutex_unlock(&(cache->lock));
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
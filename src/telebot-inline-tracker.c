@@ -0,0 +1,275 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <telebot-methods.h>
+#include <telebot-inline.h>
+#include <telebot-private.h>
+
+#define TELEBOT_INLINE_TRACKER_BUCKETS 1024
+/* Queries older than this can not be answered anymore, milliseconds */
+#define TELEBOT_INLINE_TRACKER_TTL (60 * 1000)
+
+typedef struct telebot_inline_tracker_query
+{
+    struct telebot_inline_tracker_query *next;      /* Next query in the bucket */
+    struct telebot_inline_tracker_query *fifo_next; /* Next query received */
+    uint64_t hash;
+    char *id;
+    long long int user_id;
+    int64_t received; /* Monotonic time in milliseconds */
+    bool superseded;
+} telebot_inline_tracker_query_t;
+
+/* Latest query of a user */
+typedef struct telebot_inline_tracker_user
+{
+    struct telebot_inline_tracker_user *next; /* Next user in the bucket */
+    long long int user_id;
+    telebot_inline_tracker_query_t *latest;
+} telebot_inline_tracker_user_t;
+
+struct telebot_inline_tracker
+{
+    pthread_mutex_t lock;
+    telebot_inline_tracker_query_t *fifo_head; /* Oldest query first */
+    telebot_inline_tracker_query_t *fifo_tail;
+    telebot_inline_tracker_query_t *queries[TELEBOT_INLINE_TRACKER_BUCKETS];
+    telebot_inline_tracker_user_t *users[TELEBOT_INLINE_TRACKER_BUCKETS];
+    unsigned long long superseded;
+    unsigned long long dropped;
+};
+
+static telebot_inline_tracker_query_t **telebot_inline_tracker_find_query(telebot_inline_tracker_t *tracker,
+                                                                          const char *id, uint64_t hash)
+{
+    telebot_inline_tracker_query_t **link = &(tracker->queries[hash & (TELEBOT_INLINE_TRACKER_BUCKETS - 1)]);
+    while ((*link != NULL) && (((*link)->hash != hash) || strcmp((*link)->id, id)))
+        link = &((*link)->next);
+
+    return link;
+}
+
+static telebot_inline_tracker_user_t **telebot_inline_tracker_find_user(telebot_inline_tracker_t *tracker,
+                                                                        long long int user_id)
+{
+    uint64_t hash = (uint64_t)user_id * 0x9E3779B97F4A7C15ULL;
+    hash ^= hash >> 29;
+
+    telebot_inline_tracker_user_t **link = &(tracker->users[hash & (TELEBOT_INLINE_TRACKER_BUCKETS - 1)]);
+    while ((*link != NULL) && ((*link)->user_id != user_id))
+        link = &((*link)->next);
+
+    return link;
+}
+
+/* Forget queries too old to be answered, they are received in order */
+static void telebot_inline_tracker_expire(telebot_inline_tracker_t *tracker, int64_t now)
+{
+    while ((tracker->fifo_head != NULL) && (tracker->fifo_head->received + TELEBOT_INLINE_TRACKER_TTL <= now))
+    {
+        telebot_inline_tracker_query_t *query = tracker->fifo_head;
+        tracker->fifo_head = query->fifo_next;
+        if (tracker->fifo_head == NULL)
+            tracker->fifo_tail = NULL;
+
+        telebot_inline_tracker_query_t **link = telebot_inline_tracker_find_query(tracker, query->id, query->hash);
+        *link = query->next;
+
+        telebot_inline_tracker_user_t **user_link = telebot_inline_tracker_find_user(tracker, query->user_id);
+        telebot_inline_tracker_user_t *user = *user_link;
+        if ((user != NULL) && (user->latest == query))
+        {
+            *user_link = user->next;
+            free(user);
+        }
+
+        free(query->id);
+        free(query);
+    }
+}
+
+telebot_error_e telebot_inline_tracker_create(telebot_inline_tracker_t **tracker)
+{
+    if (tracker == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_inline_tracker_t *t = calloc(1, sizeof(telebot_inline_tracker_t));
+    if (t == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    pthread_mutex_init(&(t->lock), NULL);
+
+    *tracker = t;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_inline_tracker_destroy(telebot_inline_tracker_t *tracker)
+{
+    if (tracker == NULL)
+        return;
+
+    while (tracker->fifo_head != NULL)
+    {
+        telebot_inline_tracker_query_t *query = tracker->fifo_head;
+        tracker->fifo_head = query->fifo_next;
+        free(query->id);
+        free(query);
+    }
+
+    for (int i = 0; i < TELEBOT_INLINE_TRACKER_BUCKETS; i++)
+    {
+        while (tracker->users[i] != NULL)
+        {
+            telebot_inline_tracker_user_t *user = tracker->users[i];
+            tracker->users[i] = user->next;
+            free(user);
+        }
+    }
+
+    pthread_mutex_destroy(&(tracker->lock));
+    free(tracker);
+}
+
+void telebot_inline_tracker_add(telebot_inline_tracker_t *tracker, telebot_update_t *updates, int count)
+{
+    if ((tracker == NULL) || (updates == NULL))
+        return;
+
+    int64_t now = telebot_scheduler_now();
+    pthread_mutex_lock(&(tracker->lock));
+    telebot_inline_tracker_expire(tracker, now);
+
+    for (int index = 0; index < count; index++)
+    {
+        if (updates[index].update_type != TELEBOT_UPDATE_TYPE_INLINE_QUERY)
+            continue;
+
+        telebot_inline_query_t *inline_query = updates[index].inline_query;
+        if ((inline_query == NULL) || (inline_query->id == NULL) || (inline_query->from == NULL))
+            continue;
+
+        uint64_t hash = telebot_hash_str(inline_query->id);
+        telebot_inline_tracker_query_t **link = telebot_inline_tracker_find_query(tracker, inline_query->id, hash);
+        if (*link != NULL)
+            continue;
+
+        telebot_inline_tracker_user_t **user_link = telebot_inline_tracker_find_user(tracker, inline_query->from->id);
+        telebot_inline_tracker_user_t *user = *user_link;
+        if (user == NULL)
+        {
+            user = calloc(1, sizeof(telebot_inline_tracker_user_t));
+            if (user == NULL)
+                continue;
+            user->user_id = inline_query->from->id;
+            *user_link = user;
+        }
+
+        telebot_inline_tracker_query_t *query = calloc(1, sizeof(telebot_inline_tracker_query_t));
+        if ((query == NULL) || ((query->id = strdup(inline_query->id)) == NULL))
+        {
+            free(query);
+            if (user->latest == NULL)
+            {
+                *user_link = user->next;
+                free(user);
+            }
+            continue;
+        }
+        query->hash = hash;
+        query->user_id = user->user_id;
+        query->received = now;
+
+        if (user->latest != NULL)
+        {
+            user->latest->superseded = true;
+            tracker->superseded++;
+        }
+        user->latest = query;
+
+        *link = query;
+        if (tracker->fifo_tail != NULL)
+            tracker->fifo_tail->fifo_next = query;
+        else
+            tracker->fifo_head = query;
+        tracker->fifo_tail = query;
+    }
+    pthread_mutex_unlock(&(tracker->lock));
+}
+
+bool telebot_inline_tracker_is_superseded(telebot_inline_tracker_t *tracker, const char *inline_query_id,
+                                          bool drop)
+{
+    if ((tracker == NULL) || (inline_query_id == NULL))
+        return false;
+
+    pthread_mutex_lock(&(tracker->lock));
+    telebot_inline_tracker_query_t *query = *telebot_inline_tracker_find_query(
+        tracker, inline_query_id, telebot_hash_str(inline_query_id));
+    bool superseded = (query != NULL) && query->superseded;
+    if (superseded && drop)
+        tracker->dropped++;
+    pthread_mutex_unlock(&(tracker->lock));
+
+    return superseded;
+}
+
+void telebot_inline_tracker_get_stats(telebot_inline_tracker_t *tracker, telebot_stats_t *stats)
+{
+    if (tracker == NULL)
+        return;
+
+    pthread_mutex_lock(&(tracker->lock));
+    stats->inline_queries_superseded = tracker->superseded;
+    stats->inline_answers_dropped = tracker->dropped;
+    pthread_mutex_unlock(&(tracker->lock));
+}
+
+telebot_error_e telebot_set_inline_query_supersession(telebot_handler_t handle, bool enable)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    telebot_inline_tracker_t *tracker = NULL;
+    if (enable)
+    {
+        telebot_error_e ret = telebot_inline_tracker_create(&tracker);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_inline_tracker_t *old = handle->inline_tracker;
+    handle->inline_tracker = tracker;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_inline_tracker_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+bool telebot_is_inline_query_superseded(telebot_handler_t handle, const char *inline_query_id)
+{
+    if (handle == NULL)
+        return false;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    bool superseded = telebot_inline_tracker_is_superseded(handle->inline_tracker, inline_query_id, false);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return superseded;
+}
@@ -11,6 +11,12 @@ telebot_error_e telebot_answer_inline_query(telebot_handler_t handle,
     if (handle == NULL)
         return TELEBOT_ERROR_NOT_SUPPORTED;
 
+    pthread_rwlock_rdlock(&(handle->lock));
+    bool superseded = telebot_inline_tracker_is_superseded(handle->inline_tracker, inline_query_id, true);
+    pthread_rwlock_unlock(&(handle->lock));
+    if (superseded)
+        return TELEBOT_ERROR_CANCELED;
+
     telebot_core_response_t response = telebot_core_answer_inline_query(handle->core_h, inline_query_id,
                                                                          results, cache_time, is_personal,
                                                                          next_offset, button);
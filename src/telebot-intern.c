@@ -0,0 +1,121 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <telebot-private.h>
+
+#define TELEBOT_INTERN_INITIAL_CAPACITY 64
+
+/*
+ * Interned strings of low-cardinality fields (language codes, emoji, unknown
+ * enumeration values). They are never freed, the table is an open addressing
+ * set kept at most half full.
+ */
+static struct
+{
+    pthread_mutex_t lock;
+    char **strings;
+    size_t capacity;
+    size_t count;
+} telebot_intern_table = {PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0};
+
+static bool telebot_intern_grow(void)
+{
+    size_t capacity = telebot_intern_table.capacity ? 2 * telebot_intern_table.capacity
+                                                    : TELEBOT_INTERN_INITIAL_CAPACITY;
+    char **strings = calloc(capacity, sizeof(char *));
+    if (strings == NULL)
+        return false;
+
+    for (size_t i = 0; i < telebot_intern_table.capacity; i++)
+    {
+        char *str = telebot_intern_table.strings[i];
+        if (str == NULL)
+            continue;
+
+        size_t slot = telebot_hash_str(str) & (capacity - 1);
+        while (strings[slot] != NULL)
+            slot = (slot + 1) & (capacity - 1);
+        strings[slot] = str;
+    }
+
+    free(telebot_intern_table.strings);
+    telebot_intern_table.strings = strings;
+    telebot_intern_table.capacity = capacity;
+
+    return true;
+}
+
+const char *telebot_intern(const char *str)
+{
+    if (str == NULL)
+        return NULL;
+
+    const char *interned = NULL;
+    uint64_t hash = telebot_hash_str(str);
+
+    pthread_mutex_lock(&(telebot_intern_table.lock));
+    if ((2 * (telebot_intern_table.count + 1) > telebot_intern_table.capacity) && !telebot_intern_grow())
+        goto unlock;
+
+    size_t mask = telebot_intern_table.capacity - 1;
+    size_t slot = hash & mask;
+    while (telebot_intern_table.strings[slot] != NULL)
+    {
+        if (strcmp(telebot_intern_table.strings[slot], str) == 0)
+        {
+            interned = telebot_intern_table.strings[slot];
+            goto unlock;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    telebot_intern_table.strings[slot] = strdup(str);
+    if (telebot_intern_table.strings[slot] != NULL)
+        telebot_intern_table.count++;
+    interned = telebot_intern_table.strings[slot];
+
+unlock:
+    pthread_mutex_unlock(&(telebot_intern_table.lock));
+    if (interned == NULL)
+        ERR("Failed to intern string");
+
+    return interned;
+}
+
+int telebot_intern_enum(const char *str, const char *const *values, int count, const char **interned)
+{
+    if (str == NULL)
+    {
+        *interned = NULL;
+        return 0;
+    }
+
+    for (int i = 1; i < count; i++)
+    {
+        if (strcmp(str, values[i]) == 0)
+        {
+            *interned = values[i];
+            return i;
+        }
+    }
+
+    *interned = telebot_intern(str);
+    return 0;
+}
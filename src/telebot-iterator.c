@@ -0,0 +1,330 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <telebot-methods.h>
+#include <telebot-payments.h>
+#include <telebot-private.h>
+
+#define TELEBOT_ITERATOR_PAGE_SIZE_MAX 100
+
+typedef enum telebot_iterator_kind
+{
+    TELEBOT_ITERATOR_STAR_TRANSACTIONS,
+    TELEBOT_ITERATOR_USER_GIFTS,
+    TELEBOT_ITERATOR_CHAT_GIFTS,
+    TELEBOT_ITERATOR_PROFILE_PHOTOS,
+} telebot_iterator_kind_e;
+
+typedef struct telebot_iterator_page
+{
+    union
+    {
+        telebot_star_transactions_t transactions;
+        telebot_user_gifts_t gifts;
+        telebot_user_profile_photos_t photos;
+    };
+    bool loaded;
+    int offset; /* Offset the page was requested with */
+    int count;  /* Items in the page */
+    int total;  /* Items reported by the server, -1 if not known */
+    telebot_error_e ret;
+} telebot_iterator_page_t;
+
+/*
+ * The window is the page being consumed and the next one, which is fetched
+ * by a thread started when the current page is taken.
+ */
+struct telebot_iterator
+{
+    telebot_handler_t handle;
+    telebot_iterator_kind_e kind;
+    long long int id; /* User or chat */
+    int page_size;
+    telebot_iterator_page_t pages[2];
+    int current;   /* Page being consumed, -1 before the first one */
+    int position;  /* Next item of current page */
+    int offset;    /* Offset of the page after the fetched ones */
+    bool fetching; /* Thread is fetching the other page */
+    bool finished; /* No page after the fetched ones */
+    pthread_t thread;
+    int consumed;
+    int total;
+};
+
+static void telebot_iterator_put_page(telebot_iterator_t iterator, telebot_iterator_page_t *page)
+{
+    if (!page->loaded)
+        return;
+
+    switch (iterator->kind)
+    {
+    case TELEBOT_ITERATOR_STAR_TRANSACTIONS:
+        telebot_put_star_transactions(&(page->transactions));
+        break;
+    case TELEBOT_ITERATOR_USER_GIFTS:
+    case TELEBOT_ITERATOR_CHAT_GIFTS:
+        telebot_put_user_gifts(&(page->gifts));
+        break;
+    case TELEBOT_ITERATOR_PROFILE_PHOTOS:
+        telebot_put_user_profile_photos(&(page->photos));
+        break;
+    }
+    page->loaded = false;
+}
+
+static void telebot_iterator_fetch(telebot_iterator_t iterator, telebot_iterator_page_t *page)
+{
+    memset(page, 0, sizeof(telebot_iterator_page_t));
+    page->offset = iterator->offset;
+    page->total = -1;
+
+    switch (iterator->kind)
+    {
+    case TELEBOT_ITERATOR_STAR_TRANSACTIONS:
+        page->ret = telebot_get_star_transactions(iterator->handle, page->offset, iterator->page_size,
+                                                  &(page->transactions));
+        page->count = page->transactions.count_transactions;
+        break;
+    case TELEBOT_ITERATOR_USER_GIFTS:
+        page->ret = telebot_get_user_gifts(iterator->handle, iterator->id, page->offset, iterator->page_size,
+                                           &(page->gifts));
+        page->count = page->gifts.count;
+        page->total = page->gifts.total_count;
+        break;
+    case TELEBOT_ITERATOR_CHAT_GIFTS:
+        page->ret = telebot_get_chat_gifts(iterator->handle, iterator->id, page->offset, iterator->page_size,
+                                           &(page->gifts));
+        page->count = page->gifts.count;
+        page->total = page->gifts.total_count;
+        break;
+    case TELEBOT_ITERATOR_PROFILE_PHOTOS:
+        page->ret = telebot_get_user_profile_photos(iterator->handle, (int)iterator->id, page->offset,
+                                                    iterator->page_size, &(page->photos));
+        page->count = page->photos.current_count;
+        page->total = page->photos.total_count;
+        break;
+    }
+    page->loaded = (page->ret == TELEBOT_ERROR_NONE);
+}
+
+static void *telebot_iterator_thread(void *data)
+{
+    telebot_iterator_t iterator = data;
+    telebot_iterator_fetch(iterator, &(iterator->pages[(iterator->current + 1) & 1]));
+
+    return NULL;
+}
+
+/* Prefetch the page after the fetched ones, it is fetched when needed if the thread can not be started */
+static void telebot_iterator_prefetch(telebot_iterator_t iterator)
+{
+    if (!iterator->finished)
+        iterator->fetching = (pthread_create(&(iterator->thread), NULL, telebot_iterator_thread, iterator) == 0);
+}
+
+/* Move to the next page, more is false at the end of iteration */
+static telebot_error_e telebot_iterator_advance(telebot_iterator_t iterator, bool *more)
+{
+    *more = false;
+    if (iterator->current >= 0)
+        telebot_iterator_put_page(iterator, &(iterator->pages[iterator->current]));
+
+    if (iterator->finished)
+        return TELEBOT_ERROR_NONE;
+
+    int next = (iterator->current + 1) & 1;
+    telebot_iterator_page_t *page = &(iterator->pages[next]);
+    if (iterator->fetching)
+        pthread_join(iterator->thread, NULL);
+    else
+        telebot_iterator_fetch(iterator, page);
+    iterator->fetching = false;
+
+    /* Retried by the next call */
+    if (page->ret != TELEBOT_ERROR_NONE)
+        return page->ret;
+
+    iterator->current = next;
+    iterator->position = 0;
+    iterator->offset = page->offset + page->count;
+    if (page->total >= 0)
+        iterator->total = page->total;
+    iterator->finished = (page->count < iterator->page_size) ||
+                         ((page->total >= 0) && (iterator->offset >= page->total));
+
+    telebot_iterator_prefetch(iterator);
+
+    *more = (page->count > 0);
+    return TELEBOT_ERROR_NONE;
+}
+
+/* Get index of next item in current page, -1 at the end of iteration */
+static telebot_error_e telebot_iterator_next(telebot_iterator_t iterator, telebot_iterator_kind_e kind,
+                                             int *index)
+{
+    *index = -1;
+    if ((iterator->kind != kind) &&
+        !((kind == TELEBOT_ITERATOR_USER_GIFTS) && (iterator->kind == TELEBOT_ITERATOR_CHAT_GIFTS)))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    while ((iterator->current < 0) || (iterator->position >= iterator->pages[iterator->current].count))
+    {
+        bool more = false;
+        telebot_error_e ret = telebot_iterator_advance(iterator, &more);
+        if ((ret != TELEBOT_ERROR_NONE) || !more)
+            return ret;
+    }
+
+    *index = iterator->position++;
+    iterator->consumed++;
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_iterator_create(telebot_handler_t handle, telebot_iterator_kind_e kind,
+                                               long long int id, int page_size, telebot_iterator_t *iterator)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((iterator == NULL) || (page_size < 0) || (page_size > TELEBOT_ITERATOR_PAGE_SIZE_MAX))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_iterator_t _iterator = calloc(1, sizeof(struct telebot_iterator));
+    if (_iterator == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    _iterator->handle = handle;
+    _iterator->kind = kind;
+    _iterator->id = id;
+    _iterator->page_size = (page_size > 0) ? page_size : TELEBOT_ITERATOR_PAGE_SIZE;
+    _iterator->current = -1;
+    _iterator->total = -1;
+
+    /* First page is on its way while the caller gets ready */
+    telebot_iterator_prefetch(_iterator);
+
+    *iterator = _iterator;
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_iterate_star_transactions(telebot_handler_t handle, int page_size,
+                                                  telebot_iterator_t *iterator)
+{
+    return telebot_iterator_create(handle, TELEBOT_ITERATOR_STAR_TRANSACTIONS, 0, page_size, iterator);
+}
+
+telebot_error_e telebot_iterate_user_gifts(telebot_handler_t handle, long long int user_id, int page_size,
+                                           telebot_iterator_t *iterator)
+{
+    return telebot_iterator_create(handle, TELEBOT_ITERATOR_USER_GIFTS, user_id, page_size, iterator);
+}
+
+telebot_error_e telebot_iterate_chat_gifts(telebot_handler_t handle, long long int chat_id, int page_size,
+                                           telebot_iterator_t *iterator)
+{
+    return telebot_iterator_create(handle, TELEBOT_ITERATOR_CHAT_GIFTS, chat_id, page_size, iterator);
+}
+
+telebot_error_e telebot_iterate_user_profile_photos(telebot_handler_t handle, int user_id, int page_size,
+                                                    telebot_iterator_t *iterator)
+{
+    return telebot_iterator_create(handle, TELEBOT_ITERATOR_PROFILE_PHOTOS, user_id, page_size, iterator);
+}
+
+telebot_error_e telebot_iterator_next_star_transaction(telebot_iterator_t iterator,
+                                                       const telebot_star_transaction_t **transaction)
+{
+    if ((iterator == NULL) || (transaction == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    int index = -1;
+    *transaction = NULL;
+    telebot_error_e ret = telebot_iterator_next(iterator, TELEBOT_ITERATOR_STAR_TRANSACTIONS, &index);
+    if ((ret == TELEBOT_ERROR_NONE) && (index >= 0))
+        *transaction = &(iterator->pages[iterator->current].transactions.transactions[index]);
+
+    return ret;
+}
+
+telebot_error_e telebot_iterator_next_user_gift(telebot_iterator_t iterator, const telebot_user_gift_t **gift)
+{
+    if ((iterator == NULL) || (gift == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    int index = -1;
+    *gift = NULL;
+    telebot_error_e ret = telebot_iterator_next(iterator, TELEBOT_ITERATOR_USER_GIFTS, &index);
+    if ((ret == TELEBOT_ERROR_NONE) && (index >= 0))
+        *gift = &(iterator->pages[iterator->current].gifts.gifts[index]);
+
+    return ret;
+}
+
+telebot_error_e telebot_iterator_next_profile_photo(telebot_iterator_t iterator, const telebot_photo_t *sizes[4],
+                                                    int *count)
+{
+    if ((iterator == NULL) || (sizes == NULL) || (count == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    int index = -1;
+    *count = 0;
+    for (int i = 0; i < 4; i++)
+        sizes[i] = NULL;
+
+    telebot_error_e ret = telebot_iterator_next(iterator, TELEBOT_ITERATOR_PROFILE_PHOTOS, &index);
+    if ((ret != TELEBOT_ERROR_NONE) || (index < 0))
+        return ret;
+
+    /* Sizes are stored by size, pictures with less sizes have empty ones */
+    telebot_user_profile_photos_t *photos = &(iterator->pages[iterator->current].photos);
+    for (int i = 0; i < 4; i++)
+    {
+        if ((photos->photos[i] != NULL) && (photos->photos[i][index].file_id != NULL))
+            sizes[(*count)++] = &(photos->photos[i][index]);
+    }
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_iterator_get_progress(telebot_iterator_t iterator, int *consumed, int *total)
+{
+    if (iterator == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    if (consumed != NULL)
+        *consumed = iterator->consumed;
+    if (total != NULL)
+        *total = iterator->total;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_iterator_destroy(telebot_iterator_t iterator)
+{
+    if (iterator == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    if (iterator->fetching)
+        pthread_join(iterator->thread, NULL);
+
+    telebot_iterator_put_page(iterator, &(iterator->pages[0]));
+    telebot_iterator_put_page(iterator, &(iterator->pages[1]));
+    free(iterator);
+
+    return TELEBOT_ERROR_NONE;
+}
@@ -0,0 +1,534 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <json.h>
+#include <telebot-journal.h>
+#include <telebot-parser.h>
+#include <telebot-private.h>
+
+#define TELEBOT_JOURNAL_MAGIC        0x314A4254 /* "TBJ1" */
+#define TELEBOT_JOURNAL_VERSION      2
+#define TELEBOT_JOURNAL_HEADER_SIZE  TELEBOT_BUFFER_PAGE
+#define TELEBOT_JOURNAL_ALIGN(size)  (((size) + 15) & ~((uint64_t)15))
+#define TELEBOT_JOURNAL_FLAG_PAD     0x1
+
+/*
+ * On-disk layout: a header page followed by a ring of records. Positions in
+ * the header are logical (monotonically increasing) byte offsets, physical
+ * offset in the ring is position modulo capacity. Records are 16-byte aligned
+ * and never wrap; the unused end of the ring is covered with a pad record, or
+ * skipped without one when it is too small to hold a record header.
+ */
+typedef struct telebot_journal_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity; /* Size of the ring in bytes */
+    uint64_t head;     /* Logical position to append next record */
+    uint64_t tail;     /* Logical position of oldest unacknowledged record */
+    int64_t acked_id;  /* Highest acknowledged update identifier */
+    int64_t last_id;   /* Highest journaled update identifier */
+} telebot_journal_header_t;
+
+typedef struct telebot_journal_record
+{
+    uint32_t size;     /* Payload size in bytes */
+    uint32_t flags;
+    int64_t update_id;
+    int64_t received; /* Wall clock time in milliseconds, to restore deadlines on replay */
+} telebot_journal_record_t;
+
+struct telebot_journal
+{
+    int fd;
+    size_t map_size;
+    char *map;
+    char *ring;
+    telebot_journal_header_t *header;
+    uint64_t replay;     /* Next record to replay */
+    uint64_t replay_end; /* End of records not yet delivered */
+    int sync_batch;
+    int pending;
+    pthread_mutex_t lock;
+};
+
+static inline telebot_journal_record_t *telebot_journal_record_at(telebot_journal_t *journal, uint64_t pos)
+{
+    return (telebot_journal_record_t *)(journal->ring + (pos % journal->header->capacity));
+}
+
+/* Position of the record at or after pos, skipping an end of the ring too small for a header */
+static inline uint64_t telebot_journal_record_pos(telebot_journal_t *journal, uint64_t pos)
+{
+    uint64_t gap = journal->header->capacity - (pos % journal->header->capacity);
+    return (gap < sizeof(telebot_journal_record_t)) ? pos + gap : pos;
+}
+
+static inline uint64_t telebot_journal_record_span(telebot_journal_record_t *record)
+{
+    return TELEBOT_JOURNAL_ALIGN(sizeof(telebot_journal_record_t) + record->size);
+}
+
+static telebot_error_e telebot_journal_flush(telebot_journal_t *journal)
+{
+    journal->pending = 0;
+    if (msync(journal->map, journal->map_size, MS_SYNC) != 0)
+    {
+        ERR("Failed to sync journal");
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+    return TELEBOT_ERROR_NONE;
+}
+
+static void telebot_journal_mark_dirty(telebot_journal_t *journal)
+{
+    if (++journal->pending >= journal->sync_batch)
+        telebot_journal_flush(journal);
+}
+
+telebot_error_e telebot_journal_open(telebot_journal_t **journal, const char *path,
+                                     size_t capacity, int sync_batch)
+{
+    if ((journal == NULL) || (path == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *journal = NULL;
+    if (capacity == 0)
+        capacity = TELEBOT_JOURNAL_DEFAULT_CAPACITY;
+    capacity = TELEBOT_JOURNAL_ALIGN(capacity);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0)
+    {
+        ERR("Failed to open journal '%s'", path);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ERR("Failed to stat journal '%s'", path);
+        close(fd);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    bool created = (st.st_size == 0);
+    if (created)
+    {
+        if (ftruncate(fd, TELEBOT_JOURNAL_HEADER_SIZE + capacity) != 0)
+        {
+            ERR("Failed to resize journal '%s'", path);
+            close(fd);
+            return TELEBOT_ERROR_OPERATION_FAILED;
+        }
+        st.st_size = TELEBOT_JOURNAL_HEADER_SIZE + capacity;
+    }
+    else if (st.st_size <= TELEBOT_JOURNAL_HEADER_SIZE)
+    {
+        ERR("Journal '%s' is truncated", path);
+        close(fd);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    char *map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        ERR("Failed to map journal '%s'", path);
+        close(fd);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    telebot_journal_header_t *header = (telebot_journal_header_t *)map;
+    if (created)
+    {
+        header->magic = TELEBOT_JOURNAL_MAGIC;
+        header->version = TELEBOT_JOURNAL_VERSION;
+        header->capacity = capacity;
+        header->head = 0;
+        header->tail = 0;
+        header->acked_id = -1;
+        header->last_id = -1;
+    }
+    else if ((header->magic != TELEBOT_JOURNAL_MAGIC) ||
+             (header->version != TELEBOT_JOURNAL_VERSION) ||
+             (header->capacity + TELEBOT_JOURNAL_HEADER_SIZE != (uint64_t)st.st_size) ||
+             (header->tail > header->head) ||
+             (header->head - header->tail > header->capacity))
+    {
+        ERR("Journal '%s' is corrupted or has unsupported format", path);
+        munmap(map, st.st_size);
+        close(fd);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    telebot_journal_t *_journal = calloc(1, sizeof(telebot_journal_t));
+    if (_journal == NULL)
+    {
+        ERR("Failed to allocate memory for journal");
+        munmap(map, st.st_size);
+        close(fd);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    _journal->fd = fd;
+    _journal->map = map;
+    _journal->map_size = st.st_size;
+    _journal->header = header;
+    _journal->ring = map + TELEBOT_JOURNAL_HEADER_SIZE;
+    _journal->replay = header->tail;
+    _journal->replay_end = header->head;
+    _journal->sync_batch = (sync_batch > 0) ? sync_batch : 1;
+    pthread_mutex_init(&(_journal->lock), NULL);
+
+    if (created)
+        telebot_journal_flush(_journal);
+
+    DBG("Journal opened, %llu bytes to replay",
+        (unsigned long long)(header->head - header->tail));
+
+    *journal = _journal;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_journal_close(telebot_journal_t *journal)
+{
+    if (journal == NULL)
+        return;
+
+    telebot_journal_flush(journal);
+    munmap(journal->map, journal->map_size);
+    close(journal->fd);
+    pthread_mutex_destroy(&(journal->lock));
+    TELEBOT_SAFE_FREE(journal);
+}
+
+int telebot_journal_get_offset(telebot_journal_t *journal)
+{
+    if (journal == NULL)
+        return 0;
+
+    pthread_mutex_lock(&(journal->lock));
+    int offset = (int)(journal->header->last_id + 1);
+    pthread_mutex_unlock(&(journal->lock));
+
+    return offset;
+}
+
+static int64_t telebot_journal_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static telebot_error_e telebot_journal_append_record(telebot_journal_t *journal, int64_t update_id,
+                                                     int64_t received, const char *data, size_t size)
+{
+    telebot_journal_header_t *header = journal->header;
+    uint64_t span = TELEBOT_JOURNAL_ALIGN(sizeof(telebot_journal_record_t) + size);
+    uint64_t phys = header->head % header->capacity;
+    uint64_t pad = (phys + span > header->capacity) ? (header->capacity - phys) : 0;
+
+    if (header->head + pad + span - header->tail > header->capacity)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    if (pad >= sizeof(telebot_journal_record_t))
+    {
+        telebot_journal_record_t *record = telebot_journal_record_at(journal, header->head);
+        record->size = pad - sizeof(telebot_journal_record_t);
+        record->flags = TELEBOT_JOURNAL_FLAG_PAD;
+        record->update_id = -1;
+        record->received = 0;
+    }
+    header->head += pad;
+
+    telebot_journal_record_t *record = telebot_journal_record_at(journal, header->head);
+    record->size = size;
+    record->flags = 0;
+    record->update_id = update_id;
+    record->received = received;
+    memcpy(record + 1, data, size);
+
+    header->head += span;
+    header->last_id = update_id;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_journal_append(telebot_journal_t *journal, struct json_object *updates)
+{
+    if ((journal == NULL) || (updates == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    int ret = TELEBOT_ERROR_NONE;
+    int count = json_object_array_length(updates);
+    int64_t received = telebot_journal_now();
+
+    pthread_mutex_lock(&(journal->lock));
+    uint64_t head = journal->header->head;
+    int64_t last_id = journal->header->last_id;
+    for (int index = 0; index < count; index++)
+    {
+        struct json_object *item = json_object_array_get_idx(updates, index);
+        struct json_object *update_id = NULL;
+        if (!json_object_object_get_ex(item, "update_id", &update_id))
+            continue;
+
+        int64_t id = json_object_get_int64(update_id);
+        if (id <= journal->header->last_id)
+            continue; /* already journaled */
+
+        const char *data = json_object_to_json_string_ext(item, JSON_C_TO_STRING_PLAIN);
+        ret = telebot_journal_append_record(journal, id, received, data, strlen(data));
+        if (ret != TELEBOT_ERROR_NONE)
+        {
+            ERR("Journal is full, update %lld is not journaled", (long long)id);
+            break;
+        }
+    }
+
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        /* The batch is journaled whole or not at all, so the offset is not advanced past it */
+        journal->header->head = head;
+        journal->header->last_id = last_id;
+    }
+    else
+    {
+        /* Replayed next time unless delivered */
+        journal->replay_end = journal->header->head;
+        if (count > 0)
+            telebot_journal_mark_dirty(journal);
+    }
+    pthread_mutex_unlock(&(journal->lock));
+
+    return ret;
+}
+
+void telebot_journal_delivered(telebot_journal_t *journal)
+{
+    if (journal == NULL)
+        return;
+
+    pthread_mutex_lock(&(journal->lock));
+    journal->replay = journal->replay_end;
+    pthread_mutex_unlock(&(journal->lock));
+}
+
+telebot_error_e telebot_journal_ack(telebot_journal_t *journal, int update_id)
+{
+    if (journal == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_mutex_lock(&(journal->lock));
+    telebot_journal_header_t *header = journal->header;
+    if (update_id > header->acked_id)
+        header->acked_id = update_id;
+
+    while (header->tail < header->head)
+    {
+        header->tail = telebot_journal_record_pos(journal, header->tail);
+        telebot_journal_record_t *record = telebot_journal_record_at(journal, header->tail);
+        if (!(record->flags & TELEBOT_JOURNAL_FLAG_PAD) && (record->update_id > header->acked_id))
+            break;
+        header->tail += telebot_journal_record_span(record);
+    }
+
+    if (journal->replay < header->tail)
+        journal->replay = header->tail;
+
+    telebot_journal_mark_dirty(journal);
+    pthread_mutex_unlock(&(journal->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_journal_replay(telebot_journal_t *journal, int limit, struct json_object **updates,
+                                       int64_t **received)
+{
+    if ((journal == NULL) || (updates == NULL) || (received == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *updates = NULL;
+    *received = NULL;
+
+    pthread_mutex_lock(&(journal->lock));
+    if (journal->replay >= journal->replay_end)
+    {
+        pthread_mutex_unlock(&(journal->lock));
+        return TELEBOT_ERROR_NONE;
+    }
+
+    /* Journaled updates are stored as JSON text, join them into an array */
+    size_t size = 2;
+    int count = 0;
+    uint64_t pos = journal->replay;
+    while ((pos < journal->replay_end) && (count < limit))
+    {
+        pos = telebot_journal_record_pos(journal, pos);
+        telebot_journal_record_t *record = telebot_journal_record_at(journal, pos);
+        if (!(record->flags & TELEBOT_JOURNAL_FLAG_PAD) && (record->update_id > journal->header->acked_id))
+        {
+            size += record->size + 1;
+            count++;
+        }
+        pos += telebot_journal_record_span(record);
+    }
+
+    char *array = malloc(size + 1);
+    int64_t *times = malloc((count > 0 ? count : 1) * sizeof(int64_t));
+    if ((array == NULL) || (times == NULL))
+    {
+        pthread_mutex_unlock(&(journal->lock));
+        free(array);
+        free(times);
+        ERR("Failed to allocate memory for journal replay");
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Deadlines run on the monotonic clock, which does not survive a restart */
+    int64_t now = telebot_scheduler_now();
+    int64_t wall_now = telebot_journal_now();
+
+    size_t len = 0;
+    array[len++] = '[';
+    count = 0;
+    uint64_t at = journal->replay;
+    while (at < pos)
+    {
+        at = telebot_journal_record_pos(journal, at);
+        telebot_journal_record_t *record = telebot_journal_record_at(journal, at);
+        if (!(record->flags & TELEBOT_JOURNAL_FLAG_PAD) && (record->update_id > journal->header->acked_id))
+        {
+            int64_t age = wall_now - record->received;
+            times[count] = now - ((age > 0) ? age : 0);
+            if (count++ > 0)
+                array[len++] = ',';
+            memcpy(array + len, record + 1, record->size);
+            len += record->size;
+        }
+        at += telebot_journal_record_span(record);
+    }
+    array[len++] = ']';
+    array[len] = '\0';
+    pthread_mutex_unlock(&(journal->lock));
+
+    if (count > 0)
+    {
+        DBG("Replaying %d journaled updates", count);
+        *updates = telebot_parser_str_to_obj(array);
+    }
+    TELEBOT_SAFE_FREE(array);
+
+    if ((count > 0) && (*updates == NULL))
+    {
+        /* The cursor stays, so the batch is tried again rather than dropped */
+        ERR("Failed to parse journaled updates");
+        free(times);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    pthread_mutex_lock(&(journal->lock));
+    if (journal->replay < pos)
+        journal->replay = pos;
+    pthread_mutex_unlock(&(journal->lock));
+
+    if (*updates != NULL)
+        *received = times;
+    else
+        free(times);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_enable_journal(telebot_handler_t handle, const char *path,
+                                       size_t capacity, int sync_batch)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (path == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_journal_t *journal = NULL;
+    telebot_error_e ret = telebot_journal_open(&journal, path, capacity, sync_batch);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_journal_t *old = handle->journal;
+    handle->journal = journal;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_journal_close(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_disable_journal(telebot_handler_t handle)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_journal_t *old = handle->journal;
+    handle->journal = NULL;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_journal_close(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_ack_update(telebot_handler_t handle, int update_id)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (handle->journal != NULL)
+        ret = telebot_journal_ack(handle->journal, update_id);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
+
+telebot_error_e telebot_sync_journal(telebot_handler_t handle)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (handle->journal != NULL)
+    {
+        pthread_mutex_lock(&(handle->journal->lock));
+        ret = telebot_journal_flush(handle->journal);
+        pthread_mutex_unlock(&(handle->journal->lock));
+    }
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
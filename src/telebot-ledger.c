@@ -0,0 +1,736 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <json.h>
+#include <telebot-core.h>
+#include <telebot-ledger.h>
+#include <telebot-parser.h>
+#include <telebot-private.h>
+
+#define TELEBOT_LEDGER_MAGIC        0x314C4254 /* "TBL1" */
+#define TELEBOT_LEDGER_VERSION      1
+#define TELEBOT_LEDGER_ALIGN(size)  (((size) + 7) & ~((uint64_t)7))
+#define TELEBOT_LEDGER_PAGE         100 /* Transactions per getStarTransactions request */
+#define TELEBOT_LEDGER_MIN_CAPACITY 256
+#define TELEBOT_LEDGER_ID_MAX       UINT16_MAX
+
+/*
+ * On-disk layout: a header followed by records in the order they were
+ * appended, each record followed by its identifier and padded to 8 bytes.
+ * A record cut short by a crash is dropped when the ledger is opened.
+ */
+typedef struct telebot_ledger_header
+{
+    uint32_t magic;
+    uint32_t version;
+    int64_t checkpoint; /* Offset of getStarTransactions synchronized up to */
+} telebot_ledger_header_t;
+
+typedef struct telebot_ledger_record
+{
+    uint16_t id_size; /* Identifier size in bytes, without terminator */
+    uint8_t source;   /* telebot_star_ledger_source_e */
+    uint8_t reserved[5];
+    int64_t date;
+    int64_t amount; /* Nanostars, negative for outgoing */
+} telebot_ledger_record_t;
+
+typedef struct telebot_ledger_item
+{
+    char *id;
+    uint64_t hash;
+    int64_t date;
+    int64_t amount;
+    telebot_star_ledger_source_e source;
+    int next; /* Next item in the bucket, -1 at the end */
+} telebot_ledger_item_t;
+
+struct telebot_ledger
+{
+    int fd;
+    off_t size;               /* End of records in the file */
+    int64_t checkpoint;
+    pthread_mutex_t lock;
+    pthread_mutex_t sync_lock; /* Serializes synchronizations */
+    telebot_ledger_item_t *items; /* In the order they were appended */
+    int count;
+    int capacity;
+    int *buckets; /* Items by identifier and direction */
+    int bucket_count;
+    int *order;         /* Items by date */
+    int64_t *prefix;    /* Sum of amounts of the first k items by date */
+    int64_t *prefix_in; /* Sum of incoming amounts of the first k items by date */
+};
+
+static uint64_t telebot_ledger_hash(const char *id, bool outgoing)
+{
+    uint64_t hash = telebot_hash_str(id);
+
+    /* Refunds have the identifier of the refunded payment */
+    return outgoing ? hash * 0x9E3779B97F4A7C15ULL : hash;
+}
+
+static int telebot_ledger_find(telebot_ledger_t *ledger, const char *id, uint64_t hash, bool outgoing)
+{
+    int index = ledger->buckets[hash & (ledger->bucket_count - 1)];
+    while ((index >= 0) && ((ledger->items[index].hash != hash) ||
+                            ((ledger->items[index].amount < 0) != outgoing) ||
+                            strcmp(ledger->items[index].id, id)))
+        index = ledger->items[index].next;
+
+    return index;
+}
+
+/* Index of the first item by date dated at date or later, or later only if after is true */
+static int telebot_ledger_search(telebot_ledger_t *ledger, int64_t date, bool after)
+{
+    int low = 0, high = ledger->count;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        int64_t value = ledger->items[ledger->order[middle]].date;
+        if ((value < date) || (after && (value == date)))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+static telebot_error_e telebot_ledger_reserve(telebot_ledger_t *ledger)
+{
+    if (ledger->count < ledger->capacity)
+        return TELEBOT_ERROR_NONE;
+
+    int capacity = (ledger->capacity > 0) ? ledger->capacity * 2 : TELEBOT_LEDGER_MIN_CAPACITY;
+    telebot_ledger_item_t *items = realloc(ledger->items, capacity * sizeof(telebot_ledger_item_t));
+    if (items == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    ledger->items = items;
+
+    int *order = realloc(ledger->order, capacity * sizeof(int));
+    if (order == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    ledger->order = order;
+
+    int64_t *prefix = realloc(ledger->prefix, (capacity + 1) * sizeof(int64_t));
+    if (prefix == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    ledger->prefix = prefix;
+
+    int64_t *prefix_in = realloc(ledger->prefix_in, (capacity + 1) * sizeof(int64_t));
+    if (prefix_in == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    ledger->prefix_in = prefix_in;
+
+    /* Keep chains short, buckets are as many as items */
+    int *buckets = malloc(capacity * sizeof(int));
+    if (buckets == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    for (int i = 0; i < capacity; i++)
+        buckets[i] = -1;
+    for (int i = 0; i < ledger->count; i++)
+    {
+        int bucket = ledger->items[i].hash & (capacity - 1);
+        ledger->items[i].next = buckets[bucket];
+        buckets[bucket] = i;
+    }
+    free(ledger->buckets);
+    ledger->buckets = buckets;
+    ledger->bucket_count = capacity;
+
+    ledger->capacity = capacity;
+    if (ledger->count == 0)
+        ledger->prefix[0] = ledger->prefix_in[0] = 0;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+/* Add item to memory, id is taken over */
+static telebot_error_e telebot_ledger_insert(telebot_ledger_t *ledger, char *id, uint64_t hash, int64_t date,
+                                             int64_t amount, telebot_star_ledger_source_e source)
+{
+    telebot_error_e ret = telebot_ledger_reserve(ledger);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    int index = ledger->count;
+    telebot_ledger_item_t *item = &(ledger->items[index]);
+    item->id = id;
+    item->hash = hash;
+    item->date = date;
+    item->amount = amount;
+    item->source = source;
+
+    int bucket = hash & (ledger->bucket_count - 1);
+    item->next = ledger->buckets[bucket];
+    ledger->buckets[bucket] = index;
+
+    /* Transactions mostly come in date order, so only the last sums change */
+    int position = telebot_ledger_search(ledger, date, true);
+    memmove(&(ledger->order[position + 1]), &(ledger->order[position]), (index - position) * sizeof(int));
+    ledger->order[position] = index;
+    ledger->count++;
+
+    for (int k = position; k < ledger->count; k++)
+    {
+        int64_t value = ledger->items[ledger->order[k]].amount;
+        ledger->prefix[k + 1] = ledger->prefix[k] + value;
+        ledger->prefix_in[k + 1] = ledger->prefix_in[k] + ((value > 0) ? value : 0);
+    }
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_ledger_write(int fd, const void *data, size_t size, off_t offset)
+{
+    const char *pos = data;
+    while (size > 0)
+    {
+        ssize_t written = pwrite(fd, pos, size, offset);
+        if (written <= 0)
+            return TELEBOT_ERROR_OPERATION_FAILED;
+        pos += written;
+        size -= written;
+        offset += written;
+    }
+
+    return TELEBOT_ERROR_NONE;
+}
+
+/* Append transaction unless recorded already, added is set if it is appended */
+static telebot_error_e telebot_ledger_append(telebot_ledger_t *ledger, const char *id, int64_t date,
+                                             int64_t amount, telebot_star_ledger_source_e source, bool *added)
+{
+    *added = false;
+    size_t id_size = strlen(id);
+    if ((id_size == 0) || (id_size > TELEBOT_LEDGER_ID_MAX))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    uint64_t hash = telebot_ledger_hash(id, amount < 0);
+    if ((ledger->count > 0) && (telebot_ledger_find(ledger, id, hash, amount < 0) >= 0))
+        return TELEBOT_ERROR_NONE;
+
+    size_t span = TELEBOT_LEDGER_ALIGN(sizeof(telebot_ledger_record_t) + id_size);
+    char *buffer = calloc(1, span);
+    char *_id = strdup(id);
+    if ((buffer == NULL) || (_id == NULL))
+    {
+        free(buffer);
+        free(_id);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    telebot_ledger_record_t *record = (telebot_ledger_record_t *)buffer;
+    record->id_size = id_size;
+    record->source = source;
+    record->date = date;
+    record->amount = amount;
+    memcpy(record + 1, id, id_size);
+
+    telebot_error_e ret = telebot_ledger_write(ledger->fd, buffer, span, ledger->size);
+    free(buffer);
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        ERR("Failed to append transaction %s to ledger", id);
+        free(_id);
+        return ret;
+    }
+
+    ret = telebot_ledger_insert(ledger, _id, hash, date, amount, source);
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        free(_id);
+        return ret;
+    }
+
+    ledger->size += span;
+    *added = true;
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_ledger_load(telebot_ledger_t *ledger, const char *path, off_t file_size)
+{
+    telebot_ledger_header_t header;
+    if ((file_size < (off_t)sizeof(header)) ||
+        (pread(ledger->fd, &header, sizeof(header), 0) != sizeof(header)) ||
+        (header.magic != TELEBOT_LEDGER_MAGIC) || (header.version != TELEBOT_LEDGER_VERSION))
+    {
+        ERR("Ledger '%s' is corrupted or has unsupported format", path);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+    ledger->checkpoint = header.checkpoint;
+
+    size_t size = file_size - sizeof(header);
+    char *data = malloc(size + 1);
+    if (data == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    size_t loaded = 0;
+    while (loaded < size)
+    {
+        ssize_t count = pread(ledger->fd, data + loaded, size - loaded, sizeof(header) + loaded);
+        if (count <= 0)
+            break;
+        loaded += count;
+    }
+
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    size_t pos = 0;
+    while ((ret == TELEBOT_ERROR_NONE) && (pos + sizeof(telebot_ledger_record_t) <= loaded))
+    {
+        telebot_ledger_record_t *record = (telebot_ledger_record_t *)(data + pos);
+        size_t span = TELEBOT_LEDGER_ALIGN(sizeof(telebot_ledger_record_t) + record->id_size);
+        if ((record->id_size == 0) || (pos + span > loaded))
+            break;
+
+        char *id = strndup((char *)(record + 1), record->id_size);
+        if (id == NULL)
+        {
+            ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+            break;
+        }
+
+        ret = telebot_ledger_insert(ledger, id, telebot_ledger_hash(id, record->amount < 0), record->date,
+                                    record->amount, record->source);
+        if (ret != TELEBOT_ERROR_NONE)
+            free(id);
+        pos += span;
+    }
+    free(data);
+
+    ledger->size = sizeof(header) + pos;
+    if ((ret == TELEBOT_ERROR_NONE) && (ledger->size != file_size))
+    {
+        ERR("Ledger '%s' has incomplete record, it is dropped", path);
+        if (ftruncate(ledger->fd, ledger->size) != 0)
+            ret = TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    return ret;
+}
+
+telebot_error_e telebot_ledger_open(telebot_ledger_t **ledger, const char *path)
+{
+    if ((ledger == NULL) || (path == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *ledger = NULL;
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0)
+    {
+        ERR("Failed to open ledger '%s'", path);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ERR("Failed to stat ledger '%s'", path);
+        close(fd);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    telebot_ledger_t *_ledger = calloc(1, sizeof(telebot_ledger_t));
+    if (_ledger == NULL)
+    {
+        close(fd);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+    _ledger->fd = fd;
+    pthread_mutex_init(&(_ledger->lock), NULL);
+    pthread_mutex_init(&(_ledger->sync_lock), NULL);
+
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    if (st.st_size == 0)
+    {
+        telebot_ledger_header_t header = {
+            .magic = TELEBOT_LEDGER_MAGIC,
+            .version = TELEBOT_LEDGER_VERSION,
+            .checkpoint = 0,
+        };
+        ret = telebot_ledger_write(fd, &header, sizeof(header), 0);
+        if ((ret == TELEBOT_ERROR_NONE) && (fdatasync(fd) != 0))
+            ret = TELEBOT_ERROR_OPERATION_FAILED;
+        _ledger->size = sizeof(header);
+    }
+    else
+    {
+        ret = telebot_ledger_load(_ledger, path, st.st_size);
+    }
+
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        telebot_ledger_close(_ledger);
+        return ret;
+    }
+
+    DBG("Ledger opened, %d transactions", _ledger->count);
+
+    *ledger = _ledger;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_ledger_close(telebot_ledger_t *ledger)
+{
+    if (ledger == NULL)
+        return;
+
+    fdatasync(ledger->fd);
+    close(ledger->fd);
+    for (int i = 0; i < ledger->count; i++)
+        free(ledger->items[i].id);
+    free(ledger->items);
+    free(ledger->buckets);
+    free(ledger->order);
+    free(ledger->prefix);
+    free(ledger->prefix_in);
+    pthread_mutex_destroy(&(ledger->sync_lock));
+    pthread_mutex_destroy(&(ledger->lock));
+    free(ledger);
+}
+
+/* Get payment in Telegram Stars of a service message */
+static bool telebot_ledger_get_payment(struct json_object *message, const char *name, const char **id,
+                                       int64_t *stars)
+{
+    struct json_object *payment = NULL, *currency = NULL, *charge_id = NULL, *total_amount = NULL;
+    if (!json_object_object_get_ex(message, name, &payment) ||
+        !json_object_object_get_ex(payment, "currency", &currency) ||
+        strcmp(json_object_get_string(currency), "XTR") ||
+        !json_object_object_get_ex(payment, "telegram_payment_charge_id", &charge_id) ||
+        !json_object_object_get_ex(payment, "total_amount", &total_amount))
+        return false;
+
+    *id = json_object_get_string(charge_id);
+    *stars = json_object_get_int64(total_amount);
+    return (*id != NULL);
+}
+
+void telebot_ledger_add_updates(telebot_ledger_t *ledger, struct json_object *updates)
+{
+    if ((ledger == NULL) || (updates == NULL))
+        return;
+
+    bool dirty = false;
+    int array_len = json_object_array_length(updates);
+
+    pthread_mutex_lock(&(ledger->lock));
+    for (int index = 0; index < array_len; index++)
+    {
+        struct json_object *message = NULL, *date = NULL;
+        struct json_object *item = json_object_array_get_idx(updates, index);
+        if (!json_object_object_get_ex(item, "message", &message))
+            continue;
+
+        const char *id = NULL;
+        int64_t stars = 0, amount = 0;
+        telebot_star_ledger_source_e source = TELEBOT_STAR_LEDGER_PAYMENT;
+        if (telebot_ledger_get_payment(message, "successful_payment", &id, &stars))
+        {
+            amount = stars * TELEBOT_NANOSTARS_PER_STAR;
+            source = TELEBOT_STAR_LEDGER_PAYMENT;
+        }
+        else if (telebot_ledger_get_payment(message, "refunded_payment", &id, &stars))
+        {
+            amount = -stars * TELEBOT_NANOSTARS_PER_STAR;
+            source = TELEBOT_STAR_LEDGER_REFUND;
+        }
+        else
+        {
+            continue;
+        }
+
+        json_object_object_get_ex(message, "date", &date);
+        bool added = false;
+        if (telebot_ledger_append(ledger, id, json_object_get_int64(date), amount, source, &added) !=
+            TELEBOT_ERROR_NONE)
+            ERR("Failed to record payment %s in ledger", id);
+        dirty |= added;
+    }
+
+    if (dirty)
+        fdatasync(ledger->fd);
+    pthread_mutex_unlock(&(ledger->lock));
+}
+
+/* Append transactions of a getStarTransactions page, count is set to the transactions in it */
+static telebot_error_e telebot_ledger_add_page(telebot_ledger_t *ledger, const char *data, int *count,
+                                               int *added)
+{
+    *count = 0;
+    struct json_object *obj = telebot_parser_str_to_obj(data);
+    if (obj == NULL)
+        return TELEBOT_ERROR_OPERATION_FAILED;
+
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    struct json_object *ok = NULL, *result = NULL, *array = NULL;
+    if (!json_object_object_get_ex(obj, "ok", &ok) || !json_object_get_boolean(ok) ||
+        !json_object_object_get_ex(obj, "result", &result) ||
+        !json_object_object_get_ex(result, "transactions", &array))
+    {
+        json_object_put(obj);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    int array_len = json_object_array_length(array);
+    pthread_mutex_lock(&(ledger->lock));
+    for (int index = 0; (ret == TELEBOT_ERROR_NONE) && (index < array_len); index++)
+    {
+        struct json_object *transaction = json_object_array_get_idx(array, index);
+        struct json_object *id = NULL, *amount = NULL, *nanostar_amount = NULL, *date = NULL;
+        if (!json_object_object_get_ex(transaction, "id", &id) ||
+            !json_object_object_get_ex(transaction, "amount", &amount))
+        {
+            ret = TELEBOT_ERROR_OPERATION_FAILED;
+            break;
+        }
+        json_object_object_get_ex(transaction, "nanostar_amount", &nanostar_amount);
+        json_object_object_get_ex(transaction, "date", &date);
+
+        /* Amounts are positive, outgoing transactions have a receiver instead of a source */
+        int64_t value = json_object_get_int64(amount) * TELEBOT_NANOSTARS_PER_STAR +
+                        json_object_get_int64(nanostar_amount);
+        if (!json_object_object_get_ex(transaction, "source", NULL) &&
+            json_object_object_get_ex(transaction, "receiver", NULL))
+            value = -value;
+
+        bool appended = false;
+        ret = telebot_ledger_append(ledger, json_object_get_string(id), json_object_get_int64(date), value,
+                                    TELEBOT_STAR_LEDGER_TRANSACTION, &appended);
+        if (appended)
+            (*added)++;
+    }
+
+    if (ret == TELEBOT_ERROR_NONE)
+    {
+        /* Records reach the disk before the checkpoint moves past them */
+        ledger->checkpoint += array_len;
+        if ((fdatasync(ledger->fd) != 0) ||
+            (telebot_ledger_write(ledger->fd, &(ledger->checkpoint), sizeof(ledger->checkpoint),
+                                  offsetof(telebot_ledger_header_t, checkpoint)) != TELEBOT_ERROR_NONE) ||
+            (fdatasync(ledger->fd) != 0))
+        {
+            ERR("Failed to save ledger checkpoint");
+            ret = TELEBOT_ERROR_OPERATION_FAILED;
+        }
+        *count = array_len;
+    }
+    pthread_mutex_unlock(&(ledger->lock));
+    json_object_put(obj);
+
+    return ret;
+}
+
+telebot_error_e telebot_enable_star_ledger(telebot_handler_t handle, const char *path)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (path == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_ledger_t *ledger = NULL;
+    telebot_error_e ret = telebot_ledger_open(&ledger, path);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_ledger_t *old = handle->ledger;
+    handle->ledger = ledger;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_ledger_close(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_disable_star_ledger(telebot_handler_t handle)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_ledger_t *old = handle->ledger;
+    handle->ledger = NULL;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_ledger_close(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_ledger_sync(telebot_ledger_t *ledger, telebot_core_handler_t core_h, int *added)
+{
+    if (ledger == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    int _added = 0;
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+
+    pthread_mutex_lock(&(ledger->sync_lock));
+    int count = TELEBOT_LEDGER_PAGE;
+    while ((ret == TELEBOT_ERROR_NONE) && (count == TELEBOT_LEDGER_PAGE))
+    {
+        pthread_mutex_lock(&(ledger->lock));
+        int offset = (int)ledger->checkpoint;
+        pthread_mutex_unlock(&(ledger->lock));
+
+        telebot_core_response_t response = telebot_core_get_star_transactions(core_h, offset, TELEBOT_LEDGER_PAGE);
+        ret = telebot_core_get_response_code(response);
+        if (ret == TELEBOT_ERROR_NONE)
+            ret = telebot_ledger_add_page(ledger, telebot_core_get_response_data(response), &count, &_added);
+        telebot_core_put_response(response);
+    }
+    pthread_mutex_unlock(&(ledger->sync_lock));
+
+    if (added != NULL)
+        *added = _added;
+
+    return ret;
+}
+
+static telebot_error_e telebot_ledger_get_balance(telebot_ledger_t *ledger, long long int *balance)
+{
+    if (ledger == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (balance == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    pthread_mutex_lock(&(ledger->lock));
+    *balance = (ledger->count > 0) ? ledger->prefix[ledger->count] : 0;
+    pthread_mutex_unlock(&(ledger->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_ledger_get_summary(telebot_ledger_t *ledger, long long int from, long long int to,
+                                                  telebot_star_ledger_summary_t *summary)
+{
+    if (ledger == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (summary == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    memset(summary, 0, sizeof(telebot_star_ledger_summary_t));
+    if (to <= from)
+        return TELEBOT_ERROR_NONE;
+
+    pthread_mutex_lock(&(ledger->lock));
+    int low = telebot_ledger_search(ledger, from, false);
+    int high = telebot_ledger_search(ledger, to, false);
+    if (high > low)
+    {
+        summary->count = high - low;
+        summary->incoming = ledger->prefix_in[high] - ledger->prefix_in[low];
+        summary->outgoing = summary->incoming - (ledger->prefix[high] - ledger->prefix[low]);
+    }
+    pthread_mutex_unlock(&(ledger->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_ledger_get_entries(telebot_ledger_t *ledger, long long int from, long long int to,
+                                                  int offset, telebot_star_ledger_entry_t *entries, int max,
+                                                  int *count)
+{
+    if (ledger == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((entries == NULL) || (count == NULL) || (offset < 0) || (max < 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *count = 0;
+    if (to <= from)
+        return TELEBOT_ERROR_NONE;
+
+    pthread_mutex_lock(&(ledger->lock));
+    int low = telebot_ledger_search(ledger, from, false);
+    int high = telebot_ledger_search(ledger, to, false);
+    for (int k = low + offset; (k < high) && (*count < max); k++)
+    {
+        telebot_ledger_item_t *item = &(ledger->items[ledger->order[k]]);
+        telebot_star_ledger_entry_t *entry = &(entries[(*count)++]);
+        entry->id = item->id;
+        entry->date = item->date;
+        entry->amount = item->amount;
+        entry->source = item->source;
+    }
+    pthread_mutex_unlock(&(ledger->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_sync_star_ledger(telebot_handler_t handle, int *added)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    /* The ledger is kept until the sync is done */
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_error_e ret = telebot_ledger_sync(handle->ledger, handle->core_h, added);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
+
+telebot_error_e telebot_get_star_ledger_balance(telebot_handler_t handle, long long int *balance)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_error_e ret = telebot_ledger_get_balance(handle->ledger, balance);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
+
+telebot_error_e telebot_get_star_ledger_summary(telebot_handler_t handle, long long int from, long long int to,
+                                                telebot_star_ledger_summary_t *summary)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_error_e ret = telebot_ledger_get_summary(handle->ledger, from, to, summary);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
+
+telebot_error_e telebot_get_star_ledger_entries(telebot_handler_t handle, long long int from, long long int to,
+                                                int offset, telebot_star_ledger_entry_t *entries, int max,
+                                                int *count)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_error_e ret = telebot_ledger_get_entries(handle->ledger, from, to, offset, entries, max, count);
+    pthread_rwlock_unlock(&(handle->lock));
+
+    return ret;
+}
@@ -0,0 +1,637 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <telebot-markup.h>
+#include <telebot-private.h>
+
+#define TELEBOT_MARKUP_BUCKETS 256
+
+typedef enum
+{
+    TELEBOT_MARKUP_KIND_NONE,
+    TELEBOT_MARKUP_KIND_INLINE_KEYBOARD,
+    TELEBOT_MARKUP_KIND_REPLY_KEYBOARD,
+    TELEBOT_MARKUP_KIND_FINISHED,
+} telebot_markup_kind_e;
+
+struct telebot_markup
+{
+    char *data;
+    size_t size;
+    size_t capacity;
+    telebot_markup_kind_e kind;
+    int rows;        /* Rows opened so far */
+    int row_buttons; /* Buttons in the open row, -1 if no row is open */
+
+    /* Reply keyboard options, written when the keyboard is complete */
+    bool is_persistent;
+    bool resize_keyboard;
+    bool one_time_keyboard;
+    bool selective;
+    char *input_field_placeholder;
+};
+
+typedef struct telebot_markup_entry
+{
+    struct telebot_markup_entry *next;     /* Next entry in the bucket */
+    struct telebot_markup_entry *lru_prev; /* Unused entries, oldest first */
+    struct telebot_markup_entry *lru_next;
+    uint64_t hash;
+    size_t len;
+    int refs;
+    char json[];
+} telebot_markup_entry_t;
+
+struct telebot_markup_cache
+{
+    pthread_mutex_t lock;
+    telebot_markup_entry_t *buckets[TELEBOT_MARKUP_BUCKETS];
+    telebot_markup_entry_t *lru_head;
+    telebot_markup_entry_t *lru_tail;
+    int unused;
+};
+
+static bool telebot_markup_reserve(telebot_markup_t markup, size_t len)
+{
+    size_t size = markup->size + len + 1;
+    if (size <= markup->capacity)
+        return true;
+
+    size_t capacity = (markup->capacity > 0) ? markup->capacity : TELEBOT_BUFFER_SECTOR;
+    while (capacity < size)
+        capacity *= 2;
+
+    char *data = realloc(markup->data, capacity);
+    if (data == NULL)
+        return false;
+
+    markup->data = data;
+    markup->capacity = capacity;
+
+    return true;
+}
+
+static bool telebot_markup_append(telebot_markup_t markup, const char *str, size_t len)
+{
+    if (!telebot_markup_reserve(markup, len))
+        return false;
+
+    memcpy(markup->data + markup->size, str, len);
+    markup->size += len;
+    markup->data[markup->size] = '\0';
+
+    return true;
+}
+
+#define telebot_markup_append_literal(markup, str) telebot_markup_append(markup, str, sizeof(str) - 1)
+
+/* Append JSON string literal with quotes */
+static bool telebot_markup_append_string(telebot_markup_t markup, const char *str)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    /* Worst case every byte becomes \u00XX */
+    size_t len = strlen(str);
+    if (!telebot_markup_reserve(markup, 6 * len + 2))
+        return false;
+
+    char *out = markup->data + markup->size;
+    *out++ = '"';
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++)
+    {
+        switch (*p)
+        {
+        case '"':
+        case '\\':
+            *out++ = '\\';
+            *out++ = *p;
+            break;
+        case '\n':
+            *out++ = '\\';
+            *out++ = 'n';
+            break;
+        case '\r':
+            *out++ = '\\';
+            *out++ = 'r';
+            break;
+        case '\t':
+            *out++ = '\\';
+            *out++ = 't';
+            break;
+        default:
+            if (*p < 0x20)
+            {
+                memcpy(out, "\\u00", 4);
+                out += 4;
+                *out++ = hex[*p >> 4];
+                *out++ = hex[*p & 0x0F];
+            }
+            else
+            {
+                *out++ = *p;
+            }
+        }
+    }
+    *out++ = '"';
+    markup->size = out - markup->data;
+    markup->data[markup->size] = '\0';
+
+    return true;
+}
+
+/* Append "key":"value" member, preceded by a comma */
+static bool telebot_markup_append_member(telebot_markup_t markup, const char *key, const char *value)
+{
+    return telebot_markup_append_literal(markup, ",") && telebot_markup_append_string(markup, key) &&
+           telebot_markup_append_literal(markup, ":") && telebot_markup_append_string(markup, value);
+}
+
+static bool telebot_markup_append_flag(telebot_markup_t markup, const char *key, bool value)
+{
+    if (!value)
+        return true;
+
+    return telebot_markup_append_literal(markup, ",") && telebot_markup_append_string(markup, key) &&
+           telebot_markup_append_literal(markup, ":true");
+}
+
+telebot_error_e telebot_markup_create(telebot_markup_t *markup)
+{
+    if (markup == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *markup = calloc(1, sizeof(struct telebot_markup));
+    if (*markup == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_destroy(telebot_markup_t markup)
+{
+    if (markup == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    TELEBOT_SAFE_FREE(markup->data);
+    TELEBOT_SAFE_FREE(markup->input_field_placeholder);
+    free(markup);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_reset(telebot_markup_t markup)
+{
+    if (markup == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    markup->size = 0;
+    if (markup->data != NULL)
+        markup->data[0] = '\0';
+    markup->kind = TELEBOT_MARKUP_KIND_NONE;
+    markup->rows = 0;
+    markup->row_buttons = -1;
+    markup->is_persistent = false;
+    markup->resize_keyboard = false;
+    markup->one_time_keyboard = false;
+    markup->selective = false;
+    TELEBOT_SAFE_FREE(markup->input_field_placeholder);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_inline_keyboard(telebot_markup_t markup)
+{
+    if ((markup == NULL) || (markup->kind != TELEBOT_MARKUP_KIND_NONE))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    if (!telebot_markup_append_literal(markup, "{\"inline_keyboard\":["))
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    markup->kind = TELEBOT_MARKUP_KIND_INLINE_KEYBOARD;
+    markup->rows = 0;
+    markup->row_buttons = -1;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_reply_keyboard(telebot_markup_t markup, bool is_persistent, bool resize_keyboard,
+                                              bool one_time_keyboard, const char *input_field_placeholder,
+                                              bool selective)
+{
+    if ((markup == NULL) || (markup->kind != TELEBOT_MARKUP_KIND_NONE))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    if (input_field_placeholder != NULL)
+    {
+        markup->input_field_placeholder = strdup(input_field_placeholder);
+        if (markup->input_field_placeholder == NULL)
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (!telebot_markup_append_literal(markup, "{\"keyboard\":["))
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    markup->kind = TELEBOT_MARKUP_KIND_REPLY_KEYBOARD;
+    markup->rows = 0;
+    markup->row_buttons = -1;
+    markup->is_persistent = is_persistent;
+    markup->resize_keyboard = resize_keyboard;
+    markup->one_time_keyboard = one_time_keyboard;
+    markup->selective = selective;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_force_reply(telebot_markup_t markup, const char *input_field_placeholder,
+                                           bool selective)
+{
+    if ((markup == NULL) || (markup->kind != TELEBOT_MARKUP_KIND_NONE))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    if (!telebot_markup_append_literal(markup, "{\"force_reply\":true") ||
+        ((input_field_placeholder != NULL) &&
+         !telebot_markup_append_member(markup, "input_field_placeholder", input_field_placeholder)) ||
+        !telebot_markup_append_flag(markup, "selective", selective) ||
+        !telebot_markup_append_literal(markup, "}"))
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    markup->kind = TELEBOT_MARKUP_KIND_FINISHED;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_remove_keyboard(telebot_markup_t markup, bool selective)
+{
+    if ((markup == NULL) || (markup->kind != TELEBOT_MARKUP_KIND_NONE))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    if (!telebot_markup_append_literal(markup, "{\"remove_keyboard\":true") ||
+        !telebot_markup_append_flag(markup, "selective", selective) ||
+        !telebot_markup_append_literal(markup, "}"))
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    markup->kind = TELEBOT_MARKUP_KIND_FINISHED;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_row(telebot_markup_t markup)
+{
+    if ((markup == NULL) || ((markup->kind != TELEBOT_MARKUP_KIND_INLINE_KEYBOARD) &&
+                             (markup->kind != TELEBOT_MARKUP_KIND_REPLY_KEYBOARD)))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    /* Rows are opened by their first button, so empty rows are never written */
+    if (markup->row_buttons < 0)
+        return TELEBOT_ERROR_NONE;
+
+    if (!telebot_markup_append_literal(markup, "]"))
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    markup->row_buttons = -1;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+/* Open button object with its text, the caller appends members and closes it */
+static telebot_error_e telebot_markup_begin_button(telebot_markup_t markup, telebot_markup_kind_e kind,
+                                                   const char *text)
+{
+    if ((markup == NULL) || (text == NULL) || (markup->kind != kind))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    if (markup->row_buttons < 0)
+    {
+        if (((markup->rows > 0) && !telebot_markup_append_literal(markup, ",")) ||
+            !telebot_markup_append_literal(markup, "["))
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        markup->rows++;
+        markup->row_buttons = 0;
+    }
+
+    if (((markup->row_buttons > 0) && !telebot_markup_append_literal(markup, ",")) ||
+        !telebot_markup_append_literal(markup, "{\"text\":") ||
+        !telebot_markup_append_string(markup, text))
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    markup->row_buttons++;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_markup_end_button(telebot_markup_t markup, bool ok)
+{
+    if (!ok || !telebot_markup_append_literal(markup, "}"))
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_callback_button(telebot_markup_t markup, const char *text, const char *callback_data)
+{
+    if (callback_data == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_error_e ret = telebot_markup_begin_button(markup, TELEBOT_MARKUP_KIND_INLINE_KEYBOARD, text);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    return telebot_markup_end_button(markup, telebot_markup_append_member(markup, "callback_data", callback_data));
+}
+
+telebot_error_e telebot_markup_url_button(telebot_markup_t markup, const char *text, const char *url)
+{
+    if (url == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_error_e ret = telebot_markup_begin_button(markup, TELEBOT_MARKUP_KIND_INLINE_KEYBOARD, text);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    return telebot_markup_end_button(markup, telebot_markup_append_member(markup, "url", url));
+}
+
+telebot_error_e telebot_markup_web_app_button(telebot_markup_t markup, const char *text, const char *url)
+{
+    if ((markup == NULL) || (url == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    /* Web App buttons are allowed in both kinds of keyboards */
+    telebot_markup_kind_e kind = markup->kind;
+    if (kind != TELEBOT_MARKUP_KIND_REPLY_KEYBOARD)
+        kind = TELEBOT_MARKUP_KIND_INLINE_KEYBOARD;
+
+    telebot_error_e ret = telebot_markup_begin_button(markup, kind, text);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    return telebot_markup_end_button(markup, telebot_markup_append_literal(markup, ",\"web_app\":{") &&
+                                                 telebot_markup_append_string(markup, "url") &&
+                                                 telebot_markup_append_literal(markup, ":") &&
+                                                 telebot_markup_append_string(markup, url) &&
+                                                 telebot_markup_append_literal(markup, "}"));
+}
+
+telebot_error_e telebot_markup_switch_inline_button(telebot_markup_t markup, const char *text, const char *query,
+                                                    bool current_chat)
+{
+    telebot_error_e ret = telebot_markup_begin_button(markup, TELEBOT_MARKUP_KIND_INLINE_KEYBOARD, text);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    const char *key = current_chat ? "switch_inline_query_current_chat" : "switch_inline_query";
+    return telebot_markup_end_button(markup, telebot_markup_append_member(markup, key, query ? query : ""));
+}
+
+telebot_error_e telebot_markup_copy_text_button(telebot_markup_t markup, const char *text, const char *copy_text)
+{
+    if (copy_text == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_error_e ret = telebot_markup_begin_button(markup, TELEBOT_MARKUP_KIND_INLINE_KEYBOARD, text);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    return telebot_markup_end_button(markup, telebot_markup_append_literal(markup, ",\"copy_text\":{\"text\":") &&
+                                                 telebot_markup_append_string(markup, copy_text) &&
+                                                 telebot_markup_append_literal(markup, "}"));
+}
+
+telebot_error_e telebot_markup_pay_button(telebot_markup_t markup, const char *text)
+{
+    telebot_error_e ret = telebot_markup_begin_button(markup, TELEBOT_MARKUP_KIND_INLINE_KEYBOARD, text);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    return telebot_markup_end_button(markup, telebot_markup_append_flag(markup, "pay", true));
+}
+
+telebot_error_e telebot_markup_text_button(telebot_markup_t markup, const char *text, bool request_contact,
+                                           bool request_location)
+{
+    telebot_error_e ret = telebot_markup_begin_button(markup, TELEBOT_MARKUP_KIND_REPLY_KEYBOARD, text);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    return telebot_markup_end_button(markup, telebot_markup_append_flag(markup, "request_contact", request_contact) &&
+                                                 telebot_markup_append_flag(markup, "request_location",
+                                                                            request_location));
+}
+
+/* Close the keyboard and write its options */
+static telebot_error_e telebot_markup_finish(telebot_markup_t markup)
+{
+    if (((markup->kind == TELEBOT_MARKUP_KIND_INLINE_KEYBOARD) ||
+         (markup->kind == TELEBOT_MARKUP_KIND_REPLY_KEYBOARD)) &&
+        (telebot_markup_row(markup) != TELEBOT_ERROR_NONE))
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    switch (markup->kind)
+    {
+    case TELEBOT_MARKUP_KIND_INLINE_KEYBOARD:
+        if (!telebot_markup_append_literal(markup, "]}"))
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        break;
+    case TELEBOT_MARKUP_KIND_REPLY_KEYBOARD:
+        if (!telebot_markup_append_literal(markup, "]") ||
+            !telebot_markup_append_flag(markup, "is_persistent", markup->is_persistent) ||
+            !telebot_markup_append_flag(markup, "resize_keyboard", markup->resize_keyboard) ||
+            !telebot_markup_append_flag(markup, "one_time_keyboard", markup->one_time_keyboard) ||
+            ((markup->input_field_placeholder != NULL) &&
+             !telebot_markup_append_member(markup, "input_field_placeholder", markup->input_field_placeholder)) ||
+            !telebot_markup_append_flag(markup, "selective", markup->selective) ||
+            !telebot_markup_append_literal(markup, "}"))
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        break;
+    case TELEBOT_MARKUP_KIND_FINISHED:
+        return TELEBOT_ERROR_NONE;
+    case TELEBOT_MARKUP_KIND_NONE:
+    default:
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+    }
+
+    markup->kind = TELEBOT_MARKUP_KIND_FINISHED;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_get_json(telebot_markup_t markup, const char **json)
+{
+    if ((markup == NULL) || (json == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_error_e ret = telebot_markup_finish(markup);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    *json = markup->data;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static void telebot_markup_lru_remove(telebot_markup_cache_t *cache, telebot_markup_entry_t *entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache->lru_head = entry->lru_next;
+
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache->lru_tail = entry->lru_prev;
+
+    entry->lru_prev = entry->lru_next = NULL;
+    cache->unused--;
+}
+
+static void telebot_markup_lru_append(telebot_markup_cache_t *cache, telebot_markup_entry_t *entry)
+{
+    entry->lru_next = NULL;
+    entry->lru_prev = cache->lru_tail;
+    if (cache->lru_tail)
+        cache->lru_tail->lru_next = entry;
+    else
+        cache->lru_head = entry;
+    cache->lru_tail = entry;
+    cache->unused++;
+}
+
+static void telebot_markup_evict(telebot_markup_cache_t *cache, telebot_markup_entry_t *entry)
+{
+    telebot_markup_lru_remove(cache, entry);
+
+    telebot_markup_entry_t **link = &(cache->buckets[entry->hash % TELEBOT_MARKUP_BUCKETS]);
+    while (*link != entry)
+        link = &((*link)->next);
+    *link = entry->next;
+
+    free(entry);
+}
+
+telebot_error_e telebot_markup_cache_create(telebot_markup_cache_t **cache)
+{
+    *cache = calloc(1, sizeof(telebot_markup_cache_t));
+    if (*cache == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    pthread_mutex_init(&((*cache)->lock), NULL);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_markup_cache_destroy(telebot_markup_cache_t *cache)
+{
+    if (cache == NULL)
+        return;
+
+    for (int i = 0; i < TELEBOT_MARKUP_BUCKETS; i++)
+    {
+        telebot_markup_entry_t *entry = cache->buckets[i];
+        while (entry != NULL)
+        {
+            telebot_markup_entry_t *next = entry->next;
+            free(entry);
+            entry = next;
+        }
+    }
+    pthread_mutex_destroy(&(cache->lock));
+    free(cache);
+}
+
+telebot_error_e telebot_markup_share(telebot_handler_t handle, telebot_markup_t markup, const char **json)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    const char *data = NULL;
+    telebot_error_e ret = telebot_markup_get_json(markup, &data);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    telebot_markup_cache_t *cache = handle->markups;
+    uint64_t hash = telebot_hash_bytes(TELEBOT_HASH_SEED, data, markup->size);
+    telebot_markup_entry_t **bucket = &(cache->buckets[hash % TELEBOT_MARKUP_BUCKETS]);
+
+    pthread_mutex_lock(&(cache->lock));
+    telebot_markup_entry_t *entry = *bucket;
+    while ((entry != NULL) && ((entry->hash != hash) || (entry->len != markup->size) ||
+                               (memcmp(entry->json, data, entry->len) != 0)))
+        entry = entry->next;
+
+    if (entry == NULL)
+    {
+        entry = malloc(sizeof(telebot_markup_entry_t) + markup->size + 1);
+        if (entry == NULL)
+        {
+            pthread_mutex_unlock(&(cache->lock));
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        }
+        entry->hash = hash;
+        entry->len = markup->size;
+        entry->refs = 0;
+        entry->lru_prev = entry->lru_next = NULL;
+        memcpy(entry->json, data, markup->size + 1);
+        entry->next = *bucket;
+        *bucket = entry;
+    }
+    else if (entry->refs == 0)
+    {
+        telebot_markup_lru_remove(cache, entry);
+    }
+
+    entry->refs++;
+    *json = entry->json;
+    pthread_mutex_unlock(&(cache->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_markup_release(telebot_handler_t handle, const char *json)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    telebot_markup_cache_t *cache = handle->markups;
+    if ((json == NULL) || (cache == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    size_t len = strlen(json);
+    uint64_t hash = telebot_hash_bytes(TELEBOT_HASH_SEED, json, len);
+
+    pthread_mutex_lock(&(cache->lock));
+    telebot_markup_entry_t *entry = cache->buckets[hash % TELEBOT_MARKUP_BUCKETS];
+    while ((entry != NULL) && (entry->json != json))
+        entry = entry->next;
+
+    if ((entry == NULL) || (entry->refs == 0))
+    {
+        pthread_mutex_unlock(&(cache->lock));
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+    }
+
+    if (--entry->refs == 0)
+    {
+        telebot_markup_lru_append(cache, entry);
+        if (cache->unused > TELEBOT_MARKUP_CACHE_SIZE)
+            telebot_markup_evict(cache, cache->lru_head);
+    }
+    pthread_mutex_unlock(&(cache->lock));
+
+    return TELEBOT_ERROR_NONE;
+}
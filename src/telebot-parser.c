@@ -18,7 +18,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
+#include <pthread.h>
 #include <json.h>
 #include <json_object.h>
 #include <telebot-methods.h>
@@ -38,6 +41,269 @@ static const char *telebot_update_type_str[TELEBOT_UPDATE_TYPE_MAX] = {
     "chat_member", "chat_join_request",
     "chat_boost", "removed_chat_boost"};
 
+/* Values of enumerated string fields, index 0 is the unknown value */
+static const char *const telebot_chat_type_str[TELEBOT_CHAT_TYPE_MAX] = {
+    NULL, "private", "group", "supergroup", "channel"};
+
+static const char *const telebot_message_entity_type_str[TELEBOT_MESSAGE_ENTITY_TYPE_MAX] = {
+    NULL, "mention", "hashtag", "cashtag", "bot_command", "url", "email",
+    "phone_number", "bold", "italic", "underline", "strikethrough", "spoiler",
+    "blockquote", "expandable_blockquote", "code", "pre", "text_link",
+    "text_mention", "custom_emoji"};
+
+static const char *const telebot_reaction_type_str[TELEBOT_REACTION_TYPE_MAX] = {
+    NULL, "emoji", "custom_emoji", "paid"};
+
+static const char *const telebot_chat_member_status_str[TELEBOT_CHAT_MEMBER_STATUS_MAX] = {
+    NULL, "creator", "administrator", "member", "restricted", "left", "kicked"};
+
+static const char *const telebot_poll_type_str[] = {NULL, "regular", "quiz"};
+
+#define TELEBOT_INTERN_ENUM(obj, table, interned) \
+    telebot_intern_enum(json_object_get_string(obj), table, sizeof(table) / sizeof(table[0]), interned)
+
+#define TELEBOT_PARSER_SHARED_INITIAL_CAPACITY 32
+
+/*
+ * Shared users or chats of a getUpdates batch by id, each holding a reference.
+ * An object is shared only with occurrences whose JSON is identical to its own,
+ * so a sparse occurrence never stands in for a fuller one of the same id.
+ */
+typedef struct telebot_parser_shared_table
+{
+    long long int *ids;
+    void **objects; /* telebot_user_ref_t or telebot_chat_ref_t */
+    struct json_object **sources; /* JSON each object was parsed from, owned by the batch reply */
+    size_t capacity; /* Power of two, kept at most half full */
+    size_t count;
+} telebot_parser_shared_table_t;
+
+typedef struct telebot_parser_batch
+{
+    telebot_parser_shared_table_t users;
+    telebot_parser_shared_table_t chats;
+} telebot_parser_batch_t;
+
+/* Nested parsers have fixed signatures, so they find the batch being parsed here */
+static __thread telebot_parser_batch_t *telebot_parser_batch;
+
+#define TELEBOT_PARSER_ARENA_CHUNK_SIZE (16 * 1024)
+#define TELEBOT_PARSER_ARENA_ALIGN 16
+
+/* Chunk of the arena update payloads of a getUpdates batch are allocated from */
+typedef struct telebot_parser_arena_chunk
+{
+    struct telebot_parser_arena_chunk *next;
+    size_t size; /* Usable bytes of data */
+    size_t used;
+    char data[] __attribute__((aligned(TELEBOT_PARSER_ARENA_ALIGN)));
+} telebot_parser_arena_chunk_t;
+
+/* Allocation behind the update array returned by telebot_parser_get_updates() */
+typedef struct telebot_parser_update_block
+{
+    telebot_parser_arena_chunk_t *chunks;
+    size_t payload_bytes;
+    int count;
+    telebot_update_t updates[];
+} telebot_parser_update_block_t;
+
+/* Payload sizes by update type, the inline union used to take the largest for every update */
+static const size_t telebot_parser_update_payload_size[TELEBOT_UPDATE_TYPE_MAX] = {
+    [TELEBOT_UPDATE_TYPE_MESSAGE] = sizeof(telebot_message_t),
+    [TELEBOT_UPDATE_TYPE_EDITED_MESSAGE] = sizeof(telebot_message_t),
+    [TELEBOT_UPDATE_TYPE_CHANNEL_POST] = sizeof(telebot_message_t),
+    [TELEBOT_UPDATE_TYPE_EDITED_CHANNEL_POST] = sizeof(telebot_message_t),
+    [TELEBOT_UPDATE_TYPE_BUSINESS_CONNECTION] = sizeof(telebot_business_connection_t),
+    [TELEBOT_UPDATE_TYPE_BUSINESS_MESSAGE] = sizeof(telebot_message_t),
+    [TELEBOT_UPDATE_TYPE_EDITED_BUSINESS_MESSAGE] = sizeof(telebot_message_t),
+    [TELEBOT_UPDATE_TYPE_DELETED_BUSINESS_MESSAGES] = sizeof(telebot_business_messages_deleted_t),
+    [TELEBOT_UPDATE_TYPE_MESSAGE_REACTION] = sizeof(telebot_message_reaction_updated_t),
+    [TELEBOT_UPDATE_TYPE_MESSAGE_REACTION_COUNT] = sizeof(telebot_message_reaction_count_updated_t),
+    [TELEBOT_UPDATE_TYPE_INLINE_QUERY] = sizeof(telebot_inline_query_t),
+    [TELEBOT_UPDATE_TYPE_CHOSEN_INLINE_RESULT] = sizeof(telebot_chosen_inline_result_t),
+    [TELEBOT_UPDATE_TYPE_CALLBACK_QUERY] = sizeof(telebot_callback_query_t),
+    [TELEBOT_UPDATE_TYPE_SHIPPING_QUERY] = sizeof(telebot_shipping_query_t),
+    [TELEBOT_UPDATE_TYPE_PRE_CHECKOUT_QUERY] = sizeof(telebot_pre_checkout_query_t),
+    [TELEBOT_UPDATE_TYPE_PURCHASED_PAID_MEDIA] = sizeof(telebot_paid_media_purchased_t),
+    [TELEBOT_UPDATE_TYPE_POLL] = sizeof(telebot_poll_t),
+    [TELEBOT_UPDATE_TYPE_POLL_ANSWER] = sizeof(telebot_poll_answer_t),
+    [TELEBOT_UPDATE_TYPE_MY_CHAT_MEMBER] = sizeof(telebot_chat_member_updated_t),
+    [TELEBOT_UPDATE_TYPE_CHAT_MEMBER] = sizeof(telebot_chat_member_updated_t),
+    [TELEBOT_UPDATE_TYPE_CHAT_JOIN_REQUEST] = sizeof(telebot_chat_join_request_t),
+    [TELEBOT_UPDATE_TYPE_CHAT_BOOST] = sizeof(telebot_chat_boost_updated_t),
+    [TELEBOT_UPDATE_TYPE_REMOVED_CHAT_BOOST] = sizeof(telebot_chat_boost_removed_t),
+};
+
+static void *telebot_parser_arena_alloc(telebot_parser_update_block_t *block, size_t size)
+{
+    size = (size + TELEBOT_PARSER_ARENA_ALIGN - 1) & ~(size_t)(TELEBOT_PARSER_ARENA_ALIGN - 1);
+
+    telebot_parser_arena_chunk_t *chunk = block->chunks;
+    if ((chunk == NULL) || (chunk->size - chunk->used < size))
+    {
+        size_t chunk_size = (size > TELEBOT_PARSER_ARENA_CHUNK_SIZE) ? size : TELEBOT_PARSER_ARENA_CHUNK_SIZE;
+        chunk = malloc(sizeof(telebot_parser_arena_chunk_t) + chunk_size);
+        if (chunk == NULL)
+            return NULL;
+
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        /* An oversized chunk is full, keep filling the current one */
+        if ((block->chunks != NULL) && (chunk_size > TELEBOT_PARSER_ARENA_CHUNK_SIZE))
+        {
+            chunk->next = block->chunks->next;
+            block->chunks->next = chunk;
+        }
+        else
+        {
+            chunk->next = block->chunks;
+            block->chunks = chunk;
+        }
+    }
+
+    void *ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    block->payload_bytes += size;
+    memset(ptr, 0, size);
+
+    return ptr;
+}
+
+static size_t telebot_parser_shared_slot(long long int id, size_t capacity)
+{
+    return (size_t)(((uint64_t)id * 0x9E3779B97F4A7C15ULL) >> 32) & (capacity - 1);
+}
+
+static void *telebot_parser_shared_find(const telebot_parser_shared_table_t *table, long long int id,
+                                        struct json_object *source)
+{
+    if (table->count == 0)
+        return NULL;
+
+    size_t mask = table->capacity - 1;
+    for (size_t slot = telebot_parser_shared_slot(id, table->capacity); table->objects[slot] != NULL;
+         slot = (slot + 1) & mask)
+    {
+        if (table->ids[slot] == id)
+            return json_object_equal(table->sources[slot], source) ? table->objects[slot] : NULL;
+    }
+
+    return NULL;
+}
+
+/* Keeps the first object of an id, later differing ones stay unshared */
+static bool telebot_parser_shared_insert(telebot_parser_shared_table_t *table, long long int id, void *object,
+                                         struct json_object *source)
+{
+
+    if (2 * (table->count + 1) > table->capacity)
+    {
+        size_t capacity = table->capacity ? 2 * table->capacity : TELEBOT_PARSER_SHARED_INITIAL_CAPACITY;
+        long long int *ids = calloc(capacity, sizeof(long long int));
+        void **objects = calloc(capacity, sizeof(void *));
+        struct json_object **sources = calloc(capacity, sizeof(struct json_object *));
+        if ((ids == NULL) || (objects == NULL) || (sources == NULL))
+        {
+            free(ids);
+            free(objects);
+            free(sources);
+            return false;
+        }
+
+        for (size_t i = 0; i < table->capacity; i++)
+        {
+            if (table->objects[i] == NULL)
+                continue;
+
+            size_t slot = telebot_parser_shared_slot(table->ids[i], capacity);
+            while (objects[slot] != NULL)
+                slot = (slot + 1) & (capacity - 1);
+            ids[slot] = table->ids[i];
+            objects[slot] = table->objects[i];
+            sources[slot] = table->sources[i];
+        }
+
+        free(table->ids);
+        free(table->objects);
+        free(table->sources);
+        table->ids = ids;
+        table->objects = objects;
+        table->sources = sources;
+        table->capacity = capacity;
+    }
+
+    size_t slot = telebot_parser_shared_slot(id, table->capacity);
+    while (table->objects[slot] != NULL)
+    {
+        if (table->ids[slot] == id)
+            return false;
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+    table->ids[slot] = id;
+    table->objects[slot] = object;
+    table->sources[slot] = source;
+    table->count++;
+
+    return true;
+}
+
+/* Drop references of the batch, updates keep theirs */
+static void telebot_parser_batch_release(telebot_parser_batch_t *batch)
+{
+    for (size_t i = 0; i < batch->users.capacity; i++)
+    {
+        telebot_user_ref_t *shared = batch->users.objects[i];
+        if (shared != NULL)
+            telebot_put_user_ref(&(shared->user));
+    }
+
+    for (size_t i = 0; i < batch->chats.capacity; i++)
+    {
+        telebot_chat_ref_t *shared = batch->chats.objects[i];
+        if (shared != NULL)
+            telebot_put_chat_ref(&(shared->chat));
+    }
+
+    free(batch->users.ids);
+    free(batch->users.objects);
+    free(batch->users.sources);
+    free(batch->chats.ids);
+    free(batch->chats.objects);
+    free(batch->chats.sources);
+}
+
+/*
+ * Perfect hash of the update type keys above: first character plus 19 times
+ * the length, modulo 64. Slots hold type + 1, zero marks an empty slot. The
+ * table is built from the keys on first use, which checks the hash is still
+ * collision free; if a new key collides, lookups fall back to a linear search.
+ */
+#define TELEBOT_UPDATE_TYPE_HASH(str, len) (((unsigned char)(str)[0] + 19 * (len)) & 63)
+
+static unsigned char telebot_update_type_slot[64];
+static bool telebot_update_type_perfect;
+static pthread_once_t telebot_update_type_once = PTHREAD_ONCE_INIT;
+
+static void telebot_parser_build_update_type_slots(void)
+{
+    telebot_update_type_perfect = true;
+    for (int type = 0; type < TELEBOT_UPDATE_TYPE_MAX; type++)
+    {
+        const char *str = telebot_update_type_str[type];
+        unsigned char *slot = &(telebot_update_type_slot[TELEBOT_UPDATE_TYPE_HASH(str, strlen(str))]);
+        if (*slot != 0)
+        {
+            ERR("Update types %s and %s collide in the lookup table", str, telebot_update_type_str[*slot - 1]);
+            telebot_update_type_perfect = false;
+        }
+        *slot = type + 1;
+    }
+}
+
+static telebot_error_e telebot_parser_get_update_payload(struct json_object *obj, telebot_update_type_e type,
+                                                         telebot_error_e (*get_message)(struct json_object *, telebot_message_t *),
+                                                         telebot_update_t *update);
 static telebot_error_e telebot_parser_get_photos(struct json_object *obj, telebot_photo_t **photos, int *count);
 static telebot_error_e telebot_parser_get_users(struct json_object *obj, telebot_user_t **users, int *count);
 static telebot_error_e telebot_parser_get_business_messages_deleted(struct json_object *obj, telebot_business_messages_deleted_t *deleted);
@@ -75,243 +341,321 @@ struct json_object *telebot_parser_str_to_obj(const char *data)
         return NULL;
 }
 
-telebot_error_e telebot_parser_get_updates(struct json_object *obj, telebot_update_t **updates, int *count)
+telebot_error_e telebot_parser_get_updates(struct json_object *obj, const telebot_parser_options_t *options,
+                                           telebot_update_t **updates, int *count)
 {
     if ((obj == NULL) || (updates == NULL))
         return TELEBOT_ERROR_INVALID_PARAMETER;
 
+    telebot_error_e (*get_message)(struct json_object *, telebot_message_t *) = telebot_parser_get_message;
+    if ((options != NULL) && options->lazy)
+        get_message = telebot_parser_get_message_lazy;
+
+    const telebot_filter_t *filter = (options != NULL) ? options->filter : NULL;
+    bool skip_payments = (options != NULL) && options->skip_payments;
+
     struct json_object *array = obj;
     int array_len = json_object_array_length(array);
     if (!array_len)
         return TELEBOT_ERROR_OPERATION_FAILED;
 
-    telebot_update_t *result = calloc(array_len, sizeof(telebot_update_t));
-    if (result == NULL)
+    telebot_parser_update_block_t *block = calloc(1, sizeof(telebot_parser_update_block_t) +
+                                                     array_len * sizeof(telebot_update_t));
+    if (block == NULL)
         return TELEBOT_ERROR_OUT_OF_MEMORY;
 
-    *count = array_len;
+    telebot_update_t *result = block->updates;
+    *count = 0;
     *updates = result;
 
-    for (int index = 0; index < array_len; index++)
-    {
-        struct json_object *item = json_object_array_get_idx(array, index);
-
-        struct json_object *update_id = NULL;
-        if (json_object_object_get_ex(item, "update_id", &update_id))
-        {
-            result[index].update_id = json_object_get_int(update_id);
-        }
+    telebot_parser_batch_t batch = {0};
+    telebot_parser_batch = &batch;
 
-        struct json_object *message = NULL;
-        if (json_object_object_get_ex(item, "message", &message))
-        {
-            if (telebot_parser_get_message(message, &(result[index].message)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse message of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_MESSAGE;
+    for (int i = 0; i < array_len; i++)
+    {
+        struct json_object *item = json_object_array_get_idx(array, i);
+        if ((filter != NULL) && !telebot_filter_match(filter, item))
             continue;
-        }
 
-        struct json_object *edited_message = NULL;
-        if (json_object_object_get_ex(item, "edited_message", &edited_message))
-        {
-            if (telebot_parser_get_message(edited_message, &(result[index].edited_message)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse edited message of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_EDITED_MESSAGE;
+        /* Handed to the payment lane instead */
+        if (skip_payments && (json_object_object_get_ex(item, "pre_checkout_query", NULL) ||
+                              json_object_object_get_ex(item, "shipping_query", NULL)))
             continue;
-        }
 
-        struct json_object *channel_post = NULL;
-        if (json_object_object_get_ex(item, "channel_post", &channel_post))
-        {
-            if (telebot_parser_get_message(channel_post, &(result[index].channel_post)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse channel post of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_CHANNEL_POST;
-            continue;
-        }
+        int index = (*count)++;
+        result[index].update_type = TELEBOT_UPDATE_TYPE_MAX;
 
-        struct json_object *edited_channel_post = NULL;
-        if (json_object_object_get_ex(item, "edited_channel_post", &edited_channel_post))
+        /* An update has update_id and a single key naming its type */
+        struct json_object_iterator it = json_object_iter_begin(item);
+        struct json_object_iterator end = json_object_iter_end(item);
+        for (; !json_object_iter_equal(&it, &end); json_object_iter_next(&it))
         {
-            if (telebot_parser_get_message(edited_channel_post, &(result[index].edited_channel_post)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse edited channel post of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_EDITED_CHANNEL_POST;
-            continue;
-        }
+            const char *name = json_object_iter_peek_name(&it);
+            struct json_object *value = json_object_iter_peek_value(&it);
+            if (strcmp(name, "update_id") == 0)
+            {
+                result[index].update_id = json_object_get_int(value);
+                continue;
+            }
 
-        struct json_object *business_connection = NULL;
-        if (json_object_object_get_ex(item, "business_connection", &business_connection))
-        {
-            if (telebot_parser_get_business_connection(business_connection, &(result[index].business_connection)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse business_connection of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_BUSINESS_CONNECTION;
-            continue;
-        }
+            telebot_update_type_e type = telebot_parser_get_update_type_from_str(name);
+            if (type == TELEBOT_UPDATE_TYPE_MAX)
+                continue;
 
-        struct json_object *business_message = NULL;
-        if (json_object_object_get_ex(item, "business_message", &business_message))
-        {
-            if (telebot_parser_get_message(business_message, &(result[index].business_message)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse business_message of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_BUSINESS_MESSAGE;
-            continue;
-        }
+            result[index].payload = telebot_parser_arena_alloc(block, telebot_parser_update_payload_size[type]);
+            if (result[index].payload == NULL)
+            {
+                ERR("Failed to allocate %s of bot update", name);
+                continue;
+            }
 
-        struct json_object *edited_business_message = NULL;
-        if (json_object_object_get_ex(item, "edited_business_message", &edited_business_message))
-        {
-            if (telebot_parser_get_message(edited_business_message, &(result[index].edited_business_message)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse edited_business_message of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_EDITED_BUSINESS_MESSAGE;
-            continue;
-        }
+            if (telebot_parser_get_update_payload(value, type, get_message, &(result[index])) != TELEBOT_ERROR_NONE)
+                ERR("Failed to parse %s of bot update", name);
+            result[index].update_type = type;
 
-        struct json_object *deleted_business_messages = NULL;
-        if (json_object_object_get_ex(item, "deleted_business_messages", &deleted_business_messages))
-        {
-            if (telebot_parser_get_business_messages_deleted(deleted_business_messages, &(result[index].deleted_business_messages)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse deleted_business_messages of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_DELETED_BUSINESS_MESSAGES;
-            continue;
+            /* Replayed queries keep the time they were first received at */
+            if ((options != NULL) && (options->received != NULL))
+            {
+                if (type == TELEBOT_UPDATE_TYPE_SHIPPING_QUERY)
+                    result[index].shipping_query->received = options->received[i];
+                else if (type == TELEBOT_UPDATE_TYPE_PRE_CHECKOUT_QUERY)
+                    result[index].pre_checkout_query->received = options->received[i];
+            }
         }
+    } /* for index */
 
-        struct json_object *callback_query = NULL;
-        if (json_object_object_get_ex(item, "callback_query", &callback_query))
-        {
-            if (telebot_parser_get_callback_query(callback_query, &(result[index].callback_query)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse callback query of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_CALLBACK_QUERY;
-            continue;
-        }
+    telebot_parser_batch = NULL;
+    telebot_parser_batch_release(&batch);
 
-        struct json_object *poll = NULL;
-        if (json_object_object_get_ex(item, "poll", &poll))
-        {
-            if (telebot_parser_get_poll(poll, &(result[index].poll)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse poll of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_POLL;
-            continue;
-        }
+    block->count = *count;
+    if (*count == 0)
+    {
+        telebot_parser_free_updates(result);
+        *updates = NULL;
+    }
 
-        struct json_object *poll_answer = NULL;
-        if (json_object_object_get_ex(item, "poll_answer", &poll_answer))
-        {
-            if (telebot_parser_get_poll_answer(poll_answer, &(result[index].poll_answer)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse poll answer of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_POLL_ANSWER;
-            continue;
-        }
+    return TELEBOT_ERROR_NONE;
+}
 
-        struct json_object *my_chat_member = NULL;
-        if (json_object_object_get_ex(item, "my_chat_member", &my_chat_member))
-        {
-            if (telebot_parser_get_chat_member_updated(my_chat_member, &(result[index].my_chat_member)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse my_chat_member of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_MY_CHAT_MEMBER;
-            continue;
-        }
+void telebot_parser_free_updates(telebot_update_t *updates)
+{
+    if (updates == NULL)
+        return;
 
-        struct json_object *chat_member = NULL;
-        if (json_object_object_get_ex(item, "chat_member", &chat_member))
-        {
-            if (telebot_parser_get_chat_member_updated(chat_member, &(result[index].chat_member)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse chat_member of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_CHAT_MEMBER;
-            continue;
-        }
+    telebot_parser_update_block_t *block = (telebot_parser_update_block_t *)
+        ((char *)updates - offsetof(telebot_parser_update_block_t, updates));
+    while (block->chunks != NULL)
+    {
+        telebot_parser_arena_chunk_t *next = block->chunks->next;
+        free(block->chunks);
+        block->chunks = next;
+    }
+    free(block);
+}
 
-        struct json_object *chat_join_request = NULL;
-        if (json_object_object_get_ex(item, "chat_join_request", &chat_join_request))
-        {
-            if (telebot_parser_get_chat_join_request(chat_join_request, &(result[index].chat_join_request)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse chat_join_request of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_CHAT_JOIN_REQUEST;
-            continue;
-        }
+size_t telebot_parser_get_updates_footprint(const telebot_update_t *updates)
+{
+    if (updates == NULL)
+        return 0;
 
-        struct json_object *message_reaction = NULL;
-        if (json_object_object_get_ex(item, "message_reaction", &message_reaction))
-        {
-            if (telebot_parser_get_message_reaction_updated(message_reaction, &(result[index].message_reaction)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse message_reaction of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_MESSAGE_REACTION;
-            continue;
-        }
+    const telebot_parser_update_block_t *block = (const telebot_parser_update_block_t *)
+        ((const char *)updates - offsetof(telebot_parser_update_block_t, updates));
 
-        struct json_object *message_reaction_count = NULL;
-        if (json_object_object_get_ex(item, "message_reaction_count", &message_reaction_count))
-        {
-            if (telebot_parser_get_message_reaction_count_updated(message_reaction_count, &(result[index].message_reaction_count)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse message_reaction_count of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_MESSAGE_REACTION_COUNT;
-            continue;
-        }
+    return block->count * sizeof(telebot_update_t) + block->payload_bytes;
+}
 
-        struct json_object *chat_boost = NULL;
-        if (json_object_object_get_ex(item, "chat_boost", &chat_boost))
-        {
-            if (telebot_parser_get_chat_boost_updated(chat_boost, &(result[index].chat_boost)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse chat_boost of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_CHAT_BOOST;
-            continue;
-        }
+size_t telebot_parser_get_update_payload_size(telebot_update_type_e type)
+{
+    if ((type < 0) || (type >= TELEBOT_UPDATE_TYPE_MAX))
+        return 0;
 
-        struct json_object *chat_boost_removed = NULL;
-        if (json_object_object_get_ex(item, "removed_chat_boost", &chat_boost_removed))
-        {
-            if (telebot_parser_get_chat_boost_removed(chat_boost_removed, &(result[index].chat_boost_removed)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse chat_boost_removed of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_REMOVED_CHAT_BOOST;
-            continue;
-        }
+    return telebot_parser_update_payload_size[type];
+}
 
-        struct json_object *inline_query = NULL;
-        if (json_object_object_get_ex(item, "inline_query", &inline_query))
-        {
-            if (telebot_parser_get_inline_query(inline_query, &(result[index].inline_query)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse inline_query of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_INLINE_QUERY;
-            continue;
-        }
+telebot_error_e telebot_parser_get_user_ref(struct json_object *obj, telebot_user_t **user)
+{
+    if ((obj == NULL) || (user == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
 
-        struct json_object *chosen_inline_result = NULL;
-        if (json_object_object_get_ex(item, "chosen_inline_result", &chosen_inline_result))
+    telebot_parser_batch_t *batch = telebot_parser_batch;
+    struct json_object *id = NULL;
+    telebot_user_ref_t *shared = NULL;
+    if ((batch != NULL) && json_object_object_get_ex(obj, "id", &id))
+    {
+        shared = telebot_parser_shared_find(&(batch->users), json_object_get_int64(id), obj);
+        if (shared != NULL)
         {
-            if (telebot_parser_get_chosen_inline_result(chosen_inline_result, &(result[index].chosen_inline_result)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse chosen_inline_result of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_CHOSEN_INLINE_RESULT;
-            continue;
+            __atomic_add_fetch(&(shared->refs), 1, __ATOMIC_RELAXED);
+            *user = &(shared->user);
+            return TELEBOT_ERROR_NONE;
         }
+    }
+
+    shared = calloc(1, sizeof(telebot_user_ref_t));
+    if (shared == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    telebot_error_e ret = telebot_parser_get_user(obj, &(shared->user));
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        telebot_put_user(&(shared->user));
+        free(shared);
+        return ret;
+    }
+
+    shared->refs = 1;
+    if ((batch != NULL) && telebot_parser_shared_insert(&(batch->users), shared->user.id, shared, obj))
+        shared->refs++;
+
+    *user = &(shared->user);
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_parser_get_chat_ref(struct json_object *obj, telebot_chat_t **chat)
+{
+    if ((obj == NULL) || (chat == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
 
-        struct json_object *shipping_query = NULL;
-        if (json_object_object_get_ex(item, "shipping_query", &shipping_query))
+    telebot_parser_batch_t *batch = telebot_parser_batch;
+    struct json_object *id = NULL;
+    telebot_chat_ref_t *shared = NULL;
+    if ((batch != NULL) && json_object_object_get_ex(obj, "id", &id))
+    {
+        shared = telebot_parser_shared_find(&(batch->chats), json_object_get_int64(id), obj);
+        if (shared != NULL)
         {
-            if (telebot_parser_get_shipping_query(shipping_query, &(result[index].shipping_query)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse shipping_query of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_SHIPPING_QUERY;
-            continue;
+            __atomic_add_fetch(&(shared->refs), 1, __ATOMIC_RELAXED);
+            *chat = &(shared->chat);
+            return TELEBOT_ERROR_NONE;
         }
+    }
+
+    shared = calloc(1, sizeof(telebot_chat_ref_t));
+    if (shared == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    telebot_error_e ret = telebot_parser_get_chat(obj, &(shared->chat));
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        telebot_put_chat(&(shared->chat));
+        free(shared);
+        return ret;
+    }
+
+    shared->refs = 1;
+    if ((batch != NULL) && telebot_parser_shared_insert(&(batch->chats), shared->chat.id, shared, obj))
+        shared->refs++;
 
-        struct json_object *pre_checkout_query = NULL;
-        if (json_object_object_get_ex(item, "pre_checkout_query", &pre_checkout_query))
+    *chat = &(shared->chat);
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_update_type_e telebot_parser_get_update_type(struct json_object *update, struct json_object **payload)
+{
+    struct json_object_iterator it = json_object_iter_begin(update);
+    struct json_object_iterator end = json_object_iter_end(update);
+
+    for (; !json_object_iter_equal(&it, &end); json_object_iter_next(&it))
+    {
+        telebot_update_type_e type = telebot_parser_get_update_type_from_str(json_object_iter_peek_name(&it));
+        if (type != TELEBOT_UPDATE_TYPE_MAX)
         {
-            if (telebot_parser_get_pre_checkout_query(pre_checkout_query, &(result[index].pre_checkout_query)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse pre_checkout_query of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_PRE_CHECKOUT_QUERY;
-            continue;
+            if (payload)
+                *payload = json_object_iter_peek_value(&it);
+            return type;
         }
+    }
 
-        struct json_object *purchased_paid_media = NULL;
-        if (json_object_object_get_ex(item, "purchased_paid_media", &purchased_paid_media))
+    return TELEBOT_UPDATE_TYPE_MAX;
+}
+
+telebot_update_type_e telebot_parser_get_update_type_from_str(const char *str)
+{
+    if ((str == NULL) || (str[0] == '\0'))
+        return TELEBOT_UPDATE_TYPE_MAX;
+
+    pthread_once(&telebot_update_type_once, telebot_parser_build_update_type_slots);
+    if (!telebot_update_type_perfect)
+    {
+        for (int type = 0; type < TELEBOT_UPDATE_TYPE_MAX; type++)
         {
-            if (telebot_parser_get_paid_media_purchased(purchased_paid_media, &(result[index].purchased_paid_media)) != TELEBOT_ERROR_NONE)
-                ERR("Failed to parse purchased_paid_media of bot update");
-            result[index].update_type = TELEBOT_UPDATE_TYPE_PURCHASED_PAID_MEDIA;
-            continue;
+            if (strcmp(str, telebot_update_type_str[type]) == 0)
+                return type;
         }
+        return TELEBOT_UPDATE_TYPE_MAX;
+    }
 
-    } /* for index */
+    size_t len = strlen(str);
+    int slot = telebot_update_type_slot[TELEBOT_UPDATE_TYPE_HASH(str, len)];
+    if ((slot == 0) || (strcmp(str, telebot_update_type_str[slot - 1]) != 0))
+        return TELEBOT_UPDATE_TYPE_MAX;
 
-    return TELEBOT_ERROR_NONE;
+    return slot - 1;
+}
+
+const char *telebot_parser_get_update_type_str(telebot_update_type_e type)
+{
+    if ((type < 0) || (type >= TELEBOT_UPDATE_TYPE_MAX))
+        return NULL;
+
+    return telebot_update_type_str[type];
+}
+
+static telebot_error_e telebot_parser_get_update_payload(struct json_object *obj, telebot_update_type_e type,
+                                                         telebot_error_e (*get_message)(struct json_object *, telebot_message_t *),
+                                                         telebot_update_t *update)
+{
+    switch (type)
+    {
+    case TELEBOT_UPDATE_TYPE_MESSAGE:
+        return get_message(obj, update->message);
+    case TELEBOT_UPDATE_TYPE_EDITED_MESSAGE:
+        return get_message(obj, update->edited_message);
+    case TELEBOT_UPDATE_TYPE_CHANNEL_POST:
+        return get_message(obj, update->channel_post);
+    case TELEBOT_UPDATE_TYPE_EDITED_CHANNEL_POST:
+        return get_message(obj, update->edited_channel_post);
+    case TELEBOT_UPDATE_TYPE_BUSINESS_CONNECTION:
+        return telebot_parser_get_business_connection(obj, update->business_connection);
+    case TELEBOT_UPDATE_TYPE_BUSINESS_MESSAGE:
+        return get_message(obj, update->business_message);
+    case TELEBOT_UPDATE_TYPE_EDITED_BUSINESS_MESSAGE:
+        return get_message(obj, update->edited_business_message);
+    case TELEBOT_UPDATE_TYPE_DELETED_BUSINESS_MESSAGES:
+        return telebot_parser_get_business_messages_deleted(obj, update->deleted_business_messages);
+    case TELEBOT_UPDATE_TYPE_MESSAGE_REACTION:
+        return telebot_parser_get_message_reaction_updated(obj, update->message_reaction);
+    case TELEBOT_UPDATE_TYPE_MESSAGE_REACTION_COUNT:
+        return telebot_parser_get_message_reaction_count_updated(obj, update->message_reaction_count);
+    case TELEBOT_UPDATE_TYPE_INLINE_QUERY:
+        return telebot_parser_get_inline_query(obj, update->inline_query);
+    case TELEBOT_UPDATE_TYPE_CHOSEN_INLINE_RESULT:
+        return telebot_parser_get_chosen_inline_result(obj, update->chosen_inline_result);
+    case TELEBOT_UPDATE_TYPE_CALLBACK_QUERY:
+        return telebot_parser_get_callback_query(obj, update->callback_query);
+    case TELEBOT_UPDATE_TYPE_SHIPPING_QUERY:
+        return telebot_parser_get_shipping_query(obj, update->shipping_query);
+    case TELEBOT_UPDATE_TYPE_PRE_CHECKOUT_QUERY:
+        return telebot_parser_get_pre_checkout_query(obj, update->pre_checkout_query);
+    case TELEBOT_UPDATE_TYPE_PURCHASED_PAID_MEDIA:
+        return telebot_parser_get_paid_media_purchased(obj, update->purchased_paid_media);
+    case TELEBOT_UPDATE_TYPE_POLL:
+        return telebot_parser_get_poll(obj, update->poll);
+    case TELEBOT_UPDATE_TYPE_POLL_ANSWER:
+        return telebot_parser_get_poll_answer(obj, update->poll_answer);
+    case TELEBOT_UPDATE_TYPE_MY_CHAT_MEMBER:
+        return telebot_parser_get_chat_member_updated(obj, update->my_chat_member);
+    case TELEBOT_UPDATE_TYPE_CHAT_MEMBER:
+        return telebot_parser_get_chat_member_updated(obj, update->chat_member);
+    case TELEBOT_UPDATE_TYPE_CHAT_JOIN_REQUEST:
+        return telebot_parser_get_chat_join_request(obj, update->chat_join_request);
+    case TELEBOT_UPDATE_TYPE_CHAT_BOOST:
+        return telebot_parser_get_chat_boost_updated(obj, update->chat_boost);
+    case TELEBOT_UPDATE_TYPE_REMOVED_CHAT_BOOST:
+        return telebot_parser_get_chat_boost_removed(obj, update->chat_boost_removed);
+    default:
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+    }
 }
 
 telebot_error_e telebot_parser_get_webhook_info(struct json_object *obj, telebot_webhook_info_t *info)
@@ -366,10 +710,9 @@ telebot_error_e telebot_parser_get_webhook_info(struct json_object *obj, telebot
         for (int i = 0; i < array_len; i++)
         {
             struct json_object *item = json_object_array_get_idx(allowed_updates, i);
-            const char *update_type = json_object_get_string(item);
-            for (int j = 0; j < TELEBOT_UPDATE_TYPE_MAX; j++)
-                if (strstr(update_type, telebot_update_type_str[j]))
-                    info->allowed_updates[cnt++] = j;
+            telebot_update_type_e type = telebot_parser_get_update_type_from_str(json_object_get_string(item));
+            if ((type != TELEBOT_UPDATE_TYPE_MAX) && (cnt < TELEBOT_UPDATE_TYPE_MAX))
+                info->allowed_updates[cnt++] = type;
         }
         info->allowed_updates_count = cnt;
     }
@@ -423,7 +766,7 @@ telebot_error_e telebot_parser_get_user(struct json_object *obj, telebot_user_t
 
     struct json_object *language_code = NULL;
     if (json_object_object_get_ex(obj, "language_code", &language_code))
-        user->language_code = TELEBOT_SAFE_STRDUP(json_object_get_string(language_code));
+        user->language_code = telebot_intern(json_object_get_string(language_code));
 
     struct json_object *is_premium = NULL;
     if (json_object_object_get_ex(obj, "is_premium", &is_premium))
@@ -510,7 +853,7 @@ telebot_error_e telebot_parser_get_chat(struct json_object *obj, telebot_chat_t
         ERR("Object is not chat type, type not found");
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
-    chat->type = TELEBOT_SAFE_STRDUP(json_object_get_string(type));
+    chat->chat_type = TELEBOT_INTERN_ENUM(type, telebot_chat_type_str, &(chat->type));
 
     struct json_object *title = NULL;
     if (json_object_object_get_ex(obj, "title", &title))
@@ -750,7 +1093,7 @@ telebot_error_e telebot_parser_get_chat_admins(struct json_object *obj, telebot_
     return ret;
 }
 
-telebot_error_e telebot_parser_get_message(struct json_object *obj, telebot_message_t *msg)
+static telebot_error_e telebot_parser_get_message_hot(struct json_object *obj, telebot_message_t *msg)
 {
     if ((obj == NULL) || (msg == NULL))
         return TELEBOT_ERROR_INVALID_PARAMETER;
@@ -780,25 +1123,12 @@ telebot_error_e telebot_parser_get_message(struct json_object *obj, telebot_mess
         ERR("Failed to get <date> from message object");
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
-    msg->chat = calloc(1, sizeof(telebot_chat_t));
-    if (telebot_parser_get_chat(chat, msg->chat) != TELEBOT_ERROR_NONE)
+    if (telebot_parser_get_chat_ref(chat, &(msg->chat)) != TELEBOT_ERROR_NONE)
     {
         ERR("Failed to get <chat> from message object");
-        TELEBOT_SAFE_FREE(msg->chat);
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
 
-    struct json_object *forward_origin = NULL;
-    if (json_object_object_get_ex(obj, "forward_origin", &forward_origin))
-    {
-        msg->forward_origin = calloc(1, sizeof(telebot_message_origin_t));
-        if (telebot_parser_get_message_origin(forward_origin, msg->forward_origin) != TELEBOT_ERROR_NONE)
-        {
-            ERR("Failed to get <forward_origin> from message object");
-            TELEBOT_SAFE_FREE(msg->forward_origin);
-        }
-    }
-
     /* Optional Fields */
     struct json_object *message_thread_id = NULL;
     if (json_object_object_get_ex(obj, "message_thread_id", &message_thread_id))
@@ -807,676 +1137,770 @@ telebot_error_e telebot_parser_get_message(struct json_object *obj, telebot_mess
     struct json_object *from = NULL;
     if (json_object_object_get_ex(obj, "from", &from))
     {
-        msg->from = calloc(1, sizeof(telebot_user_t));
-        if (telebot_parser_get_user(from, msg->from) != TELEBOT_ERROR_NONE)
-        {
+        if (telebot_parser_get_user_ref(from, &(msg->from)) != TELEBOT_ERROR_NONE)
             ERR("Failed to get <from user> from message object");
-            TELEBOT_SAFE_FREE(msg->from);
-        }
     }
 
-    struct json_object *sender_chat = NULL;
-    if (json_object_object_get_ex(obj, "sender_chat", &sender_chat))
-    {
-        msg->sender_chat = malloc(sizeof(telebot_chat_t));
-        if (telebot_parser_get_chat(sender_chat, msg->sender_chat) != TELEBOT_ERROR_NONE)
-        {
-            ERR("Failed to get <sender_chat> from message object");
-            TELEBOT_SAFE_FREE(msg->sender_chat);
-        }
-    }
+    struct json_object *text = NULL;
+    if (json_object_object_get_ex(obj, "text", &text))
+        msg->text = TELEBOT_SAFE_STRDUP(json_object_get_string(text));
 
-    struct json_object *sender_boost_count = NULL;
-    if (json_object_object_get_ex(obj, "sender_boost_count", &sender_boost_count))
-        msg->sender_boost_count = json_object_get_int(sender_boost_count);
+    struct json_object *edit_date = NULL;
+    if (json_object_object_get_ex(obj, "edit_date", &edit_date))
+        msg->edit_date = json_object_get_int(edit_date);
 
-    struct json_object *sender_business_bot = NULL;
-    if (json_object_object_get_ex(obj, "sender_business_bot", &sender_business_bot))
-    {
-        msg->sender_business_bot = calloc(1, sizeof(telebot_user_t));
-        if (telebot_parser_get_user(sender_business_bot, msg->sender_business_bot) != TELEBOT_ERROR_NONE)
-        {
-            ERR("Failed to get <sender_business_bot> from message object");
-            TELEBOT_SAFE_FREE(msg->sender_business_bot);
-        }
-    }
+    return TELEBOT_ERROR_NONE;
+}
 
-    struct json_object *business_connection_id = NULL;
-    if (json_object_object_get_ex(obj, "business_connection_id", &business_connection_id))
-        msg->business_connection_id = TELEBOT_SAFE_STRDUP(json_object_get_string(business_connection_id));
+static const telebot_message_extras_t telebot_parser_no_message_extras;
 
-    struct json_object *forward_from = NULL;
-    if (json_object_object_get_ex(obj, "forward_from", &forward_from))
+/* Parse the rarely set fields of a message, see telebot_message_extras_t */
+static void telebot_parser_get_message_extras(struct json_object *obj, telebot_message_extras_t *extras)
+{
+    memset(extras, 0, sizeof(telebot_message_extras_t));
+
+    struct json_object *new_chat_members = NULL;
+    if (json_object_object_get_ex(obj, "new_chat_members", &new_chat_members))
     {
-        msg->forward_from = calloc(1, sizeof(telebot_user_t));
-        if (telebot_parser_get_user(forward_from, msg->forward_from) != TELEBOT_ERROR_NONE)
-        {
-            ERR("Failed to get <forward from> from message object");
-            TELEBOT_SAFE_FREE(msg->forward_from);
-        }
+        int ret = telebot_parser_get_users(new_chat_members, &(extras->new_chat_members), &(extras->count_new_chat_members));
+        if (ret != TELEBOT_ERROR_NONE)
+            ERR("Failed to get <new_chat_members> from message object");
     }
 
-    struct json_object *forward_from_chat = NULL;
-    if (json_object_object_get_ex(obj, "forward_from_chat", &forward_from_chat))
+    struct json_object *left_chat_members = NULL;
+    if (json_object_object_get_ex(obj, "left_chat_members", &left_chat_members))
     {
-        msg->forward_from_chat = calloc(1, sizeof(telebot_chat_t));
-        if (telebot_parser_get_chat(forward_from_chat, msg->forward_from_chat) != TELEBOT_ERROR_NONE)
-        {
-            ERR("Failed to get <forward from> from message object");
-            TELEBOT_SAFE_FREE(msg->forward_from_chat);
-        }
+        int ret = telebot_parser_get_users(left_chat_members, &(extras->left_chat_members), &(extras->count_left_chat_members));
+        if (ret != TELEBOT_ERROR_NONE)
+            ERR("Failed to get <left_chat_members> from message object");
     }
 
-    struct json_object *forward_from_message_id = NULL;
-    if (json_object_object_get_ex(obj, "forward_from_message_id", &forward_from_message_id))
-        msg->forward_from_message_id = json_object_get_int(forward_from_message_id);
+    struct json_object *new_chat_title = NULL;
+    if (json_object_object_get_ex(obj, "new_chat_title", &new_chat_title))
+        extras->new_chat_title = TELEBOT_SAFE_STRDUP(json_object_get_string(new_chat_title));
 
-    struct json_object *forward_signature = NULL;
-    if (json_object_object_get_ex(obj, "forward_signature", &forward_signature))
-        msg->forward_signature = TELEBOT_SAFE_STRDUP(json_object_get_string(forward_signature));
+    struct json_object *new_chat_photo = NULL;
+    if (json_object_object_get_ex(obj, "new_chat_photo", &new_chat_photo))
+    {
+        if (telebot_parser_get_photos(new_chat_photo, &(extras->new_chat_photos), &(extras->count_new_chat_photos)) !=
+            TELEBOT_ERROR_NONE)
+            ERR("Failed to get <new_chat_photo> from message object");
+    }
 
-    struct json_object *forward_sender_name = NULL;
-    if (json_object_object_get_ex(obj, "forward_sender_name", &forward_sender_name))
-        msg->forward_sender_name = TELEBOT_SAFE_STRDUP(json_object_get_string(forward_sender_name));
+    struct json_object *del_chat_photo = NULL;
+    if (json_object_object_get_ex(obj, "delete_chat_photo", &del_chat_photo))
+        extras->delete_chat_photo = json_object_get_boolean(del_chat_photo);
 
-    struct json_object *forward_date = NULL;
-    if (json_object_object_get_ex(obj, "forward_date", &forward_date))
-        msg->forward_date = json_object_get_int(forward_date);
+    struct json_object *group_chat_created = NULL;
+    if (json_object_object_get_ex(obj, "group_chat_created", &group_chat_created))
+        extras->group_chat_created = json_object_get_boolean(group_chat_created);
 
-    struct json_object *is_topic_message = NULL;
-    if (json_object_object_get_ex(obj, "is_topic_message", &is_topic_message))
-        msg->is_topic_message = json_object_get_boolean(is_topic_message);
+    struct json_object *supergroup_chat_created = NULL;
+    if (json_object_object_get_ex(obj, "supergroup_chat_created", &supergroup_chat_created))
+        extras->supergroup_chat_created = json_object_get_boolean(supergroup_chat_created);
 
-    struct json_object *is_automatic_forward = NULL;
-    if (json_object_object_get_ex(obj, "is_automatic_forward", &is_automatic_forward))
-        msg->is_automatic_forward = json_object_get_boolean(is_automatic_forward);
+    struct json_object *channel_chat_created = NULL;
+    if (json_object_object_get_ex(obj, "channel_chat_created", &channel_chat_created))
+        extras->channel_chat_created = json_object_get_boolean(channel_chat_created);
 
-    struct json_object *reply_to_message = NULL;
-    if (json_object_object_get_ex(obj, "reply_to_message", &reply_to_message))
+    struct json_object *message_auto_delete_timer_changed = NULL;
+    if (json_object_object_get_ex(obj, "message_auto_delete_timer_changed", &message_auto_delete_timer_changed))
     {
-        msg->reply_to_message = calloc(1, sizeof(telebot_message_t));
-        if (telebot_parser_get_message(reply_to_message, msg->reply_to_message) != TELEBOT_ERROR_NONE)
+        extras->message_auto_delete_timer_changed = malloc(sizeof(telebot_message_auto_delete_timer_changed_t));
+        int ret = telebot_parser_get_message_auto_delete_timer_changed(message_auto_delete_timer_changed,
+                                                                       extras->message_auto_delete_timer_changed);
+        if (ret != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <reply_to_message> from message object");
-            TELEBOT_SAFE_FREE(msg->reply_to_message);
+            ERR("Failed to get <message_auto_delete_timer_changed> from message object");
+            TELEBOT_SAFE_FREE(extras->message_auto_delete_timer_changed);
         }
     }
 
-    struct json_object *external_reply = NULL;
-    if (json_object_object_get_ex(obj, "external_reply", &external_reply))
+    struct json_object *migrate_to_chat_id = NULL;
+    if (json_object_object_get_ex(obj, "migrate_to_chat_id", &migrate_to_chat_id))
+        extras->migrate_to_chat_id = json_object_get_int64(migrate_to_chat_id);
+
+    struct json_object *migrate_from_chat_id = NULL;
+    if (json_object_object_get_ex(obj, "migrate_from_chat_id", &migrate_from_chat_id))
+        extras->migrate_from_chat_id = json_object_get_int64(migrate_from_chat_id);
+
+    struct json_object *pinned_message = NULL;
+    if (json_object_object_get_ex(obj, "pinned_message", &pinned_message))
     {
-        msg->external_reply = calloc(1, sizeof(telebot_external_reply_info_t));
-        if (telebot_parser_get_external_reply_info(external_reply, msg->external_reply) != TELEBOT_ERROR_NONE)
+        extras->pinned_message = calloc(1, sizeof(telebot_message_t));
+        if (telebot_parser_get_message(pinned_message, extras->pinned_message) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <external_reply> from message object");
-            TELEBOT_SAFE_FREE(msg->external_reply);
+            ERR("Failed to get <pinned_message> from message object");
+            TELEBOT_SAFE_FREE(extras->pinned_message);
         }
     }
 
-    struct json_object *quote = NULL;
-    if (json_object_object_get_ex(obj, "quote", &quote))
+    struct json_object *connected_website = NULL;
+    if (json_object_object_get_ex(obj, "connected_website", &connected_website))
+        extras->connected_website = TELEBOT_SAFE_STRDUP(json_object_get_string(connected_website));
+
+    struct json_object *invoice = NULL;
+    if (json_object_object_get_ex(obj, "invoice", &invoice))
     {
-        msg->quote = calloc(1, sizeof(telebot_text_quote_t));
-        if (telebot_parser_get_text_quote(quote, msg->quote) != TELEBOT_ERROR_NONE)
+        extras->invoice = calloc(1, sizeof(telebot_invoice_t));
+        if (telebot_parser_get_invoice(invoice, extras->invoice) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <quote> from message object");
-            TELEBOT_SAFE_FREE(msg->quote);
+            ERR("Failed to get <invoice> from message object");
+            TELEBOT_SAFE_FREE(extras->invoice);
         }
     }
 
-    struct json_object *reply_to_story = NULL;
-    if (json_object_object_get_ex(obj, "reply_to_story", &reply_to_story))
+    struct json_object *successful_payment = NULL;
+    if (json_object_object_get_ex(obj, "successful_payment", &successful_payment))
     {
-        msg->reply_to_story = calloc(1, sizeof(telebot_story_t));
-        if (telebot_parser_get_story(reply_to_story, msg->reply_to_story) != TELEBOT_ERROR_NONE)
+        extras->successful_payment = calloc(1, sizeof(telebot_successful_payment_t));
+        if (telebot_parser_get_successful_payment(successful_payment, extras->successful_payment) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <reply_to_story> from message object");
-            TELEBOT_SAFE_FREE(msg->reply_to_story);
+            ERR("Failed to get <successful_payment> from message object");
+            TELEBOT_SAFE_FREE(extras->successful_payment);
         }
     }
 
-    struct json_object *via_bot = NULL;
-    if (json_object_object_get_ex(obj, "via_bot", &via_bot))
+    struct json_object *refunded_payment = NULL;
+    if (json_object_object_get_ex(obj, "refunded_payment", &refunded_payment))
     {
-        msg->via_bot = malloc(sizeof(telebot_user_t));
-        if (telebot_parser_get_user(via_bot, msg->via_bot) != TELEBOT_ERROR_NONE)
+        extras->refunded_payment = calloc(1, sizeof(telebot_refunded_payment_t));
+        if (telebot_parser_get_refunded_payment(refunded_payment, extras->refunded_payment) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <via_bot> from message object");
-            TELEBOT_SAFE_FREE(msg->via_bot);
+            ERR("Failed to get <refunded_payment> from message object");
+            TELEBOT_SAFE_FREE(extras->refunded_payment);
         }
     }
 
-    struct json_object *edit_date = NULL;
-    if (json_object_object_get_ex(obj, "edit_date", &edit_date))
-        msg->edit_date = json_object_get_int(edit_date);
-
-    struct json_object *has_protected_content = NULL;
-    if (json_object_object_get_ex(obj, "has_protected_content", &has_protected_content))
-        msg->has_protected_content = json_object_get_boolean(has_protected_content);
-
-    struct json_object *is_paid_post = NULL;
-    if (json_object_object_get_ex(obj, "is_paid_post", &is_paid_post))
-        msg->is_paid_post = json_object_get_boolean(is_paid_post);
-
-    struct json_object *media_group_id = NULL;
-    if (json_object_object_get_ex(obj, "media_group_id", &media_group_id))
-        msg->media_group_id = TELEBOT_SAFE_STRDUP(json_object_get_string(media_group_id));
-
-    struct json_object *author_signature = NULL;
-    if (json_object_object_get_ex(obj, "author_signature", &author_signature))
-        msg->author_signature = TELEBOT_SAFE_STRDUP(json_object_get_string(author_signature));
-
-    struct json_object *text = NULL;
-    if (json_object_object_get_ex(obj, "text", &text))
-        msg->text = TELEBOT_SAFE_STRDUP(json_object_get_string(text));
-
-    struct json_object *entities = NULL;
-    if (json_object_object_get_ex(obj, "entities", &entities))
+    struct json_object *write_access_allowed = NULL;
+    if (json_object_object_get_ex(obj, "write_access_allowed", &write_access_allowed))
     {
-        if (telebot_parser_get_message_entities(entities, &(msg->entities), &(msg->count_entities)) !=
-            TELEBOT_ERROR_NONE)
-            ERR("Failed to get <entities> from message object");
+        extras->write_access_allowed = calloc(1, sizeof(telebot_write_access_allowed_t));
+        if (telebot_parser_get_write_access_allowed(write_access_allowed, extras->write_access_allowed) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <write_access_allowed> from message object");
+            TELEBOT_SAFE_FREE(extras->write_access_allowed);
+        }
     }
 
-    struct json_object *link_preview_options = NULL;
-    if (json_object_object_get_ex(obj, "link_preview_options", &link_preview_options))
+    struct json_object *passport_data = NULL;
+    if (json_object_object_get_ex(obj, "passport_data", &passport_data))
     {
-        msg->link_preview_options = calloc(1, sizeof(telebot_link_preview_options_t));
-        if (telebot_parser_get_link_preview_options(link_preview_options, msg->link_preview_options) != TELEBOT_ERROR_NONE)
+        extras->passport_data = calloc(1, sizeof(telebot_passport_data_t));
+        if (telebot_parser_get_passport_data(passport_data, extras->passport_data) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <link_preview_options> from message object");
-            TELEBOT_SAFE_FREE(msg->link_preview_options);
+            ERR("Failed to get <passport_data> from message object");
+            TELEBOT_SAFE_FREE(extras->passport_data);
         }
     }
 
-    struct json_object *effect_id = NULL;
-    if (json_object_object_get_ex(obj, "effect_id", &effect_id))
-        msg->effect_id = TELEBOT_SAFE_STRDUP(json_object_get_string(effect_id));
-
-    struct json_object *animation = NULL;
-    if (json_object_object_get_ex(obj, "animation", &animation))
+    struct json_object *proximity_alert_triggered = NULL;
+    if (json_object_object_get_ex(obj, "proximity_alert_triggered", &proximity_alert_triggered))
     {
-        msg->animation = malloc(sizeof(telebot_animation_t));
-        if (telebot_parser_get_animation(animation, msg->animation) != TELEBOT_ERROR_NONE)
+        extras->proximity_alert_triggered = calloc(1, sizeof(telebot_proximity_alert_triggered_t));
+        if (telebot_parser_get_proximity_alert_triggered(proximity_alert_triggered, extras->proximity_alert_triggered) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <animation> from message object");
-            TELEBOT_SAFE_FREE(msg->animation);
+            ERR("Failed to get <proximity_alert_triggered> from message object");
+            TELEBOT_SAFE_FREE(extras->proximity_alert_triggered);
         }
     }
 
-    struct json_object *audio = NULL;
-    if (json_object_object_get_ex(obj, "audio", &audio))
+    struct json_object *forum_topic_created = NULL;
+    if (json_object_object_get_ex(obj, "forum_topic_created", &forum_topic_created))
     {
-        msg->audio = calloc(1, sizeof(telebot_audio_t));
-        if (telebot_parser_get_audio(audio, msg->audio) != TELEBOT_ERROR_NONE)
+        extras->forum_topic_created = calloc(1, sizeof(telebot_forum_topic_created_t));
+        if (telebot_parser_get_forum_topic_created(forum_topic_created, extras->forum_topic_created) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <audio> from message object");
-            TELEBOT_SAFE_FREE(msg->audio);
+            ERR("Failed to get <forum_topic_created> from message object");
+            TELEBOT_SAFE_FREE(extras->forum_topic_created);
         }
     }
 
-    struct json_object *document = NULL;
-    if (json_object_object_get_ex(obj, "document", &document))
+    struct json_object *forum_topic_edited = NULL;
+    if (json_object_object_get_ex(obj, "forum_topic_edited", &forum_topic_edited))
     {
-        msg->document = calloc(1, sizeof(telebot_document_t));
-        if (telebot_parser_get_document(document, msg->document) != TELEBOT_ERROR_NONE)
+        extras->forum_topic_edited = calloc(1, sizeof(telebot_forum_topic_edited_t));
+        if (telebot_parser_get_forum_topic_edited(forum_topic_edited, extras->forum_topic_edited) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <document> from message object");
-            TELEBOT_SAFE_FREE(msg->document);
+            ERR("Failed to get <forum_topic_edited> from message object");
+            TELEBOT_SAFE_FREE(extras->forum_topic_edited);
         }
     }
 
-    struct json_object *paid_media = NULL;
-    if (json_object_object_get_ex(obj, "paid_media", &paid_media))
+    struct json_object *forum_topic_closed = NULL;
+    if (json_object_object_get_ex(obj, "forum_topic_closed", &forum_topic_closed))
     {
-        msg->paid_media = calloc(1, sizeof(telebot_paid_media_info_t));
-        if (telebot_parser_get_paid_media_info(paid_media, msg->paid_media) != TELEBOT_ERROR_NONE)
+        extras->forum_topic_closed = calloc(1, sizeof(telebot_forum_topic_closed_t));
+        extras->forum_topic_closed->dummy = true;
+    }
+
+    struct json_object *forum_topic_reopened = NULL;
+    if (json_object_object_get_ex(obj, "forum_topic_reopened", &forum_topic_reopened))
+    {
+        extras->forum_topic_reopened = calloc(1, sizeof(telebot_forum_topic_reopened_t));
+        extras->forum_topic_reopened->dummy = true;
+    }
+
+    struct json_object *video_chat_scheduled = NULL;
+    if (json_object_object_get_ex(obj, "video_chat_scheduled", &video_chat_scheduled))
+    {
+        extras->video_chat_scheduled = calloc(1, sizeof(telebot_video_chat_scheduled_t));
+        if (telebot_parser_get_video_chat_scheduled(video_chat_scheduled, extras->video_chat_scheduled) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <paid_media> from message object");
-            TELEBOT_SAFE_FREE(msg->paid_media);
+            ERR("Failed to get <video_chat_scheduled> from message object");
+            TELEBOT_SAFE_FREE(extras->video_chat_scheduled);
         }
     }
 
-    struct json_object *photo = NULL;
-    if (json_object_object_get_ex(obj, "photo", &photo))
+    struct json_object *video_chat_started = NULL;
+    if (json_object_object_get_ex(obj, "video_chat_started", &video_chat_started))
     {
-        if (telebot_parser_get_photos(photo, &(msg->photos), &(msg->count_photos)) != TELEBOT_ERROR_NONE)
-            ERR("Failed to get <photo> from message object");
+        extras->video_chat_started = calloc(1, sizeof(telebot_video_chat_started_t));
+        extras->video_chat_started->dummy = true;
     }
 
-    // TODO: implement sticker parsing
-
-    struct json_object *video = NULL;
-    if (json_object_object_get_ex(obj, "video", &video))
+    struct json_object *video_chat_ended = NULL;
+    if (json_object_object_get_ex(obj, "video_chat_ended", &video_chat_ended))
     {
-        msg->video = calloc(1, sizeof(telebot_video_t));
-        if (telebot_parser_get_video(video, msg->video) != TELEBOT_ERROR_NONE)
+        extras->video_chat_ended = calloc(1, sizeof(telebot_video_chat_ended_t));
+        if (telebot_parser_get_video_chat_ended(video_chat_ended, extras->video_chat_ended) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <video> from message object");
-            TELEBOT_SAFE_FREE(msg->video);
+            ERR("Failed to get <video_chat_ended> from message object");
+            TELEBOT_SAFE_FREE(extras->video_chat_ended);
         }
     }
 
-    struct json_object *video_note = NULL;
-    if (json_object_object_get_ex(obj, "video_note", &video_note))
+    struct json_object *video_chat_participants_invited = NULL;
+    if (json_object_object_get_ex(obj, "video_chat_participants_invited", &video_chat_participants_invited))
     {
-        msg->video_note = calloc(1, sizeof(telebot_video_note_t));
-        if (telebot_parser_get_video_note(video_note, msg->video_note) != TELEBOT_ERROR_NONE)
+        extras->video_chat_participants_invited = calloc(1, sizeof(telebot_video_chat_participants_invited_t));
+        if (telebot_parser_get_video_chat_participants_invited(video_chat_participants_invited, extras->video_chat_participants_invited) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <video_note> from message object");
-            TELEBOT_SAFE_FREE(msg->video_note);
+            ERR("Failed to get <video_chat_participants_invited> from message object");
+            TELEBOT_SAFE_FREE(extras->video_chat_participants_invited);
         }
     }
 
-    struct json_object *voice = NULL;
-    if (json_object_object_get_ex(obj, "voice", &voice))
+    struct json_object *web_app_data = NULL;
+    if (json_object_object_get_ex(obj, "web_app_data", &web_app_data))
     {
-        msg->voice = malloc(sizeof(telebot_voice_t));
-        if (telebot_parser_get_voice(voice, msg->voice) != TELEBOT_ERROR_NONE)
+        extras->web_app_data = calloc(1, sizeof(telebot_web_app_data_t));
+        if (telebot_parser_get_web_app_data(web_app_data, extras->web_app_data) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <voice> from message object");
-            TELEBOT_SAFE_FREE(msg->voice);
+            ERR("Failed to get <web_app_data> from message object");
+            TELEBOT_SAFE_FREE(extras->web_app_data);
         }
     }
 
-    struct json_object *caption = NULL;
-    if (json_object_object_get_ex(obj, "caption", &caption))
-        msg->caption = TELEBOT_SAFE_STRDUP(json_object_get_string(caption));
+    struct json_object *users_shared = NULL;
+    if (json_object_object_get_ex(obj, "users_shared", &users_shared))
+    {
+        extras->users_shared = calloc(1, sizeof(telebot_users_shared_t));
+        if (telebot_parser_get_users_shared(users_shared, extras->users_shared) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <users_shared> from message object");
+            TELEBOT_SAFE_FREE(extras->users_shared);
+        }
+    }
 
-    struct json_object *caption_entities = NULL;
-    if (json_object_object_get_ex(obj, "caption_entities", &caption_entities))
+    struct json_object *chat_shared = NULL;
+    if (json_object_object_get_ex(obj, "chat_shared", &chat_shared))
     {
-        if (telebot_parser_get_message_entities(caption_entities, &(msg->caption_entities),
-                                                &(msg->count_caption_entities)) != TELEBOT_ERROR_NONE)
-            ERR("Failed to get <caption_entities> from message object");
+        extras->chat_shared = calloc(1, sizeof(telebot_chat_shared_t));
+        if (telebot_parser_get_chat_shared(chat_shared, extras->chat_shared) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <chat_shared> from message object");
+            TELEBOT_SAFE_FREE(extras->chat_shared);
+        }
     }
 
-    struct json_object *show_caption_above_media = NULL;
-    if (json_object_object_get_ex(obj, "show_caption_above_media", &show_caption_above_media))
-        msg->show_caption_above_media = json_object_get_boolean(show_caption_above_media);
+    struct json_object *gift = NULL;
+    if (json_object_object_get_ex(obj, "gift", &gift))
+    {
+        extras->gift = calloc(1, sizeof(telebot_gift_info_t));
+        if (telebot_parser_get_gift_info(gift, extras->gift) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <gift> from message object");
+            TELEBOT_SAFE_FREE(extras->gift);
+        }
+    }
 
-    struct json_object *has_media_spoiler = NULL;
-    if (json_object_object_get_ex(obj, "has_media_spoiler", &has_media_spoiler))
-        msg->has_media_spoiler = json_object_get_boolean(has_media_spoiler);
+    struct json_object *unique_gift = NULL;
+    if (json_object_object_get_ex(obj, "unique_gift", &unique_gift))
+    {
+        extras->unique_gift = calloc(1, sizeof(telebot_unique_gift_info_t));
+        if (telebot_parser_get_unique_gift_info(unique_gift, extras->unique_gift) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <unique_gift> from message object");
+            TELEBOT_SAFE_FREE(extras->unique_gift);
+        }
+    }
 
-    struct json_object *contact = NULL;
-    if (json_object_object_get_ex(obj, "contact", &contact))
+    struct json_object *boost_added = NULL;
+    if (json_object_object_get_ex(obj, "boost_added", &boost_added))
     {
-        msg->contact = calloc(1, sizeof(telebot_contact_t));
-        if (telebot_parser_get_contact(contact, msg->contact) != TELEBOT_ERROR_NONE)
+        extras->boost_added = calloc(1, sizeof(telebot_chat_boost_added_t));
+        if (telebot_parser_get_chat_boost_added(boost_added, extras->boost_added) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <contact> from message object");
-            TELEBOT_SAFE_FREE(msg->contact);
+            ERR("Failed to get <boost_added> from message object");
+            TELEBOT_SAFE_FREE(extras->boost_added);
         }
     }
 
-    struct json_object *dice = NULL;
-    if (json_object_object_get_ex(obj, "dice", &dice))
+    struct json_object *chat_background_set = NULL;
+    if (json_object_object_get_ex(obj, "chat_background_set", &chat_background_set))
     {
-        msg->dice = calloc(1, sizeof(telebot_dice_t));
-        if (telebot_parser_get_dice(dice, msg->dice) != TELEBOT_ERROR_NONE)
+        extras->chat_background_set = calloc(1, sizeof(telebot_chat_background_t));
+        if (telebot_parser_get_chat_background(chat_background_set, extras->chat_background_set) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <dice> from message object");
-            TELEBOT_SAFE_FREE(msg->dice);
+            ERR("Failed to get <chat_background_set> from message object");
+            TELEBOT_SAFE_FREE(extras->chat_background_set);
         }
     }
 
-    // TODO: implement game parsing
+    struct json_object *giveaway_created = NULL;
+    if (json_object_object_get_ex(obj, "giveaway_created", &giveaway_created))
+    {
+        extras->giveaway_created = calloc(1, sizeof(telebot_giveaway_created_t));
+        if (telebot_parser_get_giveaway_created(giveaway_created, extras->giveaway_created) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <giveaway_created> from message object");
+            TELEBOT_SAFE_FREE(extras->giveaway_created);
+        }
+    }
 
-    struct json_object *poll = NULL;
-    if (json_object_object_get_ex(obj, "poll", &poll))
+    struct json_object *giveaway_completed = NULL;
+    if (json_object_object_get_ex(obj, "giveaway_completed", &giveaway_completed))
     {
-        msg->poll = malloc(sizeof(telebot_poll_t));
-        if (telebot_parser_get_poll(poll, msg->poll) != TELEBOT_ERROR_NONE)
+        extras->giveaway_completed = calloc(1, sizeof(telebot_giveaway_completed_t));
+        if (telebot_parser_get_giveaway_completed(giveaway_completed, extras->giveaway_completed) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <poll> from message object");
-            TELEBOT_SAFE_FREE(msg->poll);
+            ERR("Failed to get <giveaway_completed> from message object");
+            TELEBOT_SAFE_FREE(extras->giveaway_completed);
         }
     }
+}
 
-    struct json_object *venue = NULL;
-    if (json_object_object_get_ex(obj, "venue", &venue))
+static void telebot_parser_get_message_field_forward(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *forward_origin = NULL;
+    if (json_object_object_get_ex(obj, "forward_origin", &forward_origin))
     {
-        msg->venue = malloc(sizeof(telebot_venue_t));
-        if (telebot_parser_get_venue(venue, msg->venue) != TELEBOT_ERROR_NONE)
+        msg->forward_origin = calloc(1, sizeof(telebot_message_origin_t));
+        if (telebot_parser_get_message_origin(forward_origin, msg->forward_origin) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <venue> from message object");
-            TELEBOT_SAFE_FREE(msg->venue);
+            ERR("Failed to get <forward_origin> from message object");
+            TELEBOT_SAFE_FREE(msg->forward_origin);
         }
     }
 
-    struct json_object *location = NULL;
-    if (json_object_object_get_ex(obj, "location", &location))
+    struct json_object *forward_from = NULL;
+    if (json_object_object_get_ex(obj, "forward_from", &forward_from))
     {
-        msg->location = malloc(sizeof(telebot_location_t));
-        if (telebot_parser_get_location(location, msg->location) != TELEBOT_ERROR_NONE)
+        msg->forward_from = calloc(1, sizeof(telebot_user_t));
+        if (telebot_parser_get_user(forward_from, msg->forward_from) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <location> from message object");
-            TELEBOT_SAFE_FREE(msg->location);
+            ERR("Failed to get <forward from> from message object");
+            TELEBOT_SAFE_FREE(msg->forward_from);
         }
     }
 
-    struct json_object *new_chat_members = NULL;
-    if (json_object_object_get_ex(obj, "new_chat_members", &new_chat_members))
+    struct json_object *forward_from_chat = NULL;
+    if (json_object_object_get_ex(obj, "forward_from_chat", &forward_from_chat))
     {
-        int ret = telebot_parser_get_users(new_chat_members, &(msg->new_chat_members), &(msg->count_new_chat_members));
-        if (ret != TELEBOT_ERROR_NONE)
-            ERR("Failed to get <new_chat_members> from message object");
+        msg->forward_from_chat = calloc(1, sizeof(telebot_chat_t));
+        if (telebot_parser_get_chat(forward_from_chat, msg->forward_from_chat) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <forward from> from message object");
+            TELEBOT_SAFE_FREE(msg->forward_from_chat);
+        }
     }
 
-    struct json_object *left_chat_members = NULL;
-    if (json_object_object_get_ex(obj, "left_chat_members", &left_chat_members))
-    {
-        int ret = telebot_parser_get_users(left_chat_members, &(msg->left_chat_members), &(msg->count_left_chat_members));
-        if (ret != TELEBOT_ERROR_NONE)
-            ERR("Failed to get <left_chat_members> from message object");
-    }
+    struct json_object *forward_from_message_id = NULL;
+    if (json_object_object_get_ex(obj, "forward_from_message_id", &forward_from_message_id))
+        msg->forward_from_message_id = json_object_get_int(forward_from_message_id);
 
-    struct json_object *new_chat_title = NULL;
-    if (json_object_object_get_ex(obj, "new_chat_title", &new_chat_title))
-        msg->new_chat_title = TELEBOT_SAFE_STRDUP(json_object_get_string(new_chat_title));
+    struct json_object *forward_signature = NULL;
+    if (json_object_object_get_ex(obj, "forward_signature", &forward_signature))
+        msg->forward_signature = TELEBOT_SAFE_STRDUP(json_object_get_string(forward_signature));
 
-    struct json_object *new_chat_photo = NULL;
-    if (json_object_object_get_ex(obj, "new_chat_photo", &new_chat_photo))
-    {
-        if (telebot_parser_get_photos(new_chat_photo, &(msg->new_chat_photos), &(msg->count_new_chat_photos)) !=
-            TELEBOT_ERROR_NONE)
-            ERR("Failed to get <new_chat_photo> from message object");
-    }
+    struct json_object *forward_sender_name = NULL;
+    if (json_object_object_get_ex(obj, "forward_sender_name", &forward_sender_name))
+        msg->forward_sender_name = TELEBOT_SAFE_STRDUP(json_object_get_string(forward_sender_name));
 
-    struct json_object *del_chat_photo = NULL;
-    if (json_object_object_get_ex(obj, "delete_chat_photo", &del_chat_photo))
-        msg->delete_chat_photo = json_object_get_boolean(del_chat_photo);
+    struct json_object *forward_date = NULL;
+    if (json_object_object_get_ex(obj, "forward_date", &forward_date))
+        msg->forward_date = json_object_get_int(forward_date);
 
-    struct json_object *group_chat_created = NULL;
-    if (json_object_object_get_ex(obj, "group_chat_created", &group_chat_created))
-        msg->group_chat_created = json_object_get_boolean(group_chat_created);
+    struct json_object *is_automatic_forward = NULL;
+    if (json_object_object_get_ex(obj, "is_automatic_forward", &is_automatic_forward))
+        msg->is_automatic_forward = json_object_get_boolean(is_automatic_forward);
+}
 
-    struct json_object *supergroup_chat_created = NULL;
-    if (json_object_object_get_ex(obj, "supergroup_chat_created", &supergroup_chat_created))
-        msg->supergroup_chat_created = json_object_get_boolean(supergroup_chat_created);
+static void telebot_parser_get_message_field_sender(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *sender_chat = NULL;
+    if (json_object_object_get_ex(obj, "sender_chat", &sender_chat))
+    {
+        msg->sender_chat = malloc(sizeof(telebot_chat_t));
+        if (telebot_parser_get_chat(sender_chat, msg->sender_chat) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <sender_chat> from message object");
+            TELEBOT_SAFE_FREE(msg->sender_chat);
+        }
+    }
 
-    struct json_object *channel_chat_created = NULL;
-    if (json_object_object_get_ex(obj, "channel_chat_created", &channel_chat_created))
-        msg->channel_chat_created = json_object_get_boolean(channel_chat_created);
+    struct json_object *sender_boost_count = NULL;
+    if (json_object_object_get_ex(obj, "sender_boost_count", &sender_boost_count))
+        msg->sender_boost_count = json_object_get_int(sender_boost_count);
 
-    struct json_object *message_auto_delete_timer_changed = NULL;
-    if (json_object_object_get_ex(obj, "message_auto_delete_timer_changed", &message_auto_delete_timer_changed))
+    struct json_object *sender_business_bot = NULL;
+    if (json_object_object_get_ex(obj, "sender_business_bot", &sender_business_bot))
     {
-        msg->message_auto_delete_timer_changed = malloc(sizeof(telebot_message_auto_delete_timer_changed_t));
-        int ret = telebot_parser_get_message_auto_delete_timer_changed(message_auto_delete_timer_changed,
-                                                                       msg->message_auto_delete_timer_changed);
-        if (ret != TELEBOT_ERROR_NONE)
+        msg->sender_business_bot = calloc(1, sizeof(telebot_user_t));
+        if (telebot_parser_get_user(sender_business_bot, msg->sender_business_bot) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <message_auto_delete_timer_changed> from message object");
-            TELEBOT_SAFE_FREE(msg->message_auto_delete_timer_changed);
+            ERR("Failed to get <sender_business_bot> from message object");
+            TELEBOT_SAFE_FREE(msg->sender_business_bot);
         }
     }
 
-    struct json_object *migrate_to_chat_id = NULL;
-    if (json_object_object_get_ex(obj, "migrate_to_chat_id", &migrate_to_chat_id))
-        msg->migrate_to_chat_id = json_object_get_int64(migrate_to_chat_id);
-
-    struct json_object *migrate_from_chat_id = NULL;
-    if (json_object_object_get_ex(obj, "migrate_from_chat_id", &migrate_from_chat_id))
-        msg->migrate_from_chat_id = json_object_get_int64(migrate_from_chat_id);
+    struct json_object *business_connection_id = NULL;
+    if (json_object_object_get_ex(obj, "business_connection_id", &business_connection_id))
+        msg->business_connection_id = TELEBOT_SAFE_STRDUP(json_object_get_string(business_connection_id));
 
-    struct json_object *pinned_message = NULL;
-    if (json_object_object_get_ex(obj, "pinned_message", &pinned_message))
+    struct json_object *via_bot = NULL;
+    if (json_object_object_get_ex(obj, "via_bot", &via_bot))
     {
-        msg->pinned_message = calloc(1, sizeof(telebot_message_t));
-        if (telebot_parser_get_message(pinned_message, msg->pinned_message) != TELEBOT_ERROR_NONE)
+        msg->via_bot = malloc(sizeof(telebot_user_t));
+        if (telebot_parser_get_user(via_bot, msg->via_bot) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <pinned_message> from message object");
-            TELEBOT_SAFE_FREE(msg->pinned_message);
+            ERR("Failed to get <via_bot> from message object");
+            TELEBOT_SAFE_FREE(msg->via_bot);
         }
     }
 
-    struct json_object *connected_website = NULL;
-    if (json_object_object_get_ex(obj, "connected_website", &connected_website))
-        msg->connected_website = TELEBOT_SAFE_STRDUP(json_object_get_string(connected_website));
+    struct json_object *author_signature = NULL;
+    if (json_object_object_get_ex(obj, "author_signature", &author_signature))
+        msg->author_signature = TELEBOT_SAFE_STRDUP(json_object_get_string(author_signature));
+}
 
-    struct json_object *invoice = NULL;
-    if (json_object_object_get_ex(obj, "invoice", &invoice))
+static void telebot_parser_get_message_field_reply_to_message(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *reply_to_message = NULL;
+    if (json_object_object_get_ex(obj, "reply_to_message", &reply_to_message))
     {
-        msg->invoice = calloc(1, sizeof(telebot_invoice_t));
-        if (telebot_parser_get_invoice(invoice, msg->invoice) != TELEBOT_ERROR_NONE)
+        msg->reply_to_message = calloc(1, sizeof(telebot_message_t));
+        if (telebot_parser_get_message(reply_to_message, msg->reply_to_message) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <invoice> from message object");
-            TELEBOT_SAFE_FREE(msg->invoice);
+            ERR("Failed to get <reply_to_message> from message object");
+            TELEBOT_SAFE_FREE(msg->reply_to_message);
         }
     }
+}
 
-    struct json_object *successful_payment = NULL;
-    if (json_object_object_get_ex(obj, "successful_payment", &successful_payment))
+static void telebot_parser_get_message_field_external_reply(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *external_reply = NULL;
+    if (json_object_object_get_ex(obj, "external_reply", &external_reply))
     {
-        msg->successful_payment = calloc(1, sizeof(telebot_successful_payment_t));
-        if (telebot_parser_get_successful_payment(successful_payment, msg->successful_payment) != TELEBOT_ERROR_NONE)
+        msg->external_reply = calloc(1, sizeof(telebot_external_reply_info_t));
+        if (telebot_parser_get_external_reply_info(external_reply, msg->external_reply) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <successful_payment> from message object");
-            TELEBOT_SAFE_FREE(msg->successful_payment);
+            ERR("Failed to get <external_reply> from message object");
+            TELEBOT_SAFE_FREE(msg->external_reply);
         }
     }
+}
 
-    struct json_object *refunded_payment = NULL;
-    if (json_object_object_get_ex(obj, "refunded_payment", &refunded_payment))
+static void telebot_parser_get_message_field_quote(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *quote = NULL;
+    if (json_object_object_get_ex(obj, "quote", &quote))
     {
-        msg->refunded_payment = calloc(1, sizeof(telebot_refunded_payment_t));
-        if (telebot_parser_get_refunded_payment(refunded_payment, msg->refunded_payment) != TELEBOT_ERROR_NONE)
+        msg->quote = calloc(1, sizeof(telebot_text_quote_t));
+        if (telebot_parser_get_text_quote(quote, msg->quote) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <refunded_payment> from message object");
-            TELEBOT_SAFE_FREE(msg->refunded_payment);
+            ERR("Failed to get <quote> from message object");
+            TELEBOT_SAFE_FREE(msg->quote);
         }
     }
+}
 
-    struct json_object *write_access_allowed = NULL;
-    if (json_object_object_get_ex(obj, "write_access_allowed", &write_access_allowed))
+static void telebot_parser_get_message_field_reply_to_story(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *reply_to_story = NULL;
+    if (json_object_object_get_ex(obj, "reply_to_story", &reply_to_story))
     {
-        msg->write_access_allowed = calloc(1, sizeof(telebot_write_access_allowed_t));
-        if (telebot_parser_get_write_access_allowed(write_access_allowed, msg->write_access_allowed) != TELEBOT_ERROR_NONE)
+        msg->reply_to_story = calloc(1, sizeof(telebot_story_t));
+        if (telebot_parser_get_story(reply_to_story, msg->reply_to_story) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <write_access_allowed> from message object");
-            TELEBOT_SAFE_FREE(msg->write_access_allowed);
+            ERR("Failed to get <reply_to_story> from message object");
+            TELEBOT_SAFE_FREE(msg->reply_to_story);
         }
     }
+}
 
-    struct json_object *passport_data = NULL;
-    if (json_object_object_get_ex(obj, "passport_data", &passport_data))
+static void telebot_parser_get_message_field_entities(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *entities = NULL;
+    if (json_object_object_get_ex(obj, "entities", &entities))
+    {
+        if (telebot_parser_get_message_entities(entities, &(msg->entities), &(msg->count_entities)) !=
+            TELEBOT_ERROR_NONE)
+            ERR("Failed to get <entities> from message object");
+    }
+}
+
+static void telebot_parser_get_message_field_link_preview_options(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *link_preview_options = NULL;
+    if (json_object_object_get_ex(obj, "link_preview_options", &link_preview_options))
     {
-        msg->passport_data = calloc(1, sizeof(telebot_passport_data_t));
-        if (telebot_parser_get_passport_data(passport_data, msg->passport_data) != TELEBOT_ERROR_NONE)
+        msg->link_preview_options = calloc(1, sizeof(telebot_link_preview_options_t));
+        if (telebot_parser_get_link_preview_options(link_preview_options, msg->link_preview_options) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <passport_data> from message object");
-            TELEBOT_SAFE_FREE(msg->passport_data);
+            ERR("Failed to get <link_preview_options> from message object");
+            TELEBOT_SAFE_FREE(msg->link_preview_options);
         }
     }
+}
 
-    struct json_object *proximity_alert_triggered = NULL;
-    if (json_object_object_get_ex(obj, "proximity_alert_triggered", &proximity_alert_triggered))
+static void telebot_parser_get_message_field_animation(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *animation = NULL;
+    if (json_object_object_get_ex(obj, "animation", &animation))
     {
-        msg->proximity_alert_triggered = calloc(1, sizeof(telebot_proximity_alert_triggered_t));
-        if (telebot_parser_get_proximity_alert_triggered(proximity_alert_triggered, msg->proximity_alert_triggered) != TELEBOT_ERROR_NONE)
+        msg->animation = malloc(sizeof(telebot_animation_t));
+        if (telebot_parser_get_animation(animation, msg->animation) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <proximity_alert_triggered> from message object");
-            TELEBOT_SAFE_FREE(msg->proximity_alert_triggered);
+            ERR("Failed to get <animation> from message object");
+            TELEBOT_SAFE_FREE(msg->animation);
         }
     }
+}
 
-    struct json_object *forum_topic_created = NULL;
-    if (json_object_object_get_ex(obj, "forum_topic_created", &forum_topic_created))
+static void telebot_parser_get_message_field_audio(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *audio = NULL;
+    if (json_object_object_get_ex(obj, "audio", &audio))
     {
-        msg->forum_topic_created = calloc(1, sizeof(telebot_forum_topic_created_t));
-        if (telebot_parser_get_forum_topic_created(forum_topic_created, msg->forum_topic_created) != TELEBOT_ERROR_NONE)
+        msg->audio = calloc(1, sizeof(telebot_audio_t));
+        if (telebot_parser_get_audio(audio, msg->audio) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <forum_topic_created> from message object");
-            TELEBOT_SAFE_FREE(msg->forum_topic_created);
+            ERR("Failed to get <audio> from message object");
+            TELEBOT_SAFE_FREE(msg->audio);
         }
     }
+}
 
-    struct json_object *forum_topic_edited = NULL;
-    if (json_object_object_get_ex(obj, "forum_topic_edited", &forum_topic_edited))
+static void telebot_parser_get_message_field_document(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *document = NULL;
+    if (json_object_object_get_ex(obj, "document", &document))
     {
-        msg->forum_topic_edited = calloc(1, sizeof(telebot_forum_topic_edited_t));
-        if (telebot_parser_get_forum_topic_edited(forum_topic_edited, msg->forum_topic_edited) != TELEBOT_ERROR_NONE)
+        msg->document = calloc(1, sizeof(telebot_document_t));
+        if (telebot_parser_get_document(document, msg->document) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <forum_topic_edited> from message object");
-            TELEBOT_SAFE_FREE(msg->forum_topic_edited);
+            ERR("Failed to get <document> from message object");
+            TELEBOT_SAFE_FREE(msg->document);
         }
     }
+}
 
-    struct json_object *forum_topic_closed = NULL;
-    if (json_object_object_get_ex(obj, "forum_topic_closed", &forum_topic_closed))
+static void telebot_parser_get_message_field_paid_media(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *paid_media = NULL;
+    if (json_object_object_get_ex(obj, "paid_media", &paid_media))
     {
-        msg->forum_topic_closed = calloc(1, sizeof(telebot_forum_topic_closed_t));
-        msg->forum_topic_closed->dummy = true;
+        msg->paid_media = calloc(1, sizeof(telebot_paid_media_info_t));
+        if (telebot_parser_get_paid_media_info(paid_media, msg->paid_media) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <paid_media> from message object");
+            TELEBOT_SAFE_FREE(msg->paid_media);
+        }
     }
+}
 
-    struct json_object *forum_topic_reopened = NULL;
-    if (json_object_object_get_ex(obj, "forum_topic_reopened", &forum_topic_reopened))
+static void telebot_parser_get_message_field_photos(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *photo = NULL;
+    if (json_object_object_get_ex(obj, "photo", &photo))
     {
-        msg->forum_topic_reopened = calloc(1, sizeof(telebot_forum_topic_reopened_t));
-        msg->forum_topic_reopened->dummy = true;
+        if (telebot_parser_get_photos(photo, &(msg->photos), &(msg->count_photos)) != TELEBOT_ERROR_NONE)
+            ERR("Failed to get <photo> from message object");
     }
+}
 
-    struct json_object *video_chat_scheduled = NULL;
-    if (json_object_object_get_ex(obj, "video_chat_scheduled", &video_chat_scheduled))
+static void telebot_parser_get_message_field_sticker(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *sticker = NULL;
+    if (json_object_object_get_ex(obj, "sticker", &sticker))
     {
-        msg->video_chat_scheduled = calloc(1, sizeof(telebot_video_chat_scheduled_t));
-        if (telebot_parser_get_video_chat_scheduled(video_chat_scheduled, msg->video_chat_scheduled) != TELEBOT_ERROR_NONE)
+        msg->sticker = calloc(1, sizeof(telebot_sticker_t));
+        if (telebot_parser_get_sticker(sticker, msg->sticker) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <video_chat_scheduled> from message object");
-            TELEBOT_SAFE_FREE(msg->video_chat_scheduled);
+            ERR("Failed to get <sticker> from message object");
+            TELEBOT_SAFE_FREE(msg->sticker);
         }
     }
+}
 
-    struct json_object *video_chat_started = NULL;
-    if (json_object_object_get_ex(obj, "video_chat_started", &video_chat_started))
-    {
-        msg->video_chat_started = calloc(1, sizeof(telebot_video_chat_started_t));
-        msg->video_chat_started->dummy = true;
-    }
-
-    struct json_object *video_chat_ended = NULL;
-    if (json_object_object_get_ex(obj, "video_chat_ended", &video_chat_ended))
+static void telebot_parser_get_message_field_video(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *video = NULL;
+    if (json_object_object_get_ex(obj, "video", &video))
     {
-        msg->video_chat_ended = calloc(1, sizeof(telebot_video_chat_ended_t));
-        if (telebot_parser_get_video_chat_ended(video_chat_ended, msg->video_chat_ended) != TELEBOT_ERROR_NONE)
+        msg->video = calloc(1, sizeof(telebot_video_t));
+        if (telebot_parser_get_video(video, msg->video) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <video_chat_ended> from message object");
-            TELEBOT_SAFE_FREE(msg->video_chat_ended);
+            ERR("Failed to get <video> from message object");
+            TELEBOT_SAFE_FREE(msg->video);
         }
     }
+}
 
-    struct json_object *video_chat_participants_invited = NULL;
-    if (json_object_object_get_ex(obj, "video_chat_participants_invited", &video_chat_participants_invited))
+static void telebot_parser_get_message_field_video_note(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *video_note = NULL;
+    if (json_object_object_get_ex(obj, "video_note", &video_note))
     {
-        msg->video_chat_participants_invited = calloc(1, sizeof(telebot_video_chat_participants_invited_t));
-        if (telebot_parser_get_video_chat_participants_invited(video_chat_participants_invited, msg->video_chat_participants_invited) != TELEBOT_ERROR_NONE)
+        msg->video_note = calloc(1, sizeof(telebot_video_note_t));
+        if (telebot_parser_get_video_note(video_note, msg->video_note) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <video_chat_participants_invited> from message object");
-            TELEBOT_SAFE_FREE(msg->video_chat_participants_invited);
+            ERR("Failed to get <video_note> from message object");
+            TELEBOT_SAFE_FREE(msg->video_note);
         }
     }
+}
 
-    struct json_object *web_app_data = NULL;
-    if (json_object_object_get_ex(obj, "web_app_data", &web_app_data))
+static void telebot_parser_get_message_field_voice(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *voice = NULL;
+    if (json_object_object_get_ex(obj, "voice", &voice))
     {
-        msg->web_app_data = calloc(1, sizeof(telebot_web_app_data_t));
-        if (telebot_parser_get_web_app_data(web_app_data, msg->web_app_data) != TELEBOT_ERROR_NONE)
+        msg->voice = malloc(sizeof(telebot_voice_t));
+        if (telebot_parser_get_voice(voice, msg->voice) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <web_app_data> from message object");
-            TELEBOT_SAFE_FREE(msg->web_app_data);
+            ERR("Failed to get <voice> from message object");
+            TELEBOT_SAFE_FREE(msg->voice);
         }
     }
+}
 
-    struct json_object *users_shared = NULL;
-    if (json_object_object_get_ex(obj, "users_shared", &users_shared))
+static void telebot_parser_get_message_field_caption(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *caption = NULL;
+    if (json_object_object_get_ex(obj, "caption", &caption))
+        msg->caption = TELEBOT_SAFE_STRDUP(json_object_get_string(caption));
+
+    struct json_object *caption_entities = NULL;
+    if (json_object_object_get_ex(obj, "caption_entities", &caption_entities))
     {
-        msg->users_shared = calloc(1, sizeof(telebot_users_shared_t));
-        if (telebot_parser_get_users_shared(users_shared, msg->users_shared) != TELEBOT_ERROR_NONE)
-        {
-            ERR("Failed to get <users_shared> from message object");
-            TELEBOT_SAFE_FREE(msg->users_shared);
-        }
+        if (telebot_parser_get_message_entities(caption_entities, &(msg->caption_entities),
+                                                &(msg->count_caption_entities)) != TELEBOT_ERROR_NONE)
+            ERR("Failed to get <caption_entities> from message object");
     }
 
-    struct json_object *chat_shared = NULL;
-    if (json_object_object_get_ex(obj, "chat_shared", &chat_shared))
+    struct json_object *show_caption_above_media = NULL;
+    if (json_object_object_get_ex(obj, "show_caption_above_media", &show_caption_above_media))
+        msg->show_caption_above_media = json_object_get_boolean(show_caption_above_media);
+}
+
+static void telebot_parser_get_message_field_contact(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *contact = NULL;
+    if (json_object_object_get_ex(obj, "contact", &contact))
     {
-        msg->chat_shared = calloc(1, sizeof(telebot_chat_shared_t));
-        if (telebot_parser_get_chat_shared(chat_shared, msg->chat_shared) != TELEBOT_ERROR_NONE)
+        msg->contact = calloc(1, sizeof(telebot_contact_t));
+        if (telebot_parser_get_contact(contact, msg->contact) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <chat_shared> from message object");
-            TELEBOT_SAFE_FREE(msg->chat_shared);
+            ERR("Failed to get <contact> from message object");
+            TELEBOT_SAFE_FREE(msg->contact);
         }
     }
+}
 
-    struct json_object *gift = NULL;
-    if (json_object_object_get_ex(obj, "gift", &gift))
+static void telebot_parser_get_message_field_dice(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *dice = NULL;
+    if (json_object_object_get_ex(obj, "dice", &dice))
     {
-        msg->gift = calloc(1, sizeof(telebot_gift_info_t));
-        if (telebot_parser_get_gift_info(gift, msg->gift) != TELEBOT_ERROR_NONE)
+        msg->dice = calloc(1, sizeof(telebot_dice_t));
+        if (telebot_parser_get_dice(dice, msg->dice) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <gift> from message object");
-            TELEBOT_SAFE_FREE(msg->gift);
+            ERR("Failed to get <dice> from message object");
+            TELEBOT_SAFE_FREE(msg->dice);
         }
     }
+}
 
-    struct json_object *unique_gift = NULL;
-    if (json_object_object_get_ex(obj, "unique_gift", &unique_gift))
+// TODO: implement game parsing
+
+static void telebot_parser_get_message_field_poll(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *poll = NULL;
+    if (json_object_object_get_ex(obj, "poll", &poll))
     {
-        msg->unique_gift = calloc(1, sizeof(telebot_unique_gift_info_t));
-        if (telebot_parser_get_unique_gift_info(unique_gift, msg->unique_gift) != TELEBOT_ERROR_NONE)
+        msg->poll = malloc(sizeof(telebot_poll_t));
+        if (telebot_parser_get_poll(poll, msg->poll) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <unique_gift> from message object");
-            TELEBOT_SAFE_FREE(msg->unique_gift);
+            ERR("Failed to get <poll> from message object");
+            TELEBOT_SAFE_FREE(msg->poll);
         }
     }
+}
 
-    struct json_object *boost_added = NULL;
-    if (json_object_object_get_ex(obj, "boost_added", &boost_added))
+static void telebot_parser_get_message_field_venue(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *venue = NULL;
+    if (json_object_object_get_ex(obj, "venue", &venue))
     {
-        msg->boost_added = calloc(1, sizeof(telebot_chat_boost_added_t));
-        if (telebot_parser_get_chat_boost_added(boost_added, msg->boost_added) != TELEBOT_ERROR_NONE)
+        msg->venue = malloc(sizeof(telebot_venue_t));
+        if (telebot_parser_get_venue(venue, msg->venue) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <boost_added> from message object");
-            TELEBOT_SAFE_FREE(msg->boost_added);
+            ERR("Failed to get <venue> from message object");
+            TELEBOT_SAFE_FREE(msg->venue);
         }
     }
+}
 
-    struct json_object *chat_background_set = NULL;
-    if (json_object_object_get_ex(obj, "chat_background_set", &chat_background_set))
+static void telebot_parser_get_message_field_location(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *location = NULL;
+    if (json_object_object_get_ex(obj, "location", &location))
     {
-        msg->chat_background_set = calloc(1, sizeof(telebot_chat_background_t));
-        if (telebot_parser_get_chat_background(chat_background_set, msg->chat_background_set) != TELEBOT_ERROR_NONE)
+        msg->location = malloc(sizeof(telebot_location_t));
+        if (telebot_parser_get_location(location, msg->location) != TELEBOT_ERROR_NONE)
         {
-            ERR("Failed to get <chat_background_set> from message object");
-            TELEBOT_SAFE_FREE(msg->chat_background_set);
+            ERR("Failed to get <location> from message object");
+            TELEBOT_SAFE_FREE(msg->location);
         }
     }
+}
 
-    struct json_object *giveaway_created = NULL;
-    if (json_object_object_get_ex(obj, "giveaway_created", &giveaway_created))
+static void telebot_parser_get_message_field_extras(struct json_object *obj, telebot_message_t *msg)
+{
+    /* Rare fields are parsed aside and kept only when any of them is present */
+    telebot_message_extras_t extras;
+    telebot_parser_get_message_extras(obj, &extras);
+    if (memcmp(&extras, &telebot_parser_no_message_extras, sizeof(telebot_message_extras_t)) != 0)
     {
-        msg->giveaway_created = calloc(1, sizeof(telebot_giveaway_created_t));
-        if (telebot_parser_get_giveaway_created(giveaway_created, msg->giveaway_created) != TELEBOT_ERROR_NONE)
+        msg->extras = malloc(sizeof(telebot_message_extras_t));
+        if (msg->extras != NULL)
         {
-            ERR("Failed to get <giveaway_created> from message object");
-            TELEBOT_SAFE_FREE(msg->giveaway_created);
+            *(msg->extras) = extras;
         }
-    }
-
-    struct json_object *giveaway_completed = NULL;
-    if (json_object_object_get_ex(obj, "giveaway_completed", &giveaway_completed))
-    {
-        msg->giveaway_completed = calloc(1, sizeof(telebot_giveaway_completed_t));
-        if (telebot_parser_get_giveaway_completed(giveaway_completed, msg->giveaway_completed) != TELEBOT_ERROR_NONE)
+        else
         {
-            ERR("Failed to get <giveaway_completed> from message object");
-            TELEBOT_SAFE_FREE(msg->giveaway_completed);
+            ERR("Failed to allocate extras of message object");
+            telebot_put_message_extras(&extras);
         }
     }
+}
 
+static void telebot_parser_get_message_field_reply_markup(struct json_object *obj, telebot_message_t *msg)
+{
     struct json_object *reply_markup = NULL;
     if (json_object_object_get_ex(obj, "reply_markup", &reply_markup))
     {
@@ -1487,10 +1911,143 @@ telebot_error_e telebot_parser_get_message(struct json_object *obj, telebot_mess
             TELEBOT_SAFE_FREE(msg->reply_markup);
         }
     }
+}
+
+static void telebot_parser_get_message_field_properties(struct json_object *obj, telebot_message_t *msg)
+{
+    struct json_object *is_topic_message = NULL;
+    if (json_object_object_get_ex(obj, "is_topic_message", &is_topic_message))
+        msg->is_topic_message = json_object_get_boolean(is_topic_message);
+
+    struct json_object *has_protected_content = NULL;
+    if (json_object_object_get_ex(obj, "has_protected_content", &has_protected_content))
+        msg->has_protected_content = json_object_get_boolean(has_protected_content);
+
+    struct json_object *is_paid_post = NULL;
+    if (json_object_object_get_ex(obj, "is_paid_post", &is_paid_post))
+        msg->is_paid_post = json_object_get_boolean(is_paid_post);
+
+    struct json_object *media_group_id = NULL;
+    if (json_object_object_get_ex(obj, "media_group_id", &media_group_id))
+        msg->media_group_id = TELEBOT_SAFE_STRDUP(json_object_get_string(media_group_id));
+
+    struct json_object *effect_id = NULL;
+    if (json_object_object_get_ex(obj, "effect_id", &effect_id))
+        msg->effect_id = TELEBOT_SAFE_STRDUP(json_object_get_string(effect_id));
+
+    struct json_object *has_media_spoiler = NULL;
+    if (json_object_object_get_ex(obj, "has_media_spoiler", &has_media_spoiler))
+        msg->has_media_spoiler = json_object_get_boolean(has_media_spoiler);
+}
+
+typedef void (*telebot_parser_message_field_f)(struct json_object *obj, telebot_message_t *msg);
+
+/* Parsers of the fields not covered by telebot_parser_get_message_hot(), see telebot_message_field_e */
+static const telebot_parser_message_field_f telebot_parser_message_fields[TELEBOT_MESSAGE_FIELD_MAX] = {
+    [TELEBOT_MESSAGE_FIELD_FORWARD] = telebot_parser_get_message_field_forward,
+    [TELEBOT_MESSAGE_FIELD_SENDER] = telebot_parser_get_message_field_sender,
+    [TELEBOT_MESSAGE_FIELD_REPLY_TO_MESSAGE] = telebot_parser_get_message_field_reply_to_message,
+    [TELEBOT_MESSAGE_FIELD_EXTERNAL_REPLY] = telebot_parser_get_message_field_external_reply,
+    [TELEBOT_MESSAGE_FIELD_QUOTE] = telebot_parser_get_message_field_quote,
+    [TELEBOT_MESSAGE_FIELD_REPLY_TO_STORY] = telebot_parser_get_message_field_reply_to_story,
+    [TELEBOT_MESSAGE_FIELD_ENTITIES] = telebot_parser_get_message_field_entities,
+    [TELEBOT_MESSAGE_FIELD_LINK_PREVIEW_OPTIONS] = telebot_parser_get_message_field_link_preview_options,
+    [TELEBOT_MESSAGE_FIELD_ANIMATION] = telebot_parser_get_message_field_animation,
+    [TELEBOT_MESSAGE_FIELD_AUDIO] = telebot_parser_get_message_field_audio,
+    [TELEBOT_MESSAGE_FIELD_DOCUMENT] = telebot_parser_get_message_field_document,
+    [TELEBOT_MESSAGE_FIELD_PAID_MEDIA] = telebot_parser_get_message_field_paid_media,
+    [TELEBOT_MESSAGE_FIELD_PHOTOS] = telebot_parser_get_message_field_photos,
+    [TELEBOT_MESSAGE_FIELD_STICKER] = telebot_parser_get_message_field_sticker,
+    [TELEBOT_MESSAGE_FIELD_VIDEO] = telebot_parser_get_message_field_video,
+    [TELEBOT_MESSAGE_FIELD_VIDEO_NOTE] = telebot_parser_get_message_field_video_note,
+    [TELEBOT_MESSAGE_FIELD_VOICE] = telebot_parser_get_message_field_voice,
+    [TELEBOT_MESSAGE_FIELD_CAPTION] = telebot_parser_get_message_field_caption,
+    [TELEBOT_MESSAGE_FIELD_CONTACT] = telebot_parser_get_message_field_contact,
+    [TELEBOT_MESSAGE_FIELD_DICE] = telebot_parser_get_message_field_dice,
+    [TELEBOT_MESSAGE_FIELD_POLL] = telebot_parser_get_message_field_poll,
+    [TELEBOT_MESSAGE_FIELD_VENUE] = telebot_parser_get_message_field_venue,
+    [TELEBOT_MESSAGE_FIELD_LOCATION] = telebot_parser_get_message_field_location,
+    [TELEBOT_MESSAGE_FIELD_EXTRAS] = telebot_parser_get_message_field_extras,
+    [TELEBOT_MESSAGE_FIELD_REPLY_MARKUP] = telebot_parser_get_message_field_reply_markup,
+    [TELEBOT_MESSAGE_FIELD_PROPERTIES] = telebot_parser_get_message_field_properties,
+};
+
+/* Parse the fields not covered by telebot_parser_get_message_hot() */
+static telebot_error_e telebot_parser_get_message_cold(struct json_object *obj, telebot_message_t *msg)
+{
+    for (int field = 0; field < TELEBOT_MESSAGE_FIELD_MAX; field++)
+        telebot_parser_message_fields[field](obj, msg);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_parser_get_message(struct json_object *obj, telebot_message_t *msg)
+{
+    telebot_error_e ret = telebot_parser_get_message_hot(obj, msg);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    return telebot_parser_get_message_cold(obj, msg);
+}
+
+telebot_error_e telebot_parser_get_message_lazy(struct json_object *obj, telebot_message_t *msg)
+{
+    telebot_error_e ret = telebot_parser_get_message_hot(obj, msg);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    telebot_message_lazy_t *lazy = calloc(1, sizeof(telebot_message_lazy_t));
+    if (lazy == NULL)
+        return telebot_parser_get_message_cold(obj, msg);
+
+    /* Keep the object alive, the rest is parsed by telebot_parser_load_message_field() */
+    lazy->obj = json_object_get(obj);
+    lazy->pending = TELEBOT_MESSAGE_FIELD_MAX;
+    msg->lazy = lazy;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_parser_load_message_field(telebot_message_t *msg, telebot_message_field_e field)
+{
+    if ((msg == NULL) || (field < 0) || (field >= TELEBOT_MESSAGE_FIELD_MAX))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_message_lazy_t *lazy = msg->lazy;
+    if ((lazy == NULL) || lazy->loaded[field])
+        return TELEBOT_ERROR_NONE;
+
+    telebot_parser_message_fields[field](lazy->obj, msg);
+    lazy->loaded[field] = true;
+    if (--(lazy->pending) == 0)
+    {
+        msg->lazy = NULL;
+        telebot_parser_put_message_lazy(lazy);
+    }
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_parser_load_message(telebot_message_t *msg)
+{
+    if (msg == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    for (int field = 0; (field < TELEBOT_MESSAGE_FIELD_MAX) && (msg->lazy != NULL); field++)
+        telebot_parser_load_message_field(msg, field);
 
     return TELEBOT_ERROR_NONE;
 }
 
+void telebot_parser_put_message_lazy(telebot_message_lazy_t *lazy)
+{
+    if (lazy == NULL)
+        return;
+
+    json_object_put(lazy->obj);
+    free(lazy);
+}
+
 telebot_error_e telebot_parser_get_message_entity(struct json_object *obj, telebot_message_entity_t *entity)
 {
     if ((obj == NULL) || (entity == NULL))
@@ -1503,12 +2060,12 @@ telebot_error_e telebot_parser_get_message_entity(struct json_object *obj, teleb
         ERR("Object is not message entity type, type not found");
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
-    entity->type = TELEBOT_SAFE_STRDUP(json_object_get_string(type));
+    entity->entity_type = TELEBOT_INTERN_ENUM(type, telebot_message_entity_type_str, &(entity->type));
 
     struct json_object *offset = NULL;
     if (!json_object_object_get_ex(obj, "offset", &offset))
     {
-        TELEBOT_SAFE_FREE(entity->type);
+        entity->type = NULL;
         ERR("Object is not message entity type, offset not found");
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
@@ -1518,7 +2075,8 @@ telebot_error_e telebot_parser_get_message_entity(struct json_object *obj, teleb
     if (!json_object_object_get_ex(obj, "length", &length))
     {
         ERR("Object is not message entity type, length not found");
-        TELEBOT_SAFE_FZCNT(entity->type, entity->offset);
+        entity->type = NULL;
+        entity->offset = 0;
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
     entity->length = json_object_get_int(length);
@@ -2261,7 +2819,7 @@ telebot_error_e telebot_parser_get_poll(struct json_object *obj, telebot_poll_t
         poll->is_anonymous = false;
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
-    poll->type = TELEBOT_SAFE_STRDUP(json_object_get_string(type));
+    TELEBOT_INTERN_ENUM(type, telebot_poll_type_str, &(poll->type));
 
     struct json_object *allows_multiple_answers = NULL;
     if (!json_object_object_get_ex(obj, "allows_multiple_answers", &allows_multiple_answers))
@@ -2272,7 +2830,7 @@ telebot_error_e telebot_parser_get_poll(struct json_object *obj, telebot_poll_t
         poll->total_voter_count = 0;
         poll->is_closed = false;
         poll->is_anonymous = false;
-        TELEBOT_SAFE_FREE(poll->type);
+        poll->type = NULL;
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
     poll->allows_multiple_answers = json_object_get_boolean(allows_multiple_answers);
@@ -2286,7 +2844,7 @@ telebot_error_e telebot_parser_get_poll(struct json_object *obj, telebot_poll_t
         poll->total_voter_count = 0;
         poll->is_closed = false;
         poll->is_anonymous = false;
-        TELEBOT_SAFE_FREE(poll->type);
+        poll->type = NULL;
         poll->allows_multiple_answers = false;
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
@@ -2300,7 +2858,7 @@ telebot_error_e telebot_parser_get_poll(struct json_object *obj, telebot_poll_t
         poll->total_voter_count = 0;
         poll->is_closed = false;
         poll->is_anonymous = false;
-        TELEBOT_SAFE_FREE(poll->type);
+        poll->type = NULL;
         poll->allows_multiple_answers = false;
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
@@ -2315,7 +2873,7 @@ telebot_error_e telebot_parser_get_poll(struct json_object *obj, telebot_poll_t
         poll->is_closed = false;
         poll->is_anonymous = false;
         poll->allows_multiple_answers = false;
-        TELEBOT_SAFE_FREE(poll->type);
+        poll->type = NULL;
         return TELEBOT_ERROR_OUT_OF_MEMORY;
     }
 
@@ -2451,12 +3009,10 @@ telebot_error_e telebot_parser_get_callback_query(struct json_object *obj, teleb
     struct json_object *from = NULL;
     if (json_object_object_get_ex(obj, "from", &from))
     {
-        cb_query->from = calloc(1, sizeof(telebot_user_t));
-        if (telebot_parser_get_user(from, cb_query->from) != TELEBOT_ERROR_NONE)
+        if (telebot_parser_get_user_ref(from, &(cb_query->from)) != TELEBOT_ERROR_NONE)
         {
             ERR("Failed to get <from> from callback_query object");
             TELEBOT_SAFE_FREE(cb_query->id);
-            TELEBOT_SAFE_FREE(cb_query->from);
             return TELEBOT_ERROR_OPERATION_FAILED;
         }
     }
@@ -2556,7 +3112,7 @@ telebot_error_e telebot_parser_get_chat_member(struct json_object *obj, telebot_
         ERR("Object is not chat member type, status not found");
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
-    member->status = TELEBOT_SAFE_STRDUP(json_object_get_string(status));
+    member->member_status = TELEBOT_INTERN_ENUM(status, telebot_chat_member_status_str, &(member->status));
 
     struct json_object *user = NULL;
     if (json_object_object_get_ex(obj, "user", &user))
@@ -2565,7 +3121,7 @@ telebot_error_e telebot_parser_get_chat_member(struct json_object *obj, telebot_
         if (telebot_parser_get_user(user, member->user) != TELEBOT_ERROR_NONE)
         {
             ERR("Failed to get <user> from chat member object");
-            TELEBOT_SAFE_FREE(member->status);
+            member->status = NULL;
             TELEBOT_SAFE_FREE(member->user);
             return TELEBOT_ERROR_OPERATION_FAILED;
         }
@@ -2573,7 +3129,7 @@ telebot_error_e telebot_parser_get_chat_member(struct json_object *obj, telebot_
     else
     {
         ERR("Object is not chat member type, user not found");
-        TELEBOT_SAFE_FREE(member->status);
+        member->status = NULL;
         return TELEBOT_ERROR_OPERATION_FAILED;
     }
 
@@ -3341,15 +3897,13 @@ telebot_error_e telebot_parser_get_chat_member_updated(struct json_object *obj,
     struct json_object *chat = NULL;
     if (json_object_object_get_ex(obj, "chat", &chat))
     {
-        updated->chat = calloc(1, sizeof(telebot_chat_t));
-        telebot_parser_get_chat(chat, updated->chat);
+        telebot_parser_get_chat_ref(chat, &(updated->chat));
     }
 
     struct json_object *from = NULL;
     if (json_object_object_get_ex(obj, "from", &from))
     {
-        updated->from = calloc(1, sizeof(telebot_user_t));
-        telebot_parser_get_user(from, updated->from);
+        telebot_parser_get_user_ref(from, &(updated->from));
     }
 
     struct json_object *date = NULL;
@@ -3393,15 +3947,13 @@ telebot_error_e telebot_parser_get_chat_join_request(struct json_object *obj, te
     struct json_object *chat = NULL;
     if (json_object_object_get_ex(obj, "chat", &chat))
     {
-        request->chat = calloc(1, sizeof(telebot_chat_t));
-        telebot_parser_get_chat(chat, request->chat);
+        telebot_parser_get_chat_ref(chat, &(request->chat));
     }
 
     struct json_object *from = NULL;
     if (json_object_object_get_ex(obj, "from", &from))
     {
-        request->from = calloc(1, sizeof(telebot_user_t));
-        telebot_parser_get_user(from, request->from);
+        telebot_parser_get_user_ref(from, &(request->from));
     }
 
     struct json_object *user_chat_id = NULL;
@@ -3434,11 +3986,11 @@ telebot_error_e telebot_parser_get_reaction_type(struct json_object *obj, telebo
     memset(reaction, 0, sizeof(telebot_reaction_type_t));
     struct json_object *type = NULL;
     if (json_object_object_get_ex(obj, "type", &type))
-        reaction->type = TELEBOT_SAFE_STRDUP(json_object_get_string(type));
+        reaction->reaction_type = TELEBOT_INTERN_ENUM(type, telebot_reaction_type_str, &(reaction->type));
 
     struct json_object *emoji = NULL;
     if (json_object_object_get_ex(obj, "emoji", &emoji))
-        reaction->emoji = TELEBOT_SAFE_STRDUP(json_object_get_string(emoji));
+        reaction->emoji = telebot_intern(json_object_get_string(emoji));
 
     struct json_object *custom_emoji_id = NULL;
     if (json_object_object_get_ex(obj, "custom_emoji_id", &custom_emoji_id))
@@ -3456,8 +4008,7 @@ telebot_error_e telebot_parser_get_message_reaction_updated(struct json_object *
     struct json_object *chat = NULL;
     if (json_object_object_get_ex(obj, "chat", &chat))
     {
-        updated->chat = calloc(1, sizeof(telebot_chat_t));
-        telebot_parser_get_chat(chat, updated->chat);
+        telebot_parser_get_chat_ref(chat, &(updated->chat));
     }
 
     struct json_object *message_id = NULL;
@@ -3467,15 +4018,13 @@ telebot_error_e telebot_parser_get_message_reaction_updated(struct json_object *
     struct json_object *user = NULL;
     if (json_object_object_get_ex(obj, "user", &user))
     {
-        updated->user = calloc(1, sizeof(telebot_user_t));
-        telebot_parser_get_user(user, updated->user);
+        telebot_parser_get_user_ref(user, &(updated->user));
     }
 
     struct json_object *actor_chat = NULL;
     if (json_object_object_get_ex(obj, "actor_chat", &actor_chat))
     {
-        updated->actor_chat = calloc(1, sizeof(telebot_chat_t));
-        telebot_parser_get_chat(actor_chat, updated->actor_chat);
+        telebot_parser_get_chat_ref(actor_chat, &(updated->actor_chat));
     }
 
     struct json_object *date = NULL;
@@ -3531,8 +4080,7 @@ telebot_error_e telebot_parser_get_message_reaction_count_updated(struct json_ob
     struct json_object *chat = NULL;
     if (json_object_object_get_ex(obj, "chat", &chat))
     {
-        updated->chat = calloc(1, sizeof(telebot_chat_t));
-        telebot_parser_get_chat(chat, updated->chat);
+        telebot_parser_get_chat_ref(chat, &(updated->chat));
     }
 
     struct json_object *message_id = NULL;
@@ -3613,8 +4161,7 @@ telebot_error_e telebot_parser_get_chat_boost_updated(struct json_object *obj, t
     struct json_object *chat = NULL;
     if (json_object_object_get_ex(obj, "chat", &chat))
     {
-        updated->chat = calloc(1, sizeof(telebot_chat_t));
-        telebot_parser_get_chat(chat, updated->chat);
+        telebot_parser_get_chat_ref(chat, &(updated->chat));
     }
 
     struct json_object *boost = NULL;
@@ -3636,8 +4183,7 @@ telebot_error_e telebot_parser_get_chat_boost_removed(struct json_object *obj, t
     struct json_object *chat = NULL;
     if (json_object_object_get_ex(obj, "chat", &chat))
     {
-        removed->chat = calloc(1, sizeof(telebot_chat_t));
-        telebot_parser_get_chat(chat, removed->chat);
+        telebot_parser_get_chat_ref(chat, &(removed->chat));
     }
 
     struct json_object *boost_id = NULL;
@@ -3696,8 +4242,7 @@ telebot_error_e telebot_parser_get_inline_query(struct json_object *obj, telebot
     struct json_object *from = NULL;
     if (json_object_object_get_ex(obj, "from", &from))
     {
-        query->from = calloc(1, sizeof(telebot_user_t));
-        telebot_parser_get_user(from, query->from);
+        telebot_parser_get_user_ref(from, &(query->from));
     }
 
     struct json_object *query_obj = NULL;
@@ -3735,8 +4280,7 @@ telebot_error_e telebot_parser_get_chosen_inline_result(struct json_object *obj,
     struct json_object *from = NULL;
     if (json_object_object_get_ex(obj, "from", &from))
     {
-        result->from = calloc(1, sizeof(telebot_user_t));
-        telebot_parser_get_user(from, result->from);
+        telebot_parser_get_user_ref(from, &(result->from));
     }
 
     struct json_object *location = NULL;
@@ -3770,8 +4314,7 @@ telebot_error_e telebot_parser_get_shipping_query(struct json_object *obj, teleb
     struct json_object *from = NULL;
     if (json_object_object_get_ex(obj, "from", &from))
     {
-        query->from = calloc(1, sizeof(telebot_user_t));
-        telebot_parser_get_user(from, query->from);
+        telebot_parser_get_user_ref(from, &(query->from));
     }
 
     struct json_object *invoice_payload = NULL;
@@ -3785,6 +4328,8 @@ telebot_error_e telebot_parser_get_shipping_query(struct json_object *obj, teleb
         telebot_parser_get_shipping_address(shipping_address, query->shipping_address);
     }
 
+    query->received = telebot_scheduler_now();
+
     return TELEBOT_ERROR_NONE;
 }
 
@@ -3801,8 +4346,7 @@ telebot_error_e telebot_parser_get_pre_checkout_query(struct json_object *obj, t
     struct json_object *from = NULL;
     if (json_object_object_get_ex(obj, "from", &from))
     {
-        query->from = calloc(1, sizeof(telebot_user_t));
-        telebot_parser_get_user(from, query->from);
+        telebot_parser_get_user_ref(from, &(query->from));
     }
 
     struct json_object *currency = NULL;
@@ -3828,13 +4372,186 @@ telebot_error_e telebot_parser_get_pre_checkout_query(struct json_object *obj, t
         telebot_parser_get_order_info(order_info, query->order_info);
     }
 
+    query->received = telebot_scheduler_now();
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static telebot_error_e telebot_parser_get_mask_position(struct json_object *obj, telebot_mask_position_t *mask_position)
+{
+    if ((obj == NULL) || (mask_position == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    memset(mask_position, 0, sizeof(telebot_mask_position_t));
+    struct json_object *point = NULL;
+    if (!json_object_object_get_ex(obj, "point", &point))
+    {
+        ERR("Object is not mask position type, point not found");
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+    mask_position->point = TELEBOT_SAFE_STRDUP(json_object_get_string(point));
+
+    struct json_object *x_shift = NULL;
+    if (json_object_object_get_ex(obj, "x_shift", &x_shift))
+        mask_position->x_shift = json_object_get_double(x_shift);
+
+    struct json_object *y_shift = NULL;
+    if (json_object_object_get_ex(obj, "y_shift", &y_shift))
+        mask_position->y_shift = json_object_get_double(y_shift);
+
+    struct json_object *scale = NULL;
+    if (json_object_object_get_ex(obj, "scale", &scale))
+        mask_position->scale = json_object_get_double(scale);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_parser_get_sticker(struct json_object *obj, telebot_sticker_t *sticker)
+{
+    if ((obj == NULL) || (sticker == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    memset(sticker, 0, sizeof(telebot_sticker_t));
+    struct json_object *file_id = NULL;
+    if (!json_object_object_get_ex(obj, "file_id", &file_id))
+    {
+        ERR("Object is not sticker type, file_id not found");
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+    sticker->file_id = TELEBOT_SAFE_STRDUP(json_object_get_string(file_id));
+
+    struct json_object *file_unique_id = NULL;
+    if (json_object_object_get_ex(obj, "file_unique_id", &file_unique_id))
+        sticker->file_unique_id = TELEBOT_SAFE_STRDUP(json_object_get_string(file_unique_id));
+
+    struct json_object *width = NULL;
+    if (json_object_object_get_ex(obj, "width", &width))
+        sticker->width = json_object_get_int(width);
+
+    struct json_object *height = NULL;
+    if (json_object_object_get_ex(obj, "height", &height))
+        sticker->height = json_object_get_int(height);
+
+    struct json_object *is_animated = NULL;
+    if (json_object_object_get_ex(obj, "is_animated", &is_animated))
+        sticker->is_animated = json_object_get_boolean(is_animated);
+
+    /* Renamed to thumbnail by Bot API 6.6 */
+    struct json_object *thumb = NULL;
+    if (json_object_object_get_ex(obj, "thumbnail", &thumb) || json_object_object_get_ex(obj, "thumb", &thumb))
+    {
+        sticker->thumb = calloc(1, sizeof(telebot_photo_t));
+        if (telebot_parser_get_photo(thumb, sticker->thumb) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <thumb> from sticker object");
+            TELEBOT_SAFE_FREE(sticker->thumb);
+        }
+    }
+
+    struct json_object *emoji = NULL;
+    if (json_object_object_get_ex(obj, "emoji", &emoji))
+        sticker->emoji = TELEBOT_SAFE_STRDUP(json_object_get_string(emoji));
+
+    struct json_object *set_name = NULL;
+    if (json_object_object_get_ex(obj, "set_name", &set_name))
+        sticker->set_name = TELEBOT_SAFE_STRDUP(json_object_get_string(set_name));
+
+    struct json_object *mask_position = NULL;
+    if (json_object_object_get_ex(obj, "mask_position", &mask_position))
+    {
+        sticker->mask_position = calloc(1, sizeof(telebot_mask_position_t));
+        if (telebot_parser_get_mask_position(mask_position, sticker->mask_position) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <mask_position> from sticker object");
+            TELEBOT_SAFE_FREE(sticker->mask_position);
+        }
+    }
+
+    struct json_object *file_size = NULL;
+    if (json_object_object_get_ex(obj, "file_size", &file_size))
+        sticker->file_size = json_object_get_int(file_size);
+
     return TELEBOT_ERROR_NONE;
 }
 
 telebot_error_e telebot_parser_get_stickers(struct json_object *obj, telebot_sticker_t **stickers, int *count)
 {
-    // Stub: implement if needed, usually in telebot-stickers.c
-    return TELEBOT_ERROR_OPERATION_FAILED;
+    if ((obj == NULL) || (stickers == NULL) || (count == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *stickers = NULL;
+    *count = 0;
+
+    int array_len = json_object_array_length(obj);
+    if (array_len == 0)
+        return TELEBOT_ERROR_NONE;
+
+    telebot_sticker_t *result = calloc(array_len, sizeof(telebot_sticker_t));
+    if (result == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    *count = array_len;
+    *stickers = result;
+
+    for (int index = 0; index < array_len; index++)
+    {
+        struct json_object *item = json_object_array_get_idx(obj, index);
+        if (telebot_parser_get_sticker(item, &(result[index])) != TELEBOT_ERROR_NONE)
+            ERR("Failed to parse sticker from stickers array");
+    }
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_parser_get_sticker_set(struct json_object *obj, telebot_sticker_set_t *set)
+{
+    if ((obj == NULL) || (set == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    memset(set, 0, sizeof(telebot_sticker_set_t));
+    struct json_object *name = NULL;
+    if (!json_object_object_get_ex(obj, "name", &name))
+    {
+        ERR("Object is not sticker set type, name not found");
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+    set->name = TELEBOT_SAFE_STRDUP(json_object_get_string(name));
+
+    struct json_object *title = NULL;
+    if (json_object_object_get_ex(obj, "title", &title))
+        set->title = TELEBOT_SAFE_STRDUP(json_object_get_string(title));
+
+    struct json_object *is_animated = NULL;
+    if (json_object_object_get_ex(obj, "is_animated", &is_animated))
+        set->is_animated = json_object_get_boolean(is_animated);
+
+    /* Replaced by sticker_type since Bot API 6.2 */
+    struct json_object *sticker_type = NULL;
+    struct json_object *contains_masks = NULL;
+    if (json_object_object_get_ex(obj, "sticker_type", &sticker_type))
+        set->contains_masks = !strcmp(json_object_get_string(sticker_type), "mask");
+    else if (json_object_object_get_ex(obj, "contains_masks", &contains_masks))
+        set->contains_masks = json_object_get_boolean(contains_masks);
+
+    struct json_object *stickers = NULL;
+    if (json_object_object_get_ex(obj, "stickers", &stickers))
+    {
+        if (telebot_parser_get_stickers(stickers, &(set->stickers), &(set->count_stickers)) != TELEBOT_ERROR_NONE)
+            ERR("Failed to get <stickers> from sticker set object");
+    }
+
+    struct json_object *thumb = NULL;
+    if (json_object_object_get_ex(obj, "thumbnail", &thumb) || json_object_object_get_ex(obj, "thumb", &thumb))
+    {
+        set->thumb = calloc(1, sizeof(telebot_photo_t));
+        if (telebot_parser_get_photo(thumb, set->thumb) != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to get <thumb> from sticker set object");
+            TELEBOT_SAFE_FREE(set->thumb);
+        }
+    }
+
+    return TELEBOT_ERROR_NONE;
 }
 
 static telebot_error_e telebot_parser_get_business_bot_rights(struct json_object *obj, telebot_business_bot_rights_t *rights)
@@ -16,12 +16,651 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
+#include <unistd.h>
 #include <json.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/sha.h>
 #include <telebot-core.h>
 #include <telebot-methods.h>
 #include <telebot-parser.h>
+#include <telebot-passport.h>
 #include <telebot-private.h>
 
+#define TELEBOT_PASSPORT_MAX_WORKERS 8
+/* Chunk of a passport file decrypted at once */
+#define TELEBOT_PASSPORT_CHUNK_SIZE (64 * 1024)
+#define TELEBOT_PASSPORT_HASH_SIZE SHA256_DIGEST_LENGTH
+
+struct telebot_passport_key
+{
+    EVP_PKEY *pkey;
+};
+
+struct telebot_passport_credentials
+{
+    struct json_object *obj;        /* Decrypted credentials */
+    struct json_object *secure_data;
+    const char *nonce;
+};
+
+/* Secret and hash of a decrypted value, taken from secure_data */
+typedef struct telebot_passport_secret
+{
+    unsigned char key[32];
+    unsigned char iv[16];
+    unsigned char hash[TELEBOT_PASSPORT_HASH_SIZE];
+} telebot_passport_secret_t;
+
+typedef void (*telebot_passport_work_f)(void *context, int index);
+
+typedef struct telebot_passport_work
+{
+    pthread_mutex_t lock;
+    telebot_passport_work_f work;
+    void *context;
+    int next;
+    int count;
+} telebot_passport_work_t;
+
+static unsigned char *telebot_passport_base64_decode(const char *text, int *size)
+{
+    if (text == NULL)
+        return NULL;
+
+    int length = strlen(text);
+    if ((length == 0) || (length % 4 != 0))
+        return NULL;
+
+    unsigned char *buffer = malloc(length / 4 * 3 + 1);
+    if (buffer == NULL)
+        return NULL;
+
+    int decoded = EVP_DecodeBlock(buffer, (const unsigned char *)text, length);
+    if (decoded < 0)
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    /* EVP_DecodeBlock() keeps the bytes of padding */
+    for (int i = length - 1; (i >= length - 2) && (text[i] == '='); i--)
+        decoded--;
+
+    *size = decoded;
+    return buffer;
+}
+
+/* Derive key and iv of a value from its secret and hash, both in base64 */
+static telebot_error_e telebot_passport_secret_derive(const unsigned char *secret, int secret_size,
+                                                      const char *hash_base64, telebot_passport_secret_t *out)
+{
+    int hash_size = 0;
+    unsigned char *hash = telebot_passport_base64_decode(hash_base64, &hash_size);
+    if ((hash == NULL) || (hash_size != TELEBOT_PASSPORT_HASH_SIZE))
+    {
+        free(hash);
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+    }
+
+    unsigned char digest[SHA512_DIGEST_LENGTH];
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    bool ok = (ctx != NULL) && EVP_DigestInit_ex(ctx, EVP_sha512(), NULL) &&
+              EVP_DigestUpdate(ctx, secret, secret_size) && EVP_DigestUpdate(ctx, hash, hash_size) &&
+              EVP_DigestFinal_ex(ctx, digest, NULL);
+    EVP_MD_CTX_free(ctx);
+
+    memcpy(out->hash, hash, TELEBOT_PASSPORT_HASH_SIZE);
+    memcpy(out->key, digest, sizeof(out->key));
+    memcpy(out->iv, digest + sizeof(out->key), sizeof(out->iv));
+    OPENSSL_cleanse(digest, sizeof(digest));
+    free(hash);
+
+    return ok ? TELEBOT_ERROR_NONE : TELEBOT_ERROR_OPERATION_FAILED;
+}
+
+/* Secret and hash of a value of secure_data, the secret is in base64 */
+static telebot_error_e telebot_passport_secret_get(struct json_object *value, const char *hash_name,
+                                                   telebot_passport_secret_t *out)
+{
+    struct json_object *secret = NULL, *hash = NULL;
+    if (!json_object_object_get_ex(value, "secret", &secret) ||
+        !json_object_object_get_ex(value, hash_name, &hash))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    int secret_size = 0;
+    unsigned char *raw = telebot_passport_base64_decode(json_object_get_string(secret), &secret_size);
+    if (raw == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_error_e ret = telebot_passport_secret_derive(raw, secret_size, json_object_get_string(hash), out);
+    OPENSSL_cleanse(raw, secret_size);
+    free(raw);
+
+    return ret;
+}
+
+/* Decrypt a whole value, verify its hash and strip its leading padding */
+static telebot_error_e telebot_passport_decrypt(const telebot_passport_secret_t *secret,
+                                                const unsigned char *data, int size, char **plain)
+{
+    if ((size < 32) || (size % 16 != 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    unsigned char *buffer = malloc(size + 1);
+    if (buffer == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    int length = 0, final = 0;
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    bool ok = (ctx != NULL) && EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, secret->key, secret->iv) &&
+              EVP_CIPHER_CTX_set_padding(ctx, 0) && EVP_DecryptUpdate(ctx, buffer, &length, data, size) &&
+              EVP_DecryptFinal_ex(ctx, buffer + length, &final);
+    EVP_CIPHER_CTX_free(ctx);
+    if (!ok)
+    {
+        free(buffer);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+    length += final;
+
+    unsigned char hash[TELEBOT_PASSPORT_HASH_SIZE];
+    SHA256(buffer, length, hash);
+    int padding = buffer[0];
+    if (CRYPTO_memcmp(hash, secret->hash, sizeof(hash)) || (padding < 32) || (padding > length))
+    {
+        free(buffer);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    memmove(buffer, buffer + padding, length - padding);
+    buffer[length - padding] = '\0';
+    *plain = (char *)buffer;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static void *telebot_passport_worker(void *arg)
+{
+    telebot_passport_work_t *work = arg;
+    for (;;)
+    {
+        pthread_mutex_lock(&(work->lock));
+        int index = work->next++;
+        pthread_mutex_unlock(&(work->lock));
+        if (index >= work->count)
+            break;
+
+        work->work(work->context, index);
+    }
+
+    return NULL;
+}
+
+/* Run work on every index, spread over as many threads as it is worth */
+static void telebot_passport_run(telebot_passport_work_f callback, void *context, int count)
+{
+    telebot_passport_work_t work = {.work = callback, .context = context, .count = count};
+    pthread_mutex_init(&(work.lock), NULL);
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = (online > 0) ? (int)online : 1;
+    if (workers > TELEBOT_PASSPORT_MAX_WORKERS)
+        workers = TELEBOT_PASSPORT_MAX_WORKERS;
+    if (workers > count)
+        workers = count;
+
+    /* The calling thread is a worker too */
+    pthread_t threads[TELEBOT_PASSPORT_MAX_WORKERS];
+    int started = 0;
+    for (; started < workers - 1; started++)
+    {
+        if (pthread_create(&(threads[started]), NULL, telebot_passport_worker, &work))
+            break;
+    }
+
+    telebot_passport_worker(&work);
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    pthread_mutex_destroy(&(work.lock));
+}
+
+void telebot_passport_key_destroy(telebot_passport_key_t *key)
+{
+    if (key == NULL)
+        return;
+
+    EVP_PKEY_free(key->pkey);
+    free(key);
+}
+
+telebot_error_e telebot_set_passport_private_key(telebot_handler_t handle, const char *private_key_pem)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    telebot_passport_key_t *key = NULL;
+    if (private_key_pem != NULL)
+    {
+        BIO *bio = BIO_new_mem_buf(private_key_pem, -1);
+        if (bio == NULL)
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+        EVP_PKEY *pkey = PEM_read_bio_PrivateKey(bio, NULL, NULL, NULL);
+        BIO_free(bio);
+        if ((pkey == NULL) || (EVP_PKEY_get_base_id(pkey) != EVP_PKEY_RSA))
+        {
+            EVP_PKEY_free(pkey);
+            return TELEBOT_ERROR_INVALID_PARAMETER;
+        }
+
+        key = calloc(1, sizeof(telebot_passport_key_t));
+        if (key == NULL)
+        {
+            EVP_PKEY_free(pkey);
+            return TELEBOT_ERROR_OUT_OF_MEMORY;
+        }
+        key->pkey = pkey;
+    }
+
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_passport_key_t *old = handle->passport_key;
+    handle->passport_key = key;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_passport_key_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_decrypt_passport_credentials(telebot_handler_t handle,
+                                                     const telebot_encrypted_credentials_t *encrypted,
+                                                     telebot_passport_credentials_t *credentials)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((encrypted == NULL) || (credentials == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    int encrypted_secret_size = 0;
+    unsigned char *encrypted_secret = telebot_passport_base64_decode(encrypted->secret, &encrypted_secret_size);
+    if (encrypted_secret == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    /* The key is kept until the secret is decrypted */
+    pthread_rwlock_rdlock(&(handle->lock));
+    if (handle->passport_key == NULL)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        free(encrypted_secret);
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+    }
+
+    unsigned char secret[512];
+    size_t secret_size = sizeof(secret);
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new(handle->passport_key->pkey, NULL);
+    bool ok = (ctx != NULL) && (EVP_PKEY_decrypt_init(ctx) > 0) &&
+              (EVP_PKEY_CTX_set_rsa_padding(ctx, RSA_PKCS1_OAEP_PADDING) > 0) &&
+              (EVP_PKEY_decrypt(ctx, NULL, &secret_size, encrypted_secret, encrypted_secret_size) > 0) &&
+              (secret_size <= sizeof(secret)) &&
+              (EVP_PKEY_decrypt(ctx, secret, &secret_size, encrypted_secret, encrypted_secret_size) > 0);
+    EVP_PKEY_CTX_free(ctx);
+    pthread_rwlock_unlock(&(handle->lock));
+    free(encrypted_secret);
+    if (!ok)
+        return TELEBOT_ERROR_OPERATION_FAILED;
+
+    telebot_passport_secret_t derived;
+    telebot_error_e ret = telebot_passport_secret_derive(secret, secret_size, encrypted->hash, &derived);
+    OPENSSL_cleanse(secret, sizeof(secret));
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    int data_size = 0;
+    unsigned char *data = telebot_passport_base64_decode(encrypted->data, &data_size);
+    if (data == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    char *plain = NULL;
+    ret = telebot_passport_decrypt(&derived, data, data_size, &plain);
+    OPENSSL_cleanse(&derived, sizeof(derived));
+    free(data);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    struct json_object *obj = json_tokener_parse(plain);
+    free(plain);
+    struct json_object *secure_data = NULL;
+    if ((obj == NULL) || !json_object_object_get_ex(obj, "secure_data", &secure_data))
+    {
+        json_object_put(obj);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    struct telebot_passport_credentials *result = calloc(1, sizeof(struct telebot_passport_credentials));
+    if (result == NULL)
+    {
+        json_object_put(obj);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+    result->obj = obj;
+    result->secure_data = secure_data;
+
+    struct json_object *nonce = NULL;
+    if (json_object_object_get_ex(obj, "nonce", &nonce))
+        result->nonce = json_object_get_string(nonce);
+
+    *credentials = result;
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_get_passport_nonce(telebot_passport_credentials_t credentials, const char **nonce)
+{
+    if ((credentials == NULL) || (nonce == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *nonce = credentials->nonce;
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_put_passport_credentials(telebot_passport_credentials_t credentials)
+{
+    if (credentials == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    json_object_put(credentials->obj);
+    free(credentials);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+typedef struct telebot_passport_elements_work
+{
+    telebot_passport_credentials_t credentials;
+    const telebot_passport_data_t *passport_data;
+    telebot_passport_element_t *elements;
+    telebot_error_e *results;
+} telebot_passport_elements_work_t;
+
+static void telebot_passport_decrypt_element(void *context, int index)
+{
+    telebot_passport_elements_work_t *work = context;
+    const telebot_encrypted_passport_element_t *encrypted = &(work->passport_data->data[index]);
+    telebot_passport_element_t *element = &(work->elements[index]);
+
+    if (encrypted->type == NULL)
+    {
+        work->results[index] = TELEBOT_ERROR_INVALID_PARAMETER;
+        return;
+    }
+
+    element->type = strdup(encrypted->type);
+    if (element->type == NULL)
+    {
+        work->results[index] = TELEBOT_ERROR_OUT_OF_MEMORY;
+        return;
+    }
+
+    /* Phone number and email are not encrypted */
+    if (encrypted->data == NULL)
+        return;
+
+    struct json_object *value = NULL, *data = NULL;
+    if (!json_object_object_get_ex(work->credentials->secure_data, encrypted->type, &value) ||
+        !json_object_object_get_ex(value, "data", &data))
+    {
+        work->results[index] = TELEBOT_ERROR_INVALID_PARAMETER;
+        return;
+    }
+
+    telebot_passport_secret_t secret;
+    telebot_error_e ret = telebot_passport_secret_get(data, "data_hash", &secret);
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        work->results[index] = ret;
+        return;
+    }
+
+    int size = 0;
+    unsigned char *raw = telebot_passport_base64_decode(encrypted->data, &size);
+    if (raw == NULL)
+        ret = TELEBOT_ERROR_INVALID_PARAMETER;
+    else
+        ret = telebot_passport_decrypt(&secret, raw, size, &(element->data));
+
+    OPENSSL_cleanse(&secret, sizeof(secret));
+    free(raw);
+    work->results[index] = ret;
+}
+
+telebot_error_e telebot_decrypt_passport_elements(telebot_passport_credentials_t credentials,
+                                                  const telebot_passport_data_t *passport_data,
+                                                  telebot_passport_element_t **elements, int *count)
+{
+    if ((credentials == NULL) || (passport_data == NULL) || (elements == NULL) || (count == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *elements = NULL;
+    *count = 0;
+    if ((passport_data->data == NULL) || (passport_data->count_data <= 0))
+        return TELEBOT_ERROR_NONE;
+
+    int total = passport_data->count_data;
+    telebot_passport_elements_work_t work = {
+        .credentials = credentials,
+        .passport_data = passport_data,
+        .elements = calloc(total, sizeof(telebot_passport_element_t)),
+        .results = calloc(total, sizeof(telebot_error_e)),
+    };
+    if ((work.elements == NULL) || (work.results == NULL))
+    {
+        free(work.elements);
+        free(work.results);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    telebot_passport_run(telebot_passport_decrypt_element, &work, total);
+
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    for (int index = 0; (index < total) && (ret == TELEBOT_ERROR_NONE); index++)
+        ret = work.results[index];
+    free(work.results);
+
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        telebot_put_passport_elements(work.elements, total);
+        return ret;
+    }
+
+    *elements = work.elements;
+    *count = total;
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_put_passport_elements(telebot_passport_element_t *elements, int count)
+{
+    if (elements == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    for (int index = 0; index < count; index++)
+    {
+        TELEBOT_SAFE_FREE(elements[index].type);
+        if (elements[index].data != NULL)
+            OPENSSL_cleanse(elements[index].data, strlen(elements[index].data));
+        TELEBOT_SAFE_FREE(elements[index].data);
+    }
+    free(elements);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+/* Credentials of a file, from secure_data.<type>.<field>[index] */
+static telebot_error_e telebot_passport_file_secret(telebot_passport_credentials_t credentials,
+                                                    const telebot_passport_file_job_t *job,
+                                                    telebot_passport_secret_t *secret)
+{
+    static const char *const fields[] = {
+        [TELEBOT_PASSPORT_FILE] = "files",
+        [TELEBOT_PASSPORT_FILE_FRONT_SIDE] = "front_side",
+        [TELEBOT_PASSPORT_FILE_REVERSE_SIDE] = "reverse_side",
+        [TELEBOT_PASSPORT_FILE_SELFIE] = "selfie",
+        [TELEBOT_PASSPORT_FILE_TRANSLATION] = "translation",
+    };
+
+    if ((job->element_type == NULL) || (job->kind < TELEBOT_PASSPORT_FILE) ||
+        (job->kind > TELEBOT_PASSPORT_FILE_TRANSLATION))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    struct json_object *value = NULL, *field = NULL;
+    if (!json_object_object_get_ex(credentials->secure_data, job->element_type, &value) ||
+        !json_object_object_get_ex(value, fields[job->kind], &field))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    if ((job->kind == TELEBOT_PASSPORT_FILE) || (job->kind == TELEBOT_PASSPORT_FILE_TRANSLATION))
+    {
+        if ((job->index < 0) || (job->index >= (int)json_object_array_length(field)))
+            return TELEBOT_ERROR_INVALID_PARAMETER;
+        field = json_object_array_get_idx(field, job->index);
+    }
+
+    return telebot_passport_secret_get(field, "file_hash", secret);
+}
+
+/* Decrypt a file chunk by chunk, the leading padding may span chunks */
+static telebot_error_e telebot_passport_decrypt_file(const telebot_passport_secret_t *secret,
+                                                     FILE *in, FILE *out)
+{
+    unsigned char *input = malloc(TELEBOT_PASSPORT_CHUNK_SIZE);
+    unsigned char *output = malloc(TELEBOT_PASSPORT_CHUNK_SIZE + 16);
+    EVP_CIPHER_CTX *cipher = EVP_CIPHER_CTX_new();
+    EVP_MD_CTX *digest = EVP_MD_CTX_new();
+
+    telebot_error_e ret = TELEBOT_ERROR_OPERATION_FAILED;
+    if ((input == NULL) || (output == NULL) || (cipher == NULL) || (digest == NULL))
+    {
+        ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+        goto finish;
+    }
+
+    if (!EVP_DecryptInit_ex(cipher, EVP_aes_256_cbc(), NULL, secret->key, secret->iv) ||
+        !EVP_CIPHER_CTX_set_padding(cipher, 0) || !EVP_DigestInit_ex(digest, EVP_sha256(), NULL))
+        goto finish;
+
+    long long int total = 0;
+    int padding = -1, skip = 0;
+    size_t size;
+    while ((size = fread(input, 1, TELEBOT_PASSPORT_CHUNK_SIZE, in)) > 0)
+    {
+        int length = 0;
+        if (!EVP_DecryptUpdate(cipher, output, &length, input, size) ||
+            !EVP_DigestUpdate(digest, output, length))
+            goto finish;
+        total += size;
+
+        if ((padding < 0) && (length > 0))
+        {
+            padding = output[0];
+            skip = padding;
+        }
+
+        int offset = (skip < length) ? skip : length;
+        skip -= offset;
+        if ((length > offset) && (fwrite(output + offset, 1, length - offset, out) != (size_t)(length - offset)))
+        {
+            ret = TELEBOT_ERROR_OPERATION_FAILED;
+            goto finish;
+        }
+    }
+
+    int final = 0;
+    unsigned char hash[TELEBOT_PASSPORT_HASH_SIZE];
+    if (ferror(in) || !EVP_DecryptFinal_ex(cipher, output, &final) ||
+        !EVP_DigestFinal_ex(digest, hash, NULL))
+        goto finish;
+
+    if ((total < 32) || (total % 16 != 0) || (padding < 32) || (skip > 0) ||
+        CRYPTO_memcmp(hash, secret->hash, sizeof(hash)))
+        goto finish;
+
+    ret = (fflush(out) == 0) ? TELEBOT_ERROR_NONE : TELEBOT_ERROR_OPERATION_FAILED;
+
+finish:
+    EVP_MD_CTX_free(digest);
+    EVP_CIPHER_CTX_free(cipher);
+    free(output);
+    free(input);
+    return ret;
+}
+
+typedef struct telebot_passport_files_work
+{
+    telebot_passport_credentials_t credentials;
+    telebot_passport_file_job_t *jobs;
+} telebot_passport_files_work_t;
+
+static void telebot_passport_decrypt_file_job(void *context, int index)
+{
+    telebot_passport_files_work_t *work = context;
+    telebot_passport_credentials_t credentials = work->credentials;
+    telebot_passport_file_job_t *job = &(work->jobs[index]);
+
+    if ((job->input_path == NULL) || (job->output_path == NULL))
+    {
+        job->result = TELEBOT_ERROR_INVALID_PARAMETER;
+        return;
+    }
+
+    telebot_passport_secret_t secret;
+    job->result = telebot_passport_file_secret(credentials, job, &secret);
+    if (job->result != TELEBOT_ERROR_NONE)
+        return;
+
+    FILE *in = fopen(job->input_path, "rb");
+    if (in == NULL)
+    {
+        OPENSSL_cleanse(&secret, sizeof(secret));
+        job->result = TELEBOT_ERROR_OPERATION_FAILED;
+        return;
+    }
+
+    FILE *out = fopen(job->output_path, "wb");
+    if (out == NULL)
+        job->result = TELEBOT_ERROR_OPERATION_FAILED;
+    else
+        job->result = telebot_passport_decrypt_file(&secret, in, out);
+
+    OPENSSL_cleanse(&secret, sizeof(secret));
+    fclose(in);
+    if ((out != NULL) && (fclose(out) != 0) && (job->result == TELEBOT_ERROR_NONE))
+        job->result = TELEBOT_ERROR_OPERATION_FAILED;
+
+    /* Do not leave a partial or forged file behind */
+    if ((out != NULL) && (job->result != TELEBOT_ERROR_NONE))
+        unlink(job->output_path);
+}
+
+telebot_error_e telebot_decrypt_passport_files(telebot_passport_credentials_t credentials,
+                                               telebot_passport_file_job_t *jobs, int count)
+{
+    if ((credentials == NULL) || (jobs == NULL) || (count <= 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_passport_files_work_t work = {.credentials = credentials, .jobs = jobs};
+    telebot_passport_run(telebot_passport_decrypt_file_job, &work, count);
+
+    for (int index = 0; index < count; index++)
+    {
+        if (jobs[index].result != TELEBOT_ERROR_NONE)
+            return jobs[index].result;
+    }
+
+    return TELEBOT_ERROR_NONE;
+}
+
 telebot_error_e telebot_set_passport_data_errors(telebot_handler_t handle,
                                                  long long int user_id, const char *errors)
 {
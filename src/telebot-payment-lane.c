@@ -0,0 +1,531 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <json.h>
+#include <telebot-core.h>
+#include <telebot-methods.h>
+#include <telebot-parser.h>
+#include <telebot-payments.h>
+#include <telebot-private.h>
+
+/* Idle time after which the answer connection is refreshed, milliseconds */
+#define TELEBOT_PAYMENT_KEEPALIVE (30 * 1000)
+/* Queries answered at the deadline are remembered this long to reject late answers */
+#define TELEBOT_PAYMENT_RETAIN (60 * 1000)
+/* Connections of the answer transport, so the deadline timer never waits for the worker */
+#define TELEBOT_PAYMENT_CONNECTIONS 2
+
+/* Query waiting for its answer, payment queries are rare so they are kept in a list */
+typedef struct telebot_payment_query
+{
+    struct telebot_payment_query *next; /* Next query received */
+    char *id;
+    telebot_update_type_e type;
+    int64_t received; /* Monotonic time in milliseconds */
+    bool overrun;     /* Answered with the error at the deadline */
+} telebot_payment_query_t;
+
+/* Update waiting for the worker */
+typedef struct telebot_payment_job
+{
+    struct telebot_payment_job *next;
+    telebot_update_t *update;
+} telebot_payment_job_t;
+
+/* Overrun query to answer, taken out of the lock */
+typedef struct telebot_payment_overrun
+{
+    struct telebot_payment_overrun *next;
+    char *id;
+    telebot_update_type_e type;
+} telebot_payment_overrun_t;
+
+struct telebot_payment_lane
+{
+    telebot_handler_t handle;
+    telebot_core_handler_t core_h; /* Persistent connections for answers */
+    telebot_payment_cb_f callback;
+    void *user_data;
+    int64_t deadline; /* Milliseconds to answer in */
+    char *error_message;
+    pthread_t thread;
+    pthread_t timer; /* Answers overrun queries, the worker may be busy past the deadline */
+    pthread_mutex_t lock;
+    pthread_cond_t cond; /* Shared by worker and timer, so it is broadcast */
+    bool stop;
+    int64_t due; /* Monotonic time the timer runs next */
+    telebot_payment_job_t *jobs_head;
+    telebot_payment_job_t *jobs_tail;
+    telebot_payment_query_t *queries; /* Oldest query first */
+    telebot_payment_query_t *queries_tail;
+    int64_t last_request; /* Monotonic time of last request on core_h */
+    unsigned long long received;
+    unsigned long long answers;
+    unsigned long long overruns;
+    unsigned long long late_answers;
+    int64_t answer_time_max;
+};
+
+static void telebot_payment_lane_query_free(telebot_payment_query_t *query)
+{
+    free(query->id);
+    free(query);
+}
+
+static void *telebot_payment_lane_thread(void *data)
+{
+    telebot_payment_lane_t *lane = data;
+
+    while (true)
+    {
+        pthread_mutex_lock(&(lane->lock));
+        while (!lane->stop && (lane->jobs_head == NULL))
+            pthread_cond_wait(&(lane->cond), &(lane->lock));
+
+        if (lane->stop)
+        {
+            pthread_mutex_unlock(&(lane->lock));
+            break;
+        }
+
+        telebot_payment_job_t *job = lane->jobs_head;
+        lane->jobs_head = job->next;
+        if (lane->jobs_head == NULL)
+            lane->jobs_tail = NULL;
+        pthread_mutex_unlock(&(lane->lock));
+
+        lane->callback(lane->user_data, lane->handle, job->update);
+        telebot_put_updates(job->update, 1);
+        free(job);
+    }
+
+    return NULL;
+}
+
+static int64_t telebot_payment_lane_expire(telebot_payment_lane_t *lane, int64_t now)
+{
+    telebot_payment_overrun_t *batch = NULL;
+    int64_t next = -1;
+
+    pthread_mutex_lock(&(lane->lock));
+    telebot_payment_query_t **link = &(lane->queries);
+    lane->queries_tail = NULL;
+    while (*link != NULL)
+    {
+        telebot_payment_query_t *query = *link;
+        if (!query->overrun && (query->received + lane->deadline <= now))
+        {
+            telebot_payment_overrun_t *overrun = malloc(sizeof(telebot_payment_overrun_t));
+            if ((overrun != NULL) && ((overrun->id = strdup(query->id)) != NULL))
+            {
+                overrun->type = query->type;
+                overrun->next = batch;
+                batch = overrun;
+            }
+            else
+            {
+                free(overrun);
+            }
+            query->overrun = true;
+            lane->overruns++;
+        }
+
+        int64_t due = query->overrun ? query->received + lane->deadline + TELEBOT_PAYMENT_RETAIN
+                                     : query->received + lane->deadline;
+        if (due <= now)
+        {
+            *link = query->next;
+            telebot_payment_lane_query_free(query);
+            continue;
+        }
+
+        if ((next < 0) || (due < next))
+            next = due;
+        lane->queries_tail = query;
+        link = &(query->next);
+    }
+
+    bool keepalive = (batch == NULL) && (lane->last_request + TELEBOT_PAYMENT_KEEPALIVE <= now);
+    if ((batch != NULL) || keepalive)
+        lane->last_request = now;
+    if ((next < 0) || (lane->last_request + TELEBOT_PAYMENT_KEEPALIVE < next))
+        next = lane->last_request + TELEBOT_PAYMENT_KEEPALIVE;
+    pthread_mutex_unlock(&(lane->lock));
+
+    while (batch != NULL)
+    {
+        telebot_payment_overrun_t *overrun = batch;
+        batch = overrun->next;
+
+        telebot_core_response_t response = NULL;
+        if (overrun->type == TELEBOT_UPDATE_TYPE_PRE_CHECKOUT_QUERY)
+            response = telebot_core_answer_pre_checkout_query(lane->core_h, overrun->id, false,
+                                                              lane->error_message);
+        else
+            response = telebot_core_answer_shipping_query(lane->core_h, overrun->id, false, NULL,
+                                                          lane->error_message);
+        if (telebot_core_get_response_code(response) != TELEBOT_ERROR_NONE)
+            ERR("Failed to answer overrun payment query %s", overrun->id);
+        telebot_core_put_response(response);
+
+        free(overrun->id);
+        free(overrun);
+    }
+
+    if (keepalive)
+        telebot_core_put_response(telebot_core_get_me(lane->core_h));
+
+    return next;
+}
+
+static void *telebot_payment_lane_timer(void *data)
+{
+    telebot_payment_lane_t *lane = data;
+
+    pthread_mutex_lock(&(lane->lock));
+    while (!lane->stop)
+    {
+        int64_t now = telebot_scheduler_now();
+        if (lane->due > now)
+        {
+            struct timespec ts = {.tv_sec = lane->due / 1000, .tv_nsec = (lane->due % 1000) * 1000000};
+            pthread_cond_timedwait(&(lane->cond), &(lane->lock), &ts);
+            continue;
+        }
+
+        /* Queries submitted meanwhile lower it again */
+        lane->due = INT64_MAX;
+        pthread_mutex_unlock(&(lane->lock));
+
+        int64_t next = telebot_payment_lane_expire(lane, now);
+
+        pthread_mutex_lock(&(lane->lock));
+        if (next < lane->due)
+            lane->due = next;
+    }
+    pthread_mutex_unlock(&(lane->lock));
+
+    return NULL;
+}
+
+static telebot_error_e telebot_payment_lane_create_core(telebot_core_handler_t source,
+                                                        telebot_core_handler_t *core_h)
+{
+    telebot_error_e ret = telebot_core_create(core_h, source->token);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    ret = telebot_core_set_api_url(*core_h, source->api_url);
+    if ((ret == TELEBOT_ERROR_NONE) && (source->proxy_addr != NULL))
+        ret = telebot_core_set_proxy(*core_h, source->proxy_addr, source->proxy_auth);
+    if (ret == TELEBOT_ERROR_NONE)
+        ret = telebot_core_set_http_version(*core_h, TELEBOT_HTTP_VERSION_1_1, TELEBOT_PAYMENT_CONNECTIONS, 0);
+
+    if (ret != TELEBOT_ERROR_NONE)
+        telebot_core_destroy(core_h);
+
+    return ret;
+}
+
+static telebot_error_e telebot_payment_lane_create(telebot_handler_t handle, telebot_payment_cb_f callback,
+                                                   void *user_data, int deadline, const char *error_message,
+                                                   telebot_payment_lane_t **lane)
+{
+    telebot_payment_lane_t *_lane = calloc(1, sizeof(telebot_payment_lane_t));
+    if (_lane == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    _lane->handle = handle;
+    _lane->callback = callback;
+    _lane->user_data = user_data;
+    _lane->deadline = deadline;
+    _lane->error_message = strdup(error_message);
+    if (_lane->error_message == NULL)
+    {
+        free(_lane);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    telebot_error_e ret = telebot_payment_lane_create_core(handle->core_h, &(_lane->core_h));
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        free(_lane->error_message);
+        free(_lane);
+        return ret;
+    }
+
+    /* Open the answer connection right away */
+    int64_t now = telebot_scheduler_now();
+    _lane->last_request = now - TELEBOT_PAYMENT_KEEPALIVE;
+    _lane->due = now;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&(_lane->cond), &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&(_lane->lock), NULL);
+    if (pthread_create(&(_lane->thread), NULL, telebot_payment_lane_thread, _lane) != 0)
+    {
+        ERR("Failed to start payment lane thread");
+        ret = TELEBOT_ERROR_OPERATION_FAILED;
+        goto error;
+    }
+
+    if (pthread_create(&(_lane->timer), NULL, telebot_payment_lane_timer, _lane) != 0)
+    {
+        ERR("Failed to start payment lane timer");
+        pthread_mutex_lock(&(_lane->lock));
+        _lane->stop = true;
+        pthread_cond_broadcast(&(_lane->cond));
+        pthread_mutex_unlock(&(_lane->lock));
+        pthread_join(_lane->thread, NULL);
+        ret = TELEBOT_ERROR_OPERATION_FAILED;
+        goto error;
+    }
+
+    *lane = _lane;
+    return TELEBOT_ERROR_NONE;
+
+error:
+    pthread_cond_destroy(&(_lane->cond));
+    pthread_mutex_destroy(&(_lane->lock));
+    telebot_core_destroy(&(_lane->core_h));
+    free(_lane->error_message);
+    free(_lane);
+    return ret;
+}
+
+void telebot_payment_lane_destroy(telebot_payment_lane_t *lane)
+{
+    if (lane == NULL)
+        return;
+
+    pthread_mutex_lock(&(lane->lock));
+    lane->stop = true;
+    pthread_cond_broadcast(&(lane->cond));
+    pthread_mutex_unlock(&(lane->lock));
+    pthread_join(lane->thread, NULL);
+    pthread_join(lane->timer, NULL);
+
+    while (lane->jobs_head != NULL)
+    {
+        telebot_payment_job_t *job = lane->jobs_head;
+        lane->jobs_head = job->next;
+        telebot_put_updates(job->update, 1);
+        free(job);
+    }
+
+    while (lane->queries != NULL)
+    {
+        telebot_payment_query_t *query = lane->queries;
+        lane->queries = query->next;
+        telebot_payment_lane_query_free(query);
+    }
+
+    telebot_core_destroy(&(lane->core_h));
+    pthread_cond_destroy(&(lane->cond));
+    pthread_mutex_destroy(&(lane->lock));
+    free(lane->error_message);
+    free(lane);
+}
+
+void telebot_payment_lane_submit(telebot_payment_lane_t *lane, struct json_object *updates,
+                                 const int64_t *received, const telebot_filter_t *filter)
+{
+    if ((lane == NULL) || (updates == NULL))
+        return;
+
+    telebot_parser_options_t options = {
+        .lazy = false,
+        .filter = filter,
+    };
+
+    int array_len = json_object_array_length(updates);
+    for (int index = 0; index < array_len; index++)
+    {
+        struct json_object *item = json_object_array_get_idx(updates, index);
+        if (!json_object_object_get_ex(item, "pre_checkout_query", NULL) &&
+            !json_object_object_get_ex(item, "shipping_query", NULL))
+            continue;
+
+        /* Parsed alone, so the worker releases it independently of the batch */
+        struct json_object *array = json_object_new_array();
+        if (array == NULL)
+            continue;
+        json_object_array_add(array, json_object_get(item));
+
+        telebot_update_t *update = NULL;
+        int count = 0;
+        options.received = (received != NULL) ? &(received[index]) : NULL;
+        telebot_error_e ret = telebot_parser_get_updates(array, &options, &update, &count);
+        json_object_put(array);
+        if ((ret != TELEBOT_ERROR_NONE) || (count != 1))
+            continue;
+
+        const char *id = NULL;
+        int64_t query_received = 0;
+        if ((update->update_type == TELEBOT_UPDATE_TYPE_PRE_CHECKOUT_QUERY) && (update->pre_checkout_query != NULL))
+        {
+            id = update->pre_checkout_query->id;
+            query_received = update->pre_checkout_query->received;
+        }
+        else if ((update->update_type == TELEBOT_UPDATE_TYPE_SHIPPING_QUERY) && (update->shipping_query != NULL))
+        {
+            id = update->shipping_query->id;
+            query_received = update->shipping_query->received;
+        }
+
+        telebot_payment_query_t *query = NULL;
+        telebot_payment_job_t *job = NULL;
+        if ((id == NULL) ||
+            ((query = calloc(1, sizeof(telebot_payment_query_t))) == NULL) ||
+            ((query->id = strdup(id)) == NULL) ||
+            ((job = calloc(1, sizeof(telebot_payment_job_t))) == NULL))
+        {
+            ERR("Failed to queue payment query of update %d", update->update_id);
+            if (query != NULL)
+                telebot_payment_lane_query_free(query);
+            telebot_put_updates(update, 1);
+            continue;
+        }
+        query->type = update->update_type;
+        query->received = query_received;
+        job->update = update;
+
+        pthread_mutex_lock(&(lane->lock));
+        if (lane->queries_tail != NULL)
+            lane->queries_tail->next = query;
+        else
+            lane->queries = query;
+        lane->queries_tail = query;
+
+        if (lane->jobs_tail != NULL)
+            lane->jobs_tail->next = job;
+        else
+            lane->jobs_head = job;
+        lane->jobs_tail = job;
+        lane->received++;
+        if (query_received + lane->deadline < lane->due)
+            lane->due = query_received + lane->deadline;
+        pthread_cond_broadcast(&(lane->cond));
+        pthread_mutex_unlock(&(lane->lock));
+    }
+}
+
+telebot_error_e telebot_payment_lane_claim(telebot_payment_lane_t *lane, const char *query_id,
+                                           telebot_core_handler_t *core_h)
+{
+    if ((lane == NULL) || (query_id == NULL))
+        return TELEBOT_ERROR_NONE;
+
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+    int64_t now = telebot_scheduler_now();
+
+    pthread_mutex_lock(&(lane->lock));
+    telebot_payment_query_t **link = &(lane->queries);
+    telebot_payment_query_t *prev = NULL;
+    while ((*link != NULL) && strcmp((*link)->id, query_id))
+    {
+        prev = *link;
+        link = &((*link)->next);
+    }
+
+    telebot_payment_query_t *query = *link;
+    if ((query != NULL) && query->overrun)
+    {
+        lane->late_answers++;
+        ret = TELEBOT_ERROR_CANCELED;
+    }
+    else if (query != NULL)
+    {
+        *link = query->next;
+        if (lane->queries_tail == query)
+            lane->queries_tail = prev;
+
+        lane->answers++;
+        if (now - query->received > lane->answer_time_max)
+            lane->answer_time_max = now - query->received;
+        telebot_payment_lane_query_free(query);
+    }
+
+    if (ret == TELEBOT_ERROR_NONE)
+    {
+        lane->last_request = now;
+        *core_h = lane->core_h;
+    }
+    pthread_mutex_unlock(&(lane->lock));
+
+    return ret;
+}
+
+void telebot_payment_lane_get_stats(telebot_payment_lane_t *lane, telebot_stats_t *stats)
+{
+    if (lane == NULL)
+        return;
+
+    pthread_mutex_lock(&(lane->lock));
+    stats->payment_queries = lane->received;
+    stats->payment_answers = lane->answers;
+    stats->payment_overruns = lane->overruns;
+    stats->payment_late_answers = lane->late_answers;
+    stats->payment_answer_time_max = lane->answer_time_max;
+    pthread_mutex_unlock(&(lane->lock));
+
+    /* Requests of the answer connection count as requests of the bot */
+    telebot_stats_t core_stats;
+    if (telebot_core_get_stats(lane->core_h, &core_stats) == TELEBOT_ERROR_NONE)
+    {
+        stats->http_requests += core_stats.http_requests;
+        stats->http_connections += core_stats.http_connections;
+    }
+}
+
+telebot_error_e telebot_set_payment_lane(telebot_handler_t handle, telebot_payment_cb_f callback,
+                                         void *user_data, int deadline, const char *error_message)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (deadline < 0)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_payment_lane_t *lane = NULL;
+    if (callback != NULL)
+    {
+        telebot_error_e ret = telebot_payment_lane_create(handle, callback, user_data,
+                                                          (deadline > 0) ? deadline : TELEBOT_PAYMENT_DEADLINE,
+                                                          (error_message != NULL) ? error_message
+                                                                                  : TELEBOT_PAYMENT_ERROR_MESSAGE,
+                                                          &lane);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    /* Replaced once it is not in use, destroyed after as its threads may call back */
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_payment_lane_t *old = handle->payment_lane;
+    handle->payment_lane = lane;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_payment_lane_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
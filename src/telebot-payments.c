@@ -149,9 +149,20 @@ telebot_error_e telebot_answer_shipping_query(telebot_handler_t handle,
     if (handle == NULL)
         return TELEBOT_ERROR_NOT_SUPPORTED;
 
-    telebot_core_response_t response = telebot_core_answer_shipping_query(handle->core_h, shipping_query_id, ok, shipping_options, error_message);
+    /* The lane keeps its connection until the answer is sent */
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_core_handler_t core_h = handle->core_h;
+    telebot_error_e claimed = telebot_payment_lane_claim(handle->payment_lane, shipping_query_id, &core_h);
+    if (claimed != TELEBOT_ERROR_NONE)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return claimed;
+    }
+
+    telebot_core_response_t response = telebot_core_answer_shipping_query(core_h, shipping_query_id, ok, shipping_options, error_message);
     int ret = telebot_core_get_response_code(response);
     telebot_core_put_response(response);
+    pthread_rwlock_unlock(&(handle->lock));
     return ret;
 }
 
@@ -161,9 +172,20 @@ telebot_error_e telebot_answer_pre_checkout_query(telebot_handler_t handle,
     if (handle == NULL)
         return TELEBOT_ERROR_NOT_SUPPORTED;
 
-    telebot_core_response_t response = telebot_core_answer_pre_checkout_query(handle->core_h, pre_checkout_query_id, ok, error_message);
+    /* The lane keeps its connection until the answer is sent */
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_core_handler_t core_h = handle->core_h;
+    telebot_error_e claimed = telebot_payment_lane_claim(handle->payment_lane, pre_checkout_query_id, &core_h);
+    if (claimed != TELEBOT_ERROR_NONE)
+    {
+        pthread_rwlock_unlock(&(handle->lock));
+        return claimed;
+    }
+
+    telebot_core_response_t response = telebot_core_answer_pre_checkout_query(core_h, pre_checkout_query_id, ok, error_message);
     int ret = telebot_core_get_response_code(response);
     telebot_core_put_response(response);
+    pthread_rwlock_unlock(&(handle->lock));
     return ret;
 }
 
@@ -0,0 +1,223 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <telebot-private.h>
+
+#define TELEBOT_SCHEDULER_IDLE INT64_MAX
+
+typedef struct telebot_scheduler_slot
+{
+    telebot_scheduler_task_f task; /* NULL if the slot is free */
+    void *data;
+    int64_t due; /* Monotonic time in milliseconds */
+} telebot_scheduler_slot_t;
+
+/*
+ * One thread per handler runs the timed work of batching features (edit
+ * coalescing, chat action refreshing, ...). Each feature registers a task,
+ * which is run when it is due and tells when it wants to run again.
+ */
+struct telebot_scheduler
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;  /* Signalled when a task becomes due earlier */
+    pthread_cond_t idle;  /* Signalled when a task run completes */
+    telebot_scheduler_slot_t slots[TELEBOT_SCHEDULER_TASKS];
+    int running; /* Slot of the task being run, -1 if none */
+    bool stop;
+};
+
+int64_t telebot_scheduler_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void *telebot_scheduler_thread(void *data)
+{
+    telebot_scheduler_t *scheduler = data;
+
+    pthread_mutex_lock(&(scheduler->lock));
+    while (!scheduler->stop)
+    {
+        int64_t now = telebot_scheduler_now();
+        int64_t next = TELEBOT_SCHEDULER_IDLE;
+        int slot = -1;
+        for (int i = 0; i < TELEBOT_SCHEDULER_TASKS; i++)
+        {
+            if ((scheduler->slots[i].task != NULL) && (scheduler->slots[i].due < next))
+            {
+                next = scheduler->slots[i].due;
+                slot = i;
+            }
+        }
+
+        if (next > now)
+        {
+            if (next == TELEBOT_SCHEDULER_IDLE)
+            {
+                pthread_cond_wait(&(scheduler->cond), &(scheduler->lock));
+            }
+            else
+            {
+                struct timespec ts = {.tv_sec = next / 1000, .tv_nsec = (next % 1000) * 1000000};
+                pthread_cond_timedwait(&(scheduler->cond), &(scheduler->lock), &ts);
+            }
+            continue;
+        }
+
+        /* Tasks are run without the lock, so they can wake themselves and others */
+        telebot_scheduler_slot_t task = scheduler->slots[slot];
+        scheduler->slots[slot].due = TELEBOT_SCHEDULER_IDLE;
+        scheduler->running = slot;
+        pthread_mutex_unlock(&(scheduler->lock));
+
+        int64_t due = task.task(task.data, now);
+
+        pthread_mutex_lock(&(scheduler->lock));
+        scheduler->running = -1;
+        if ((due >= 0) && (scheduler->slots[slot].task != NULL) && (due < scheduler->slots[slot].due))
+            scheduler->slots[slot].due = due;
+        pthread_cond_broadcast(&(scheduler->idle));
+    }
+    pthread_mutex_unlock(&(scheduler->lock));
+
+    return NULL;
+}
+
+telebot_error_e telebot_scheduler_create(telebot_scheduler_t **scheduler)
+{
+    if (scheduler == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_scheduler_t *s = calloc(1, sizeof(telebot_scheduler_t));
+    if (s == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&(s->cond), &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_cond_init(&(s->idle), NULL);
+    pthread_mutex_init(&(s->lock), NULL);
+    s->running = -1;
+
+    if (pthread_create(&(s->thread), NULL, telebot_scheduler_thread, s) != 0)
+    {
+        ERR("Failed to start scheduler thread");
+        pthread_cond_destroy(&(s->idle));
+        pthread_cond_destroy(&(s->cond));
+        pthread_mutex_destroy(&(s->lock));
+        free(s);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    *scheduler = s;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_scheduler_destroy(telebot_scheduler_t *scheduler)
+{
+    if (scheduler == NULL)
+        return;
+
+    pthread_mutex_lock(&(scheduler->lock));
+    scheduler->stop = true;
+    pthread_cond_signal(&(scheduler->cond));
+    pthread_mutex_unlock(&(scheduler->lock));
+    pthread_join(scheduler->thread, NULL);
+
+    pthread_cond_destroy(&(scheduler->idle));
+    pthread_cond_destroy(&(scheduler->cond));
+    pthread_mutex_destroy(&(scheduler->lock));
+    free(scheduler);
+}
+
+int telebot_scheduler_add(telebot_scheduler_t *scheduler, telebot_scheduler_task_f task, void *data)
+{
+    if ((scheduler == NULL) || (task == NULL))
+        return -1;
+
+    int slot = -1;
+    pthread_mutex_lock(&(scheduler->lock));
+    for (int i = 0; i < TELEBOT_SCHEDULER_TASKS; i++)
+    {
+        if (scheduler->slots[i].task == NULL)
+        {
+            scheduler->slots[i].task = task;
+            scheduler->slots[i].data = data;
+            scheduler->slots[i].due = TELEBOT_SCHEDULER_IDLE;
+            slot = i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&(scheduler->lock));
+
+    if (slot < 0)
+        ERR("No free scheduler slot");
+
+    return slot;
+}
+
+void telebot_scheduler_remove(telebot_scheduler_t *scheduler, int slot)
+{
+    if ((scheduler == NULL) || (slot < 0) || (slot >= TELEBOT_SCHEDULER_TASKS))
+        return;
+
+    pthread_mutex_lock(&(scheduler->lock));
+    while (scheduler->running == slot)
+        pthread_cond_wait(&(scheduler->idle), &(scheduler->lock));
+    scheduler->slots[slot].task = NULL;
+    scheduler->slots[slot].data = NULL;
+    pthread_mutex_unlock(&(scheduler->lock));
+}
+
+void telebot_scheduler_wake(telebot_scheduler_t *scheduler, int slot, int64_t at)
+{
+    if ((scheduler == NULL) || (slot < 0) || (slot >= TELEBOT_SCHEDULER_TASKS))
+        return;
+
+    pthread_mutex_lock(&(scheduler->lock));
+    if ((scheduler->slots[slot].task != NULL) && (at < scheduler->slots[slot].due))
+    {
+        scheduler->slots[slot].due = at;
+        pthread_cond_signal(&(scheduler->cond));
+    }
+    pthread_mutex_unlock(&(scheduler->lock));
+}
+
+telebot_error_e telebot_scheduler_get(telebot_handler_t handle, telebot_scheduler_t **scheduler)
+{
+    telebot_error_e ret = TELEBOT_ERROR_NONE;
+
+    /* Features may be enabled from several threads at once */
+    pthread_mutex_lock(&(handle->scheduler_lock));
+    if (handle->scheduler == NULL)
+        ret = telebot_scheduler_create(&(handle->scheduler));
+    *scheduler = handle->scheduler;
+    pthread_mutex_unlock(&(handle->scheduler_lock));
+
+    return ret;
+}
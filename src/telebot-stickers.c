@@ -0,0 +1,419 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <json.h>
+#include <telebot-core.h>
+#include <telebot-methods.h>
+#include <telebot-parser.h>
+#include <telebot-stickers.h>
+#include <telebot-private.h>
+
+/* Attempts to upload a sticker file */
+#define TELEBOT_STICKER_UPLOAD_ATTEMPTS 3
+/* Wait before retrying a failed upload, doubled by every attempt, milliseconds */
+#define TELEBOT_STICKER_RETRY_DELAY 1000
+
+typedef struct telebot_sticker_pipeline
+{
+    pthread_mutex_t lock;
+    telebot_handler_t handle;
+    long long int user_id;
+    const telebot_input_sticker_t *stickers;
+    char **file_ids; /* Uploaded or given file_id of every sticker */
+    int count;
+    int next;             /* Next sticker to upload */
+    int64_t interval;     /* Milliseconds between requests */
+    int64_t next_request; /* Earliest time of the next request */
+    telebot_error_e ret;  /* First failure */
+} telebot_sticker_pipeline_t;
+
+/* Parse response and take its result, obj is to be released by the caller */
+static telebot_error_e telebot_sticker_get_result(telebot_core_response_t response, struct json_object **obj,
+                                                  struct json_object **result)
+{
+    int ret = telebot_core_get_response_code(response);
+    if (ret != TELEBOT_ERROR_NONE)
+        return ret;
+
+    *obj = telebot_parser_str_to_obj(telebot_core_get_response_data(response));
+    if (*obj == NULL)
+        return TELEBOT_ERROR_OPERATION_FAILED;
+
+    struct json_object *ok = NULL;
+    if (!json_object_object_get_ex(*obj, "ok", &ok) || !json_object_get_boolean(ok) ||
+        !json_object_object_get_ex(*obj, "result", result))
+        return TELEBOT_ERROR_OPERATION_FAILED;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_get_sticker_set(telebot_handler_t handle, const char *name,
+                                        telebot_sticker_set_t *stickers)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((name == NULL) || (stickers == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    unsigned long generation = 0;
+    pthread_rwlock_rdlock(&(handle->lock));
+    char *cached = telebot_cache_get_named(handle->sticker_cache, TELEBOT_CACHE_STICKER_SET, name, &generation);
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_core_response_t response = NULL;
+    struct json_object *obj = NULL;
+    struct json_object *result = NULL;
+    int ret = TELEBOT_ERROR_NONE;
+
+    if (cached != NULL)
+    {
+        obj = telebot_parser_str_to_obj(cached);
+        if (obj == NULL)
+        {
+            ret = TELEBOT_ERROR_OPERATION_FAILED;
+            goto finish;
+        }
+        json_object_object_get_ex(obj, "result", &result);
+    }
+    else
+    {
+        response = telebot_core_get_sticker_set(handle->core_h, name);
+        ret = telebot_sticker_get_result(response, &obj, &result);
+        if (ret != TELEBOT_ERROR_NONE)
+            goto finish;
+    }
+
+    ret = telebot_parser_get_sticker_set(result, stickers);
+    if ((ret == TELEBOT_ERROR_NONE) && (cached == NULL))
+    {
+        pthread_rwlock_rdlock(&(handle->lock));
+        telebot_cache_put_named(handle->sticker_cache, TELEBOT_CACHE_STICKER_SET, name,
+                                telebot_core_get_response_data(response), generation);
+        pthread_rwlock_unlock(&(handle->lock));
+    }
+
+finish:
+    TELEBOT_SAFE_FREE(cached);
+    if (obj)
+        json_object_put(obj);
+    if (response)
+        telebot_core_put_response(response);
+    return ret;
+}
+
+telebot_error_e telebot_set_sticker_set_cache(telebot_handler_t handle, int ttl, int capacity)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((ttl < 0) || (capacity < 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_cache_t *cache = NULL;
+    if (ttl > 0)
+    {
+        telebot_error_e ret = telebot_cache_create(&cache, ttl,
+                                                   capacity ? capacity : TELEBOT_STICKER_SET_CACHE_CAPACITY);
+        if (ret != TELEBOT_ERROR_NONE)
+            return ret;
+    }
+
+    /* Replaced once it is not in use, destroyed after as its threads may call back */
+    pthread_rwlock_wrlock(&(handle->lock));
+    telebot_cache_t *old = handle->sticker_cache;
+    handle->sticker_cache = cache;
+    pthread_rwlock_unlock(&(handle->lock));
+    telebot_cache_destroy(old);
+
+    return TELEBOT_ERROR_NONE;
+}
+
+static void telebot_sticker_pipeline_sleep(int64_t milliseconds)
+{
+    struct timespec ts = {.tv_sec = milliseconds / 1000, .tv_nsec = (milliseconds % 1000) * 1000000};
+    while ((nanosleep(&ts, &ts) != 0) && (errno == EINTR))
+        ;
+}
+
+/* Wait for the turn of a request, requests of all workers are spaced by the interval */
+static void telebot_sticker_pipeline_pace(telebot_sticker_pipeline_t *pipeline)
+{
+    pthread_mutex_lock(&(pipeline->lock));
+    int64_t now = telebot_scheduler_now();
+    int64_t at = (pipeline->next_request > now) ? pipeline->next_request : now;
+    pipeline->next_request = at + pipeline->interval;
+    pthread_mutex_unlock(&(pipeline->lock));
+
+    if (at > now)
+        telebot_sticker_pipeline_sleep(at - now);
+}
+
+/* Hold back requests of all workers, a failure is likely due to flood limits */
+static void telebot_sticker_pipeline_back_off(telebot_sticker_pipeline_t *pipeline, int64_t delay)
+{
+    pthread_mutex_lock(&(pipeline->lock));
+    int64_t at = telebot_scheduler_now() + delay;
+    if (pipeline->next_request < at)
+        pipeline->next_request = at;
+    pthread_mutex_unlock(&(pipeline->lock));
+}
+
+static telebot_error_e telebot_sticker_pipeline_upload(telebot_sticker_pipeline_t *pipeline, int index)
+{
+    const telebot_input_sticker_t *sticker = &(pipeline->stickers[index]);
+    telebot_error_e ret = TELEBOT_ERROR_OPERATION_FAILED;
+
+    for (int attempt = 0; attempt < TELEBOT_STICKER_UPLOAD_ATTEMPTS; attempt++)
+    {
+        if (attempt > 0)
+            telebot_sticker_pipeline_back_off(pipeline, (int64_t)TELEBOT_STICKER_RETRY_DELAY << (attempt - 1));
+        telebot_sticker_pipeline_pace(pipeline);
+
+        struct json_object *obj = NULL;
+        struct json_object *result = NULL;
+        struct json_object *file_id = NULL;
+        telebot_core_response_t response = telebot_core_upload_sticker_file(pipeline->handle->core_h,
+                                                                            pipeline->user_id, sticker->sticker,
+                                                                            sticker->format);
+        ret = telebot_sticker_get_result(response, &obj, &result);
+        long status = telebot_core_get_response_status(response);
+        if ((ret == TELEBOT_ERROR_NONE) && !json_object_object_get_ex(result, "file_id", &file_id))
+            ret = TELEBOT_ERROR_OPERATION_FAILED;
+        if (ret == TELEBOT_ERROR_NONE)
+        {
+            pipeline->file_ids[index] = strdup(json_object_get_string(file_id));
+            if (pipeline->file_ids[index] == NULL)
+                ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+        }
+
+        if (obj)
+            json_object_put(obj);
+        telebot_core_put_response(response);
+
+        /* Only transport failures, flood limits and server errors may pass on retry */
+        if ((ret != TELEBOT_ERROR_OPERATION_FAILED) || ((status != 0L) && (status != 429L) && (status < 500L)))
+            break;
+    }
+
+    return ret;
+}
+
+static void *telebot_sticker_pipeline_worker(void *arg)
+{
+    telebot_sticker_pipeline_t *pipeline = arg;
+    for (;;)
+    {
+        pthread_mutex_lock(&(pipeline->lock));
+        while ((pipeline->next < pipeline->count) && !pipeline->stickers[pipeline->next].is_file)
+            pipeline->next++;
+        int index = pipeline->next++;
+        bool done = (index >= pipeline->count) || (pipeline->ret != TELEBOT_ERROR_NONE);
+        pthread_mutex_unlock(&(pipeline->lock));
+        if (done)
+            break;
+
+        telebot_error_e ret = telebot_sticker_pipeline_upload(pipeline, index);
+        if (ret != TELEBOT_ERROR_NONE)
+        {
+            ERR("Failed to upload sticker file '%s'", pipeline->stickers[index].sticker);
+            pthread_mutex_lock(&(pipeline->lock));
+            if (pipeline->ret == TELEBOT_ERROR_NONE)
+                pipeline->ret = ret;
+            pthread_mutex_unlock(&(pipeline->lock));
+        }
+    }
+
+    return NULL;
+}
+
+/* Upload all sticker files, the calling thread is a worker too */
+static telebot_error_e telebot_sticker_pipeline_upload_all(telebot_sticker_pipeline_t *pipeline, int uploads,
+                                                           int concurrency)
+{
+    int workers = (concurrency < uploads) ? concurrency : uploads;
+    pthread_t *threads = calloc(workers, sizeof(pthread_t));
+    int started = 0;
+    for (; (threads != NULL) && (started < workers - 1); started++)
+    {
+        if (pthread_create(&(threads[started]), NULL, telebot_sticker_pipeline_worker, pipeline))
+            break;
+    }
+
+    telebot_sticker_pipeline_worker(pipeline);
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+
+    return pipeline->ret;
+}
+
+/* InputSticker object without the sticker itself, NULL if parameters are invalid */
+static struct json_object *telebot_sticker_input_new(const telebot_input_sticker_t *sticker)
+{
+    if ((sticker->sticker == NULL) || (sticker->format == NULL) || (sticker->emoji_list == NULL))
+        return NULL;
+
+    struct json_object *emoji_list = json_tokener_parse(sticker->emoji_list);
+    if (!json_object_is_type(emoji_list, json_type_array))
+    {
+        json_object_put(emoji_list);
+        return NULL;
+    }
+
+    struct json_object *keywords = NULL;
+    if (sticker->keywords != NULL)
+    {
+        keywords = json_tokener_parse(sticker->keywords);
+        if (!json_object_is_type(keywords, json_type_array))
+        {
+            json_object_put(keywords);
+            json_object_put(emoji_list);
+            return NULL;
+        }
+    }
+
+    struct json_object *input = json_object_new_object();
+    json_object_object_add(input, "format", json_object_new_string(sticker->format));
+    json_object_object_add(input, "emoji_list", emoji_list);
+    if (keywords != NULL)
+        json_object_object_add(input, "keywords", keywords);
+
+    return input;
+}
+
+telebot_error_e telebot_create_sticker_set(telebot_handler_t handle, long long int user_id,
+                                           const char *name, const char *title, const char *sticker_type,
+                                           const telebot_input_sticker_t *stickers, int count, int concurrency,
+                                           int interval)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((name == NULL) || (title == NULL) || (stickers == NULL) || (count <= 0) || (concurrency < 0) ||
+        (interval < 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_sticker_pipeline_t pipeline = {
+        .handle = handle,
+        .user_id = user_id,
+        .stickers = stickers,
+        .count = count,
+        .interval = interval ? interval : TELEBOT_STICKER_UPLOAD_INTERVAL,
+        .ret = TELEBOT_ERROR_NONE,
+    };
+    struct json_object **inputs = calloc(count, sizeof(struct json_object *));
+    pipeline.file_ids = calloc(count, sizeof(char *));
+    if ((inputs == NULL) || (pipeline.file_ids == NULL))
+    {
+        free(inputs);
+        free(pipeline.file_ids);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+    pthread_mutex_init(&(pipeline.lock), NULL);
+
+    /* Check every sticker before uploading any of them */
+    int ret = TELEBOT_ERROR_NONE;
+    int uploads = 0;
+    for (int index = 0; index < count; index++)
+    {
+        inputs[index] = telebot_sticker_input_new(&(stickers[index]));
+        if (inputs[index] == NULL)
+        {
+            ERR("Invalid sticker at %d", index);
+            ret = TELEBOT_ERROR_INVALID_PARAMETER;
+            goto finish;
+        }
+
+        if (stickers[index].is_file)
+        {
+            uploads++;
+            continue;
+        }
+
+        pipeline.file_ids[index] = strdup(stickers[index].sticker);
+        if (pipeline.file_ids[index] == NULL)
+        {
+            ret = TELEBOT_ERROR_OUT_OF_MEMORY;
+            goto finish;
+        }
+    }
+
+    if (uploads > 0)
+    {
+        ret = telebot_sticker_pipeline_upload_all(&pipeline, uploads,
+                                                  concurrency ? concurrency : TELEBOT_STICKER_UPLOAD_CONCURRENCY);
+        if (ret != TELEBOT_ERROR_NONE)
+            goto finish;
+    }
+
+    for (int index = 0; index < count; index++)
+        json_object_object_add(inputs[index], "sticker", json_object_new_string(pipeline.file_ids[index]));
+
+    int initial = (count < TELEBOT_STICKER_SET_INITIAL_MAX) ? count : TELEBOT_STICKER_SET_INITIAL_MAX;
+    struct json_object *array = json_object_new_array();
+    for (int index = 0; index < initial; index++)
+        json_object_array_add(array, json_object_get(inputs[index]));
+
+    telebot_sticker_pipeline_pace(&pipeline);
+    telebot_core_response_t response = telebot_core_create_new_sticker_set(
+        handle->core_h, user_id, name, title, json_object_to_json_string_ext(array, JSON_C_TO_STRING_PLAIN),
+        sticker_type);
+    json_object_put(array);
+
+    struct json_object *obj = NULL;
+    struct json_object *result = NULL;
+    ret = telebot_sticker_get_result(response, &obj, &result);
+    if (obj)
+        json_object_put(obj);
+    telebot_core_put_response(response);
+    if (ret != TELEBOT_ERROR_NONE)
+        goto finish;
+
+    /* Stickers are appended in order, so they are added one at a time */
+    for (int index = initial; (index < count) && (ret == TELEBOT_ERROR_NONE); index++)
+    {
+        telebot_sticker_pipeline_pace(&pipeline);
+        response = telebot_core_add_sticker_to_set(
+            handle->core_h, user_id, name, json_object_to_json_string_ext(inputs[index], JSON_C_TO_STRING_PLAIN));
+        obj = NULL;
+        ret = telebot_sticker_get_result(response, &obj, &result);
+        if (obj)
+            json_object_put(obj);
+        telebot_core_put_response(response);
+    }
+
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_cache_invalidate_named(handle->sticker_cache, TELEBOT_CACHE_STICKER_SET, name);
+    pthread_rwlock_unlock(&(handle->lock));
+
+finish:
+    for (int index = 0; index < count; index++)
+    {
+        if (inputs[index])
+            json_object_put(inputs[index]);
+        TELEBOT_SAFE_FREE(pipeline.file_ids[index]);
+    }
+    free(inputs);
+    free(pipeline.file_ids);
+    pthread_mutex_destroy(&(pipeline.lock));
+
+    return ret;
+}
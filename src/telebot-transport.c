@@ -0,0 +1,277 @@
+/*
+ * telebot
+ *
+ * Copyright (c) 2015 Elmurod Talipov.
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <curl/curl.h>
+#include <telebot-private.h>
+
+/* Upper bound of a multi poll, transfers are woken up explicitly anyway */
+#define TELEBOT_TRANSPORT_POLL_MS 1000
+/* Result of transfers the transport stopped before they were done */
+#define TELEBOT_TRANSPORT_STOPPED CURLE_ABORTED_BY_CALLBACK
+
+/* Request submitted by a caller thread, lives on its stack until done */
+typedef struct telebot_core_transfer
+{
+    CURL *curl_h;
+    CURLcode result;
+    bool done;
+    struct telebot_core_transfer *next;
+} telebot_core_transfer_t;
+
+/*
+ * All curl multi calls except curl_multi_wakeup() are made by the transport
+ * thread. Callers queue their easy handles and wait for completion on cond.
+ */
+struct telebot_core_transport
+{
+    CURLM *multi;
+    long http_version; /* CURL_HTTP_VERSION_* of requests */
+    bool multiplex;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    telebot_core_transfer_t *head; /* Submitted, not yet added to multi */
+    telebot_core_transfer_t *tail;
+    telebot_core_transfer_t *active; /* Added to multi, used by transport thread only */
+    int refs; /* Core handler and requests being performed */
+    bool stop;
+};
+
+static void telebot_core_transport_complete(telebot_core_transport_t *transport,
+                                            telebot_core_transfer_t *transfer, CURLcode result)
+{
+    pthread_mutex_lock(&(transport->lock));
+    transfer->result = result;
+    transfer->done = true;
+    pthread_cond_broadcast(&(transport->cond));
+    pthread_mutex_unlock(&(transport->lock));
+}
+
+static void telebot_core_transport_remove(telebot_core_transport_t *transport,
+                                          telebot_core_transfer_t *transfer, CURLcode result)
+{
+    telebot_core_transfer_t **link = &(transport->active);
+    while ((*link != NULL) && (*link != transfer))
+        link = &((*link)->next);
+    if (*link != NULL)
+        *link = transfer->next;
+
+    curl_multi_remove_handle(transport->multi, transfer->curl_h);
+    telebot_core_transport_complete(transport, transfer, result);
+}
+
+static void *telebot_core_transport_thread(void *data)
+{
+    telebot_core_transport_t *transport = data;
+    int running = 0;
+
+    while (true)
+    {
+        pthread_mutex_lock(&(transport->lock));
+        bool stop = transport->stop;
+        telebot_core_transfer_t *queue = transport->head;
+        transport->head = transport->tail = NULL;
+        pthread_mutex_unlock(&(transport->lock));
+
+        while (queue != NULL)
+        {
+            telebot_core_transfer_t *transfer = queue;
+            queue = queue->next;
+            if (stop)
+            {
+                telebot_core_transport_complete(transport, transfer, TELEBOT_TRANSPORT_STOPPED);
+            }
+            else if (curl_multi_add_handle(transport->multi, transfer->curl_h) != CURLM_OK)
+            {
+                ERR("Failed to add request to transport");
+                telebot_core_transport_complete(transport, transfer, CURLE_FAILED_INIT);
+            }
+            else
+            {
+                transfer->next = transport->active;
+                transport->active = transfer;
+            }
+        }
+
+        if (stop)
+            break;
+
+        curl_multi_perform(transport->multi, &running);
+
+        CURLMsg *msg = NULL;
+        int left = 0;
+        while ((msg = curl_multi_info_read(transport->multi, &left)) != NULL)
+        {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            CURL *curl_h = msg->easy_handle;
+            CURLcode result = msg->data.result;
+            telebot_core_transfer_t *transfer = NULL;
+            curl_easy_getinfo(curl_h, CURLINFO_PRIVATE, (char **)&transfer);
+            if (transfer != NULL)
+                telebot_core_transport_remove(transport, transfer, result);
+            else
+                curl_multi_remove_handle(transport->multi, curl_h);
+        }
+
+        curl_multi_poll(transport->multi, NULL, 0, TELEBOT_TRANSPORT_POLL_MS, NULL);
+    }
+
+    /* Callers still waiting are released with an error */
+    while (transport->active != NULL)
+        telebot_core_transport_remove(transport, transport->active, TELEBOT_TRANSPORT_STOPPED);
+
+    return NULL;
+}
+
+telebot_error_e telebot_core_transport_create(telebot_http_version_e version, int max_connections,
+                                              int max_streams, telebot_core_transport_t **transport)
+{
+    if ((transport == NULL) || (version <= TELEBOT_HTTP_VERSION_DEFAULT) ||
+        (version > TELEBOT_HTTP_VERSION_2_PRIOR_KNOWLEDGE) || (max_connections < 0) || (max_streams < 0))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    *transport = NULL;
+    if (version != TELEBOT_HTTP_VERSION_1_1)
+    {
+        curl_version_info_data *info = curl_version_info(CURLVERSION_NOW);
+        if ((info == NULL) || !(info->features & CURL_VERSION_HTTP2))
+        {
+            ERR("HTTP/2 is not supported by libcurl");
+            return TELEBOT_ERROR_NOT_SUPPORTED;
+        }
+    }
+
+    telebot_core_transport_t *_transport = calloc(1, sizeof(telebot_core_transport_t));
+    if (_transport == NULL)
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+
+    _transport->multi = curl_multi_init();
+    if (_transport->multi == NULL)
+    {
+        free(_transport);
+        return TELEBOT_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (max_connections == 0)
+        max_connections = TELEBOT_HTTP_MAX_CONNECTIONS;
+    if (max_streams == 0)
+        max_streams = TELEBOT_HTTP_MAX_STREAMS;
+
+    switch (version)
+    {
+    case TELEBOT_HTTP_VERSION_2:
+        _transport->http_version = CURL_HTTP_VERSION_2TLS;
+        _transport->multiplex = true;
+        break;
+    case TELEBOT_HTTP_VERSION_2_PRIOR_KNOWLEDGE:
+        _transport->http_version = CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+        _transport->multiplex = true;
+        break;
+    default:
+        _transport->http_version = CURL_HTTP_VERSION_1_1;
+        break;
+    }
+
+    curl_multi_setopt(_transport->multi, CURLMOPT_PIPELINING,
+                      _transport->multiplex ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+    curl_multi_setopt(_transport->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max_connections);
+    curl_multi_setopt(_transport->multi, CURLMOPT_MAXCONNECTS, (long)max_connections);
+    curl_multi_setopt(_transport->multi, CURLMOPT_MAX_CONCURRENT_STREAMS, (long)max_streams);
+
+    _transport->refs = 1;
+    pthread_mutex_init(&(_transport->lock), NULL);
+    pthread_cond_init(&(_transport->cond), NULL);
+    if (pthread_create(&(_transport->thread), NULL, telebot_core_transport_thread, _transport) != 0)
+    {
+        ERR("Failed to start transport thread");
+        pthread_cond_destroy(&(_transport->cond));
+        pthread_mutex_destroy(&(_transport->lock));
+        curl_multi_cleanup(_transport->multi);
+        free(_transport);
+        return TELEBOT_ERROR_OPERATION_FAILED;
+    }
+
+    *transport = _transport;
+    return TELEBOT_ERROR_NONE;
+}
+
+void telebot_core_transport_get(telebot_core_transport_t *transport)
+{
+    pthread_mutex_lock(&(transport->lock));
+    transport->refs++;
+    pthread_mutex_unlock(&(transport->lock));
+}
+
+void telebot_core_transport_put(telebot_core_transport_t *transport)
+{
+    if (transport == NULL)
+        return;
+
+    pthread_mutex_lock(&(transport->lock));
+    bool last = (--transport->refs == 0);
+    if (last)
+        transport->stop = true;
+    pthread_mutex_unlock(&(transport->lock));
+    if (!last)
+        return;
+
+    curl_multi_wakeup(transport->multi);
+    pthread_join(transport->thread, NULL);
+
+    curl_multi_cleanup(transport->multi);
+    pthread_cond_destroy(&(transport->cond));
+    pthread_mutex_destroy(&(transport->lock));
+    free(transport);
+}
+
+CURLcode telebot_core_transport_perform(telebot_core_transport_t *transport, CURL *curl_h)
+{
+    telebot_core_transfer_t transfer = {.curl_h = curl_h, .result = CURLE_OK, .done = false, .next = NULL};
+
+    curl_easy_setopt(curl_h, CURLOPT_HTTP_VERSION, transport->http_version);
+    /* Wait for a stream on a connection being set up rather than open another */
+    if (transport->multiplex)
+        curl_easy_setopt(curl_h, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl_h, CURLOPT_PRIVATE, &transfer);
+
+    pthread_mutex_lock(&(transport->lock));
+    if (transport->stop)
+    {
+        pthread_mutex_unlock(&(transport->lock));
+        return TELEBOT_TRANSPORT_STOPPED;
+    }
+    if (transport->tail != NULL)
+        transport->tail->next = &transfer;
+    else
+        transport->head = &transfer;
+    transport->tail = &transfer;
+    pthread_mutex_unlock(&(transport->lock));
+
+    curl_multi_wakeup(transport->multi);
+
+    pthread_mutex_lock(&(transport->lock));
+    while (!transfer.done)
+        pthread_cond_wait(&(transport->cond), &(transport->lock));
+    pthread_mutex_unlock(&(transport->lock));
+
+    return transfer.result;
+}
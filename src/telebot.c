@@ -16,6 +16,9 @@
  * limitations under the License.
  */
 
+#define _GNU_SOURCE
+
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -32,31 +35,6 @@
 #include <telebot-payments.h>
 #include <telebot-private.h>
 
-static const char *telebot_update_type_str[TELEBOT_UPDATE_TYPE_MAX] = {
-    "message",
-    "edited_message",
-    "channel_post",
-    "edited_channel_post",
-    "business_connection",
-    "business_message",
-    "edited_business_message",
-    "deleted_business_messages",
-    "message_reaction",
-    "message_reaction_count",
-    "inline_query",
-    "chosen_inline_result",
-    "callback_query",
-    "shipping_query",
-    "pre_checkout_query",
-    "purchased_paid_media",
-    "poll",
-    "poll_answer",
-    "my_chat_member",
-    "chat_member",
-    "chat_join_request",
-    "chat_boost",
-    "removed_chat_boost"};
-
 static void telebot_put_chat_photo(telebot_chat_photo_t *photo);
 static void telebot_put_chat_permissions(telebot_chat_permissions_t *permissions);
 static void telebot_put_chat_location(telebot_chat_location_t *chat_location);
@@ -82,6 +60,7 @@ static void telebot_put_unique_gift_info(telebot_unique_gift_info_t *gift_info);
 static void telebot_put_game(telebot_game_t *game);
 static void telebot_put_invoice(telebot_invoice_t *invoice);
 static void telebot_put_successful_payment(telebot_successful_payment_t *payment);
+static void telebot_put_refunded_payment(telebot_refunded_payment_t *payment);
 static void telebot_put_passport_data(telebot_passport_data_t *passport_data);
 static void telebot_put_proximity_alert_triggered(telebot_proximity_alert_triggered_t *alert);
 static void telebot_put_forum_topic_created(telebot_forum_topic_created_t *topic);
@@ -122,6 +101,23 @@ telebot_error_e telebot_create(telebot_handler_t *handle, char *token)
         return ret;
     }
 
+    ret = telebot_markup_cache_create(&(_handle->markups));
+    if (ret != TELEBOT_ERROR_NONE)
+    {
+        telebot_core_destroy(&(_handle->core_h));
+        TELEBOT_SAFE_FREE(_handle);
+        return ret;
+    }
+
+    /* Writers are preferred, or modules are never replaced while handler threads keep reading */
+    pthread_rwlockattr_t lock_attr;
+    pthread_rwlockattr_init(&lock_attr);
+#ifdef __GLIBC__
+    pthread_rwlockattr_setkind_np(&lock_attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&(_handle->lock), &lock_attr);
+    pthread_rwlockattr_destroy(&lock_attr);
+    pthread_mutex_init(&(_handle->scheduler_lock), NULL);
     _handle->offset = 0;
 
     *handle = _handle;
@@ -133,7 +129,23 @@ telebot_error_e telebot_destroy(telebot_handler_t handle)
     if (handle == NULL)
         return TELEBOT_ERROR_NOT_SUPPORTED;
 
+    telebot_edits_destroy(handle->edits);
+    telebot_actions_destroy(handle->actions);
+    telebot_batcher_destroy(handle->batcher);
+    telebot_inline_cache_destroy(handle->inline_cache);
+    telebot_inline_tracker_destroy(handle->inline_tracker);
+    telebot_payment_lane_destroy(handle->payment_lane);
+    telebot_scheduler_destroy(handle->scheduler);
+    telebot_journal_close(handle->journal);
+    telebot_ledger_close(handle->ledger);
+    telebot_passport_key_destroy(handle->passport_key);
+    telebot_filter_destroy(handle->filter);
+    telebot_markup_cache_destroy(handle->markups);
+    telebot_cache_destroy(handle->chat_cache);
+    telebot_cache_destroy(handle->sticker_cache);
     telebot_core_destroy(&(handle->core_h));
+    pthread_mutex_destroy(&(handle->scheduler_lock));
+    pthread_rwlock_destroy(&(handle->lock));
     TELEBOT_SAFE_FREE(handle);
 
     return TELEBOT_ERROR_NONE;
@@ -165,6 +177,78 @@ telebot_error_e telebot_get_proxy(telebot_handler_t handle, char **addr)
     return telebot_core_get_proxy(handle->core_h, addr);
 }
 
+telebot_error_e telebot_set_api_url(telebot_handler_t handle, const char *url)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    return telebot_core_set_api_url(handle->core_h, url);
+}
+
+telebot_error_e telebot_set_http_version(telebot_handler_t handle, telebot_http_version_e version,
+                                         int max_connections, int max_streams)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    return telebot_core_set_http_version(handle->core_h, version, max_connections, max_streams);
+}
+
+telebot_error_e telebot_get_stats(telebot_handler_t handle, telebot_stats_t *stats)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    telebot_error_e ret = telebot_core_get_stats(handle->core_h, stats);
+    if (ret == TELEBOT_ERROR_NONE)
+    {
+        telebot_cache_stats_t cache_stats;
+        pthread_rwlock_rdlock(&(handle->lock));
+        telebot_cache_get_stats(handle->chat_cache, &cache_stats);
+        stats->chat_cache_hits = cache_stats.hits;
+        stats->chat_cache_misses = cache_stats.misses;
+        stats->chat_cache_invalidations = cache_stats.invalidations;
+        stats->chat_cache_entries = cache_stats.entries;
+
+        telebot_cache_get_stats(handle->sticker_cache, &cache_stats);
+        stats->sticker_cache_hits = cache_stats.hits;
+        stats->sticker_cache_misses = cache_stats.misses;
+        stats->sticker_cache_entries = cache_stats.entries;
+        telebot_edits_get_stats(handle->edits, stats);
+        telebot_actions_get_stats(handle->actions, stats);
+        telebot_batcher_get_stats(handle->batcher, stats);
+        telebot_inline_cache_get_stats(handle->inline_cache, stats);
+        telebot_inline_tracker_get_stats(handle->inline_tracker, stats);
+        telebot_payment_lane_get_stats(handle->payment_lane, stats);
+        pthread_rwlock_unlock(&(handle->lock));
+    }
+
+    return ret;
+}
+
+/* The chat cache is used under the handler lock, as it may be replaced meanwhile */
+static void telebot_invalidate_chat(telebot_handler_t handle, telebot_cache_kind_e kind, long long int chat_id)
+{
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_cache_invalidate(handle->chat_cache, kind, chat_id, 0);
+    pthread_rwlock_unlock(&(handle->lock));
+}
+
+static void telebot_invalidate_chat_member(telebot_handler_t handle, long long int chat_id, int user_id)
+{
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_cache_invalidate_member(handle->chat_cache, chat_id, user_id);
+    pthread_rwlock_unlock(&(handle->lock));
+}
+
+/* Called with the handler lock held for reading */
+static void telebot_submit_payments(telebot_handler_t handle, struct json_object *updates,
+                                    telebot_parser_options_t *options)
+{
+    options->skip_payments = (handle->payment_lane != NULL);
+    telebot_payment_lane_submit(handle->payment_lane, updates, options->received, options->filter);
+}
+
 telebot_error_e
 telebot_get_updates(telebot_handler_t handle, int offset, int limit, int timeout,
                     telebot_update_type_e allowed_updates[], int allowed_updates_count,
@@ -183,6 +267,51 @@ telebot_get_updates(telebot_handler_t handle, int offset, int limit, int timeout
     *updates = NULL;
     *count = 0;
 
+    int _timeout = timeout > 0 ? timeout : 0;
+    int _limit = TELEBOT_UPDATE_COUNT_MAX_LIMIT;
+    if ((limit > 0) && (limit < TELEBOT_UPDATE_COUNT_MAX_LIMIT))
+        _limit = limit;
+
+    telebot_parser_options_t options = {
+        .lazy = handle->lazy_parsing,
+    };
+
+    int _offset = offset != 0 ? offset : handle->offset;
+
+    /* Optional modules are used under the handler lock, which is not held while polling */
+    pthread_rwlock_rdlock(&(handle->lock));
+    options.filter = handle->filter;
+    if (handle->journal != NULL)
+    {
+        /* Unacknowledged updates of previous run are delivered first */
+        int64_t *received = NULL;
+        ret = telebot_journal_replay(handle->journal, _limit, &obj, &received);
+        if (ret != TELEBOT_ERROR_NONE)
+        {
+            pthread_rwlock_unlock(&(handle->lock));
+            return ret;
+        }
+
+        if (obj != NULL)
+        {
+            options.received = received;
+            telebot_submit_payments(handle, obj, &options);
+            telebot_ledger_add_updates(handle->ledger, obj);
+            ret = telebot_parser_get_updates(obj, &options, updates, count);
+            json_object_put(obj);
+            free(received);
+            if (ret == TELEBOT_ERROR_NONE)
+                telebot_inline_tracker_add(handle->inline_tracker, *updates, *count);
+            pthread_rwlock_unlock(&(handle->lock));
+            return ret;
+        }
+
+        int journal_offset = telebot_journal_get_offset(handle->journal);
+        if ((_offset >= 0) && (_offset < journal_offset))
+            _offset = journal_offset;
+    }
+    pthread_rwlock_unlock(&(handle->lock));
+
     const char *str_allowed_updates = NULL;
     struct json_object *array = NULL;
     if (allowed_updates_count > 0)
@@ -190,19 +319,13 @@ telebot_get_updates(telebot_handler_t handle, int offset, int limit, int timeout
         array = json_object_new_array();
         for (int i = 0; i < allowed_updates_count; i++)
         {
-            const char *item = telebot_update_type_str[allowed_updates[i]];
+            const char *item = telebot_parser_get_update_type_str(allowed_updates[i]);
             json_object_array_add(array, json_object_new_string(item));
         }
         str_allowed_updates = json_object_to_json_string(array);
         DBG("Allowed updates: %s", str_allowed_updates);
     }
 
-    int _offset = offset != 0 ? offset : handle->offset;
-    int _timeout = timeout > 0 ? timeout : 0;
-    int _limit = TELEBOT_UPDATE_COUNT_MAX_LIMIT;
-    if ((limit > 0) && (limit < TELEBOT_UPDATE_COUNT_MAX_LIMIT))
-        _limit = limit;
-
     response = telebot_core_get_updates(handle->core_h, _offset, _limit, _timeout, str_allowed_updates);
     if (array)
         json_object_put(array);
@@ -234,17 +357,44 @@ telebot_get_updates(telebot_handler_t handle, int offset, int limit, int timeout
         goto finish;
     }
 
-    ret = telebot_parser_get_updates(result, updates, count);
+    pthread_rwlock_rdlock(&(handle->lock));
+    options.filter = handle->filter;
+    if (handle->journal != NULL)
+    {
+        /* Journal before the offset is advanced, so nothing is lost on crash */
+        ret = telebot_journal_append(handle->journal, result);
+        if (ret != TELEBOT_ERROR_NONE)
+            goto unlock;
+    }
+
+    /* Payment queries have a deadline, they do not wait for the caller */
+    telebot_submit_payments(handle, result, &options);
+    telebot_ledger_add_updates(handle->ledger, result);
+
+    ret = telebot_parser_get_updates(result, &options, updates, count);
     if (ret == TELEBOT_ERROR_NONE)
     {
-        telebot_update_t *ups = *updates;
-        for (int index = 0; index < *count; index++)
+        telebot_journal_delivered(handle->journal);
+        telebot_inline_tracker_add(handle->inline_tracker, *updates, *count);
+
+        /* Filtered out updates are confirmed as well, and invalidate cached chats */
+        int array_len = json_object_array_length(result);
+        for (int index = 0; index < array_len; index++)
         {
-            if (ups[index].update_id >= handle->offset)
-                handle->offset = ups[index].update_id + 1;
+            struct json_object *update_id = NULL;
+            struct json_object *item = json_object_array_get_idx(result, index);
+            telebot_cache_invalidate_update(handle->chat_cache, item);
+            if (!json_object_object_get_ex(item, "update_id", &update_id))
+                continue;
+
+            int id = json_object_get_int(update_id);
+            if (id >= handle->offset)
+                handle->offset = id + 1;
         }
     }
 
+unlock:
+    pthread_rwlock_unlock(&(handle->lock));
 finish:
     if (obj)
         json_object_put(obj);
@@ -260,72 +410,101 @@ telebot_error_e telebot_put_updates(telebot_update_t *updates, int count)
 
     for (int index = 0; index < count; index++)
     {
+        if (updates[index].payload == NULL)
+            continue;
+
         switch (updates[index].update_type)
         {
         case TELEBOT_UPDATE_TYPE_MESSAGE:
-            telebot_put_message(&(updates[index].message));
+            telebot_put_message(updates[index].message);
             break;
         case TELEBOT_UPDATE_TYPE_EDITED_MESSAGE:
-            telebot_put_message(&(updates[index].edited_message));
+            telebot_put_message(updates[index].edited_message);
             break;
         case TELEBOT_UPDATE_TYPE_CHANNEL_POST:
-            telebot_put_message(&(updates[index].channel_post));
+            telebot_put_message(updates[index].channel_post);
             break;
         case TELEBOT_UPDATE_TYPE_EDITED_CHANNEL_POST:
-            telebot_put_message(&(updates[index].edited_channel_post));
+            telebot_put_message(updates[index].edited_channel_post);
             break;
         case TELEBOT_UPDATE_TYPE_CALLBACK_QUERY:
-            telebot_put_callback_query(&(updates[index].callback_query));
+            telebot_put_callback_query(updates[index].callback_query);
             break;
         case TELEBOT_UPDATE_TYPE_POLL:
-            telebot_put_poll(&(updates[index].poll));
+            telebot_put_poll(updates[index].poll);
             break;
         case TELEBOT_UPDATE_TYPE_POLL_ANSWER:
-            telebot_put_poll_answer(&(updates[index].poll_answer));
+            telebot_put_poll_answer(updates[index].poll_answer);
             break;
         case TELEBOT_UPDATE_TYPE_MY_CHAT_MEMBER:
-            telebot_put_chat_member_updated(&(updates[index].my_chat_member));
+            telebot_put_chat_member_updated(updates[index].my_chat_member);
             break;
         case TELEBOT_UPDATE_TYPE_CHAT_MEMBER:
-            telebot_put_chat_member_updated(&(updates[index].chat_member));
+            telebot_put_chat_member_updated(updates[index].chat_member);
             break;
         case TELEBOT_UPDATE_TYPE_CHAT_JOIN_REQUEST:
-            telebot_put_chat_join_request(&(updates[index].chat_join_request));
+            telebot_put_chat_join_request(updates[index].chat_join_request);
             break;
         case TELEBOT_UPDATE_TYPE_MESSAGE_REACTION:
-            telebot_put_message_reaction_updated(&(updates[index].message_reaction));
+            telebot_put_message_reaction_updated(updates[index].message_reaction);
             break;
         case TELEBOT_UPDATE_TYPE_MESSAGE_REACTION_COUNT:
-            telebot_put_message_reaction_count_updated(&(updates[index].message_reaction_count));
+            telebot_put_message_reaction_count_updated(updates[index].message_reaction_count);
             break;
         case TELEBOT_UPDATE_TYPE_CHAT_BOOST:
-            telebot_put_chat_boost_updated(&(updates[index].chat_boost));
+            telebot_put_chat_boost_updated(updates[index].chat_boost);
             break;
         case TELEBOT_UPDATE_TYPE_REMOVED_CHAT_BOOST:
-            telebot_put_chat_boost_removed(&(updates[index].chat_boost_removed));
+            telebot_put_chat_boost_removed(updates[index].chat_boost_removed);
             break;
         case TELEBOT_UPDATE_TYPE_INLINE_QUERY:
-            telebot_put_inline_query(&(updates[index].inline_query));
+            telebot_put_inline_query(updates[index].inline_query);
             break;
         case TELEBOT_UPDATE_TYPE_CHOSEN_INLINE_RESULT:
-            telebot_put_chosen_inline_result(&(updates[index].chosen_inline_result));
+            telebot_put_chosen_inline_result(updates[index].chosen_inline_result);
             break;
         case TELEBOT_UPDATE_TYPE_SHIPPING_QUERY:
-            telebot_put_shipping_query(&(updates[index].shipping_query));
+            telebot_put_shipping_query(updates[index].shipping_query);
             break;
         case TELEBOT_UPDATE_TYPE_PRE_CHECKOUT_QUERY:
-            telebot_put_pre_checkout_query(&(updates[index].pre_checkout_query));
+            telebot_put_pre_checkout_query(updates[index].pre_checkout_query);
             break;
         default:
             ERR("Unsupported update type: %d", updates[index].update_type);
         }
     }
 
-    TELEBOT_SAFE_FREE(updates);
+    telebot_parser_free_updates(updates);
 
     return TELEBOT_ERROR_NONE;
 }
 
+telebot_error_e telebot_set_lazy_parsing(telebot_handler_t handle, bool enable)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    handle->lazy_parsing = enable;
+
+    return TELEBOT_ERROR_NONE;
+}
+
+telebot_error_e telebot_load_message(telebot_message_t *message)
+{
+    if (message == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    return telebot_parser_load_message(message);
+}
+
+telebot_error_e telebot_load_message_field(telebot_message_t *message, telebot_message_field_e field)
+{
+    if (message == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    return telebot_parser_load_message_field(message, field);
+}
+
 telebot_error_e telebot_get_me(telebot_handler_t handle, telebot_user_t *me)
 {
     int ret = TELEBOT_ERROR_NONE;
@@ -401,7 +580,7 @@ telebot_error_e telebot_set_webhook(telebot_handler_t handle, char *url, char *c
         strncat(allowed_updates_str, "[", TELEBOT_BUFFER_BLOCK);
         for (int index = 0; index < allowed_updates_count; index++)
         {
-            strncat(allowed_updates_str, telebot_update_type_str[allowed_updates[index]],
+            strncat(allowed_updates_str, telebot_parser_get_update_type_str(allowed_updates[index]),
                     TELEBOT_BUFFER_BLOCK);
             if (index < (allowed_updates_count - 1)) // intermediate element
                 strncat(allowed_updates_str, ",", TELEBOT_BUFFER_BLOCK);
@@ -508,6 +687,47 @@ telebot_error_e telebot_send_message(telebot_handler_t handle, long long int cha
     return ret;
 }
 
+telebot_error_e telebot_prepare_send_message(telebot_handler_t handle, const char *parse_mode,
+                                             bool disable_web_page_preview, bool disable_notification,
+                                             const char *reply_markup, telebot_prepared_request_t *prepared)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (prepared == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    return telebot_core_prepare_send_message(handle->core_h, parse_mode, disable_web_page_preview,
+                                             disable_notification, reply_markup, prepared);
+}
+
+telebot_error_e telebot_send_prepared_message(telebot_handler_t handle, telebot_prepared_request_t prepared,
+                                              long long int chat_id, const char *text, int reply_to_message_id)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if ((prepared == NULL) || (text == NULL))
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_core_response_t response = telebot_core_send_prepared_message(handle->core_h, prepared, chat_id,
+                                                                          text, reply_to_message_id);
+    int ret = telebot_core_get_response_code(response);
+    telebot_core_put_response(response);
+
+    return ret;
+}
+
+telebot_error_e telebot_put_prepared_request(telebot_prepared_request_t prepared)
+{
+    if (prepared == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    telebot_core_put_prepared_request(prepared);
+
+    return TELEBOT_ERROR_NONE;
+}
+
 telebot_error_e telebot_forward_message(telebot_handler_t handle, long long int chat_id, long long int from_chat_id,
                                         bool disable_notification, int message_id)
 {
@@ -896,6 +1116,8 @@ telebot_error_e telebot_put_user_profile_photos(telebot_user_profile_photos_t *p
     for (int i = 0; i < total; i++)
         for (int j = 0; j < subtotal; j++)
             telebot_put_photo(&(photos->photos[j][i]));
+    for (int j = 0; j < subtotal; j++)
+        TELEBOT_SAFE_FREE(photos->photos[j]);
     photos->current_count = 0;
     photos->total_count = 0;
 
@@ -1215,6 +1437,8 @@ telebot_error_e telebot_kick_chat_member(telebot_handler_t handle, long long int
 
     telebot_core_response_t response = telebot_core_kick_chat_member(handle->core_h, chat_id, user_id, until_date);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat_member(handle, chat_id, user_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1227,6 +1451,8 @@ telebot_error_e telebot_unban_chat_member(telebot_handler_t handle, long long in
 
     telebot_core_response_t response = telebot_core_unban_chat_member(handle->core_h, chat_id, user_id);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat_member(handle, chat_id, user_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1246,6 +1472,8 @@ telebot_error_e telebot_restrict_chat_member(telebot_handler_t handle, long long
                                                  can_send_other_messages, can_add_web_page_previews, can_change_info,
                                                  can_invite_users, can_pin_messages);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat_member(handle, chat_id, user_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1264,6 +1492,8 @@ telebot_error_e telebot_promote_chat_member(telebot_handler_t handle,
                                                                         can_invite_users, can_restrict_members,
                                                                         can_pin_messages, can_promote_members);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat_member(handle, chat_id, user_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1281,6 +1511,8 @@ telebot_error_e telebot_set_chat_admin_custom_title(telebot_handler_t handle,
     response = telebot_core_set_chat_admin_custom_title(handle->core_h, chat_id,
                                                         user_id, custom_title);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat_member(handle, chat_id, user_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1299,6 +1531,8 @@ telebot_error_e telebot_set_chat_permissions(telebot_handler_t handle,
                                                  can_send_other_messages, can_add_web_page_previews, can_change_info,
                                                  can_invite_users, can_pin_messages);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
 
     telebot_core_put_response(response);
     return ret;
@@ -1365,6 +1599,8 @@ telebot_error_e telebot_set_chat_photo(telebot_handler_t handle, long long int c
 
     telebot_core_response_t response = telebot_core_set_chat_photo(handle->core_h, chat_id, photo);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1376,6 +1612,8 @@ telebot_error_e telebot_delete_chat_photo(telebot_handler_t handle, long long in
 
     telebot_core_response_t response = telebot_core_delete_chat_photo(handle->core_h, chat_id);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1391,6 +1629,8 @@ telebot_error_e telebot_set_chat_title(telebot_handler_t handle, long long int c
 
     telebot_core_response_t response = telebot_core_set_chat_title(handle->core_h, chat_id, title);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1406,6 +1646,8 @@ telebot_error_e telebot_set_chat_description(telebot_handler_t handle,
 
     telebot_core_response_t response = telebot_core_set_chat_description(handle->core_h, chat_id, description);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1420,6 +1662,8 @@ telebot_error_e telebot_pin_chat_message(telebot_handler_t handle, long long int
     response = telebot_core_pin_chat_message(handle->core_h, chat_id, message_id,
                                              disable_notification);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1432,6 +1676,8 @@ telebot_error_e telebot_unpin_chat_message(telebot_handler_t handle, long long i
     telebot_core_response_t response;
     response = telebot_core_unpin_chat_message(handle->core_h, chat_id);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1444,57 +1690,109 @@ telebot_error_e telebot_leave_chat(telebot_handler_t handle, long long int chat_
     telebot_core_response_t response;
     response = telebot_core_leave_chat(handle->core_h, chat_id);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+    {
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT_ADMINS, chat_id);
+    }
     telebot_core_put_response(response);
     return ret;
 }
 
-telebot_error_e telebot_get_chat(telebot_handler_t handle, long long int chat_id,
-                                 telebot_chat_t *chat)
-{
-    if (handle == NULL)
-        return TELEBOT_ERROR_NOT_SUPPORTED;
+/*
+ * Get result of chat information method, served from the chat cache when
+ * possible. On success obj holds the response to be released by the caller.
+ */
+static telebot_error_e telebot_get_chat_result(telebot_handler_t handle, telebot_cache_kind_e kind,
+                                               long long int chat_id, int user_id, struct json_object **obj,
+                                               struct json_object **result)
+{
+    unsigned long generation = 0;
+    telebot_core_response_t response = NULL;
+    pthread_rwlock_rdlock(&(handle->lock));
+    telebot_cache_t *cache = handle->chat_cache;
+    char *cached = telebot_cache_get(cache, kind, chat_id, user_id, &generation);
+    pthread_rwlock_unlock(&(handle->lock));
+    const char *rdata = cached;
+    int ret = TELEBOT_ERROR_NONE;
 
-    if (chat == NULL)
-        return TELEBOT_ERROR_INVALID_PARAMETER;
+    if (cached == NULL)
+    {
+        switch (kind)
+        {
+        case TELEBOT_CACHE_CHAT:
+            response = telebot_core_get_chat(handle->core_h, chat_id);
+            break;
+        case TELEBOT_CACHE_CHAT_ADMINS:
+            response = telebot_core_get_chat_admins(handle->core_h, chat_id);
+            break;
+        case TELEBOT_CACHE_CHAT_MEMBER:
+        default:
+            response = telebot_core_get_chat_member(handle->core_h, chat_id, user_id);
+            break;
+        }
 
-    struct json_object *obj = NULL;
-    telebot_core_response_t response = telebot_core_get_chat(handle->core_h, chat_id);
-    int ret = telebot_core_get_response_code(response);
-    if (ret != TELEBOT_ERROR_NONE)
-        goto finish;
+        ret = telebot_core_get_response_code(response);
+        if (ret != TELEBOT_ERROR_NONE)
+            goto finish;
 
-    const char *rdata = telebot_core_get_response_data(response);
-    obj = telebot_parser_str_to_obj(rdata);
-    if (obj == NULL)
+        rdata = telebot_core_get_response_data(response);
+    }
+
+    *obj = telebot_parser_str_to_obj(rdata);
+    if (*obj == NULL)
     {
         ret = TELEBOT_ERROR_OPERATION_FAILED;
         goto finish;
     }
 
     struct json_object *ok = NULL;
-    if (!json_object_object_get_ex(obj, "ok", &ok) || !json_object_get_boolean(ok))
+    if (!json_object_object_get_ex(*obj, "ok", &ok) || !json_object_get_boolean(ok) ||
+        !json_object_object_get_ex(*obj, "result", result))
     {
+        json_object_put(*obj);
+        *obj = NULL;
         ret = TELEBOT_ERROR_OPERATION_FAILED;
         goto finish;
     }
 
-    struct json_object *result = NULL;
-    if (!json_object_object_get_ex(obj, "result", &result))
+    if (cached == NULL)
     {
-        ret = TELEBOT_ERROR_OPERATION_FAILED;
-        goto finish;
+        /* The generation belongs to the cache it was taken from */
+        pthread_rwlock_rdlock(&(handle->lock));
+        if (handle->chat_cache == cache)
+            telebot_cache_put(cache, kind, chat_id, user_id, rdata, generation);
+        pthread_rwlock_unlock(&(handle->lock));
     }
 
-    ret = telebot_parser_get_chat(result, chat);
-
 finish:
+    TELEBOT_SAFE_FREE(cached);
+    if (response)
+        telebot_core_put_response(response);
+    return ret;
+}
+
+telebot_error_e telebot_get_chat(telebot_handler_t handle, long long int chat_id,
+                                 telebot_chat_t *chat)
+{
+    if (handle == NULL)
+        return TELEBOT_ERROR_NOT_SUPPORTED;
+
+    if (chat == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    struct json_object *obj = NULL;
+    struct json_object *result = NULL;
+    int ret = telebot_get_chat_result(handle, TELEBOT_CACHE_CHAT, chat_id, 0, &obj, &result);
+    if (ret == TELEBOT_ERROR_NONE)
+        ret = telebot_parser_get_chat(result, chat);
+
     if (ret != TELEBOT_ERROR_NONE)
         telebot_put_chat(chat);
 
     if (obj)
         json_object_put(obj);
 
-    telebot_core_put_response(response);
     return ret;
 }
 
@@ -1508,43 +1806,17 @@ telebot_error_e telebot_get_chat_admins(telebot_handler_t handle, long long int
         return TELEBOT_ERROR_INVALID_PARAMETER;
 
     struct json_object *obj = NULL;
-    telebot_core_response_t response = telebot_core_get_chat_admins(handle->core_h, chat_id);
-    int ret = telebot_core_get_response_code(response);
-    if (ret != TELEBOT_ERROR_NONE)
-        goto finish;
-
-    const char *rdata = telebot_core_get_response_data(response);
-    obj = telebot_parser_str_to_obj(rdata);
-    if (obj == NULL)
-    {
-        ret = TELEBOT_ERROR_OPERATION_FAILED;
-        goto finish;
-    }
-
-    struct json_object *ok = NULL;
-    if (!json_object_object_get_ex(obj, "ok", &ok) || !json_object_get_boolean(ok))
-    {
-        ret = TELEBOT_ERROR_OPERATION_FAILED;
-        goto finish;
-    }
-
     struct json_object *result = NULL;
-    if (!json_object_object_get_ex(obj, "result", &result))
-    {
-        ret = TELEBOT_ERROR_OPERATION_FAILED;
-        goto finish;
-    }
-
-    ret = telebot_parser_get_chat_admins(result, admins, count);
+    int ret = telebot_get_chat_result(handle, TELEBOT_CACHE_CHAT_ADMINS, chat_id, 0, &obj, &result);
+    if (ret == TELEBOT_ERROR_NONE)
+        ret = telebot_parser_get_chat_admins(result, admins, count);
 
-finish:
     if (ret != TELEBOT_ERROR_NONE)
         telebot_put_chat_admins(*admins, *count);
 
     if (obj)
         json_object_put(obj);
 
-    telebot_core_put_response(response);
     return ret;
 }
 
@@ -1615,43 +1887,17 @@ telebot_error_e telebot_get_chat_member(telebot_handler_t handle, long long int
         return TELEBOT_ERROR_INVALID_PARAMETER;
 
     struct json_object *obj = NULL;
-    telebot_core_response_t response = telebot_core_get_chat_member(handle->core_h, chat_id, user_id);
-    int ret = telebot_core_get_response_code(response);
-    if (ret != TELEBOT_ERROR_NONE)
-        goto finish;
-
-    const char *rdata = telebot_core_get_response_data(response);
-    obj = telebot_parser_str_to_obj(rdata);
-    if (obj == NULL)
-    {
-        ret = TELEBOT_ERROR_OPERATION_FAILED;
-        goto finish;
-    }
-
-    struct json_object *ok = NULL;
-    if (!json_object_object_get_ex(obj, "ok", &ok) || !json_object_get_boolean(ok))
-    {
-        ret = TELEBOT_ERROR_OPERATION_FAILED;
-        goto finish;
-    }
-
     struct json_object *result = NULL;
-    if (!json_object_object_get_ex(obj, "result", &result))
-    {
-        ret = TELEBOT_ERROR_OPERATION_FAILED;
-        goto finish;
-    }
-
-    ret = telebot_parser_get_chat_member(result, member);
+    int ret = telebot_get_chat_result(handle, TELEBOT_CACHE_CHAT_MEMBER, chat_id, user_id, &obj, &result);
+    if (ret == TELEBOT_ERROR_NONE)
+        ret = telebot_parser_get_chat_member(result, member);
 
-finish:
     if (ret != TELEBOT_ERROR_NONE)
         telebot_put_chat_member(member);
 
     if (obj)
         json_object_put(obj);
 
-    telebot_core_put_response(response);
     return ret;
 }
 
@@ -1662,7 +1908,7 @@ telebot_error_e telebot_put_chat_member(telebot_chat_member_t *member)
 
     telebot_put_user(member->user);
     TELEBOT_SAFE_FREE(member->user);
-    TELEBOT_SAFE_FREE(member->status);
+    member->status = NULL; /* Interned */
 
     return TELEBOT_ERROR_NONE;
 }
@@ -1678,6 +1924,8 @@ telebot_error_e telebot_set_chat_sticker_set(telebot_handler_t handle,
 
     telebot_core_response_t response = telebot_core_set_chat_sticker_set(handle->core_h, chat_id, sticker_set_name);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
     telebot_core_put_response(response);
 
     return ret;
@@ -1691,6 +1939,8 @@ telebot_error_e telebot_delete_chat_sticker_set(telebot_handler_t handle,
 
     telebot_core_response_t response = telebot_core_delete_chat_sticker_set(handle->core_h, chat_id);
     int ret = telebot_core_get_response_code(response);
+    if (ret == TELEBOT_ERROR_NONE)
+        telebot_invalidate_chat(handle, TELEBOT_CACHE_CHAT, chat_id);
     telebot_core_put_response(response);
     return ret;
 }
@@ -1878,6 +2128,32 @@ telebot_error_e telebot_delete_message(telebot_handler_t handle, long long int c
 }
 
 /* Utility functions for releasing memory */
+void telebot_put_user_ref(telebot_user_t *user)
+{
+    if (user == NULL)
+        return;
+
+    telebot_user_ref_t *ref = (telebot_user_ref_t *)((char *)user - offsetof(telebot_user_ref_t, user));
+    if (__atomic_sub_fetch(&(ref->refs), 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+
+    telebot_put_user(user);
+    free(ref);
+}
+
+void telebot_put_chat_ref(telebot_chat_t *chat)
+{
+    if (chat == NULL)
+        return;
+
+    telebot_chat_ref_t *ref = (telebot_chat_ref_t *)((char *)chat - offsetof(telebot_chat_ref_t, chat));
+    if (__atomic_sub_fetch(&(ref->refs), 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+
+    telebot_put_chat(chat);
+    free(ref);
+}
+
 telebot_error_e telebot_put_user(telebot_user_t *user)
 {
     if (user == NULL)
@@ -1886,7 +2162,7 @@ telebot_error_e telebot_put_user(telebot_user_t *user)
     TELEBOT_SAFE_FREE(user->first_name);
     TELEBOT_SAFE_FREE(user->last_name);
     TELEBOT_SAFE_FREE(user->username);
-    TELEBOT_SAFE_FREE(user->language_code);
+    user->language_code = NULL; /* Interned */
 
     return TELEBOT_ERROR_NONE;
 }
@@ -1897,7 +2173,7 @@ telebot_error_e telebot_put_chat(telebot_chat_t *chat)
     if (chat == NULL)
         return TELEBOT_ERROR_INVALID_PARAMETER;
 
-    TELEBOT_SAFE_FREE(chat->type);
+    chat->type = NULL; /* Interned */
     TELEBOT_SAFE_FREE(chat->title);
     TELEBOT_SAFE_FREE(chat->username);
     TELEBOT_SAFE_FREE(chat->first_name);
@@ -1962,14 +2238,17 @@ static void telebot_put_message(telebot_message_t *msg)
     if (msg == NULL)
         return;
 
-    telebot_put_user(msg->from);
-    TELEBOT_SAFE_FREE(msg->from);
+    telebot_parser_put_message_lazy(msg->lazy);
+    msg->lazy = NULL;
+
+    telebot_put_user_ref(msg->from);
+    msg->from = NULL;
 
     telebot_put_chat(msg->sender_chat);
     TELEBOT_SAFE_FREE(msg->sender_chat);
 
-    telebot_put_chat(msg->chat);
-    TELEBOT_SAFE_FREE(msg->chat);
+    telebot_put_chat_ref(msg->chat);
+    msg->chat = NULL;
 
     telebot_put_user(msg->forward_from);
     TELEBOT_SAFE_FREE(msg->forward_from);
@@ -2054,88 +2333,99 @@ static void telebot_put_message(telebot_message_t *msg)
     telebot_put_location(msg->location);
     TELEBOT_SAFE_FREE(msg->location);
 
-    telebot_put_gift_info(msg->gift);
-    TELEBOT_SAFE_FREE(msg->gift);
+    telebot_put_message_extras(msg->extras);
+    TELEBOT_SAFE_FREE(msg->extras);
 
-    telebot_put_unique_gift_info(msg->unique_gift);
-    TELEBOT_SAFE_FREE(msg->unique_gift);
+    telebot_put_inline_keyboard_markup(msg->reply_markup);
+    TELEBOT_SAFE_FREE(msg->reply_markup);
+}
 
-    if (msg->new_chat_members)
+void telebot_put_message_extras(telebot_message_extras_t *extras)
+{
+    if (extras == NULL)
+        return;
+
+    if (extras->new_chat_members)
     {
-        for (int index = 0; index < msg->count_new_chat_members; index++)
-            telebot_put_user(&(msg->new_chat_members[index]));
-        TELEBOT_SAFE_FREE(msg->new_chat_members);
-        msg->count_new_chat_members = 0;
+        for (int index = 0; index < extras->count_new_chat_members; index++)
+            telebot_put_user(&(extras->new_chat_members[index]));
+        TELEBOT_SAFE_FREE(extras->new_chat_members);
+        extras->count_new_chat_members = 0;
     }
 
-    if (msg->left_chat_members)
+    if (extras->left_chat_members)
     {
-        for (int index = 0; index < msg->count_left_chat_members; index++)
-            telebot_put_user(&(msg->left_chat_members[index]));
-        TELEBOT_SAFE_FREE(msg->left_chat_members);
-        msg->count_left_chat_members = 0;
+        for (int index = 0; index < extras->count_left_chat_members; index++)
+            telebot_put_user(&(extras->left_chat_members[index]));
+        TELEBOT_SAFE_FREE(extras->left_chat_members);
+        extras->count_left_chat_members = 0;
     }
 
-    TELEBOT_SAFE_FREE(msg->new_chat_title);
+    TELEBOT_SAFE_FREE(extras->new_chat_title);
 
-    if (msg->new_chat_photos)
+    if (extras->new_chat_photos)
     {
-        for (int index = 0; index < msg->count_new_chat_photos; index++)
-            telebot_put_photo(&(msg->new_chat_photos[index]));
-        TELEBOT_SAFE_FREE(msg->new_chat_photos);
-        msg->count_new_chat_photos = 0;
+        for (int index = 0; index < extras->count_new_chat_photos; index++)
+            telebot_put_photo(&(extras->new_chat_photos[index]));
+        TELEBOT_SAFE_FREE(extras->new_chat_photos);
+        extras->count_new_chat_photos = 0;
     }
 
-    TELEBOT_SAFE_FREE(msg->message_auto_delete_timer_changed);
+    TELEBOT_SAFE_FREE(extras->message_auto_delete_timer_changed);
 
-    telebot_put_message(msg->pinned_message);
-    TELEBOT_SAFE_FREE(msg->pinned_message);
+    telebot_put_message(extras->pinned_message);
+    TELEBOT_SAFE_FREE(extras->pinned_message);
 
-    telebot_put_invoice(msg->invoice);
-    TELEBOT_SAFE_FREE(msg->invoice);
+    telebot_put_invoice(extras->invoice);
+    TELEBOT_SAFE_FREE(extras->invoice);
 
-    telebot_put_successful_payment(msg->successful_payment);
-    TELEBOT_SAFE_FREE(msg->successful_payment);
+    telebot_put_successful_payment(extras->successful_payment);
+    TELEBOT_SAFE_FREE(extras->successful_payment);
+    telebot_put_refunded_payment(extras->refunded_payment);
+    TELEBOT_SAFE_FREE(extras->refunded_payment);
 
-    TELEBOT_SAFE_FREE(msg->connected_website);
+    TELEBOT_SAFE_FREE(extras->connected_website);
 
-    telebot_put_passport_data(msg->passport_data);
-    TELEBOT_SAFE_FREE(msg->passport_data);
+    telebot_put_passport_data(extras->passport_data);
+    TELEBOT_SAFE_FREE(extras->passport_data);
 
-    telebot_put_proximity_alert_triggered(msg->proximity_alert_triggered);
-    TELEBOT_SAFE_FREE(msg->proximity_alert_triggered);
+    telebot_put_proximity_alert_triggered(extras->proximity_alert_triggered);
+    TELEBOT_SAFE_FREE(extras->proximity_alert_triggered);
 
-    telebot_put_forum_topic_created(msg->forum_topic_created);
-    TELEBOT_SAFE_FREE(msg->forum_topic_created);
+    telebot_put_forum_topic_created(extras->forum_topic_created);
+    TELEBOT_SAFE_FREE(extras->forum_topic_created);
 
-    telebot_put_forum_topic_edited(msg->forum_topic_edited);
-    TELEBOT_SAFE_FREE(msg->forum_topic_edited);
+    telebot_put_forum_topic_edited(extras->forum_topic_edited);
+    TELEBOT_SAFE_FREE(extras->forum_topic_edited);
 
-    telebot_put_forum_topic_created((telebot_forum_topic_created_t *)msg->forum_topic_closed);
-    TELEBOT_SAFE_FREE(msg->forum_topic_closed);
+    telebot_put_forum_topic_created((telebot_forum_topic_created_t *)extras->forum_topic_closed);
+    TELEBOT_SAFE_FREE(extras->forum_topic_closed);
 
-    telebot_put_forum_topic_created((telebot_forum_topic_created_t *)msg->forum_topic_reopened);
-    TELEBOT_SAFE_FREE(msg->forum_topic_reopened);
+    telebot_put_forum_topic_created((telebot_forum_topic_created_t *)extras->forum_topic_reopened);
+    TELEBOT_SAFE_FREE(extras->forum_topic_reopened);
 
-    TELEBOT_SAFE_FREE(msg->general_forum_topic_hidden);
-    TELEBOT_SAFE_FREE(msg->general_forum_topic_unhidden);
+    TELEBOT_SAFE_FREE(extras->general_forum_topic_hidden);
+    TELEBOT_SAFE_FREE(extras->general_forum_topic_unhidden);
 
-    telebot_put_video_chat_scheduled(msg->video_chat_scheduled);
-    TELEBOT_SAFE_FREE(msg->video_chat_scheduled);
+    telebot_put_video_chat_scheduled(extras->video_chat_scheduled);
+    TELEBOT_SAFE_FREE(extras->video_chat_scheduled);
 
-    TELEBOT_SAFE_FREE(msg->video_chat_started);
+    TELEBOT_SAFE_FREE(extras->video_chat_started);
 
-    telebot_put_video_chat_ended(msg->video_chat_ended);
-    TELEBOT_SAFE_FREE(msg->video_chat_ended);
+    telebot_put_video_chat_ended(extras->video_chat_ended);
+    TELEBOT_SAFE_FREE(extras->video_chat_ended);
 
-    telebot_put_video_chat_participants_invited(msg->video_chat_participants_invited);
-    TELEBOT_SAFE_FREE(msg->video_chat_participants_invited);
+    telebot_put_video_chat_participants_invited(extras->video_chat_participants_invited);
+    TELEBOT_SAFE_FREE(extras->video_chat_participants_invited);
 
-    telebot_put_web_app_data(msg->web_app_data);
-    TELEBOT_SAFE_FREE(msg->web_app_data);
+    telebot_put_web_app_data(extras->web_app_data);
+    TELEBOT_SAFE_FREE(extras->web_app_data);
 
-    telebot_put_inline_keyboard_markup(msg->reply_markup);
-    TELEBOT_SAFE_FREE(msg->reply_markup);
+    telebot_put_gift_info(extras->gift);
+    TELEBOT_SAFE_FREE(extras->gift);
+
+    telebot_put_unique_gift_info(extras->unique_gift);
+    TELEBOT_SAFE_FREE(extras->unique_gift);
 }
 
 static void telebot_put_telebot_message_entity(telebot_message_entity_t *entity)
@@ -2143,7 +2433,7 @@ static void telebot_put_telebot_message_entity(telebot_message_entity_t *entity)
     if (entity == NULL)
         return;
 
-    TELEBOT_SAFE_FREE(entity->type);
+    entity->type = NULL; /* Interned */
     TELEBOT_SAFE_FREE(entity->url);
 
     telebot_put_user(entity->user);
@@ -2312,7 +2602,7 @@ static void telebot_put_poll(telebot_poll_t *poll)
             telebot_put_poll_option(&(poll->options[index]));
     }
     TELEBOT_SAFE_FREE(poll->options);
-    TELEBOT_SAFE_FREE(poll->type);
+    poll->type = NULL; /* Interned */
 }
 
 static void telebot_put_dice(telebot_dice_t *dice)
@@ -2329,8 +2619,8 @@ static void telebot_put_callback_query(telebot_callback_query_t *query)
         return;
 
     TELEBOT_SAFE_FREE(query->id);
-    telebot_put_user(query->from);
-    TELEBOT_SAFE_FREE(query->from);
+    telebot_put_user_ref(query->from);
+    query->from = NULL;
     telebot_put_message(query->message);
     TELEBOT_SAFE_FREE(query->message);
     TELEBOT_SAFE_FREE(query->inline_message_id);
@@ -2350,12 +2640,30 @@ telebot_error_e telebot_put_sticker(telebot_sticker_t *sticker)
     TELEBOT_SAFE_FREE(sticker->thumb);
     TELEBOT_SAFE_FREE(sticker->emoji);
     TELEBOT_SAFE_FREE(sticker->set_name);
-    // telebot_put_mask_position(sticker->mask_position);
+    if (sticker->mask_position != NULL)
+        TELEBOT_SAFE_FREE(sticker->mask_position->point);
     TELEBOT_SAFE_FREE(sticker->mask_position);
 
     return TELEBOT_ERROR_NONE;
 }
 
+telebot_error_e telebot_put_sticker_set(telebot_sticker_set_t *stickers)
+{
+    if (stickers == NULL)
+        return TELEBOT_ERROR_INVALID_PARAMETER;
+
+    TELEBOT_SAFE_FREE(stickers->name);
+    TELEBOT_SAFE_FREE(stickers->title);
+    for (int index = 0; index < stickers->count_stickers; index++)
+        telebot_put_sticker(&(stickers->stickers[index]));
+    TELEBOT_SAFE_FREE(stickers->stickers);
+    stickers->count_stickers = 0;
+    telebot_put_photo(stickers->thumb);
+    TELEBOT_SAFE_FREE(stickers->thumb);
+
+    return TELEBOT_ERROR_NONE;
+}
+
 telebot_error_e telebot_put_gift(telebot_gift_t *gift)
 {
     if (gift == NULL)
@@ -2877,8 +3185,9 @@ telebot_error_e telebot_copy_messages(telebot_handler_t handle, long long int ch
             *message_ids_out = calloc(array_len, sizeof(int));
             for (int i = 0; i < array_len; i++)
             {
-                struct json_object *mid_obj = json_object_array_get_idx(result, i);
-                (*message_ids_out)[i] = json_object_get_int(mid_obj);
+                struct json_object *mid_obj = NULL;
+                if (json_object_object_get_ex(json_object_array_get_idx(result, i), "message_id", &mid_obj))
+                    (*message_ids_out)[i] = json_object_get_int(mid_obj);
             }
         }
     }
@@ -2928,8 +3237,9 @@ telebot_error_e telebot_forward_messages(telebot_handler_t handle, long long int
             *message_ids_out = calloc(array_len, sizeof(int));
             for (int i = 0; i < array_len; i++)
             {
-                struct json_object *mid_obj = json_object_array_get_idx(result, i);
-                (*message_ids_out)[i] = json_object_get_int(mid_obj);
+                struct json_object *mid_obj = NULL;
+                if (json_object_object_get_ex(json_object_array_get_idx(result, i), "message_id", &mid_obj))
+                    (*message_ids_out)[i] = json_object_get_int(mid_obj);
             }
         }
     }
@@ -2998,6 +3308,16 @@ static void telebot_put_successful_payment(telebot_successful_payment_t *payment
     TELEBOT_SAFE_FREE(payment->provider_payment_charge_id);
 }
 
+static void telebot_put_refunded_payment(telebot_refunded_payment_t *payment)
+{
+    if (payment == NULL)
+        return;
+    TELEBOT_SAFE_FREE(payment->currency);
+    TELEBOT_SAFE_FREE(payment->invoice_payload);
+    TELEBOT_SAFE_FREE(payment->telegram_payment_charge_id);
+    TELEBOT_SAFE_FREE(payment->provider_payment_charge_id);
+}
+
 static void telebot_put_passport_data(telebot_passport_data_t *passport_data)
 {
     if (passport_data == NULL)
@@ -3113,10 +3433,10 @@ static void telebot_put_chat_member_updated(telebot_chat_member_updated_t *updat
 {
     if (updated == NULL)
         return;
-    telebot_put_chat(updated->chat);
-    TELEBOT_SAFE_FREE(updated->chat);
-    telebot_put_user(updated->from);
-    TELEBOT_SAFE_FREE(updated->from);
+    telebot_put_chat_ref(updated->chat);
+    updated->chat = NULL;
+    telebot_put_user_ref(updated->from);
+    updated->from = NULL;
     telebot_put_chat_member(updated->old_chat_member);
     TELEBOT_SAFE_FREE(updated->old_chat_member);
     telebot_put_chat_member(updated->new_chat_member);
@@ -3129,10 +3449,10 @@ static void telebot_put_chat_join_request(telebot_chat_join_request_t *request)
 {
     if (request == NULL)
         return;
-    telebot_put_chat(request->chat);
-    TELEBOT_SAFE_FREE(request->chat);
-    telebot_put_user(request->from);
-    TELEBOT_SAFE_FREE(request->from);
+    telebot_put_chat_ref(request->chat);
+    request->chat = NULL;
+    telebot_put_user_ref(request->from);
+    request->from = NULL;
     TELEBOT_SAFE_FREE(request->bio);
     telebot_put_chat_invite_link_internal(request->invite_link);
     TELEBOT_SAFE_FREE(request->invite_link);
@@ -3142,8 +3462,8 @@ static void telebot_put_reaction_type(telebot_reaction_type_t *reaction)
 {
     if (reaction == NULL)
         return;
-    TELEBOT_SAFE_FREE(reaction->type);
-    TELEBOT_SAFE_FREE(reaction->emoji);
+    reaction->type = NULL; /* Interned */
+    reaction->emoji = NULL; /* Interned */
     TELEBOT_SAFE_FREE(reaction->custom_emoji_id);
 }
 
@@ -3151,12 +3471,12 @@ static void telebot_put_message_reaction_updated(telebot_message_reaction_update
 {
     if (updated == NULL)
         return;
-    telebot_put_chat(updated->chat);
-    TELEBOT_SAFE_FREE(updated->chat);
-    telebot_put_user(updated->user);
-    TELEBOT_SAFE_FREE(updated->user);
-    telebot_put_chat(updated->actor_chat);
-    TELEBOT_SAFE_FREE(updated->actor_chat);
+    telebot_put_chat_ref(updated->chat);
+    updated->chat = NULL;
+    telebot_put_user_ref(updated->user);
+    updated->user = NULL;
+    telebot_put_chat_ref(updated->actor_chat);
+    updated->actor_chat = NULL;
     if (updated->old_reaction)
     {
         for (int i = 0; i < updated->count_old_reaction; i++)
@@ -3175,8 +3495,8 @@ static void telebot_put_message_reaction_count_updated(telebot_message_reaction_
 {
     if (updated == NULL)
         return;
-    telebot_put_chat(updated->chat);
-    TELEBOT_SAFE_FREE(updated->chat);
+    telebot_put_chat_ref(updated->chat);
+    updated->chat = NULL;
     if (updated->reactions)
     {
         for (int i = 0; i < updated->count_reactions; i++)
@@ -3189,8 +3509,8 @@ static void telebot_put_chat_boost_updated(telebot_chat_boost_updated_t *updated
 {
     if (updated == NULL)
         return;
-    telebot_put_chat(updated->chat);
-    TELEBOT_SAFE_FREE(updated->chat);
+    telebot_put_chat_ref(updated->chat);
+    updated->chat = NULL;
     if (updated->boost)
     {
         TELEBOT_SAFE_FREE(updated->boost->boost_id);
@@ -3209,8 +3529,8 @@ static void telebot_put_chat_boost_removed(telebot_chat_boost_removed_t *removed
 {
     if (removed == NULL)
         return;
-    telebot_put_chat(removed->chat);
-    TELEBOT_SAFE_FREE(removed->chat);
+    telebot_put_chat_ref(removed->chat);
+    removed->chat = NULL;
     TELEBOT_SAFE_FREE(removed->boost_id);
     if (removed->source)
     {
@@ -3226,8 +3546,8 @@ static void telebot_put_inline_query(telebot_inline_query_t *query)
     if (query == NULL)
         return;
     TELEBOT_SAFE_FREE(query->id);
-    telebot_put_user(query->from);
-    TELEBOT_SAFE_FREE(query->from);
+    telebot_put_user_ref(query->from);
+    query->from = NULL;
     TELEBOT_SAFE_FREE(query->query);
     TELEBOT_SAFE_FREE(query->offset);
     TELEBOT_SAFE_FREE(query->chat_type);
@@ -3240,8 +3560,8 @@ static void telebot_put_chosen_inline_result(telebot_chosen_inline_result_t *res
     if (result == NULL)
         return;
     TELEBOT_SAFE_FREE(result->result_id);
-    telebot_put_user(result->from);
-    TELEBOT_SAFE_FREE(result->from);
+    telebot_put_user_ref(result->from);
+    result->from = NULL;
     telebot_put_location(result->location);
     TELEBOT_SAFE_FREE(result->location);
     TELEBOT_SAFE_FREE(result->inline_message_id);
@@ -3253,8 +3573,8 @@ static void telebot_put_shipping_query(telebot_shipping_query_t *query)
     if (query == NULL)
         return;
     TELEBOT_SAFE_FREE(query->id);
-    telebot_put_user(query->from);
-    TELEBOT_SAFE_FREE(query->from);
+    telebot_put_user_ref(query->from);
+    query->from = NULL;
     TELEBOT_SAFE_FREE(query->invoice_payload);
     telebot_put_shipping_address(query->shipping_address);
     TELEBOT_SAFE_FREE(query->shipping_address);
@@ -3265,8 +3585,8 @@ static void telebot_put_pre_checkout_query(telebot_pre_checkout_query_t *query)
     if (query == NULL)
         return;
     TELEBOT_SAFE_FREE(query->id);
-    telebot_put_user(query->from);
-    TELEBOT_SAFE_FREE(query->from);
+    telebot_put_user_ref(query->from);
+    query->from = NULL;
     TELEBOT_SAFE_FREE(query->currency);
     TELEBOT_SAFE_FREE(query->invoice_payload);
     TELEBOT_SAFE_FREE(query->shipping_option_id);
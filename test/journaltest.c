@@ -0,0 +1,106 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <json.h>
+#include <telebot.h>
+#include <telebot-private.h>
+
+/*
+ * Update journal regression test.
+ *
+ *   journaltest
+ *       Fills a 4096 bytes journal with 85 records of 48 bytes, which leaves
+ *       16 bytes at the end of the ring, too few for a record header. Once
+ *       they are acknowledged, the next record has to wrap around to the
+ *       start of the ring, and be replayed after the journal is reopened.
+ */
+
+#define JOURNAL_CAPACITY 4096
+#define JOURNAL_RECORDS  85  /* {"update_id":NNN} takes 48 bytes with its header */
+#define JOURNAL_FIRST_ID 100
+
+static int check(bool ok, const char *what)
+{
+    printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+    return ok ? 0 : 1;
+}
+
+static telebot_error_e journal_append(telebot_journal_t *journal, int update_id)
+{
+    char data[32];
+    snprintf(data, sizeof(data), "[{\"update_id\":%d}]", update_id);
+
+    struct json_object *updates = json_tokener_parse(data);
+    telebot_error_e ret = telebot_journal_append(journal, updates);
+    json_object_put(updates);
+    telebot_journal_delivered(journal);
+
+    return ret;
+}
+
+static int journal_replay_id(telebot_journal_t *journal)
+{
+    struct json_object *updates = NULL;
+    int64_t *received = NULL;
+    int update_id = -1;
+
+    if (telebot_journal_replay(journal, TELEBOT_UPDATE_COUNT_MAX_LIMIT, &updates, &received) != TELEBOT_ERROR_NONE)
+        return -2;
+
+    if ((updates != NULL) && (json_object_array_length(updates) == 1))
+    {
+        struct json_object *id = NULL;
+        if (json_object_object_get_ex(json_object_array_get_idx(updates, 0), "update_id", &id))
+            update_id = json_object_get_int(id);
+    }
+
+    json_object_put(updates);
+    free(received);
+    return update_id;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/telebot-journal-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+    unlink(path);
+
+    int failed = 0;
+    telebot_journal_t *journal = NULL;
+    failed += check(telebot_journal_open(&journal, path, JOURNAL_CAPACITY, 1) == TELEBOT_ERROR_NONE, "open");
+    if (journal == NULL)
+        return 1;
+
+    int last_id = JOURNAL_FIRST_ID + JOURNAL_RECORDS - 1;
+    bool appended = true;
+    for (int id = JOURNAL_FIRST_ID; id <= last_id; id++)
+        appended = appended && (journal_append(journal, id) == TELEBOT_ERROR_NONE);
+    failed += check(appended, "fill the ring up to a gap smaller than a record header");
+    failed += check(journal_append(journal, last_id + 1) == TELEBOT_ERROR_OUT_OF_MEMORY, "full ring rejects a record");
+
+    telebot_journal_ack(journal, last_id);
+    failed += check(journal_append(journal, last_id + 1) == TELEBOT_ERROR_NONE, "append wraps past the gap");
+    telebot_journal_close(journal);
+
+    failed += check(telebot_journal_open(&journal, path, JOURNAL_CAPACITY, 1) == TELEBOT_ERROR_NONE, "reopen");
+    if (journal == NULL)
+        return 1;
+
+    failed += check(journal_replay_id(journal) == last_id + 1, "wrapped record is replayed");
+    failed += check(journal_replay_id(journal) == -1, "acknowledged records are not replayed");
+
+    telebot_journal_ack(journal, last_id + 1);
+    failed += check(journal_append(journal, last_id + 2) == TELEBOT_ERROR_NONE, "append after the wrapped record");
+    telebot_journal_close(journal);
+    unlink(path);
+
+    return failed ? 1 : 0;
+}
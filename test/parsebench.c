@@ -0,0 +1,247 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <json.h>
+#include <telebot.h>
+#include <telebot-parser.h>
+
+/*
+ * Update parsing benchmark.
+ *
+ *   parsebench [--uniform] [--capture <file>] [--count N] [--rounds N]
+ *       Builds a stream of updates and measures update type dispatch, comparing
+ *       the perfect hash lookup with probing every update type key in turn,
+ *       and the throughput of parsing the stream in getUpdates batches.
+ *
+ * By default the stream mixes update types the way a busy group bot sees them
+ * (mostly messages, edits and callback queries). --uniform spreads it over all
+ * update types, --capture uses updates recorded with replaybot.
+ */
+
+#define BENCH_BATCH  100
+#define BENCH_BUFFER 2048
+
+static const char *bench_user = "{\"id\":1001,\"is_bot\":false,\"first_name\":\"Ann\"}";
+static const char *bench_chat = "{\"id\":-1002,\"type\":\"supergroup\",\"title\":\"Group\"}";
+
+static const struct bench_type
+{
+    const char *key;
+    const char *payload; /* printf format, %1$s is user, %2$s is chat */
+    int weight;          /* Share in the default stream, in percents */
+} bench_types[TELEBOT_UPDATE_TYPE_MAX] = {
+    {"message", "{\"message_id\":1,\"date\":1,\"chat\":%2$s,\"from\":%1$s,\"text\":\"hello\"}", 55},
+    {"edited_message", "{\"message_id\":1,\"date\":1,\"edit_date\":2,\"chat\":%2$s,\"from\":%1$s,\"text\":\"hi\"}", 8},
+    {"channel_post", "{\"message_id\":1,\"date\":1,\"chat\":%2$s,\"text\":\"news\"}", 2},
+    {"edited_channel_post", "{\"message_id\":1,\"date\":1,\"chat\":%2$s,\"text\":\"news\"}", 1},
+    {"business_connection", "{\"id\":\"b\",\"user\":%1$s,\"user_chat_id\":1001,\"date\":1,\"is_enabled\":true}", 1},
+    {"business_message", "{\"message_id\":1,\"date\":1,\"chat\":%2$s,\"text\":\"b\"}", 1},
+    {"edited_business_message", "{\"message_id\":1,\"date\":1,\"chat\":%2$s,\"text\":\"b\"}", 1},
+    {"deleted_business_messages", "{\"business_connection_id\":\"b\",\"chat\":%2$s,\"message_ids\":[1,2]}", 1},
+    {"message_reaction", "{\"chat\":%2$s,\"message_id\":1,\"user\":%1$s,\"date\":1,\"old_reaction\":[],"
+                         "\"new_reaction\":[{\"type\":\"emoji\",\"emoji\":\"+\"}]}", 3},
+    {"message_reaction_count", "{\"chat\":%2$s,\"message_id\":1,\"date\":1,\"reactions\":[]}", 1},
+    {"inline_query", "{\"id\":\"q\",\"from\":%1$s,\"query\":\"cats\",\"offset\":\"\"}", 2},
+    {"chosen_inline_result", "{\"result_id\":\"r\",\"from\":%1$s,\"query\":\"cats\"}", 1},
+    {"callback_query", "{\"id\":\"c\",\"from\":%1$s,\"chat_instance\":\"i\",\"data\":\"vote:1\"}", 12},
+    {"shipping_query", "{\"id\":\"s\",\"from\":%1$s,\"invoice_payload\":\"p\",\"shipping_address\":{"
+                       "\"country_code\":\"US\",\"state\":\"\",\"city\":\"c\",\"street_line1\":\"s\","
+                       "\"street_line2\":\"\",\"post_code\":\"1\"}}", 1},
+    {"pre_checkout_query", "{\"id\":\"p\",\"from\":%1$s,\"currency\":\"XTR\",\"total_amount\":1,"
+                           "\"invoice_payload\":\"p\"}", 1},
+    {"purchased_paid_media", "{\"from\":%1$s,\"paid_media_payload\":\"p\"}", 1},
+    {"poll", "{\"id\":\"p\",\"question\":\"q\",\"options\":[{\"text\":\"a\",\"voter_count\":0}],\"total_voter_count\":0,\"is_closed\":false,"
+             "\"is_anonymous\":true,\"type\":\"regular\",\"allows_multiple_answers\":false}", 1},
+    {"poll_answer", "{\"poll_id\":\"p\",\"user\":%1$s,\"option_ids\":[0]}", 1},
+    {"my_chat_member", "{\"chat\":%2$s,\"from\":%1$s,\"date\":1,\"old_chat_member\":{\"status\":\"left\","
+                       "\"user\":%1$s},\"new_chat_member\":{\"status\":\"member\",\"user\":%1$s}}", 1},
+    {"chat_member", "{\"chat\":%2$s,\"from\":%1$s,\"date\":1,\"old_chat_member\":{\"status\":\"left\","
+                    "\"user\":%1$s},\"new_chat_member\":{\"status\":\"member\",\"user\":%1$s}}", 2},
+    {"chat_join_request", "{\"chat\":%2$s,\"from\":%1$s,\"user_chat_id\":1001,\"date\":1}", 1},
+    {"chat_boost", "{\"chat\":%2$s,\"boost\":{\"boost_id\":\"b\",\"add_date\":1,\"expiration_date\":2,"
+                   "\"source\":{\"source\":\"premium\",\"user\":%1$s}}}", 1},
+    {"removed_chat_boost", "{\"chat\":%2$s,\"boost_id\":\"b\",\"remove_date\":1,"
+                           "\"source\":{\"source\":\"premium\",\"user\":%1$s}}", 1},
+};
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static struct json_object *bench_build_stream(int count, bool uniform)
+{
+    struct json_object *array = json_object_new_array();
+    int total = 0;
+    for (int i = 0; i < TELEBOT_UPDATE_TYPE_MAX; i++)
+        total += bench_types[i].weight;
+
+    unsigned int seed = 42;
+    char payload[BENCH_BUFFER];
+    char update[2 * BENCH_BUFFER];
+    for (int n = 0; n < count; n++)
+    {
+        int type = 0;
+        if (uniform)
+        {
+            type = rand_r(&seed) % TELEBOT_UPDATE_TYPE_MAX;
+        }
+        else
+        {
+            int pick = rand_r(&seed) % total;
+            while (pick >= bench_types[type].weight)
+                pick -= bench_types[type++].weight;
+        }
+
+        snprintf(payload, sizeof(payload), bench_types[type].payload, bench_user, bench_chat);
+        snprintf(update, sizeof(update), "{\"update_id\":%d,\"%s\":%s}", n + 1, bench_types[type].key, payload);
+        json_object_array_add(array, json_tokener_parse(update));
+    }
+
+    return array;
+}
+
+static struct json_object *bench_load_capture(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    struct json_object *array = json_object_new_array();
+    char *line = NULL;
+    size_t size = 0;
+    while (getline(&line, &size, fp) > 0)
+    {
+        char *tab = strchr(line, '\t');
+        struct json_object *update = json_tokener_parse(tab ? tab + 1 : line);
+        if (update != NULL)
+            json_object_array_add(array, update);
+    }
+    free(line);
+    fclose(fp);
+
+    return array;
+}
+
+/* Dispatch as done before the perfect hash: probe every type key in turn */
+static int bench_probe_update_type(struct json_object *update)
+{
+    for (int type = 0; type < TELEBOT_UPDATE_TYPE_MAX; type++)
+    {
+        if (json_object_object_get_ex(update, bench_types[type].key, NULL))
+            return type;
+    }
+
+    return TELEBOT_UPDATE_TYPE_MAX;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = 10000;
+    int rounds = 20;
+    bool uniform = false;
+    const char *capture = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--count") == 0) && (i + 1 < argc))
+            count = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--rounds") == 0) && (i + 1 < argc))
+            rounds = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--capture") == 0) && (i + 1 < argc))
+            capture = argv[++i];
+        else if (strcmp(argv[i], "--uniform") == 0)
+            uniform = true;
+        else
+        {
+            printf("Usage: %s [--uniform] [--capture <file>] [--count N] [--rounds N]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    struct json_object *stream = capture ? bench_load_capture(capture) : bench_build_stream(count, uniform);
+    if (stream == NULL)
+        return -1;
+
+    int len = json_object_array_length(stream);
+    if (len == 0)
+    {
+        printf("No updates to parse\n");
+        json_object_put(stream);
+        return -1;
+    }
+    printf("Updates: %d (%s), rounds: %d\n", len, capture ? capture : (uniform ? "uniform" : "mixed"), rounds);
+
+    /* Update type dispatch */
+    long checksum = 0;
+    double start = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < len; i++)
+            checksum += bench_probe_update_type(json_object_array_get_idx(stream, i));
+    double probe_ns = (now_ns() - start) / ((double)rounds * len);
+
+    start = now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < len; i++)
+            checksum -= telebot_parser_get_update_type(json_object_array_get_idx(stream, i), NULL);
+    double hash_ns = (now_ns() - start) / ((double)rounds * len);
+
+    printf("Dispatch, key probing: %8.1f ns/update\n", probe_ns);
+    printf("Dispatch, perfect hash: %7.1f ns/update (%.1fx)\n", hash_ns, probe_ns / hash_ns);
+    if (checksum != 0)
+        printf("Dispatch results differ!\n");
+
+    /* Full parsing in getUpdates batches */
+    double parse_ns = 0;
+    size_t footprint = 0;
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int i = 0; i < len; i += BENCH_BATCH)
+        {
+            struct json_object *batch = json_object_new_array();
+            for (int j = i; (j < len) && (j < i + BENCH_BATCH); j++)
+                json_object_array_add(batch, json_object_get(json_object_array_get_idx(stream, j)));
+
+            telebot_update_t *updates = NULL;
+            int n = 0;
+            start = now_ns();
+            telebot_error_e ret = telebot_parser_get_updates(batch, NULL, &updates, &n);
+            parse_ns += now_ns() - start;
+            if (ret == TELEBOT_ERROR_NONE)
+            {
+                if (r == 0)
+                    footprint += telebot_parser_get_updates_footprint(updates);
+                telebot_put_updates(updates, n);
+            }
+            json_object_put(batch);
+        }
+    }
+    printf("Parse: %.1f ns/update, %.0f updates/s\n",
+           parse_ns / ((double)rounds * len), ((double)rounds * len) * 1e9 / parse_ns);
+
+    /* Memory of parsed updates, against every update inlining the largest payload */
+    size_t largest = 0;
+    for (int type = 0; type < TELEBOT_UPDATE_TYPE_MAX; type++)
+    {
+        size_t size = telebot_parser_get_update_payload_size(type);
+        if (size > largest)
+            largest = size;
+    }
+    size_t header = offsetof(telebot_update_t, payload);
+    printf("sizeof(telebot_update_t): %zu bytes, largest payload: %zu bytes\n", sizeof(telebot_update_t), largest);
+    printf("Footprint: %.1f bytes/update, inline payloads: %zu bytes/update (%.1fx)\n",
+           (double)footprint / len, header + largest, (header + largest) / ((double)footprint / len));
+
+    json_object_put(stream);
+    return 0;
+}
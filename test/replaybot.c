@@ -0,0 +1,891 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <json.h>
+#include <telebot.h>
+#include <telebot-core.h>
+
+/*
+ * Update capture and replay tool.
+ *
+ *   replaybot record <capture> [count] [--redact-text]
+ *       Polls getUpdates with the token from .token file and stores received
+ *       updates, with anonymized identifiers and names, into a capture file.
+ *
+ *   replaybot replay <capture> [--speed N] [--port N] [--no-reply]
+ *                    [--senders N] [--http 1.1|2|h2c] [--api-url URL]
+ *       Starts a local mock Bot API server that releases captured updates at
+ *       their original pace multiplied by speed (0 releases all at once), and
+ *       runs a polling bot against it, reporting throughput and latency.
+ *       Replies are sent by the polling thread, or by N sender threads to keep
+ *       several requests in flight. --http selects the HTTP version of the
+ *       bot, and --api-url sends its requests to e.g. an HTTP/2 proxy in
+ *       front of the mock server instead of the mock server itself.
+ *
+ * A capture is a text file with one update per line, prefixed with arrival
+ * time in milliseconds relative to the first update and a tab.
+ */
+
+#define REPLAY_HTTP_BUFFER   65536
+#define REPLAY_BATCH_LIMIT   100
+#define REPLAY_TOKEN         "0:replay"
+
+typedef struct replay_update
+{
+    long long time_ms;   /* Arrival time relative to the first update */
+    char *payload;       /* Update JSON with renumbered update_id */
+    double released_ms;  /* Time the mock server made the update available */
+    double handled_ms;   /* Time the bot handed the update to the handler */
+} replay_update_t;
+
+typedef struct replay_context
+{
+    replay_update_t *updates;
+    int count;
+    double speed;
+    double start_ms;
+    int listen_fd;
+    volatile bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int get_updates_calls;
+    int other_calls;
+} replay_context_t;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ---------------------------------------------------------------- record */
+
+static uint64_t anon_salt;
+
+static uint64_t anon_hash(uint64_t value);
+
+static uint64_t anon_string_hash(const char *str)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (; *str != '\0'; str++)
+        hash = (hash ^ (unsigned char)*str) * 0x100000001b3ULL;
+    return anon_hash(hash);
+}
+
+static uint64_t anon_hash(uint64_t value)
+{
+    uint64_t z = value ^ anon_salt;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Map identifier to another one with the same sign and number of digits */
+static long long anon_id(long long id)
+{
+    long long magnitude = id < 0 ? -id : id;
+    long long low = 1;
+    while (low * 10 <= magnitude)
+        low *= 10;
+    long long mapped = (low < 10) ? magnitude : low + (long long)(anon_hash(magnitude) % (uint64_t)(low * 9));
+    return id < 0 ? -mapped : mapped;
+}
+
+static bool key_in(const char *key, const char *const keys[])
+{
+    for (int i = 0; keys[i] != NULL; i++)
+        if (strcmp(key, keys[i]) == 0)
+            return true;
+    return false;
+}
+
+static void anonymize(struct json_object *obj, bool redact_text)
+{
+    static const char *const id_keys[] = {"id", "user_id", "chat_id", "sender_chat_id",
+                                          "linked_chat_id", "migrate_to_chat_id",
+                                          "migrate_from_chat_id", NULL};
+    static const char *const name_keys[] = {"first_name", "last_name", "username", "title",
+                                            "phone_number", "bio", "description", "email",
+                                            "invite_link", "author_signature", NULL};
+    static const char *const text_keys[] = {"text", "caption", "query", NULL};
+
+    if (json_object_get_type(obj) == json_type_array)
+    {
+        size_t len = json_object_array_length(obj);
+        for (size_t i = 0; i < len; i++)
+            anonymize(json_object_array_get_idx(obj, i), redact_text);
+        return;
+    }
+
+    if (json_object_get_type(obj) != json_type_object)
+        return;
+
+    struct json_object_iterator it = json_object_iter_begin(obj);
+    struct json_object_iterator end = json_object_iter_end(obj);
+    for (; !json_object_iter_equal(&it, &end); json_object_iter_next(&it))
+    {
+        const char *key = json_object_iter_peek_name(&it);
+        struct json_object *value = json_object_iter_peek_value(&it);
+        json_type type = json_object_get_type(value);
+
+        if ((type == json_type_int) && key_in(key, id_keys))
+        {
+            json_object_set_int64(value, anon_id(json_object_get_int64(value)));
+        }
+        else if ((type == json_type_string) && key_in(key, name_keys))
+        {
+            char anon[32];
+            snprintf(anon, sizeof(anon), "anon%08llx",
+                     (unsigned long long)(anon_string_hash(json_object_get_string(value)) & 0xffffffff));
+            json_object_set_string(value, anon);
+        }
+        else if ((type == json_type_string) && redact_text && key_in(key, text_keys))
+        {
+            /* Keep leading bot command, so command routing still works */
+            char *text = strdup(json_object_get_string(value));
+            if (text == NULL)
+                continue;
+            size_t keep = (text[0] == '/') ? strcspn(text, " @\n") : 0;
+            for (size_t i = keep; text[i] != '\0'; i++)
+                if (text[i] != ' ' && text[i] != '\n')
+                    text[i] = 'x';
+            json_object_set_string(value, text);
+            free(text);
+        }
+        else
+        {
+            anonymize(value, redact_text);
+        }
+    }
+}
+
+static int do_record(const char *path, int max_count, bool redact_text)
+{
+    FILE *fp = fopen(".token", "r");
+    if (fp == NULL)
+    {
+        printf("Failed to open .token file\n");
+        return -1;
+    }
+
+    char token[1024];
+    if (fscanf(fp, "%1023s", token) != 1)
+    {
+        printf("Failed to read token\n");
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        printf("Failed to open capture file '%s'\n", path);
+        return -1;
+    }
+
+    telebot_core_handler_t core_h;
+    if (telebot_core_create(&core_h, token) != TELEBOT_ERROR_NONE)
+    {
+        printf("Telebot core create failed\n");
+        fclose(out);
+        return -1;
+    }
+
+    anon_salt = ((uint64_t)time(NULL) << 32) ^ (uint64_t)getpid() ^ (uint64_t)(uintptr_t)&core_h;
+
+    int offset = 0, recorded = 0;
+    double first_ms = -1;
+    while ((max_count <= 0) || (recorded < max_count))
+    {
+        telebot_core_response_t response = telebot_core_get_updates(core_h, offset, REPLAY_BATCH_LIMIT, 10, NULL);
+        const char *data = telebot_core_get_response_data(response);
+        struct json_object *obj = data ? json_tokener_parse(data) : NULL;
+        struct json_object *result = NULL;
+        double arrival_ms = now_ms();
+
+        if ((obj != NULL) && json_object_object_get_ex(obj, "result", &result))
+        {
+            size_t len = json_object_array_length(result);
+            for (size_t i = 0; (i < len) && ((max_count <= 0) || (recorded < max_count)); i++)
+            {
+                struct json_object *item = json_object_array_get_idx(result, i);
+                struct json_object *update_id = NULL;
+                if (json_object_object_get_ex(item, "update_id", &update_id))
+                    offset = json_object_get_int(update_id) + 1;
+
+                if (first_ms < 0)
+                    first_ms = arrival_ms;
+                anonymize(item, redact_text);
+                fprintf(out, "%lld\t%s\n", (long long)(arrival_ms - first_ms),
+                        json_object_to_json_string_ext(item, JSON_C_TO_STRING_PLAIN));
+                recorded++;
+            }
+            fflush(out);
+            printf("\rRecorded %d updates", recorded);
+            fflush(stdout);
+        }
+        else
+        {
+            sleep(1);
+        }
+
+        if (obj)
+            json_object_put(obj);
+        telebot_core_put_response(response);
+    }
+
+    /* Confirm recorded updates, so they are not delivered to the bot again */
+    telebot_core_put_response(telebot_core_get_updates(core_h, offset, 1, 0, NULL));
+    telebot_core_destroy(&core_h);
+    fclose(out);
+    printf("\nCapture saved to %s\n", path);
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------- replay */
+
+static int load_capture(const char *path, replay_update_t **updates, int *count)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        printf("Failed to open capture file '%s'\n", path);
+        return -1;
+    }
+
+    int capacity = 256, len = 0;
+    replay_update_t *list = calloc(capacity, sizeof(replay_update_t));
+    char *line = NULL;
+    size_t line_size = 0;
+    while ((list != NULL) && (getline(&line, &line_size, fp) > 0))
+    {
+        char *tab = strchr(line, '\t');
+        if (tab == NULL)
+            continue;
+
+        struct json_object *item = json_tokener_parse(tab + 1);
+        if (item == NULL)
+            continue;
+
+        if (len == capacity)
+        {
+            capacity *= 2;
+            replay_update_t *grown = realloc(list, capacity * sizeof(replay_update_t));
+            if (grown == NULL)
+            {
+                json_object_put(item);
+                break;
+            }
+            list = grown;
+        }
+
+        /* Renumber updates, so the mock server can honour offsets */
+        json_object_object_add(item, "update_id", json_object_new_int(len + 1));
+        list[len].time_ms = atoll(line);
+        list[len].payload = strdup(json_object_to_json_string_ext(item, JSON_C_TO_STRING_PLAIN));
+        list[len].released_ms = -1;
+        list[len].handled_ms = -1;
+        json_object_put(item);
+        len++;
+    }
+    free(line);
+    fclose(fp);
+
+    if ((list == NULL) || (len == 0))
+    {
+        printf("Capture file '%s' has no updates\n", path);
+        free(list);
+        return -1;
+    }
+
+    *updates = list;
+    *count = len;
+    return 0;
+}
+
+/* Release time of update in milliseconds relative to replay start */
+static double release_at(replay_context_t *ctx, int index)
+{
+    return (ctx->speed > 0) ? ctx->updates[index].time_ms / ctx->speed : 0;
+}
+
+/* Find value of form field either in multipart or urlencoded request body */
+static long body_field(const char *body, const char *name, long def)
+{
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "name=\"%s\"", name);
+    const char *pos = strstr(body, pattern);
+    if (pos != NULL)
+    {
+        pos = strstr(pos, "\r\n\r\n");
+        return pos ? strtol(pos + 4, NULL, 10) : def;
+    }
+
+    size_t len = strlen(name);
+    for (pos = body; (pos = strstr(pos, name)) != NULL; pos += len)
+    {
+        if (((pos == body) || (pos[-1] == '&')) && (pos[len] == '='))
+            return strtol(pos + len + 1, NULL, 10);
+    }
+
+    return def;
+}
+
+static char *build_updates_response(replay_context_t *ctx, long offset, long limit, size_t *size)
+{
+    size_t capacity = 64;
+    double elapsed = now_ms() - ctx->start_ms;
+    int first = (offset > 0) ? offset - 1 : 0, last = first;
+    while ((last < ctx->count) && (last - first < limit) && (release_at(ctx, last) <= elapsed))
+        capacity += strlen(ctx->updates[last++].payload) + 1;
+
+    char *buffer = malloc(capacity);
+    if (buffer == NULL)
+        return NULL;
+
+    size_t len = sprintf(buffer, "{\"ok\":true,\"result\":[");
+    for (int i = first; i < last; i++)
+    {
+        if (ctx->updates[i].released_ms < 0)
+            ctx->updates[i].released_ms = ctx->start_ms + release_at(ctx, i);
+        len += sprintf(buffer + len, "%s%s", (i > first) ? "," : "", ctx->updates[i].payload);
+    }
+    len += sprintf(buffer + len, "]}");
+    *size = len;
+
+    return buffer;
+}
+
+static void serve_get_updates(replay_context_t *ctx, const char *body, char **response, size_t *size)
+{
+    long offset = body_field(body, "offset", 0);
+    long limit = body_field(body, "limit", REPLAY_BATCH_LIMIT);
+    long timeout = body_field(body, "timeout", 0);
+    double deadline = now_ms() + timeout * 1000.0;
+
+    pthread_mutex_lock(&(ctx->lock));
+    ctx->get_updates_calls++;
+    /* Long polling: hold the request until the next update is released */
+    int next = (offset > 0) ? offset - 1 : 0;
+    while (!ctx->stop && (next < ctx->count))
+    {
+        double wait_until = ctx->start_ms + release_at(ctx, next);
+        if (wait_until <= now_ms())
+            break;
+        if (wait_until > deadline)
+            wait_until = deadline;
+        if (now_ms() >= deadline)
+            break;
+
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        double delta = wait_until - now_ms();
+        ts.tv_sec += (time_t)(delta / 1000);
+        ts.tv_nsec += (long)((delta - (long)(delta / 1000) * 1000) * 1e6);
+        if (ts.tv_nsec >= 1000000000L)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&(ctx->cond), &(ctx->lock), &ts);
+    }
+    *response = build_updates_response(ctx, offset, limit, size);
+    pthread_mutex_unlock(&(ctx->lock));
+}
+
+static bool read_request(int fd, char *buffer, size_t capacity, size_t *used, char **body, size_t *body_len)
+{
+    char *end = NULL;
+    bool continued = false;
+    while (true)
+    {
+        buffer[*used] = '\0';
+        end = strstr(buffer, "\r\n\r\n");
+        if (end != NULL)
+        {
+            const char *cl = strcasestr(buffer, "\r\nContent-Length:");
+            size_t length = (cl && cl < end) ? strtoul(cl + 17, NULL, 10) : 0;
+            size_t header_len = end + 4 - buffer;
+            if (!continued && (strcasestr(buffer, "\r\nExpect: 100-continue") != NULL) &&
+                (*used < header_len + length))
+            {
+                const char *reply = "HTTP/1.1 100 Continue\r\n\r\n";
+                if (write(fd, reply, strlen(reply)) < 0)
+                    return false;
+                continued = true;
+            }
+            if (*used >= header_len + length)
+            {
+                *body = buffer + header_len;
+                *body_len = length;
+                return true;
+            }
+        }
+
+        if (*used + 1 >= capacity)
+            return false;
+        ssize_t r = read(fd, buffer + *used, capacity - *used - 1);
+        if (r <= 0)
+            return false;
+        *used += r;
+    }
+}
+
+typedef struct replay_connection
+{
+    replay_context_t *ctx;
+    int fd;
+} replay_connection_t;
+
+static void *connection_thread(void *data)
+{
+    replay_connection_t *conn = data;
+    replay_context_t *ctx = conn->ctx;
+    char *buffer = malloc(REPLAY_HTTP_BUFFER);
+    size_t used = 0;
+
+    while ((buffer != NULL) && !ctx->stop)
+    {
+        char *body = NULL;
+        size_t body_len = 0;
+        if (!read_request(conn->fd, buffer, REPLAY_HTTP_BUFFER, &used, &body, &body_len))
+            break;
+
+        char saved = body[body_len];
+        body[body_len] = '\0';
+
+        char *response = NULL;
+        size_t size = 0;
+        if (strstr(buffer, "/getUpdates ") != NULL)
+        {
+            serve_get_updates(ctx, body, &response, &size);
+        }
+        else
+        {
+            pthread_mutex_lock(&(ctx->lock));
+            ctx->other_calls++;
+            pthread_mutex_unlock(&(ctx->lock));
+            response = strdup("{\"ok\":true,\"result\":true}");
+            size = response ? strlen(response) : 0;
+        }
+        body[body_len] = saved;
+
+        char header[128];
+        int header_len = snprintf(header, sizeof(header),
+                                  "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                                  "Content-Length: %zu\r\n\r\n", size);
+        bool ok = (response != NULL) && (write(conn->fd, header, header_len) == header_len) &&
+                  (write(conn->fd, response, size) == (ssize_t)size);
+        free(response);
+        if (!ok)
+            break;
+
+        /* Keep pipelined remainder for the next request */
+        size_t consumed = (body + body_len) - buffer;
+        memmove(buffer, buffer + consumed, used - consumed);
+        used -= consumed;
+    }
+
+    free(buffer);
+    close(conn->fd);
+    free(conn);
+    return NULL;
+}
+
+static void *server_thread(void *data)
+{
+    replay_context_t *ctx = data;
+    while (!ctx->stop)
+    {
+        int fd = accept(ctx->listen_fd, NULL, NULL);
+        if (fd < 0)
+            continue;
+
+        /* Header and body are written separately, don't hold the body back on persistent connections */
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        replay_connection_t *conn = malloc(sizeof(replay_connection_t));
+        pthread_t thread;
+        if (conn == NULL)
+        {
+            close(fd);
+            continue;
+        }
+        conn->ctx = ctx;
+        conn->fd = fd;
+        if (pthread_create(&thread, NULL, connection_thread, conn) != 0)
+        {
+            close(fd);
+            free(conn);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+static int start_server(replay_context_t *ctx, int port)
+{
+    struct sockaddr_in addr = {0};
+    socklen_t addr_len = sizeof(addr);
+    int one = 1;
+
+    ctx->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (ctx->listen_fd < 0)
+        return -1;
+
+    setsockopt(ctx->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if ((bind(ctx->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+        (listen(ctx->listen_fd, 64) != 0) ||
+        (getsockname(ctx->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0))
+    {
+        close(ctx->listen_fd);
+        return -1;
+    }
+
+    return ntohs(addr.sin_port);
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct replay_options
+{
+    double speed;
+    int port;
+    bool reply;
+    int senders;
+    telebot_http_version_e http_version;
+    const char *api_url;
+} replay_options_t;
+
+typedef struct replay_reply
+{
+    long long chat_id;
+    char *text;
+} replay_reply_t;
+
+/* Replies queued by the polling thread, sent by sender threads or inline */
+typedef struct replay_sender
+{
+    telebot_handler_t handle;
+    telebot_prepared_request_t echo;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    replay_reply_t *queue;
+    int queued;
+    int next;
+    bool stop;
+    int sent;
+    double *latency; /* Duration of each sent reply request */
+} replay_sender_t;
+
+static void send_reply(replay_sender_t *sender, replay_reply_t *reply)
+{
+    double start = now_ms();
+    telebot_error_e ret = telebot_send_prepared_message(sender->handle, sender->echo, reply->chat_id,
+                                                        reply->text, 0);
+    double duration = now_ms() - start;
+
+    pthread_mutex_lock(&(sender->lock));
+    if (ret == TELEBOT_ERROR_NONE)
+        sender->latency[sender->sent++] = duration;
+    pthread_mutex_unlock(&(sender->lock));
+
+    free(reply->text);
+    reply->text = NULL;
+}
+
+static void *sender_thread(void *data)
+{
+    replay_sender_t *sender = data;
+
+    pthread_mutex_lock(&(sender->lock));
+    while (true)
+    {
+        while (!sender->stop && (sender->next == sender->queued))
+            pthread_cond_wait(&(sender->cond), &(sender->lock));
+        if (sender->next == sender->queued)
+            break;
+
+        replay_reply_t *reply = &(sender->queue[sender->next++]);
+        pthread_mutex_unlock(&(sender->lock));
+        send_reply(sender, reply);
+        pthread_mutex_lock(&(sender->lock));
+    }
+    pthread_mutex_unlock(&(sender->lock));
+
+    return NULL;
+}
+
+static void print_latency(const char *title, double *latency, int count)
+{
+    if (count == 0)
+        return;
+
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += latency[i];
+    qsort(latency, count, sizeof(double), compare_double);
+    printf("%-19s avg %.2f, p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n", title, sum / count,
+           latency[count / 2], latency[count * 9 / 10], latency[count * 99 / 100], latency[count - 1]);
+}
+
+static int do_replay(const char *path, const replay_options_t *options)
+{
+    replay_context_t ctx = {0};
+    if (load_capture(path, &ctx.updates, &ctx.count) != 0)
+        return -1;
+
+    ctx.speed = options->speed;
+    pthread_mutex_init(&ctx.lock, NULL);
+    pthread_cond_init(&ctx.cond, NULL);
+
+    bool reply = options->reply;
+    int port = start_server(&ctx, options->port);
+    if (port < 0)
+    {
+        printf("Failed to start mock server\n");
+        return -1;
+    }
+
+    telebot_handler_t handle;
+    if (telebot_create(&handle, REPLAY_TOKEN) != TELEBOT_ERROR_NONE)
+    {
+        printf("Telebot create failed\n");
+        return -1;
+    }
+
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d", port);
+    const char *api_url = (options->api_url != NULL) ? options->api_url : url;
+    telebot_set_api_url(handle, api_url);
+    if ((options->http_version != TELEBOT_HTTP_VERSION_DEFAULT) &&
+        (telebot_set_http_version(handle, options->http_version, 0, 0) != TELEBOT_ERROR_NONE))
+    {
+        printf("Failed to set HTTP version\n");
+        telebot_destroy(handle);
+        return -1;
+    }
+    printf("Replaying %d updates from %s at %gx via %s (mock server %s)\n", ctx.count, path,
+           options->speed, api_url, url);
+
+    /* Echo replies differ only in chat and text */
+    telebot_prepared_request_t echo = NULL;
+    if (reply && (telebot_prepare_send_message(handle, "", false, false, "", &echo) != TELEBOT_ERROR_NONE))
+    {
+        printf("Failed to prepare echo reply\n");
+        reply = false;
+    }
+
+    replay_sender_t sender = {.handle = handle, .echo = echo};
+    pthread_mutex_init(&sender.lock, NULL);
+    pthread_cond_init(&sender.cond, NULL);
+    sender.queue = calloc(ctx.count, sizeof(replay_reply_t));
+    sender.latency = calloc(ctx.count, sizeof(double));
+    if ((sender.queue == NULL) || (sender.latency == NULL))
+        reply = false;
+
+    pthread_t *senders = NULL;
+    int sender_count = 0;
+    if (reply && (options->senders > 0))
+    {
+        senders = calloc(options->senders, sizeof(pthread_t));
+        for (; (senders != NULL) && (sender_count < options->senders); sender_count++)
+        {
+            if (pthread_create(&senders[sender_count], NULL, sender_thread, &sender) != 0)
+                break;
+        }
+    }
+
+    ctx.start_ms = now_ms();
+    pthread_t server;
+    pthread_create(&server, NULL, server_thread, &ctx);
+
+    int handled = 0, replies = 0;
+    while (handled < ctx.count)
+    {
+        telebot_update_t *updates = NULL;
+        int count = 0;
+        if (telebot_get_updates(handle, 0, REPLAY_BATCH_LIMIT, 1, NULL, 0, &updates, &count) != TELEBOT_ERROR_NONE)
+            continue;
+
+        double received_ms = now_ms();
+        for (int index = 0; index < count; index++)
+        {
+            int id = updates[index].update_id;
+            if ((id >= 1) && (id <= ctx.count) && (ctx.updates[id - 1].handled_ms < 0))
+            {
+                ctx.updates[id - 1].handled_ms = received_ms;
+                handled++;
+            }
+
+            telebot_message_t *message = updates[index].message;
+            if (reply && (updates[index].update_type == TELEBOT_UPDATE_TYPE_MESSAGE) &&
+                (message->chat != NULL) && (message->text != NULL))
+            {
+                pthread_mutex_lock(&sender.lock);
+                replay_reply_t *queued = &(sender.queue[sender.queued]);
+                queued->chat_id = message->chat->id;
+                queued->text = strdup(message->text);
+                if (sender_count > 0)
+                    sender.queued++;
+                pthread_cond_signal(&sender.cond);
+                pthread_mutex_unlock(&sender.lock);
+
+                if (sender_count == 0)
+                    send_reply(&sender, queued);
+            }
+        }
+        telebot_put_updates(updates, count);
+    }
+
+    pthread_mutex_lock(&sender.lock);
+    sender.stop = true;
+    pthread_cond_broadcast(&sender.cond);
+    pthread_mutex_unlock(&sender.lock);
+    for (int i = 0; i < sender_count; i++)
+        pthread_join(senders[i], NULL);
+    free(senders);
+    replies = sender.sent;
+    double elapsed_ms = now_ms() - ctx.start_ms;
+
+    double *latency = malloc(ctx.count * sizeof(double));
+    double sum = 0;
+    for (int i = 0; latency && (i < ctx.count); i++)
+    {
+        latency[i] = ctx.updates[i].handled_ms - ctx.updates[i].released_ms;
+        sum += latency[i];
+    }
+
+    printf("Updates handled:   %d in %.1f ms\n", handled, elapsed_ms);
+    printf("Throughput:        %.1f updates/s\n", handled * 1000.0 / elapsed_ms);
+    printf("Replies sent:      %d by %s\n", replies,
+           (sender_count > 0) ? "sender threads" : "polling thread");
+    printf("Mock requests:     %d getUpdates, %d other\n", ctx.get_updates_calls, ctx.other_calls);
+    if (latency != NULL)
+    {
+        qsort(latency, ctx.count, sizeof(double), compare_double);
+        printf("Latency (ms):      avg %.2f, p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n",
+               sum / ctx.count, latency[ctx.count / 2], latency[ctx.count * 9 / 10],
+               latency[ctx.count * 99 / 100], latency[ctx.count - 1]);
+    }
+
+    telebot_stats_t stats;
+    if (telebot_get_stats(handle, &stats) == TELEBOT_ERROR_NONE)
+    {
+        unsigned long long lookups = stats.buffer_pool_hits + stats.buffer_pool_misses;
+        printf("Buffer pool:       %.1f%% hits (%llu/%llu), %llu grows, %llu bytes retained\n",
+               lookups ? stats.buffer_pool_hits * 100.0 / lookups : 0.0, stats.buffer_pool_hits, lookups,
+               stats.buffer_pool_grows, stats.buffer_pool_retained);
+        printf("Connections:       %llu opened for %llu requests\n", stats.http_connections,
+               stats.http_requests);
+    }
+    print_latency("Reply latency (ms):", sender.latency, sender.sent);
+
+    ctx.stop = true;
+    pthread_cond_broadcast(&ctx.cond);
+    shutdown(ctx.listen_fd, SHUT_RDWR);
+    close(ctx.listen_fd);
+    pthread_join(server, NULL);
+
+    if (echo != NULL)
+        telebot_put_prepared_request(echo);
+    telebot_destroy(handle);
+    for (int i = 0; i < ctx.count; i++)
+        free(ctx.updates[i].payload);
+    free(ctx.updates);
+    free(latency);
+    free(sender.queue);
+    free(sender.latency);
+    pthread_cond_destroy(&sender.cond);
+    pthread_mutex_destroy(&sender.lock);
+
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage:\n"
+           "  %s record <capture> [count] [--redact-text]\n"
+           "  %s replay <capture> [--speed N] [--port N] [--no-reply]\n"
+           "         [--senders N] [--http 1.1|2|h2c] [--api-url URL]\n", name, name);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        usage(argv[0]);
+        return -1;
+    }
+
+    if (strcmp(argv[1], "record") == 0)
+    {
+        int count = 0;
+        bool redact_text = false;
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--redact-text") == 0)
+                redact_text = true;
+            else
+                count = atoi(argv[i]);
+        }
+        return do_record(argv[2], count, redact_text);
+    }
+
+    if (strcmp(argv[1], "replay") == 0)
+    {
+        replay_options_t options = {.speed = 1.0, .reply = true};
+        for (int i = 3; i < argc; i++)
+        {
+            if ((strcmp(argv[i], "--speed") == 0) && (i + 1 < argc))
+                options.speed = atof(argv[++i]);
+            else if ((strcmp(argv[i], "--port") == 0) && (i + 1 < argc))
+                options.port = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--no-reply") == 0)
+                options.reply = false;
+            else if ((strcmp(argv[i], "--senders") == 0) && (i + 1 < argc))
+                options.senders = atoi(argv[++i]);
+            else if ((strcmp(argv[i], "--api-url") == 0) && (i + 1 < argc))
+                options.api_url = argv[++i];
+            else if ((strcmp(argv[i], "--http") == 0) && (i + 1 < argc))
+            {
+                const char *version = argv[++i];
+                if (strcmp(version, "1.1") == 0)
+                    options.http_version = TELEBOT_HTTP_VERSION_1_1;
+                else if (strcmp(version, "2") == 0)
+                    options.http_version = TELEBOT_HTTP_VERSION_2;
+                else if (strcmp(version, "h2c") == 0)
+                    options.http_version = TELEBOT_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+            }
+        }
+        return do_replay(argv[2], &options);
+    }
+
+    usage(argv[0]);
+    return -1;
+}
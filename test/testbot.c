@@ -74,8 +74,21 @@ void handle_message(telebot_handler_t handle, telebot_message_t *message)
     }
     else if (strstr(message->text, "/keyboard"))
     {
-        const char *keyboard = "{\"keyboard\":[[{\"text\":\"Button 1\"},{\"text\":\"Button 2\"}],[{\"text\":\"Button 3\"}]],\"resize_keyboard\":true,\"one_time_keyboard\":true}";
-        ret = telebot_send_message(handle, message->chat->id, "Testing reply keyboard:", "", false, false, 0, keyboard);
+        telebot_markup_t markup = NULL;
+        const char *keyboard = NULL;
+        ret = telebot_markup_create(&markup);
+        if (ret == TELEBOT_ERROR_NONE)
+        {
+            telebot_markup_reply_keyboard(markup, false, true, true, NULL, false);
+            telebot_markup_text_button(markup, "Button 1", false, false);
+            telebot_markup_text_button(markup, "Button 2", false, false);
+            telebot_markup_row(markup);
+            telebot_markup_text_button(markup, "Button 3", false, false);
+            ret = telebot_markup_get_json(markup, &keyboard);
+            if (ret == TELEBOT_ERROR_NONE)
+                ret = telebot_send_message(handle, message->chat->id, "Testing reply keyboard:", "", false, false, 0, keyboard);
+            telebot_markup_destroy(markup);
+        }
     }
     else if (strstr(message->text, "/poll"))
     {
@@ -257,11 +270,11 @@ int main(int argc, char *argv[])
         {
             if (updates[index].update_type == TELEBOT_UPDATE_TYPE_MESSAGE)
             {
-                handle_message(handle, &(updates[index].message));
+                handle_message(handle, updates[index].message);
             }
             else if (updates[index].update_type == TELEBOT_UPDATE_TYPE_CALLBACK_QUERY)
             {
-                handle_callback_query(handle, &(updates[index].callback_query));
+                handle_callback_query(handle, updates[index].callback_query);
             }
             offset = updates[index].update_id + 1;
         }